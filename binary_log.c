@@ -0,0 +1,571 @@
+/**
+ * Binary Log - Deferred-Formatting Log Records
+ *
+ * Parses printf formats into argument layouts, copies a call's raw
+ * arguments into a record and renders them back to text offline. Only the
+ * conversions the formats in this code base use need to round-trip:
+ * integers of every width, doubles, narrow strings, characters and
+ * pointers. Anything else (%n, wide strings, long double) is reported as
+ * unsupported and the host logs that call as text instead.
+ */
+
+#include "include/core/binary_log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BINARY_ARG_UNSIGNED 0x80        // Flag on integer types: zero-extend, print unsigned
+#define BINARY_LOG_SPEC_SIZE 32
+
+typedef enum {
+    SPEC_LENGTH_NONE,
+    SPEC_LENGTH_SHORT,          // h, hh: printf still takes an int
+    SPEC_LENGTH_LONG,           // l
+    SPEC_LENGTH_LLONG,          // ll, j, I64
+    SPEC_LENGTH_SIZE,           // z, t, I
+    SPEC_LENGTH_INT,            // I32
+    SPEC_LENGTH_LONG_DOUBLE     // L
+} SpecLength;
+
+// One conversion specification, '%' through the conversion character
+typedef struct {
+    const char* start;
+    const char* end;
+    int stars;                  // '*' width and/or precision, each an int argument
+    SpecLength length;
+    const char* length_start;   // Length modifier position within the spec
+    const char* length_end;
+    char conversion;
+} FormatSpec;
+
+static const char* BinaryLog_ScanSpec(const char* p, FormatSpec* spec) {
+    memset(spec, 0, sizeof(*spec));
+    spec->start = p++;
+
+    while (*p && strchr("-+ #0'", *p)) p++;
+    if (*p == '*') {
+        spec->stars++;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->stars++;
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') p++;
+        }
+    }
+
+    spec->length_start = p;
+    if (p[0] == 'h') {
+        spec->length = SPEC_LENGTH_SHORT;
+        p += p[1] == 'h' ? 2 : 1;
+    } else if (p[0] == 'l') {
+        spec->length = p[1] == 'l' ? SPEC_LENGTH_LLONG : SPEC_LENGTH_LONG;
+        p += p[1] == 'l' ? 2 : 1;
+    } else if (p[0] == 'j') {
+        spec->length = SPEC_LENGTH_LLONG;
+        p++;
+    } else if (p[0] == 'z' || p[0] == 't') {
+        spec->length = SPEC_LENGTH_SIZE;
+        p++;
+    } else if (p[0] == 'L') {
+        spec->length = SPEC_LENGTH_LONG_DOUBLE;
+        p++;
+    } else if (p[0] == 'I' && p[1] == '6' && p[2] == '4') {
+        spec->length = SPEC_LENGTH_LLONG;
+        p += 3;
+    } else if (p[0] == 'I' && p[1] == '3' && p[2] == '2') {
+        spec->length = SPEC_LENGTH_INT;
+        p += 3;
+    } else if (p[0] == 'I') {
+        spec->length = SPEC_LENGTH_SIZE;
+        p++;
+    }
+    spec->length_end = p;
+
+    if (!*p) return NULL;
+    spec->conversion = *p++;
+    spec->end = p;
+    return p;
+}
+
+// Argument type of a conversion; 0 for none (%%), -1 if unsupported
+static int BinaryLog_SpecType(const FormatSpec* spec) {
+    switch (spec->conversion) {
+        case '%':
+            return 0;
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': {
+            int flag = spec->conversion == 'd' || spec->conversion == 'i' ? 0 : BINARY_ARG_UNSIGNED;
+            switch (spec->length) {
+                case SPEC_LENGTH_LONG: return BINARY_ARG_LONG | flag;
+                case SPEC_LENGTH_LLONG: return BINARY_ARG_LLONG | flag;
+                case SPEC_LENGTH_SIZE: return BINARY_ARG_SIZE | flag;
+                case SPEC_LENGTH_LONG_DOUBLE: return -1;
+                default: return BINARY_ARG_INT | flag;
+            }
+        }
+        case 'c':
+            return spec->length == SPEC_LENGTH_NONE ? BINARY_ARG_INT : -1;
+        case 's':
+            return spec->length == SPEC_LENGTH_NONE ? BINARY_ARG_STRING : -1;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            return spec->length == SPEC_LENGTH_LONG_DOUBLE ? -1 : BINARY_ARG_DOUBLE;
+        case 'p':
+            return BINARY_ARG_POINTER;
+        default:
+            return -1;
+    }
+}
+
+bool BinaryLog_ParseFormat(const char* format, uint8_t* types, uint8_t* count) {
+    if (!format || !types || !count) return false;
+
+    uint8_t n = 0;
+    for (const char* p = format; *p; ) {
+        if (*p != '%') {
+            p++;
+            continue;
+        }
+
+        FormatSpec spec;
+        p = BinaryLog_ScanSpec(p, &spec);
+        if (!p) return false;
+
+        int type = BinaryLog_SpecType(&spec);
+        if (type < 0) return false;
+        if (type == 0) continue;
+        if (n + spec.stars + 1 > LOG_SITE_MAX_ARGS) return false;
+
+        for (int i = 0; i < spec.stars; i++) {
+            types[n++] = BINARY_ARG_INT;
+        }
+        types[n++] = (uint8_t)type;
+    }
+    *count = n;
+    return true;
+}
+
+const uint8_t* BinaryLog_SiteTypes(LogSite* site, uint8_t* scratch, uint8_t* count) {
+    if (!site || !count) return NULL;
+
+    int32_t state = __atomic_load_n(&site->state, __ATOMIC_ACQUIRE);
+    if (state == LOG_SITE_READY) {
+        *count = site->arg_count;
+        return site->arg_types;
+    }
+    if (state == LOG_SITE_UNSUPPORTED) return NULL;
+
+    int32_t expected = LOG_SITE_UNPARSED;
+    if (state == LOG_SITE_UNPARSED &&
+        __atomic_compare_exchange_n(&site->state, &expected, LOG_SITE_PARSING, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        bool supported = BinaryLog_ParseFormat(site->format, site->arg_types, &site->arg_count);
+        __atomic_store_n(&site->state, supported ? LOG_SITE_READY : LOG_SITE_UNSUPPORTED,
+                         __ATOMIC_RELEASE);
+        if (!supported) return NULL;
+        *count = site->arg_count;
+        return site->arg_types;
+    }
+
+    // Another thread is parsing this site right now
+    if (!scratch || !BinaryLog_ParseFormat(site->format, scratch, count)) return NULL;
+    return scratch;
+}
+
+static void BinaryLog_PutU16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static void BinaryLog_PutU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = (uint8_t)(value >> (8 * i));
+}
+
+static void BinaryLog_PutU64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out[i] = (uint8_t)(value >> (8 * i));
+}
+
+static uint16_t BinaryLog_GetU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t BinaryLog_GetU32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) value = (value << 8) | in[i];
+    return value;
+}
+
+static uint64_t BinaryLog_GetU64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) value = (value << 8) | in[i];
+    return value;
+}
+
+size_t BinaryLog_EncodeArgs(const uint8_t* types, uint8_t count, uint8_t* out, size_t capacity,
+                            va_list args) {
+    if (!out || (count > 0 && !types)) return 0;
+
+    // Fixed-size arguments first, so strings know how much room is left
+    size_t fixed = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        fixed += (types[i] & ~BINARY_ARG_UNSIGNED) == BINARY_ARG_STRING ? 2 : 8;
+    }
+    if (fixed > capacity) return 0;
+    size_t spare = capacity - fixed;
+
+    size_t offset = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        bool is_unsigned = (types[i] & BINARY_ARG_UNSIGNED) != 0;
+        uint64_t value = 0;
+
+        switch (types[i] & ~BINARY_ARG_UNSIGNED) {
+            case BINARY_ARG_INT:
+                value = is_unsigned ? (uint64_t)va_arg(args, unsigned int)
+                                    : (uint64_t)(int64_t)va_arg(args, int);
+                break;
+            case BINARY_ARG_LONG:
+                value = is_unsigned ? (uint64_t)va_arg(args, unsigned long)
+                                    : (uint64_t)(int64_t)va_arg(args, long);
+                break;
+            case BINARY_ARG_LLONG:
+                value = is_unsigned ? (uint64_t)va_arg(args, unsigned long long)
+                                    : (uint64_t)(int64_t)va_arg(args, long long);
+                break;
+            case BINARY_ARG_SIZE:
+                value = is_unsigned ? (uint64_t)va_arg(args, size_t)
+                                    : (uint64_t)(int64_t)va_arg(args, ptrdiff_t);
+                break;
+            case BINARY_ARG_DOUBLE: {
+                double number = va_arg(args, double);
+                memcpy(&value, &number, sizeof(value));
+                break;
+            }
+            case BINARY_ARG_POINTER:
+                value = (uint64_t)(uintptr_t)va_arg(args, void*);
+                break;
+            case BINARY_ARG_STRING: {
+                const char* text = va_arg(args, const char*);
+                if (!text) text = "(null)";
+                size_t length = strlen(text);
+                if (length > spare) length = spare;
+                if (length > 0xFFFF) length = 0xFFFF;
+                spare -= length;
+
+                BinaryLog_PutU16(out + offset, (uint16_t)length);
+                memcpy(out + offset + 2, text, length);
+                offset += 2 + length;
+                continue;
+            }
+            default:
+                return 0;
+        }
+        BinaryLog_PutU64(out + offset, value);
+        offset += 8;
+    }
+    return offset;
+}
+
+// Rewrite a spec for the decoder: integers wider than int print as long long
+static bool BinaryLog_BuildSpec(const FormatSpec* spec, int type, char* out, size_t size) {
+    size_t prefix = (size_t)(spec->length_start - spec->start);
+    const char* length = "";
+    int base = type & ~BINARY_ARG_UNSIGNED;
+
+    if (base == BINARY_ARG_LONG || base == BINARY_ARG_LLONG || base == BINARY_ARG_SIZE) {
+        length = "ll";
+    } else if (spec->length == SPEC_LENGTH_SHORT) {
+        prefix = (size_t)(spec->length_end - spec->start);
+    }
+    if (prefix + strlen(length) + 2 > size) return false;
+
+    memcpy(out, spec->start, prefix);
+    size_t n = prefix + strlen(length);
+    memcpy(out + prefix, length, strlen(length));
+    out[n++] = spec->conversion;
+    out[n] = '\0';
+    return true;
+}
+
+// snprintf with up to two '*' arguments before the value
+#define BINARY_LOG_PRINT(out, size, spec, stars, star, value) \
+    ((stars) == 0 ? snprintf(out, size, spec, value) \
+     : (stars) == 1 ? snprintf(out, size, spec, (star)[0], value) \
+     : snprintf(out, size, spec, (star)[0], (star)[1], value))
+
+size_t BinaryLog_Format(const char* format, const uint8_t* args, size_t length, char* out,
+                        size_t size) {
+    if (!out || size == 0) return 0;
+    out[0] = '\0';
+    if (!format) return 0;
+
+    size_t used = 0;
+    size_t offset = 0;
+    for (const char* p = format; *p && used + 1 < size; ) {
+        if (*p != '%') {
+            out[used++] = *p++;
+            continue;
+        }
+
+        FormatSpec spec;
+        const char* next = BinaryLog_ScanSpec(p, &spec);
+        int type = next ? BinaryLog_SpecType(&spec) : -1;
+        if (type == 0) {
+            out[used++] = '%';
+            p = next;
+            continue;
+        }
+        if (type < 0) break;
+
+        int star[2] = {0, 0};
+        bool missing = false;
+        for (int i = 0; i < spec.stars; i++) {
+            if (offset + 8 > length) {
+                missing = true;
+                break;
+            }
+            star[i] = (int)(int64_t)BinaryLog_GetU64(args + offset);
+            offset += 8;
+        }
+
+        char text[BINARY_LOG_TEXT_SIZE];
+        char pattern[BINARY_LOG_SPEC_SIZE];
+        if (missing || !BinaryLog_BuildSpec(&spec, type, pattern, sizeof(pattern))) break;
+
+        int written;
+        bool is_unsigned = (type & BINARY_ARG_UNSIGNED) != 0;
+        if ((type & ~BINARY_ARG_UNSIGNED) == BINARY_ARG_STRING) {
+            if (offset + 2 > length) break;
+            size_t text_length = BinaryLog_GetU16(args + offset);
+            if (offset + 2 + text_length > length) break;
+            if (text_length >= sizeof(text)) text_length = sizeof(text) - 1;
+            memcpy(text, args + offset + 2, text_length);
+            text[text_length] = '\0';
+            offset += 2 + BinaryLog_GetU16(args + offset);
+            written = BINARY_LOG_PRINT(out + used, size - used, pattern, spec.stars, star, text);
+        } else {
+            if (offset + 8 > length) break;
+            uint64_t value = BinaryLog_GetU64(args + offset);
+            offset += 8;
+
+            switch (type & ~BINARY_ARG_UNSIGNED) {
+                case BINARY_ARG_INT:
+                    written = is_unsigned
+                        ? BINARY_LOG_PRINT(out + used, size - used, pattern, spec.stars, star,
+                                           (unsigned int)value)
+                        : BINARY_LOG_PRINT(out + used, size - used, pattern, spec.stars, star,
+                                           (int)(int64_t)value);
+                    break;
+                case BINARY_ARG_DOUBLE: {
+                    double number;
+                    memcpy(&number, &value, sizeof(number));
+                    written = BINARY_LOG_PRINT(out + used, size - used, pattern, spec.stars, star,
+                                               number);
+                    break;
+                }
+                case BINARY_ARG_POINTER:
+                    written = BINARY_LOG_PRINT(out + used, size - used, pattern, spec.stars, star,
+                                               (void*)(uintptr_t)value);
+                    break;
+                default:
+                    written = is_unsigned
+                        ? BINARY_LOG_PRINT(out + used, size - used, pattern, spec.stars, star,
+                                           (unsigned long long)value)
+                        : BINARY_LOG_PRINT(out + used, size - used, pattern, spec.stars, star,
+                                           (long long)(int64_t)value);
+                    break;
+            }
+        }
+
+        if (written < 0) break;
+        used += (size_t)written < size - used ? (size_t)written : size - used - 1;
+        p = next;
+    }
+
+    out[used] = '\0';
+    return used;
+}
+
+static size_t BinaryLog_PutRecordHeader(uint8_t* out, size_t capacity, BinaryLogRecordType type,
+                                        size_t payload) {
+    if (payload > 0xFFFF || capacity < BINARY_LOG_RECORD_HEADER_SIZE + payload) return 0;
+    out[0] = (uint8_t)type;
+    BinaryLog_PutU16(out + 1, (uint16_t)payload);
+    return BINARY_LOG_RECORD_HEADER_SIZE;
+}
+
+size_t BinaryLog_PutHeader(uint8_t* out, size_t capacity, uint64_t time) {
+    if (!out || capacity < BINARY_LOG_HEADER_SIZE) return 0;
+    memcpy(out, BINARY_LOG_MAGIC, 4);
+    BinaryLog_PutU16(out + 4, BINARY_LOG_VERSION);
+    BinaryLog_PutU16(out + 6, BINARY_LOG_HEADER_SIZE);
+    BinaryLog_PutU64(out + 8, time);
+    return BINARY_LOG_HEADER_SIZE;
+}
+
+size_t BinaryLog_PutDefine(uint8_t* out, size_t capacity, uint32_t id, LogLevel level,
+                           const char* format) {
+    if (!out || !format) return 0;
+    size_t format_length = strlen(format) + 1;
+    size_t header = BinaryLog_PutRecordHeader(out, capacity, BINARY_LOG_DEFINE, 5 + format_length);
+    if (!header) return 0;
+
+    BinaryLog_PutU32(out + header, id);
+    out[header + 4] = (uint8_t)level;
+    memcpy(out + header + 5, format, format_length);
+    return header + 5 + format_length;
+}
+
+size_t BinaryLog_PutEvent(uint8_t* out, size_t capacity, uint32_t id, uint64_t time,
+                          const uint8_t* args, size_t length) {
+    if (!out || (length > 0 && !args)) return 0;
+    size_t header = BinaryLog_PutRecordHeader(out, capacity, BINARY_LOG_EVENT, 12 + length);
+    if (!header) return 0;
+
+    BinaryLog_PutU32(out + header, id);
+    BinaryLog_PutU64(out + header + 4, time);
+    if (length > 0) memcpy(out + header + 12, args, length);
+    return header + 12 + length;
+}
+
+size_t BinaryLog_PutText(uint8_t* out, size_t capacity, LogLevel level, uint64_t time,
+                         const char* message, size_t length) {
+    if (!out || (length > 0 && !message)) return 0;
+    size_t header = BinaryLog_PutRecordHeader(out, capacity, BINARY_LOG_TEXT, 9 + length);
+    if (!header) return 0;
+
+    out[header] = (uint8_t)level;
+    BinaryLog_PutU64(out + header + 1, time);
+    if (length > 0) memcpy(out + header + 9, message, length);
+    return header + 9 + length;
+}
+
+// Session header at the reader's offset: start a new site table
+static bool BinaryLog_ReadHeader(BinaryLogReader* reader, uint64_t* time) {
+    const uint8_t* in = reader->data + reader->offset;
+    size_t remaining = reader->length - reader->offset;
+    if (remaining < BINARY_LOG_HEADER_SIZE || memcmp(in, BINARY_LOG_MAGIC, 4) != 0) return false;
+
+    uint16_t version = BinaryLog_GetU16(in + 4);
+    uint16_t header_size = BinaryLog_GetU16(in + 6);
+    if (version == 0 || version > BINARY_LOG_VERSION || header_size < BINARY_LOG_HEADER_SIZE ||
+        header_size > remaining) {
+        return false;
+    }
+
+    *time = BinaryLog_GetU64(in + 8);
+    memset(reader->sites, 0, sizeof(reader->sites));
+    reader->offset += header_size;
+    reader->sessions++;
+    return true;
+}
+
+bool BinaryLog_Open(BinaryLogReader* reader, const void* data, size_t length) {
+    if (!reader) return false;
+    memset(reader, 0, sizeof(*reader));
+    if (!data) return false;
+
+    reader->data = (const uint8_t*)data;
+    reader->length = length;
+    if (length < BINARY_LOG_HEADER_SIZE || memcmp(data, BINARY_LOG_MAGIC, 4) != 0) {
+        reader->corrupt = true;
+        return false;
+    }
+    return true;
+}
+
+// Decode one record's payload; false if it is malformed
+static bool BinaryLog_ReadRecord(BinaryLogReader* reader, uint8_t type, const uint8_t* payload,
+                                 size_t length, BinaryLogEntry* entry, bool* produced) {
+    *produced = false;
+
+    if (type == BINARY_LOG_DEFINE) {
+        if (length < 6 || payload[length - 1] != '\0') return false;
+        uint32_t id = BinaryLog_GetU32(payload);
+        if (id == 0 || id > BINARY_LOG_MAX_SITES) return false;
+        reader->sites[id].format = (const char*)payload + 5;
+        reader->sites[id].level = (LogLevel)payload[4];
+        return true;
+    }
+
+    if (type == BINARY_LOG_EVENT) {
+        if (length < 12) return false;
+        uint32_t id = BinaryLog_GetU32(payload);
+        entry->type = BINARY_LOG_ENTRY_MESSAGE;
+        entry->site = id;
+        entry->time = BinaryLog_GetU64(payload + 4);
+
+        const BinaryLogDefinition* site = NULL;
+        if (id > 0 && id <= BINARY_LOG_MAX_SITES) site = &reader->sites[id];
+        if (site && site->format) {
+            entry->level = site->level;
+            entry->length = BinaryLog_Format(site->format, payload + 12, length - 12,
+                                             entry->text, sizeof(entry->text));
+        } else {
+            entry->level = LOG_INFO;
+            int written = snprintf(entry->text, sizeof(entry->text), "<undefined log site %lu>",
+                                   (unsigned long)id);
+            entry->length = written > 0 ? (size_t)written : 0;
+        }
+        *produced = true;
+        return true;
+    }
+
+    if (type == BINARY_LOG_TEXT) {
+        if (length < 9) return false;
+        entry->type = BINARY_LOG_ENTRY_MESSAGE;
+        entry->level = (LogLevel)payload[0];
+        entry->time = BinaryLog_GetU64(payload + 1);
+        entry->length = length - 9;
+        if (entry->length >= sizeof(entry->text)) entry->length = sizeof(entry->text) - 1;
+        memcpy(entry->text, payload + 9, entry->length);
+        entry->text[entry->length] = '\0';
+        *produced = true;
+        return true;
+    }
+
+    return false;
+}
+
+bool BinaryLog_Next(BinaryLogReader* reader, BinaryLogEntry* entry) {
+    if (!reader || !entry || reader->corrupt) return false;
+
+    while (reader->offset < reader->length) {
+        memset(entry, 0, sizeof(*entry));
+
+        // Zero is no record type either: the unused tail of a preallocated
+        // segment whose writer never truncated it
+        if (reader->data[reader->offset] == 0) {
+            reader->offset = reader->length;
+            break;
+        }
+
+        // Session headers start with 'M', which is never a record type
+        if (reader->data[reader->offset] == (uint8_t)BINARY_LOG_MAGIC[0]) {
+            if (!BinaryLog_ReadHeader(reader, &entry->time)) break;
+            entry->type = BINARY_LOG_ENTRY_SESSION;
+            return true;
+        }
+
+        size_t remaining = reader->length - reader->offset;
+        if (remaining < BINARY_LOG_RECORD_HEADER_SIZE) break;
+        const uint8_t* record = reader->data + reader->offset;
+        size_t payload_length = BinaryLog_GetU16(record + 1);
+        if (remaining - BINARY_LOG_RECORD_HEADER_SIZE < payload_length) break;
+
+        bool produced;
+        if (!BinaryLog_ReadRecord(reader, record[0], record + BINARY_LOG_RECORD_HEADER_SIZE,
+                                  payload_length, entry, &produced)) {
+            break;
+        }
+        reader->offset += BINARY_LOG_RECORD_HEADER_SIZE + payload_length;
+        if (produced) return true;
+    }
+
+    // Stopped short of the end: malformed or truncated record
+    reader->corrupt = reader->offset < reader->length;
+    return false;
+}
@@ -1,54 +1,441 @@
 #include "mouse_stabilizer.h"
 
+#define LOG_WRITER_IDLE_MS 50                   // Writer wakes at least this often
+#define LOG_WRITER_RECORD_ROOM 4096             // Segment space reserved per record
+#define LOG_STOP_PUBLISH_WAIT_MS 100            // Longest wait for a claimed record at shutdown
+#define FILETIME_TICKS_PER_SECOND 10000000ULL
+
+// [Device <match>] sections, read by Settings_Load
+typedef struct {
+    char match[SETTINGS_DEVICE_NAME_SIZE];
+    DeviceSettings settings;
+} Settings_DeviceSection;
+
+static Settings_DeviceSection g_device_sections[SETTINGS_MAX_DEVICE_SECTIONS];
+static int g_device_section_count = 0;
+
 // Global log level configuration (default: INFO)
-LogLevel g_log_level = LOG_INFO;
+volatile LogLevel g_log_level = LOG_INFO;  // Read inline by LOG_AT on any thread
 
-void Settings_WriteLog(const char* format, ...) {
-    static FILE* log_file = NULL;
-    static bool first_call = true;
-    
-    if (first_call) {
-        char log_path[MAX_PATH];
-        GetModuleFileName(NULL, log_path, MAX_PATH);
-        char* last_slash = strrchr(log_path, '\\');
+// Write mouse_stabilizer.mslog (deferred formatting) instead of the text log
+bool g_log_binary = false;
+
+// Log file limits: segment size, rotated files kept, segment age
+static uint32_t g_log_max_size_kb = LOG_SINK_DEFAULT_SEGMENT_BYTES / 1024;
+static uint32_t g_log_max_files = LOG_SINK_DEFAULT_MAX_FILES;
+static uint32_t g_log_rotate_hours = LOG_SINK_DEFAULT_MAX_AGE_SECONDS / 3600;
+
+// Asynchronous log: callers only format their message into the ring; the
+// writer thread stamps the records and copies them into the mapped log
+// segment. Until the writer starts and after it stops, records are
+// written on the calling thread instead.
+static LogRing g_log_ring;
+static HANDLE g_log_thread = NULL;
+static HANDLE g_log_wake = NULL;                // Auto-reset: urgent record or stop requested
+static volatile LONG g_log_running = 0;         // 1 while callers go through the ring
+static volatile LONG g_log_stop = 0;
+static SRWLOCK g_log_file_lock = SRWLOCK_INIT;  // Guards everything below
+static uint64_t g_log_dropped_total = 0;
+
+// mouse_stabilizer.log and .mslog, each rotating on its own
+static LogSink g_log_text_sink;
+static LogSink g_log_binary_sink;
+static bool g_log_sinks_ready = false;
+static bool g_log_banner_written = false;
+
+// Binary log session: call sites get ids in the order the writer first
+// sees them, starting over in every segment
+static const LogSite* g_log_sites[BINARY_LOG_MAX_SITES];    // Open addressing, id = slot + 1
+
+// "HH:MM:SS" of the last second a record was stamped in
+static uint64_t g_log_stamp_second = UINT64_MAX;
+static char g_log_stamp[9];
+
+static uint64_t Settings_LogTime(void) {
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    return ((uint64_t)now.dwHighDateTime << 32) | now.dwLowDateTime;
+}
+
+static void Settings_LocalTime(uint64_t time, SYSTEMTIME* stamp) {
+    FILETIME utc, local;
+    utc.dwLowDateTime = (DWORD)time;
+    utc.dwHighDateTime = (DWORD)(time >> 32);
+    FileTimeToLocalFileTime(&utc, &local);
+    FileTimeToSystemTime(&local, stamp);
+}
+
+// Called with g_log_file_lock held
+static void Settings_ConfigureLogSinks(void) {
+    LogSinkOptions options;
+    options.segment_bytes = g_log_max_size_kb * 1024;
+    options.max_files = g_log_max_files;
+    options.max_age_seconds = g_log_rotate_hours * 3600;
+    options.trim_padding = true;
+
+    if (!g_log_sinks_ready) {
+        char base[MAX_PATH];
+        GetModuleFileName(NULL, base, MAX_PATH);
+        char* last_slash = strrchr(base, '\\');
         if (last_slash) {
-            strcpy_s(last_slash + 1, MAX_PATH - (last_slash + 1 - log_path), "mouse_stabilizer.log");
+            strcpy_s(last_slash + 1, MAX_PATH - (last_slash + 1 - base), "mouse_stabilizer");
         }
-        
-        if (fopen_s(&log_file, log_path, "a") != 0) {
-            log_file = NULL;
-            // Cannot log here since logging system is not yet initialized
+        LogSink_Initialize(&g_log_text_sink, base, ".log", &options);
+        LogSink_Initialize(&g_log_binary_sink, base, ".mslog", &options);
+        g_log_sinks_ready = true;
+    }
+
+    LogSink_Configure(&g_log_text_sink, &options);
+    options.trim_padding = false;   // Binary records may end in zero bytes
+    LogSink_Configure(&g_log_binary_sink, &options);
+}
+
+// "[HH:MM:SS.mmm LEVEL] message\n"; the clock is only converted once a second
+static size_t Settings_FormatRecord(char* out, size_t size, uint64_t time, LogLevel level,
+                                    const char* message, size_t length) {
+    if (size < 22) return 0;
+    if (length > size - 22) length = size - 22;
+
+    uint64_t second = time / FILETIME_TICKS_PER_SECOND;
+    if (second != g_log_stamp_second) {
+        SYSTEMTIME stamp;
+        Settings_LocalTime(time, &stamp);
+        snprintf(g_log_stamp, sizeof(g_log_stamp), "%02u:%02u:%02u",
+                 stamp.wHour, stamp.wMinute, stamp.wSecond);
+        g_log_stamp_second = second;
+    }
+
+    unsigned millis = (unsigned)((time / 10000) % 1000);
+    out[0] = '[';
+    memcpy(out + 1, g_log_stamp, 8);
+    out[9] = '.';
+    out[10] = (char)('0' + millis / 100);
+    out[11] = (char)('0' + millis / 10 % 10);
+    out[12] = (char)('0' + millis % 10);
+    out[13] = ' ';
+    memcpy(out + 14, Settings_GetLogLevelName(level), 5);
+    out[19] = ']';
+    out[20] = ' ';
+    memcpy(out + 21, message, length);
+    out[21 + length] = '\n';
+    return 22 + length;
+}
+
+// Called with g_log_file_lock held
+static void Settings_AppendText(uint64_t time, LogLevel level, const char* message, size_t length) {
+    bool new_segment;
+    char* out = (char*)LogSink_Reserve(&g_log_text_sink, LOG_WRITER_RECORD_ROOM,
+                                       time / FILETIME_TICKS_PER_SECOND, &new_segment);
+    if (!out) return;
+
+    size_t written = 0;
+    if (new_segment) {
+        SYSTEMTIME stamp;
+        Settings_LocalTime(time, &stamp);
+        int banner = snprintf(out, LOG_WRITER_RECORD_ROOM,
+                              "\n=== Mouse Stabilizer %s: %04u-%02u-%02u %02u:%02u:%02u ===\n",
+                              g_log_banner_written ? "Log Continued" : "Started",
+                              stamp.wYear, stamp.wMonth, stamp.wDay,
+                              stamp.wHour, stamp.wMinute, stamp.wSecond);
+        written = banner > 0 ? (size_t)banner : 0;
+        g_log_banner_written = true;
+    }
+    written += Settings_FormatRecord(out + written, LOG_WRITER_RECORD_ROOM - written, time, level,
+                                     message, length);
+    LogSink_Commit(&g_log_text_sink, written);
+}
+
+// Called with g_log_file_lock held; a new segment starts a new session
+static uint8_t* Settings_ReserveBinary(uint64_t time) {
+    bool new_segment;
+    uint8_t* out = LogSink_Reserve(&g_log_binary_sink, LOG_WRITER_RECORD_ROOM,
+                                   time / FILETIME_TICKS_PER_SECOND, &new_segment);
+    if (!out || !new_segment) return out;
+
+    LogSink_Commit(&g_log_binary_sink, BinaryLog_PutHeader(out, LOG_WRITER_RECORD_ROOM,
+                                                           Settings_LogTime()));
+    memset(g_log_sites, 0, sizeof(g_log_sites));
+    return out + BINARY_LOG_HEADER_SIZE;
+}
+
+// Session id of a call site, 0 if the table is full
+static uint32_t Settings_LogSiteId(const LogSite* site, bool* is_new) {
+    size_t slot = ((uintptr_t)site >> 3) & (BINARY_LOG_MAX_SITES - 1);
+    *is_new = false;
+
+    for (size_t probe = 0; probe < BINARY_LOG_MAX_SITES; probe++) {
+        size_t index = (slot + probe) & (BINARY_LOG_MAX_SITES - 1);
+        if (g_log_sites[index] == site) return (uint32_t)index + 1;
+        if (!g_log_sites[index]) {
+            g_log_sites[index] = site;
+            *is_new = true;
+            return (uint32_t)index + 1;
         }
-        first_call = false;
-        
-        if (log_file) {
-            time_t now = time(NULL);
-            struct tm timeinfo;
-            localtime_s(&timeinfo, &now);
-            
-            fprintf(log_file, "\n=== Mouse Stabilizer Started: %04d-%02d-%02d %02d:%02d:%02d ===\n",
-                    timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
-                    timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-            fflush(log_file);
+    }
+    return 0;
+}
+
+/**
+ * Write one record to the text or binary log (called with g_log_file_lock held)
+ * @param site Call site of a binary record (message holds its raw arguments), NULL for text
+ */
+static void Settings_AppendRecord(uint64_t time, LogLevel level, const LogSite* site,
+                                  const char* message, size_t length) {
+    char text[BINARY_LOG_TEXT_SIZE];
+    if (!g_log_sinks_ready) Settings_ConfigureLogSinks();
+
+    uint8_t* out = g_log_binary ? Settings_ReserveBinary(time) : NULL;
+    size_t capacity = LOG_WRITER_RECORD_ROOM - BINARY_LOG_HEADER_SIZE;
+    if (out && site) {
+        bool is_new;
+        uint32_t id = Settings_LogSiteId(site, &is_new);
+        size_t define = 0;
+        if (is_new) {
+            define = BinaryLog_PutDefine(out, capacity, id, site->level, site->format);
+            if (define == 0) g_log_sites[id - 1] = NULL;
+        }
+
+        if (id != 0 && (!is_new || define > 0)) {
+            size_t event = BinaryLog_PutEvent(out + define, capacity - define, id, time,
+                                              (const uint8_t*)message, length);
+            LogSink_Commit(&g_log_binary_sink, define + event);
+            return;
         }
     }
-    
-    if (!log_file) return;
-    
-    time_t now = time(NULL);
-    struct tm timeinfo;
-    localtime_s(&timeinfo, &now);
-    
-    fprintf(log_file, "[%02d:%02d:%02d] ", 
-            timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-    
+
+    // Text record, or a binary one without an id (table full, format too long) or without a
+    // binary log
+    if (site) {
+        length = BinaryLog_Format(site->format, (const uint8_t*)message, length, text,
+                                  sizeof(text));
+        message = text;
+    }
+    if (out) {
+        LogSink_Commit(&g_log_binary_sink, BinaryLog_PutText(out, capacity, level, time, message,
+                                                             length));
+    } else {
+        Settings_AppendText(time, level, message, length);
+    }
+}
+
+/**
+ * Write out everything in the ring (the writer thread, or Stop after joining it)
+ */
+static void Settings_DrainLog(void) {
+    EventTracer_Begin("Log flush");
+    AcquireSRWLockExclusive(&g_log_file_lock);
+
+    uint64_t dropped = LogRing_TakeDropped(&g_log_ring);
+    if (dropped > 0) {
+        char notice[96];
+        int length = snprintf(notice, sizeof(notice), "%llu log messages dropped (log buffer full)",
+                              (unsigned long long)dropped);
+        Settings_AppendRecord(Settings_LogTime(), LOG_WARN, NULL, notice, (size_t)length);
+        g_log_dropped_total += dropped;
+    }
+
+    const LogRecord* record;
+    int64_t records = 0;
+    while ((record = LogRing_Peek(&g_log_ring)) != NULL) {
+        Settings_AppendRecord(record->time, (LogLevel)record->level, record->site, record->message,
+                              record->length);
+        LogRing_Pop(&g_log_ring);
+        records++;
+    }
+    ReleaseSRWLockExclusive(&g_log_file_lock);
+    EventTracer_Counter("Log records per flush", records);
+    EventTracer_End();
+}
+
+static DWORD WINAPI Settings_LogWriterThread(LPVOID parameter) {
+    (void)parameter;
+    EventTracer_NameThread("Log writer");
+
+    for (;;) {
+        bool stopping = InterlockedCompareExchange(&g_log_stop, 1, 1) == 1;
+        Settings_DrainLog();
+        if (stopping) break;
+        WaitForSingleObject(g_log_wake, LOG_WRITER_IDLE_MS);
+    }
+    return 0;
+}
+
+// Problems and a filling ring are written promptly; the rest waits for the idle tick
+static void Settings_WakeLogWriter(LogLevel level) {
+    if (level <= LOG_WARN || LogRing_Pending(&g_log_ring) >= LOG_RING_CAPACITY / 2) {
+        SetEvent(g_log_wake);
+    }
+}
+
+static void Settings_LogV(LogLevel level, const char* format, va_list args) {
+    if (InterlockedCompareExchange(&g_log_running, 1, 1) == 1) {
+        LogRing_Write(&g_log_ring, level, Settings_LogTime(), format, args);
+        Settings_WakeLogWriter(level);
+        return;
+    }
+
+    char message[LOG_RING_MESSAGE_SIZE];
+    int length = vsnprintf(message, sizeof(message), format, args);
+    if (length < 0) return;
+    if (length >= (int)sizeof(message)) length = (int)sizeof(message) - 1;
+
+    AcquireSRWLockExclusive(&g_log_file_lock);
+    Settings_AppendRecord(Settings_LogTime(), level, NULL, message, (size_t)length);
+    ReleaseSRWLockExclusive(&g_log_file_lock);
+}
+
+bool Settings_StartLogWriter(void) {
+    static bool exit_hook = false;
+    if (InterlockedCompareExchange(&g_log_running, 1, 1) == 1) return true;
+
+    LogRing_Initialize(&g_log_ring);
+    g_log_stop = 0;
+    g_log_wake = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (!g_log_wake) return false;
+
+    g_log_thread = CreateThread(NULL, 0, Settings_LogWriterThread, NULL, 0, NULL);
+    if (!g_log_thread) {
+        CloseHandle(g_log_wake);
+        g_log_wake = NULL;
+        return false;
+    }
+    SetThreadPriority(g_log_thread, THREAD_PRIORITY_BELOW_NORMAL);
+
+    // Early returns from WinMain still flush the log
+    if (!exit_hook) {
+        atexit(Settings_StopLogWriter);
+        exit_hook = true;
+    }
+    InterlockedExchange(&g_log_running, 1);
+    return true;
+}
+
+void Settings_StopLogWriter(void) {
+    if (InterlockedExchange(&g_log_running, 0) == 1) {
+        InterlockedExchange(&g_log_stop, 1);
+        SetEvent(g_log_wake);
+        WaitForSingleObject(g_log_thread, INFINITE);
+        CloseHandle(g_log_thread);
+        CloseHandle(g_log_wake);
+        g_log_thread = NULL;
+        g_log_wake = NULL;
+
+        // Records from callers that saw the writer running just before the switch.
+        // One of them may still be between claiming its slot and publishing it;
+        // the drain stops at that slot, so give it a moment to finish.
+        ULONGLONG deadline = GetTickCount64() + LOG_STOP_PUBLISH_WAIT_MS;
+        for (;;) {
+            Settings_DrainLog();
+            if (LogRing_Pending(&g_log_ring) == 0 || GetTickCount64() >= deadline) break;
+            Sleep(1);
+        }
+    }
+
+    // Cut the segments back to what was written; a later line opens a new one
+    AcquireSRWLockExclusive(&g_log_file_lock);
+    if (g_log_sinks_ready) {
+        LogSink_Close(&g_log_text_sink);
+        LogSink_Close(&g_log_binary_sink);
+    }
+    ReleaseSRWLockExclusive(&g_log_file_lock);
+}
+
+uint64_t Settings_GetLogDropped(void) {
+    return g_log_dropped_total;
+}
+
+uint32_t Settings_GetLogPending(void) {
+    return LogRing_Pending(&g_log_ring);
+}
+
+void Settings_WriteLog(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    vfprintf(log_file, format, args);
+    Settings_LogV(LOG_INFO, format, args);
     va_end(args);
-    
-    fprintf(log_file, "\n");
-    fflush(log_file);
+}
+
+// Only keys present in the section count; GetPrivateProfileInt cannot tell a default from a value
+static bool Settings_ReadDeviceInt(const char* section, const char* key, const char* config_path,
+                                   int* value) {
+    char text[32];
+    DWORD length = GetPrivateProfileString(section, key, "", text, sizeof(text), config_path);
+    if (length == 0) return false;
+    *value = atoi(text);
+    return true;
+}
+
+static void Settings_LoadDeviceSection(const char* section, const char* config_path,
+                                       DeviceSettings* settings) {
+    int value;
+    memset(settings, 0, sizeof(*settings));
+    if (Settings_ReadDeviceInt(section, "FollowStrength", config_path, &value)) {
+        settings->follow_strength = (float)value / (float)STABILIZER_INI_FOLLOW_SCALE;
+        settings->set |= DEVICE_SETTING_FOLLOW_STRENGTH;
+    }
+    if (Settings_ReadDeviceInt(section, "MinDistance", config_path, &value)) {
+        settings->min_distance = (float)value / (float)STABILIZER_INI_DISTANCE_SCALE;
+        settings->set |= DEVICE_SETTING_MIN_DISTANCE;
+    }
+    if (Settings_ReadDeviceInt(section, "EaseType", config_path, &value)) {
+        settings->ease_type = (EaseType)value;
+        settings->set |= DEVICE_SETTING_EASE_TYPE;
+    }
+    if (Settings_ReadDeviceInt(section, "DualMode", config_path, &value)) {
+        settings->dual_mode = value != 0;
+        settings->set |= DEVICE_SETTING_DUAL_MODE;
+    }
+    if (Settings_ReadDeviceInt(section, "DelayStartMs", config_path, &value)) {
+        settings->delay_start_ms = value > 0 ? (uint32_t)value : 0;
+        settings->set |= DEVICE_SETTING_DELAY_START;
+    }
+    if (Settings_ReadDeviceInt(section, "DragOnly", config_path, &value)) {
+        settings->drag_only = value != 0;
+        settings->set |= DEVICE_SETTING_DRAG_ONLY;
+    }
+    if (Settings_ReadDeviceInt(section, "DragButton", config_path, &value)) {
+        settings->drag_button = (DragButton)value;
+        settings->set |= DEVICE_SETTING_DRAG_BUTTON;
+    }
+}
+
+static void Settings_LoadDeviceSections(const char* config_path) {
+    static char names[8192];
+    static const char prefix[] = "Device ";
+    
+    g_device_section_count = 0;
+    DWORD length = GetPrivateProfileSectionNames(names, sizeof(names), config_path);
+    for (const char* name = names; name < names + length && *name; name += strlen(name) + 1) {
+        if (_strnicmp(name, prefix, sizeof(prefix) - 1) != 0 ||
+            name[sizeof(prefix) - 1] == '\0') continue;
+        if (g_device_section_count == SETTINGS_MAX_DEVICE_SECTIONS) {
+            LOG_WARN("More than %d [Device ...] sections, ignoring [%s]",
+                     SETTINGS_MAX_DEVICE_SECTIONS, name);
+            continue;
+        }
+        
+        Settings_DeviceSection* section = &g_device_sections[g_device_section_count++];
+        strcpy_s(section->match, sizeof(section->match), name + sizeof(prefix) - 1);
+        CharLowerA(section->match);
+        Settings_LoadDeviceSection(name, config_path, &section->settings);
+        Settings_WriteLog("Device settings [%s] loaded (overrides 0x%02x)",
+                          name, section->settings.set);
+    }
+}
+
+bool Settings_GetDeviceSettings(const char* device_name, DeviceSettings* settings) {
+    if (!device_name || !settings) return false;
+    
+    char name[SETTINGS_DEVICE_NAME_SIZE];
+    strcpy_s(name, sizeof(name), device_name);
+    CharLowerA(name);
+    for (int i = 0; i < g_device_section_count; i++) {
+        if (strstr(name, g_device_sections[i].match)) {
+            *settings = g_device_sections[i].settings;
+            return true;
+        }
+    }
+    return false;
 }
 
 void Settings_Load(void) {
@@ -60,12 +447,16 @@ void Settings_Load(void) {
     }
     
     g_stabilizer.follow_strength = (float)GetPrivateProfileInt("Settings", "FollowStrength", 
-                                                               (int)(DEFAULT_FOLLOW_STRENGTH * 100), 
-                                                               config_path) / 100.0f;
+                                                               (int)(DEFAULT_FOLLOW_STRENGTH *
+                                                                     STABILIZER_INI_FOLLOW_SCALE),
+                                                               config_path) /
+                                   (float)STABILIZER_INI_FOLLOW_SCALE;
     
     g_stabilizer.min_distance = (float)GetPrivateProfileInt("Settings", "MinDistance", 
-                                                            (int)(DEFAULT_MIN_DISTANCE * 10), 
-                                                            config_path) / 10.0f;
+                                                            (int)(DEFAULT_MIN_DISTANCE *
+                                                                  STABILIZER_INI_DISTANCE_SCALE),
+                                                            config_path) /
+                                (float)STABILIZER_INI_DISTANCE_SCALE;
     
     g_stabilizer.ease_type = (EaseType)GetPrivateProfileInt("Settings", "EaseType", 
                                                             EASE_OUT, config_path);
@@ -75,6 +466,16 @@ void Settings_Load(void) {
     
     g_stabilizer.delay_start_ms = GetPrivateProfileInt("Settings", "DelayStartMs", 
                                                        DEFAULT_DELAY_START_MS, config_path);
+    g_stabilizer.drag_only = GetPrivateProfileInt("Settings", "DragOnly", 
+                                                  DEFAULT_DRAG_ONLY ? 1 : 0, config_path) != 0;
+    g_stabilizer.drag_button = (DragButton)GetPrivateProfileInt("Settings", "DragButton", 
+                                                                DEFAULT_DRAG_BUTTON, config_path);
+    g_device_policy = (DevicePolicy)GetPrivateProfileInt("Settings", "DevicePolicy", 
+                                                         DEFAULT_DEVICE_POLICY, config_path);
+    g_output_mode = (OutputMode)GetPrivateProfileInt("Settings", "OutputMode", 
+                                                     DEFAULT_OUTPUT_MODE, config_path);
+    g_shared_telemetry = GetPrivateProfileInt("Settings", "SharedTelemetry", 0, config_path) != 0;
+    g_metrics_port = GetPrivateProfileInt("Settings", "MetricsPort", 0, config_path);
     g_stabilizer.target_show_distance = (float)GetPrivateProfileInt("Settings", "TargetShowDistance", 
                                                                     (int)(DEFAULT_TARGET_SHOW_DISTANCE * 10), 
                                                                     config_path) / 10.0f;
@@ -90,6 +491,13 @@ void Settings_Load(void) {
     // Load log level setting
     g_log_level = (LogLevel)GetPrivateProfileInt("Settings", "LogLevel", 
                                                  LOG_DEBUG, config_path);  // Default to DEBUG for now
+    g_log_binary = GetPrivateProfileInt("Settings", "BinaryLog", 0, config_path) != 0;
+    g_log_max_size_kb = GetPrivateProfileInt("Settings", "LogMaxSizeKB", 
+                                             LOG_SINK_DEFAULT_SEGMENT_BYTES / 1024, config_path);
+    g_log_max_files = GetPrivateProfileInt("Settings", "LogMaxFiles",
+                                           LOG_SINK_DEFAULT_MAX_FILES, config_path);
+    g_log_rotate_hours = GetPrivateProfileInt("Settings", "LogRotateHours", 
+                                              LOG_SINK_DEFAULT_MAX_AGE_SECONDS / 3600, config_path);
     
     // Load capture exclusion settings
     g_stabilizer.exclude_from_capture = GetPrivateProfileInt("Settings", "ExcludeFromCapture", 
@@ -101,14 +509,17 @@ void Settings_Load(void) {
     g_stabilizer.target_always_visible = GetPrivateProfileInt("Settings", "TargetAlwaysVisible", 
                                                               DEFAULT_TARGET_ALWAYS_VISIBLE ? 1 : 0, config_path) != 0;
     
-    if (g_stabilizer.follow_strength < 0.05f) g_stabilizer.follow_strength = 0.05f;
-    if (g_stabilizer.follow_strength > 1.0f) g_stabilizer.follow_strength = 1.0f;
-    if (g_stabilizer.min_distance < 0.1f) g_stabilizer.min_distance = 0.1f;
-    if (g_stabilizer.min_distance > 5.0f) g_stabilizer.min_distance = 5.0f;
-    if (g_stabilizer.ease_type < 0 || g_stabilizer.ease_type > 3) {
-        g_stabilizer.ease_type = EASE_OUT;
+    StabilizerCore_ClampSettings(&g_stabilizer);
+    if (g_device_policy < DEVICE_POLICY_LAST_ACTIVE || g_device_policy > DEVICE_POLICY_MERGE) {
+        g_device_policy = DEFAULT_DEVICE_POLICY;
+    }
+    if (g_output_mode < OUTPUT_MODE_SET_CURSOR_POS || g_output_mode > OUTPUT_MODE_SEND_INPUT) {
+        g_output_mode = DEFAULT_OUTPUT_MODE;
+    }
+    if (g_metrics_port != 0 && (g_metrics_port < METRICS_SERVER_MIN_PORT ||
+                                g_metrics_port > 65535)) {
+        g_metrics_port = 0;
     }
-    if (g_stabilizer.delay_start_ms > 1000) g_stabilizer.delay_start_ms = 1000;
     if (g_stabilizer.target_show_distance < 1.0f) g_stabilizer.target_show_distance = 1.0f;
     if (g_stabilizer.target_show_distance > 50.0f) g_stabilizer.target_show_distance = 50.0f;
     if (g_stabilizer.pointer_type < POINTER_CIRCLE || g_stabilizer.pointer_type > POINTER_CROSS) {
@@ -119,14 +530,27 @@ void Settings_Load(void) {
     if (g_stabilizer.target_alpha < 50) g_stabilizer.target_alpha = 50;
     if (g_stabilizer.target_alpha > 255) g_stabilizer.target_alpha = 255;
     if (g_log_level < LOG_ERROR || g_log_level > LOG_TRACE) g_log_level = LOG_INFO;
-    
-    Settings_WriteLog("Settings loaded - Follow: %.2f, Ease: %d, Dual: %s, Delay: %dms, TargetDist: %.1f, Enabled: %s",
-             g_stabilizer.follow_strength, g_stabilizer.ease_type,
-             g_stabilizer.dual_mode ? "true" : "false", g_stabilizer.delay_start_ms,
-             g_stabilizer.target_show_distance, g_stabilizer.enabled ? "true" : "false");
+    if (g_log_max_size_kb < 64) g_log_max_size_kb = 64;
+    if (g_log_max_size_kb > 256 * 1024) g_log_max_size_kb = 256 * 1024;
+    if (g_log_max_files > 99) g_log_max_files = 99;
+    if (g_log_rotate_hours > 24 * 365) g_log_rotate_hours = 24 * 365;
+    
+    AcquireSRWLockExclusive(&g_log_file_lock);
+    Settings_ConfigureLogSinks();
+    ReleaseSRWLockExclusive(&g_log_file_lock);
+    
+    Settings_LoadDeviceSections(config_path);
+    Settings_WriteLog("Settings loaded - Follow: %.2f, Ease: %d, Dual: %s, Delay: %dms, "
+                      "TargetDist: %.1f, DragOnly: %s, Enabled: %s",
+                      g_stabilizer.follow_strength, g_stabilizer.ease_type,
+                      g_stabilizer.dual_mode ? "true" : "false", g_stabilizer.delay_start_ms,
+                      g_stabilizer.target_show_distance, g_stabilizer.drag_only ? "true" : "false",
+                      g_stabilizer.enabled ? "true" : "false");
 }
 
 void Settings_Save(void) {
+    EventTracer_Begin("Settings save");
+    
     char config_path[MAX_PATH];
     GetModuleFileName(NULL, config_path, MAX_PATH);
     char* last_slash = strrchr(config_path, '\\');
@@ -154,6 +578,24 @@ void Settings_Save(void) {
     sprintf_s(buffer, sizeof(buffer), "%lu", (unsigned long)g_stabilizer.delay_start_ms);
     WritePrivateProfileString("Settings", "DelayStartMs", buffer, config_path);
     
+    sprintf_s(buffer, sizeof(buffer), "%d", g_stabilizer.drag_only ? 1 : 0);
+    WritePrivateProfileString("Settings", "DragOnly", buffer, config_path);
+    
+    sprintf_s(buffer, sizeof(buffer), "%d", (int)g_stabilizer.drag_button);
+    WritePrivateProfileString("Settings", "DragButton", buffer, config_path);
+    
+    sprintf_s(buffer, sizeof(buffer), "%d", (int)g_device_policy);
+    WritePrivateProfileString("Settings", "DevicePolicy", buffer, config_path);
+    
+    sprintf_s(buffer, sizeof(buffer), "%d", (int)g_output_mode);
+    WritePrivateProfileString("Settings", "OutputMode", buffer, config_path);
+    
+    sprintf_s(buffer, sizeof(buffer), "%d", g_shared_telemetry ? 1 : 0);
+    WritePrivateProfileString("Settings", "SharedTelemetry", buffer, config_path);
+    
+    sprintf_s(buffer, sizeof(buffer), "%d", g_metrics_port);
+    WritePrivateProfileString("Settings", "MetricsPort", buffer, config_path);
+    
     sprintf_s(buffer, sizeof(buffer), "%d", (int)(g_stabilizer.target_show_distance * 10));
     WritePrivateProfileString("Settings", "TargetShowDistance", buffer, config_path);
     
@@ -172,6 +614,18 @@ void Settings_Save(void) {
     sprintf_s(buffer, sizeof(buffer), "%d", (int)g_log_level);
     WritePrivateProfileString("Settings", "LogLevel", buffer, config_path);
     
+    sprintf_s(buffer, sizeof(buffer), "%d", g_log_binary ? 1 : 0);
+    WritePrivateProfileString("Settings", "BinaryLog", buffer, config_path);
+    
+    sprintf_s(buffer, sizeof(buffer), "%u", g_log_max_size_kb);
+    WritePrivateProfileString("Settings", "LogMaxSizeKB", buffer, config_path);
+    
+    sprintf_s(buffer, sizeof(buffer), "%u", g_log_max_files);
+    WritePrivateProfileString("Settings", "LogMaxFiles", buffer, config_path);
+    
+    sprintf_s(buffer, sizeof(buffer), "%u", g_log_rotate_hours);
+    WritePrivateProfileString("Settings", "LogRotateHours", buffer, config_path);
+    
     sprintf_s(buffer, sizeof(buffer), "%d", g_stabilizer.exclude_from_capture ? 1 : 0);
     WritePrivateProfileString("Settings", "ExcludeFromCapture", buffer, config_path);
     
@@ -181,6 +635,7 @@ void Settings_Save(void) {
     sprintf_s(buffer, sizeof(buffer), "%d", g_stabilizer.target_always_visible ? 1 : 0);
     WritePrivateProfileString("Settings", "TargetAlwaysVisible", buffer, config_path);
     
+    EventTracer_End();
     Settings_WriteLog("Settings saved");
 }
 
@@ -189,57 +644,47 @@ void Settings_Save(void) {
  */
 
 void Settings_WriteLogLevel(LogLevel level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    Settings_WriteLogLevelV(level, format, args);
+    va_end(args);
+}
+
+void Settings_WriteLogLevelV(LogLevel level, const char* format, va_list args) {
     // Skip logging if current level is below the message level
     if (level > g_log_level) {
         return;
     }
     
-    static FILE* log_file = NULL;
-    static bool first_call = true;
-    
-    if (first_call) {
-        char log_path[MAX_PATH];
-        GetModuleFileName(NULL, log_path, MAX_PATH);
-        char* last_slash = strrchr(log_path, '\\');
-        if (last_slash) {
-            strcpy_s(last_slash + 1, MAX_PATH - (last_slash + 1 - log_path), "mouse_stabilizer.log");
-        }
-        
-        if (fopen_s(&log_file, log_path, "a") != 0) {
-            log_file = NULL;
-        }
-        first_call = false;
-        
-        if (log_file) {
-            time_t now = time(NULL);
-            struct tm timeinfo;
-            localtime_s(&timeinfo, &now);
-            
-            fprintf(log_file, "\n=== Mouse Stabilizer Started: %04d-%02d-%02d %02d:%02d:%02d ===\n",
-                    timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
-                    timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-            fflush(log_file);
+    Settings_LogV(level, format, args);
+}
+
+void Settings_WriteLogSiteV(LogSite* site, va_list args) {
+    if (!site || site->level > g_log_level) return;
+
+    // Binary mode: copy the raw arguments, the decoder formats them later
+    if (g_log_binary && InterlockedCompareExchange(&g_log_running, 1, 1) == 1) {
+        uint8_t scratch[LOG_SITE_MAX_ARGS];
+        uint8_t count;
+        const uint8_t* types = BinaryLog_SiteTypes(site, scratch, &count);
+        if (types) {
+            uint64_t position;
+            LogRecord* record = LogRing_Claim(&g_log_ring, &position);
+            if (record) {
+                size_t length = BinaryLog_EncodeArgs(types, count, (uint8_t*)record->message,
+                                                     sizeof(record->message), args);
+                record->time = Settings_LogTime();
+                record->site = site;
+                record->level = (uint8_t)site->level;
+                record->length = (uint16_t)length;
+                LogRing_Publish(&g_log_ring, record, position);
+            }
+            Settings_WakeLogWriter(site->level);
+            return;
         }
     }
-    
-    if (!log_file) return;
-    
-    time_t now = time(NULL);
-    struct tm timeinfo;
-    localtime_s(&timeinfo, &now);
-    
-    // Add log level prefix to timestamp
-    const char* level_str = Settings_GetLogLevelName(level);
-    fprintf(log_file, "[%02d:%02d:%02d %s] ", 
-            timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec, level_str);
-    
-    va_list args;
-    va_start(args, format);
-    vfprintf(log_file, format, args);
-    va_end(args);
-    
-    fprintf(log_file, "\n");
-    fflush(log_file);
+
+    Settings_LogV(site->level, site->format, args);
 }
 
 void Settings_SetLogLevel(LogLevel level) {
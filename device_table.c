@@ -0,0 +1,115 @@
+/**
+ * Device Table - Per-Device Stabilizer Storage
+ *
+ * Linear-probing hash table keyed by raw input device handle. Removal uses
+ * backward-shift deletion so probe chains stay short without tombstones.
+ */
+
+#include "include/core/device_table.h"
+
+#include <string.h>
+
+#define DEVICE_TABLE_MASK (DEVICE_TABLE_CAPACITY - 1)
+
+static unsigned int DeviceTable_Hash(void* device) {
+    // Device handles are small, pointer-aligned values; drop the low bits and
+    // spread the rest with a Fibonacci multiplier
+    unsigned int key = (unsigned int)((uintptr_t)device >> 2);
+    return (key * 2654435761u) & DEVICE_TABLE_MASK;
+}
+
+void DeviceTable_Initialize(DeviceTable* table) {
+    if (!table) return;
+
+    memset(table, 0, sizeof(*table));
+}
+
+DeviceEntry* DeviceTable_Find(DeviceTable* table, void* device) {
+    if (!table || !device) return NULL;
+
+    unsigned int slot = DeviceTable_Hash(device);
+    for (int probe = 0; probe < DEVICE_TABLE_CAPACITY; probe++) {
+        DeviceEntry* entry = &table->entries[slot];
+        if (entry->device == device) return entry;
+        if (!entry->device) return NULL;
+        slot = (slot + 1) & DEVICE_TABLE_MASK;
+    }
+
+    return NULL;
+}
+
+DeviceEntry* DeviceTable_Insert(DeviceTable* table, void* device, bool* created) {
+    if (created) *created = false;
+    if (!table || !device) return NULL;
+
+    unsigned int slot = DeviceTable_Hash(device);
+    for (int probe = 0; probe < DEVICE_TABLE_CAPACITY; probe++) {
+        DeviceEntry* entry = &table->entries[slot];
+        if (entry->device == device) return entry;
+        if (!entry->device) {
+            memset(entry, 0, sizeof(*entry));
+            entry->device = device;
+            table->count++;
+            if (created) *created = true;
+            return entry;
+        }
+        slot = (slot + 1) & DEVICE_TABLE_MASK;
+    }
+
+    return NULL;
+}
+
+bool DeviceTable_Remove(DeviceTable* table, void* device) {
+    if (!table || !device) return false;
+
+    unsigned int slot = DeviceTable_Hash(device);
+    int probe;
+    for (probe = 0; probe < DEVICE_TABLE_CAPACITY; probe++) {
+        if (table->entries[slot].device == device) break;
+        if (!table->entries[slot].device) return false;
+        slot = (slot + 1) & DEVICE_TABLE_MASK;
+    }
+    if (probe == DEVICE_TABLE_CAPACITY) return false;
+
+    // Shift later members of the probe chain back into the hole, but only
+    // entries whose home slot does not lie cyclically between hole and entry.
+    // The scan is bounded because a full table has no empty slot to stop at.
+    unsigned int hole = slot;
+    unsigned int next = (hole + 1) & DEVICE_TABLE_MASK;
+    for (int step = 1; step < DEVICE_TABLE_CAPACITY && table->entries[next].device; step++) {
+        unsigned int home = DeviceTable_Hash(table->entries[next].device);
+        unsigned int distance_to_home = (next - home) & DEVICE_TABLE_MASK;
+        unsigned int distance_to_hole = (next - hole) & DEVICE_TABLE_MASK;
+        if (distance_to_home >= distance_to_hole) {
+            table->entries[hole] = table->entries[next];
+            hole = next;
+        }
+        next = (next + 1) & DEVICE_TABLE_MASK;
+    }
+
+    memset(&table->entries[hole], 0, sizeof(table->entries[hole]));
+    table->count--;
+    return true;
+}
+
+void DeviceTable_ApplySettings(DeviceEntry* entry, const SmoothStabilizer* defaults) {
+    if (!entry || !defaults) return;
+
+    SmoothStabilizer* stabilizer = &entry->stabilizer;
+    const DeviceSettings* settings = &entry->settings;
+    StabilizerCore_CopySettings(stabilizer, defaults);
+    if (settings->set & DEVICE_SETTING_FOLLOW_STRENGTH) {
+        stabilizer->follow_strength = settings->follow_strength;
+    }
+    if (settings->set & DEVICE_SETTING_MIN_DISTANCE) {
+        stabilizer->min_distance = settings->min_distance;
+    }
+    if (settings->set & DEVICE_SETTING_EASE_TYPE) stabilizer->ease_type = settings->ease_type;
+    if (settings->set & DEVICE_SETTING_DUAL_MODE) stabilizer->dual_mode = settings->dual_mode;
+    if (settings->set & DEVICE_SETTING_DELAY_START) {
+        stabilizer->delay_start_ms = settings->delay_start_ms;
+    }
+    if (settings->set & DEVICE_SETTING_DRAG_ONLY) stabilizer->drag_only = settings->drag_only;
+    if (settings->set & DEVICE_SETTING_DRAG_BUTTON) stabilizer->drag_button = settings->drag_button;
+    StabilizerCore_ClampSettings(stabilizer);
+}
@@ -0,0 +1,180 @@
+/**
+ * Event Trace - Chrome Trace Event Recording and JSON Export
+ *
+ * Per-thread timeline buffers for the opt-in event tracing mode and the
+ * writer that turns them into a Chrome trace JSON file. Recording is an
+ * array append; all text formatting happens when the trace is written.
+ */
+
+#include "include/core/event_trace.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define EVENT_TRACE_NAME_SIZE 128       // Longer names are cut
+#define EVENT_TRACE_LINE_SIZE 384
+
+void EventTrace_Initialize(EventTraceBuffer* buffer, EventTraceEvent* events, uint32_t capacity,
+                           uint32_t thread_id, const char* thread_name) {
+    if (!buffer) return;
+
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->events = events;
+    buffer->capacity = events ? capacity : 0;
+    buffer->thread_id = thread_id;
+    buffer->thread_name = thread_name;
+}
+
+bool EventTrace_Add(EventTraceBuffer* buffer, EventTracePhase phase, const char* name,
+                    uint64_t time_us, int64_t value) {
+    if (!buffer) return false;
+    if (buffer->count >= buffer->capacity) {
+        buffer->dropped++;
+        return false;
+    }
+
+    EventTraceEvent* event = &buffer->events[buffer->count++];
+    event->name = name;
+    event->time_us = time_us;
+    event->value = value;
+    event->phase = (uint8_t)phase;
+    return true;
+}
+
+// Copy a string as the inside of a JSON string literal
+static void EventTrace_Escape(const char* text, char* out, size_t size) {
+    size_t length = 0;
+    for (const char* c = text ? text : ""; *c && length + 7 < size; c++) {
+        unsigned char ch = (unsigned char)*c;
+        if (ch == '"' || ch == '\\') {
+            out[length++] = '\\';
+            out[length++] = (char)ch;
+        } else if (ch < 0x20) {
+            length += (size_t)snprintf(out + length, size - length, "\\u%04x", ch);
+        } else {
+            out[length++] = (char)ch;
+        }
+    }
+    out[length] = '\0';
+}
+
+static bool EventTrace_Emit(EventTraceWriteFn write, void* context, bool* first, const char* line,
+                            int length) {
+    if (length < 0) return false;
+    if (length >= EVENT_TRACE_LINE_SIZE) length = EVENT_TRACE_LINE_SIZE - 1;
+    if (!*first && !write(context, ",\n", 2)) return false;
+    *first = false;
+    return write(context, line, (size_t)length);
+}
+
+static bool EventTrace_WriteMetadata(EventTraceWriteFn write, void* context, bool* first,
+                                     const char* kind, uint32_t process_id, uint32_t thread_id,
+                                     const char* name) {
+    char line[EVENT_TRACE_LINE_SIZE];
+    char escaped[EVENT_TRACE_NAME_SIZE];
+    EventTrace_Escape(name, escaped, sizeof(escaped));
+    int length = snprintf(line, sizeof(line),
+                          "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%lu,\"tid\":%lu,"
+                          "\"args\":{\"name\":\"%s\"}}",
+                          kind, (unsigned long)process_id, (unsigned long)thread_id, escaped);
+    return EventTrace_Emit(write, context, first, line, length);
+}
+
+static bool EventTrace_WriteBuffer(const EventTraceBuffer* buffer, uint32_t process_id,
+                                   uint64_t origin_us, EventTraceWriteFn write, void* context,
+                                   bool* first) {
+    char line[EVENT_TRACE_LINE_SIZE];
+    char escaped[EVENT_TRACE_NAME_SIZE];
+    unsigned long pid = (unsigned long)process_id;
+    unsigned long tid = (unsigned long)buffer->thread_id;
+
+    if (buffer->thread_name) {
+        if (!EventTrace_WriteMetadata(write, context, first, "thread_name",
+                                      process_id, buffer->thread_id, buffer->thread_name)) {
+            return false;
+        }
+    }
+
+    uint32_t depth = 0;
+    unsigned long long last = 0;
+    for (uint32_t i = 0; i < buffer->count; i++) {
+        const EventTraceEvent* event = &buffer->events[i];
+        unsigned long long ts = event->time_us > origin_us ? event->time_us - origin_us : 0;
+        last = ts;
+        EventTrace_Escape(event->name, escaped, sizeof(escaped));
+
+        int length;
+        switch (event->phase) {
+            case EVENT_TRACE_BEGIN:
+                depth++;
+                length = snprintf(line, sizeof(line),
+                                  "{\"name\":\"%s\",\"ph\":\"B\",\"ts\":%llu,"
+                                  "\"pid\":%lu,\"tid\":%lu}",
+                                  escaped, ts, pid, tid);
+                break;
+            case EVENT_TRACE_END:
+                // An end without its begin (tracing started inside the span) is dropped
+                if (depth == 0) continue;
+                depth--;
+                length = snprintf(line, sizeof(line),
+                                  "{\"ph\":\"E\",\"ts\":%llu,\"pid\":%lu,\"tid\":%lu}",
+                                  ts, pid, tid);
+                break;
+            case EVENT_TRACE_COUNTER:
+                length = snprintf(line, sizeof(line),
+                                  "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%llu,"
+                                  "\"pid\":%lu,\"tid\":%lu,\"args\":{\"value\":%lld}}",
+                                  escaped, ts, pid, tid, (long long)event->value);
+                break;
+            case EVENT_TRACE_INSTANT:
+                length = snprintf(line, sizeof(line),
+                                  "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%llu,"
+                                  "\"pid\":%lu,\"tid\":%lu}",
+                                  escaped, ts, pid, tid);
+                break;
+            default:
+                continue;
+        }
+        if (!EventTrace_Emit(write, context, first, line, length)) return false;
+    }
+
+    // Close what a full buffer or a stop in the middle of a span left open
+    while (depth > 0) {
+        int length = snprintf(line, sizeof(line),
+                              "{\"ph\":\"E\",\"ts\":%llu,\"pid\":%lu,\"tid\":%lu}", last, pid, tid);
+        if (!EventTrace_Emit(write, context, first, line, length)) return false;
+        depth--;
+    }
+    return true;
+}
+
+bool EventTrace_WriteJson(const EventTraceBuffer* const* buffers, int count, uint32_t process_id,
+                          const char* process_name, uint64_t origin_us, EventTraceWriteFn write,
+                          void* context) {
+    if (!write || (count > 0 && !buffers)) return false;
+
+    uint64_t dropped = 0;
+    for (int i = 0; i < count; i++) {
+        if (buffers[i]) dropped += buffers[i]->dropped;
+    }
+
+    char line[EVENT_TRACE_LINE_SIZE];
+    int length = snprintf(line, sizeof(line),
+                          "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":%llu},"
+                          "\"traceEvents\":[\n",
+                          (unsigned long long)dropped);
+    if (!write(context, line, (size_t)length)) return false;
+
+    bool first = true;
+    if (process_name && !EventTrace_WriteMetadata(write, context, &first, "process_name",
+                                                  process_id, 0, process_name)) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (buffers[i] && !EventTrace_WriteBuffer(buffers[i], process_id, origin_us, write, context,
+                                                  &first)) {
+            return false;
+        }
+    }
+    return write(context, "\n]}\n", 4);
+}
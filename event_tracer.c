@@ -0,0 +1,236 @@
+/**
+ * Event Tracer - Opt-In Timeline Tracing for the Win32 Host
+ *
+ * Gives each traced thread its own event buffer, claimed on the thread's
+ * first event and found again through a TLS slot, and writes all buffers
+ * as one Chrome trace JSON file when tracing stops. Recording threads
+ * never wait for each other; only Stop waits for calls in flight.
+ */
+
+#include "mouse_stabilizer.h"
+
+#define EVENT_TRACER_NAMED_THREADS 8
+#define EVENT_TRACER_WRITE_BUFFER (64 * 1024)
+
+typedef struct {
+    DWORD thread_id;
+    const char* name;
+} EventTracer_ThreadName;
+
+static volatile LONG g_event_tracing = 0;
+static volatile LONG g_event_writers = 0;       // Record calls between their two flag checks
+static volatile LONG g_event_claimed = 0;       // Buffers handed to threads this session
+static LONG g_event_session = 0;                // Tells this session's TLS tags from older ones
+static DWORD g_event_tls = TLS_OUT_OF_INDEXES;
+
+static EventTraceEvent* g_event_storage = NULL;
+static EventTraceBuffer g_event_buffers[EVENT_TRACER_THREADS];
+static uint64_t g_event_origin_us = 0;
+static char g_event_path[MAX_PATH] = "";
+
+static EventTracer_ThreadName g_event_thread_names[EVENT_TRACER_NAMED_THREADS];
+static volatile LONG g_event_thread_name_count = 0;
+
+static HANDLE g_event_file = INVALID_HANDLE_VALUE;
+static char g_event_write_buffer[EVENT_TRACER_WRITE_BUFFER];
+static size_t g_event_write_fill = 0;
+
+void EventTracer_NameThread(const char* name) {
+    LONG index = InterlockedIncrement(&g_event_thread_name_count) - 1;
+    if (index >= EVENT_TRACER_NAMED_THREADS) return;
+
+    g_event_thread_names[index].name = name;
+    InterlockedExchange((volatile LONG*)&g_event_thread_names[index].thread_id,
+                        (LONG)GetCurrentThreadId());
+}
+
+static const char* EventTracer_FindThreadName(DWORD thread_id) {
+    LONG count = InterlockedCompareExchange(&g_event_thread_name_count, 0, 0);
+    if (count > EVENT_TRACER_NAMED_THREADS) count = EVENT_TRACER_NAMED_THREADS;
+    for (LONG i = 0; i < count; i++) {
+        if (g_event_thread_names[i].thread_id == thread_id) return g_event_thread_names[i].name;
+    }
+    return NULL;
+}
+
+// TLS tag: session << 8 | buffer index + 1 (0 = no buffer left for this thread)
+static EventTraceBuffer* EventTracer_ThreadBuffer(void) {
+    uintptr_t tag = (uintptr_t)TlsGetValue(g_event_tls);
+    uintptr_t session = (uintptr_t)g_event_session;
+    if ((tag >> 8) == session) {
+        uintptr_t index = tag & 0xFF;
+        return index ? &g_event_buffers[index - 1] : NULL;
+    }
+
+    LONG index = InterlockedIncrement(&g_event_claimed) - 1;
+    if (index >= EVENT_TRACER_THREADS) {
+        TlsSetValue(g_event_tls, (LPVOID)(session << 8));
+        return NULL;
+    }
+
+    DWORD thread_id = GetCurrentThreadId();
+    EventTraceBuffer* buffer = &g_event_buffers[index];
+    EventTrace_Initialize(buffer, g_event_storage + (size_t)index * EVENT_TRACER_EVENTS_PER_THREAD,
+                          EVENT_TRACER_EVENTS_PER_THREAD, (uint32_t)thread_id,
+                          EventTracer_FindThreadName(thread_id));
+    TlsSetValue(g_event_tls, (LPVOID)(session << 8 | (uintptr_t)(index + 1)));
+    return buffer;
+}
+
+static void EventTracer_Record(EventTracePhase phase, const char* name, int64_t value) {
+    if (!g_event_tracing) return;
+
+    // Stop waits for g_event_writers to drain, so a buffer is never written while it is read
+    InterlockedIncrement(&g_event_writers);
+    if (g_event_tracing) {
+        EventTraceBuffer* buffer = EventTracer_ThreadBuffer();
+        if (buffer) {
+            EventTrace_Add(buffer, phase, name, Platform_NowMicros(PlatformWin32_Get()), value);
+        }
+    }
+    InterlockedDecrement(&g_event_writers);
+}
+
+void EventTracer_Begin(const char* name) {
+    EventTracer_Record(EVENT_TRACE_BEGIN, name, 0);
+}
+
+void EventTracer_End(void) {
+    EventTracer_Record(EVENT_TRACE_END, NULL, 0);
+}
+
+void EventTracer_Counter(const char* name, int64_t value) {
+    EventTracer_Record(EVENT_TRACE_COUNTER, name, value);
+}
+
+bool EventTracer_IsActive(void) {
+    return g_event_tracing != 0;
+}
+
+const char* EventTracer_GetPath(void) {
+    return g_event_path;
+}
+
+static void EventTracer_BuildPath(void) {
+    SYSTEMTIME now;
+    char name[64];
+
+    GetLocalTime(&now);
+    sprintf_s(name, sizeof(name), "mouse_stabilizer_events_%04u%02u%02u_%02u%02u%02u.json",
+              now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond);
+
+    GetModuleFileName(NULL, g_event_path, MAX_PATH);
+    char* last_slash = strrchr(g_event_path, '\\');
+    if (last_slash) {
+        strcpy_s(last_slash + 1, MAX_PATH - (last_slash + 1 - g_event_path), name);
+    } else {
+        strcpy_s(g_event_path, MAX_PATH, name);
+    }
+}
+
+bool EventTracer_Start(void) {
+    if (g_event_tracing) return false;
+
+    if (g_event_tls == TLS_OUT_OF_INDEXES) {
+        g_event_tls = TlsAlloc();
+        if (g_event_tls == TLS_OUT_OF_INDEXES) {
+            LOG_ERROR("Failed to allocate event trace TLS slot: error code %lu", GetLastError());
+            return false;
+        }
+    }
+
+    // Committed up front but only touched pages become resident
+    size_t bytes = sizeof(EventTraceEvent) * EVENT_TRACER_EVENTS_PER_THREAD * EVENT_TRACER_THREADS;
+    g_event_storage = (EventTraceEvent*)VirtualAlloc(NULL, bytes, MEM_COMMIT | MEM_RESERVE,
+                                                     PAGE_READWRITE);
+    if (!g_event_storage) {
+        LOG_ERROR("Failed to allocate %llu bytes for event tracing: error code %lu",
+                  (unsigned long long)bytes, GetLastError());
+        return false;
+    }
+
+    memset(g_event_buffers, 0, sizeof(g_event_buffers));
+    g_event_claimed = 0;
+    g_event_session++;
+    g_event_origin_us = Platform_NowMicros(PlatformWin32_Get());
+    InterlockedExchange(&g_event_tracing, 1);
+
+    LOG_INFO("Event tracing started (%u threads, %u events each)", (unsigned)EVENT_TRACER_THREADS,
+             (unsigned)EVENT_TRACER_EVENTS_PER_THREAD);
+    return true;
+}
+
+static bool EventTracer_FlushFile(void) {
+    DWORD written = 0;
+    DWORD fill = (DWORD)g_event_write_fill;
+    bool ok = fill == 0 ||
+              (WriteFile(g_event_file, g_event_write_buffer, fill, &written, NULL) &&
+               written == fill);
+    g_event_write_fill = 0;
+    return ok;
+}
+
+static bool EventTracer_WriteFile(void* context, const char* data, size_t length) {
+    (void)context;
+
+    if (g_event_write_fill + length > sizeof(g_event_write_buffer) &&
+        !EventTracer_FlushFile()) return false;
+    if (length > sizeof(g_event_write_buffer)) {
+        DWORD written = 0;
+        return WriteFile(g_event_file, data, (DWORD)length, &written, NULL) &&
+               written == (DWORD)length;
+    }
+    memcpy(g_event_write_buffer + g_event_write_fill, data, length);
+    g_event_write_fill += length;
+    return true;
+}
+
+void EventTracer_Stop(void) {
+    if (InterlockedExchange(&g_event_tracing, 0) == 0) return;
+    while (InterlockedCompareExchange(&g_event_writers, 0, 0) != 0) {
+        Sleep(0);
+    }
+
+    const EventTraceBuffer* buffers[EVENT_TRACER_THREADS];
+    LONG claimed = g_event_claimed < EVENT_TRACER_THREADS ? g_event_claimed : EVENT_TRACER_THREADS;
+    uint64_t events = 0, dropped = 0;
+    for (LONG i = 0; i < claimed; i++) {
+        buffers[i] = &g_event_buffers[i];
+        events += g_event_buffers[i].count;
+        dropped += g_event_buffers[i].dropped;
+    }
+
+    EventTracer_BuildPath();
+    g_event_file = CreateFile(g_event_path, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (g_event_file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Failed to create event trace %s: error code %lu", g_event_path, GetLastError());
+    } else {
+        g_event_write_fill = 0;
+        bool ok = EventTrace_WriteJson(buffers, (int)claimed, (uint32_t)GetCurrentProcessId(),
+                                       APP_NAME, g_event_origin_us, EventTracer_WriteFile, NULL) &&
+                  EventTracer_FlushFile();
+        CloseHandle(g_event_file);
+        g_event_file = INVALID_HANDLE_VALUE;
+
+        if (ok) {
+            LOG_INFO("Event trace written: %s (%llu events, %llu dropped)", g_event_path,
+                     (unsigned long long)events, (unsigned long long)dropped);
+        } else {
+            LOG_ERROR("Failed to write event trace %s: error code %lu",
+                      g_event_path, GetLastError());
+        }
+    }
+
+    VirtualFree(g_event_storage, 0, MEM_RELEASE);
+    g_event_storage = NULL;
+    memset(g_event_buffers, 0, sizeof(g_event_buffers));
+}
+
+void EventTracer_Toggle(void) {
+    if (g_event_tracing) {
+        EventTracer_Stop();
+    } else {
+        EventTracer_Start();
+    }
+}
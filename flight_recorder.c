@@ -0,0 +1,242 @@
+/**
+ * Flight Recorder - Always-On Input History
+ *
+ * Keeps the last few seconds of raw input, engine output and tick timing
+ * in a fixed ring of plain records, and re-encodes a window of it as an
+ * input trace on demand. Recording costs one record store; all encoding
+ * is deferred to the dump, which only happens when the user asks for it.
+ */
+
+#include "include/core/flight_recorder.h"
+#include "include/core/input_trace.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FLIGHT_RECORDER_MASK (FLIGHT_RECORDER_CAPACITY - 1)
+#define FLIGHT_RECORDER_CHUNK 4096
+#define FLIGHT_RECORDER_LINE_SIZE 96      // One CSV tick line
+
+typedef struct {
+    FlightRecorderWriteFn write;
+    void* context;
+    uint8_t data[FLIGHT_RECORDER_CHUNK];
+    size_t fill;
+    uint64_t bytes;
+    bool failed;
+} FlightRecorder_Output;
+
+static int32_t FlightRecorder_ToFixed(float value) {
+    return (int32_t)floorf(value * INPUT_TRACE_POSITION_SCALE + 0.5f);
+}
+
+static FlightRecord* FlightRecorder_Next(FlightRecorder* recorder) {
+    return &recorder->records[recorder->head++ & FLIGHT_RECORDER_MASK];
+}
+
+void FlightRecorder_Initialize(FlightRecorder* recorder) {
+    if (!recorder) return;
+
+    recorder->head = 0;
+    recorder->output_x = 0;
+    recorder->output_y = 0;
+    recorder->has_output = false;
+}
+
+void FlightRecorder_RecordPacket(FlightRecorder* recorder, uint64_t time_us, uint64_t device,
+                                 int32_t dx, int32_t dy, unsigned int pressed,
+                                 unsigned int released) {
+    if (!recorder) return;
+
+    FlightRecord* record = FlightRecorder_Next(recorder);
+    record->time_us = time_us;
+    record->device = device;
+    record->a = dx;
+    record->b = dy;
+    record->type = FLIGHT_RECORD_PACKET;
+    record->pressed = (uint8_t)pressed;
+    record->released = (uint8_t)released;
+}
+
+void FlightRecorder_RecordOutput(FlightRecorder* recorder, uint64_t time_us, float x, float y) {
+    if (!recorder) return;
+
+    int32_t fixed_x = FlightRecorder_ToFixed(x);
+    int32_t fixed_y = FlightRecorder_ToFixed(y);
+    if (recorder->has_output && fixed_x == recorder->output_x &&
+        fixed_y == recorder->output_y) return;
+    recorder->output_x = fixed_x;
+    recorder->output_y = fixed_y;
+    recorder->has_output = true;
+
+    FlightRecord* record = FlightRecorder_Next(recorder);
+    record->time_us = time_us;
+    record->device = 0;
+    record->a = fixed_x;
+    record->b = fixed_y;
+    record->type = FLIGHT_RECORD_OUTPUT;
+    record->pressed = 0;
+    record->released = 0;
+}
+
+void FlightRecorder_RecordTick(FlightRecorder* recorder, uint64_t start_us, uint32_t duration_us,
+                               bool engaged, float distance) {
+    if (!recorder) return;
+
+    FlightRecord* record = FlightRecorder_Next(recorder);
+    record->time_us = start_us;
+    record->device = 0;
+    record->a = duration_us > INT32_MAX ? INT32_MAX : (int32_t)duration_us;
+    record->b = FlightRecorder_ToFixed(distance);
+    record->type = FLIGHT_RECORD_TICK;
+    record->pressed = engaged ? 1 : 0;
+    record->released = 0;
+}
+
+// Oldest retained record index
+static uint64_t FlightRecorder_Oldest(const FlightRecorder* recorder) {
+    if (recorder->head <= FLIGHT_RECORDER_CAPACITY) return 0;
+    return recorder->head - FLIGHT_RECORDER_CAPACITY;
+}
+
+// First retained record at or after now_us - window_us
+static uint64_t FlightRecorder_WindowStart(const FlightRecorder* recorder, uint64_t now_us,
+                                           uint64_t window_us) {
+    uint64_t cutoff = now_us > window_us ? now_us - window_us : 0;
+    uint64_t index = FlightRecorder_Oldest(recorder);
+    while (index < recorder->head &&
+           recorder->records[index & FLIGHT_RECORDER_MASK].time_us < cutoff) {
+        index++;
+    }
+    return index;
+}
+
+static bool FlightRecorder_Flush(FlightRecorder_Output* output) {
+    if (!output->failed && output->fill > 0 &&
+        !output->write(output->context, output->data, output->fill)) {
+        output->failed = true;
+    }
+    output->bytes += output->fill;
+    output->fill = 0;
+    return !output->failed;
+}
+
+// Room for size more bytes
+static uint8_t* FlightRecorder_Reserve(FlightRecorder_Output* output, size_t size) {
+    if (output->fill + size > sizeof(output->data) && !FlightRecorder_Flush(output)) {
+        return NULL;
+    }
+    return output->data + output->fill;
+}
+
+static void FlightRecorder_Encode(FlightRecorder_Output* output, InputTraceState* state,
+                                  const FlightRecord* record, FlightRecorderSummary* written) {
+    if (record->type == FLIGHT_RECORD_TICK) {
+        written->ticks++;
+        return;
+    }
+
+    uint8_t* out = FlightRecorder_Reserve(output, INPUT_TRACE_MAX_RECORD_SIZE);
+    if (!out) return;
+
+    if (record->type == FLIGHT_RECORD_PACKET) {
+        output->fill += InputTrace_EncodePacket(state, out, record->time_us, record->device,
+                                                record->a, record->b, record->pressed,
+                                                record->released);
+        written->packets++;
+    } else if (record->type == FLIGHT_RECORD_OUTPUT) {
+        output->fill += InputTrace_EncodeOutput(state, out, record->time_us,
+                                                (float)record->a / INPUT_TRACE_POSITION_SCALE,
+                                                (float)record->b / INPUT_TRACE_POSITION_SCALE);
+        written->outputs++;
+    }
+    if (record->time_us > written->last_us) written->last_us = record->time_us;
+}
+
+bool FlightRecorder_WriteTrace(const FlightRecorder* recorder, uint64_t now_us, uint64_t window_us,
+                               FlightRecorderWriteFn write, void* context,
+                               FlightRecorderSummary* summary) {
+    if (summary) memset(summary, 0, sizeof(*summary));
+    if (!recorder || !write) return false;
+
+    uint64_t start = FlightRecorder_WindowStart(recorder, now_us, window_us);
+
+    // The replay starts from the first output; carry the engine position from
+    // before the window in so a dump taken mid-stroke starts on the right pixel
+    const FlightRecord* anchor = NULL;
+    for (uint64_t index = start; index > FlightRecorder_Oldest(recorder); index--) {
+        const FlightRecord* record = &recorder->records[(index - 1) & FLIGHT_RECORDER_MASK];
+        if (record->type == FLIGHT_RECORD_OUTPUT) {
+            anchor = record;
+            break;
+        }
+    }
+
+    uint64_t start_us = now_us;
+    if (start < recorder->head) start_us = recorder->records[start & FLIGHT_RECORDER_MASK].time_us;
+    if (anchor) start_us = anchor->time_us;
+
+    FlightRecorder_Output output;
+    output.write = write;
+    output.context = context;
+    output.fill = InputTrace_WriteHeader(output.data, start_us);
+    output.bytes = 0;
+    output.failed = false;
+
+    InputTraceState state;
+    InputTrace_ResetState(&state, start_us);
+    FlightRecorderSummary written;
+    memset(&written, 0, sizeof(written));
+    written.first_us = start_us;
+    written.last_us = start_us;
+
+    if (anchor) FlightRecorder_Encode(&output, &state, anchor, &written);
+    for (uint64_t index = start; index < recorder->head && !output.failed; index++) {
+        FlightRecorder_Encode(&output, &state, &recorder->records[index & FLIGHT_RECORDER_MASK],
+                              &written);
+    }
+
+    bool ok = FlightRecorder_Flush(&output);
+    written.bytes = output.bytes;
+    if (summary) *summary = written;
+    return ok;
+}
+
+bool FlightRecorder_WriteTicks(const FlightRecorder* recorder, uint64_t now_us, uint64_t window_us,
+                               FlightRecorderWriteFn write, void* context) {
+    if (!recorder || !write) return false;
+
+    FlightRecorder_Output output;
+    output.write = write;
+    output.context = context;
+    output.fill = (size_t)snprintf((char*)output.data, sizeof(output.data),
+                                   "time_ms,interval_us,duration_us,engaged,distance_px\n");
+    output.bytes = 0;
+    output.failed = false;
+
+    uint64_t start = FlightRecorder_WindowStart(recorder, now_us, window_us);
+    uint64_t origin_us = now_us;
+    if (start < recorder->head) origin_us = recorder->records[start & FLIGHT_RECORDER_MASK].time_us;
+    uint64_t previous_us = 0;
+
+    for (uint64_t index = start; index < recorder->head; index++) {
+        const FlightRecord* record = &recorder->records[index & FLIGHT_RECORDER_MASK];
+        if (record->type != FLIGHT_RECORD_TICK) continue;
+
+        uint8_t* out = FlightRecorder_Reserve(&output, FLIGHT_RECORDER_LINE_SIZE);
+        if (!out) break;
+
+        uint64_t interval = 0;
+        if (previous_us && record->time_us > previous_us) interval = record->time_us - previous_us;
+        previous_us = record->time_us;
+        uint64_t offset = record->time_us > origin_us ? record->time_us - origin_us : 0;
+        int length = snprintf((char*)out, FLIGHT_RECORDER_LINE_SIZE, "%.3f,%llu,%ld,%u,%.2f\n",
+                              (double)offset / 1000.0, (unsigned long long)interval,
+                              (long)record->a, (unsigned)record->pressed,
+                              (double)record->b / INPUT_TRACE_POSITION_SCALE);
+        if (length > 0 && length < FLIGHT_RECORDER_LINE_SIZE) output.fill += (size_t)length;
+    }
+
+    return FlightRecorder_Flush(&output);
+}
@@ -0,0 +1,109 @@
+/**
+ * Health Monitor - Hook Watchdog and Scheduling Checks
+ *
+ * Turns the perf monitor's interval figures into watchdog samples, acts
+ * on what the watchdog reports and keeps the incident record. Runs only
+ * on the message thread, which also owns the hook, so reinstalling needs
+ * no synchronisation.
+ */
+
+#include "mouse_stabilizer.h"
+
+static HookWatchdog g_watchdog;
+static uint64_t g_watchdog_packets = 0;     // packets_total at the previous check
+static volatile LONG g_watchdog_reinstalls = 0;
+
+static uint32_t HealthMonitor_Micros(double ms) {
+    double us = ms * 1000.0;
+    if (us <= 0.0) return 0;
+    return us >= (double)UINT32_MAX ? UINT32_MAX : (uint32_t)(us + 0.5);
+}
+
+static void HealthMonitor_LogHistory(void) {
+    uint32_t count = g_watchdog.history_count;
+    const HookWatchdogSample* history = g_watchdog.history;
+    uint32_t oldest = (g_watchdog.history_next + HOOK_WATCHDOG_HISTORY - count) %
+                      HOOK_WATCHDOG_HISTORY;
+    uint64_t now = history[(oldest + count - 1) % HOOK_WATCHDOG_HISTORY].time_us;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const HookWatchdogSample* sample = &history[(oldest + i) % HOOK_WATCHDOG_HISTORY];
+        LOG_INFO("  -%5.1f s: %llu packets, %llu hook calls, hook max %.2f ms, tick max %.1f ms, "
+                 "jitter %.2f ms",
+                 (double)(now - sample->time_us) / 1e6, (unsigned long long)sample->packets,
+                 (unsigned long long)sample->hook_calls, sample->hook_max_us / 1000.0,
+                 sample->tick_max_us / 1000.0, sample->tick_jitter_us / 1000.0);
+    }
+}
+
+static void HealthMonitor_HookDead(uint64_t now_us) {
+    HookWatchdogContext context;
+    HookWatchdog_GetContext(&g_watchdog, &context);
+
+    LOG_WARN("Mouse hook stopped receiving events: %.1f s quiet with %llu raw input packets; "
+             "slowest hook call %.2f ms (%.1f s ago, timeout %u ms), tick max %.1f ms, "
+             "jitter %.2f ms",
+             (double)context.quiet_us / 1e6, (unsigned long long)context.packets_unhooked,
+             context.hook_max_us / 1000.0, (double)context.hook_max_age_us / 1e6,
+             PerfMonitor_GetHookTimeoutMs(), context.tick_max_us / 1000.0,
+             context.tick_jitter_us / 1000.0);
+    LOG_INFO("Watchdog history (%.1f s):", (double)context.window_us / 1e6);
+    HealthMonitor_LogHistory();
+
+    // Input is unhooked until this returns, so the hook comes back before anything else
+    bool ok = MouseInput_ReinstallHook();
+    DWORD error = ok ? ERROR_SUCCESS : GetLastError();
+    HookWatchdog_Reinstalled(&g_watchdog, now_us);
+    InterlockedIncrement(&g_watchdog_reinstalls);
+    if (ok) {
+        LOG_WARN("Mouse hook reinstalled (%u so far)", g_watchdog.reinstalls);
+    } else {
+        LOG_ERROR("Failed to reinstall mouse hook: error code %lu", error);
+    }
+
+    // Only copies the ring here; the files are written on the dump thread
+    TraceRecorder_DumpFlight();
+}
+
+void HealthMonitor_Initialize(void) {
+    uint32_t timeout_us = PerfMonitor_GetHookTimeoutMs() * 1000u;
+    HookWatchdog_Initialize(&g_watchdog, timeout_us / 2, HEALTH_MONITOR_STALL_MS * 1000u);
+
+    // Start the first interval now rather than at startup
+    PerfMonitorReading reading;
+    PerfMonitor_Read(PERF_MONITOR_READER_WATCHDOG, &reading);
+    g_watchdog_packets = reading.packets_total;
+}
+
+void HealthMonitor_Check(void) {
+    PerfMonitorReading reading;
+    PerfMonitor_Read(PERF_MONITOR_READER_WATCHDOG, &reading);
+
+    HookWatchdogSample sample;
+    sample.time_us = Platform_NowMicros(PlatformWin32_Get());
+    sample.packets = reading.packets_total - g_watchdog_packets;
+    sample.hook_calls = reading.hook_calls;
+    sample.hook_max_us = HealthMonitor_Micros(reading.hook_max_us / 1000.0);
+    sample.tick_max_us = HealthMonitor_Micros(reading.tick_max_ms);
+    sample.tick_jitter_us = HealthMonitor_Micros(reading.tick_jitter_ms);
+    g_watchdog_packets = reading.packets_total;
+
+    unsigned int events = HookWatchdog_Observe(&g_watchdog, &sample);
+    if (events & HOOK_WATCHDOG_HOOK_DEAD) {
+        HealthMonitor_HookDead(sample.time_us);
+    }
+    if (events & HOOK_WATCHDOG_SLOW_HOOK) {
+        LOG_WARN("Slow mouse hook call: %.2f ms of the %u ms LowLevelHooksTimeout "
+                 "(%llu timeouts so far)",
+                 sample.hook_max_us / 1000.0, PerfMonitor_GetHookTimeoutMs(),
+                 (unsigned long long)reading.hook_timeouts);
+    }
+    if (events & HOOK_WATCHDOG_TICK_STALL) {
+        LOG_WARN("Engine tick stalled: %.1f ms between ticks (mean %.2f ms, jitter %.2f ms)",
+                 reading.tick_max_ms, reading.tick_mean_ms, reading.tick_jitter_ms);
+    }
+}
+
+uint32_t HealthMonitor_GetReinstalls(void) {
+    return (uint32_t)InterlockedCompareExchange(&g_watchdog_reinstalls, 0, 0);
+}
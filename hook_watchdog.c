@@ -0,0 +1,115 @@
+/**
+ * Hook Watchdog - Dead Hook and Scheduling Stall Detection
+ *
+ * Decides from per-interval counts whether the low-level mouse hook is
+ * still being called and whether hook callbacks or engine ticks are
+ * running late. Pure bookkeeping on the caller's struct; the host owns
+ * the clock, the counters and the hook itself.
+ */
+
+#include "include/core/hook_watchdog.h"
+
+#include <string.h>
+
+void HookWatchdog_Initialize(HookWatchdog* watchdog, uint32_t slow_hook_us, uint32_t stall_us) {
+    if (!watchdog) return;
+
+    memset(watchdog, 0, sizeof(*watchdog));
+    watchdog->slow_hook_us = slow_hook_us;
+    watchdog->stall_us = stall_us;
+    watchdog->backoff_us = HOOK_WATCHDOG_BACKOFF_MS * 1000ull;
+}
+
+// At most once per warn interval; the first report is never held back
+static bool HookWatchdog_Throttle(uint64_t now_us, uint64_t* last_us, bool* warned) {
+    if (*warned && now_us - *last_us < HOOK_WATCHDOG_WARN_INTERVAL_MS * 1000ull) return false;
+    *last_us = now_us;
+    *warned = true;
+    return true;
+}
+
+unsigned int HookWatchdog_Observe(HookWatchdog* watchdog, const HookWatchdogSample* sample) {
+    if (!watchdog || !sample) return 0;
+
+    watchdog->history[watchdog->history_next] = *sample;
+    watchdog->history_next = (watchdog->history_next + 1) % HOOK_WATCHDOG_HISTORY;
+    if (watchdog->history_count < HOOK_WATCHDOG_HISTORY) watchdog->history_count++;
+
+    uint64_t now = sample->time_us;
+    if (!watchdog->started) {
+        watchdog->started = true;
+        watchdog->last_hook_us = now;
+    }
+
+    unsigned int events = 0;
+    if (sample->hook_calls > 0) {
+        // The hook is alive: a later silence starts from here with a fresh backoff
+        watchdog->last_hook_us = now;
+        watchdog->packets_unhooked = 0;
+        watchdog->backoff_us = HOOK_WATCHDOG_BACKOFF_MS * 1000ull;
+    } else {
+        watchdog->packets_unhooked += sample->packets;
+        bool quiet = now - watchdog->last_hook_us >= HOOK_WATCHDOG_QUIET_MS * 1000ull;
+        bool waited = !watchdog->reinstalled ||
+                      now - watchdog->last_reinstall_us >= watchdog->backoff_us;
+        if (quiet && waited && watchdog->packets_unhooked >= HOOK_WATCHDOG_MIN_PACKETS) {
+            events |= HOOK_WATCHDOG_HOOK_DEAD;
+        }
+    }
+
+    if (watchdog->slow_hook_us > 0 && sample->hook_max_us >= watchdog->slow_hook_us &&
+        HookWatchdog_Throttle(now, &watchdog->last_slow_warn_us, &watchdog->slow_warned)) {
+        events |= HOOK_WATCHDOG_SLOW_HOOK;
+    }
+    if (watchdog->stall_us > 0 && sample->tick_max_us >= watchdog->stall_us &&
+        HookWatchdog_Throttle(now, &watchdog->last_stall_warn_us, &watchdog->stall_warned)) {
+        events |= HOOK_WATCHDOG_TICK_STALL;
+    }
+    return events;
+}
+
+void HookWatchdog_Reinstalled(HookWatchdog* watchdog, uint64_t now_us) {
+    if (!watchdog) return;
+
+    // Still silent at the next check means the new hook did not help either: wait longer
+    if (watchdog->reinstalled && watchdog->last_hook_us < watchdog->last_reinstall_us) {
+        watchdog->backoff_us *= 2;
+        if (watchdog->backoff_us > HOOK_WATCHDOG_MAX_BACKOFF_MS * 1000ull) {
+            watchdog->backoff_us = HOOK_WATCHDOG_MAX_BACKOFF_MS * 1000ull;
+        }
+    }
+    watchdog->last_reinstall_us = now_us;
+    watchdog->reinstalled = true;
+    watchdog->packets_unhooked = 0;
+    watchdog->reinstalls++;
+}
+
+void HookWatchdog_GetContext(const HookWatchdog* watchdog, HookWatchdogContext* context) {
+    if (!context) return;
+
+    memset(context, 0, sizeof(*context));
+    if (!watchdog || watchdog->history_count == 0) return;
+
+    uint32_t newest = (watchdog->history_next + HOOK_WATCHDOG_HISTORY - 1) % HOOK_WATCHDOG_HISTORY;
+    uint32_t oldest = (watchdog->history_next + HOOK_WATCHDOG_HISTORY - watchdog->history_count) %
+                      HOOK_WATCHDOG_HISTORY;
+    uint64_t now = watchdog->history[newest].time_us;
+    uint64_t first = watchdog->history[oldest].time_us;
+
+    context->window_us = now - first;
+    context->quiet_us = now - watchdog->last_hook_us;
+    context->packets_unhooked = watchdog->packets_unhooked;
+    context->reinstalls = watchdog->reinstalls;
+
+    for (uint32_t i = 0; i < watchdog->history_count; i++) {
+        const HookWatchdogSample* sample = &watchdog->history[(oldest + i) % HOOK_WATCHDOG_HISTORY];
+        if (sample->hook_max_us >= context->hook_max_us && sample->hook_max_us > 0) {
+            context->hook_max_us = sample->hook_max_us;
+            context->hook_max_age_us = now - sample->time_us;
+        }
+        if (sample->tick_max_us > context->tick_max_us) context->tick_max_us = sample->tick_max_us;
+        if (sample->tick_jitter_us > context->tick_jitter_us) {
+            context->tick_jitter_us = sample->tick_jitter_us;
+        }
+    }
+}
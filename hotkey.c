@@ -2,6 +2,7 @@
 
 void Hotkey_ToggleStabilizer(void) {
     g_stabilizer.enabled = !g_stabilizer.enabled;
+    MouseInput_SyncDeviceSettings();
     
     Settings_WriteLog("Mouse stabilizer %s", g_stabilizer.enabled ? "enabled" : "disabled");
     TrayUI_UpdateIcon();
@@ -12,18 +13,49 @@ LRESULT CALLBACK Hotkey_WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM l
         case WM_HOTKEY:
             if (wParam == HOTKEY_ID) {
                 Hotkey_ToggleStabilizer();
+            } else if (wParam == DUMP_HOTKEY_ID) {
+                TraceRecorder_DumpFlight();
             }
             return 0;
             
         case WM_INPUT:
+            EventTracer_Begin("WM_INPUT");
             MouseInput_ProcessRawInput(lParam);
+            EventTracer_End();
+            return 0;
+            
+        case WM_INPUT_DEVICE_CHANGE:
+            MouseInput_HandleDeviceChange(wParam, lParam);
+            return 0;
+            
+        case WM_DISPLAYCHANGE:
+            ScreenGeometry_Refresh(&g_screen_geometry, PlatformWin32_Get());
             return 0;
             
         case WM_TIMER:
             if (wParam == TIMER_ID) {
-                StabilizerCore_UpdatePosition(&g_stabilizer);
+                SmoothStabilizer* active = MouseInput_GetActiveStabilizer();
+                uint64_t tick_us = Platform_NowMicros(PlatformWin32_Get());
+                PerfMonitor_CountTick(tick_us);
+                EventTracer_Begin("Engine step");
+                LatencyProbe_BeginTick();
+                StabilizerCore_UpdatePosition(active);
+                LatencyProbe_EndTick(StabilizerCore_IsEngaged(active));
+                TraceRecorder_RecordOutput(active);
+                TraceRecorder_RecordTick(active, tick_us);
+                SharedTelemetry_OnTick(active, tick_us);
+                if (EventTracer_IsActive()) {
+                    float lag = StabilizerCore_CalculateDistance(active->current_pos,
+                                                                 active->target_pos);
+                    EventTracer_Counter("Target distance (px)", (int64_t)(lag + 0.5f));
+                }
+                EventTracer_End();
             } else if (wParam == DRAW_TIMER_ID) {
+                EventTracer_Begin("Overlay draw");
                 TargetPointer_UpdateWindow();
+                EventTracer_End();
+            } else if (wParam == WATCHDOG_TIMER_ID) {
+                HealthMonitor_Check();
             }
             return 0;
             
@@ -58,6 +90,16 @@ LRESULT CALLBACK Hotkey_WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM l
                         Settings_Save();
                     }
                     break;
+                case 1005:  // Input Recording Toggle
+                    TraceRecorder_Toggle();
+                    SettingsUI_UpdateControls();
+                    break;
+                case 1006:  // Event Tracing Toggle
+                    EventTracer_Toggle();
+                    break;
+                case 1007:  // Flight Recorder Dump
+                    TraceRecorder_DumpFlight();
+                    break;
                 case 1004:  // Exit
                     g_running = false;
                     PostQuitMessage(0);
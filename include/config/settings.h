@@ -6,6 +6,9 @@
 #include <string.h>
 #include <time.h>
 
+#include "../core/platform.h"
+#include "../core/device_table.h"
+
 // Enable Microsoft secure functions
 #ifdef _MSC_VER
     #ifndef _CRT_SECURE_NO_WARNINGS
@@ -23,34 +26,66 @@
     #define fopen_s(pFile, filename, mode) ((*(pFile) = fopen(filename, mode)) ? 0 : 1)
 #endif
 
-// Log levels for debugging and output control
-typedef enum {
-    LOG_ERROR,      // Critical errors only
-    LOG_WARN,       // Warnings and errors
-    LOG_INFO,       // General information (default)
-    LOG_DEBUG,      // Detailed debugging information
-    LOG_TRACE       // Very detailed trace information
-} LogLevel;
-
 // Global log level setting
-extern LogLevel g_log_level;
+extern volatile LogLevel g_log_level;
+extern bool g_log_binary;
+
+// [Device <text>] sections in mouse_stabilizer.ini give a mouse its own
+// FollowStrength, MinDistance, EaseType, DualMode, DelayStartMs, DragOnly
+// or DragButton; keys a section leaves out follow [Settings]. A section
+// applies to every device whose raw input name (e.g.
+// \\?\HID#VID_046D&PID_C08B...) contains <text>, ignoring case; the first
+// matching section wins.
+#define SETTINGS_MAX_DEVICE_SECTIONS 16
+#define SETTINGS_DEVICE_NAME_SIZE 256
 
 // Settings management functions
 void Settings_Load(void);
 void Settings_Save(void);
 
+/**
+ * Look up the [Device ...] section for a raw input device name
+ * @return false if no section matches (settings is left unchanged)
+ */
+bool Settings_GetDeviceSettings(const char* device_name, DeviceSettings* settings);
+
 // Enhanced logging functions
 void Settings_WriteLog(const char* format, ...);
+
+/**
+ * Start the background log writer; log calls then only queue their record
+ * @return false if the thread could not be created (logging stays synchronous)
+ */
+bool Settings_StartLogWriter(void);
+
+/**
+ * Write everything queued, stop the writer thread and flush the file
+ * Also runs at process exit.
+ */
+void Settings_StopLogWriter(void);
+
+/**
+ * Log records lost to a full queue since startup
+ */
+uint64_t Settings_GetLogDropped(void);
+
+/**
+ * Log records queued but not yet written; approximate
+ */
+uint32_t Settings_GetLogPending(void);
+
 void Settings_WriteLogLevel(LogLevel level, const char* format, ...);
+void Settings_WriteLogLevelV(LogLevel level, const char* format, va_list args);
+
+/**
+ * Log a LOG_* call site; in binary mode only its raw arguments are queued
+ */
+void Settings_WriteLogSiteV(LogSite* site, va_list args);
 void Settings_SetLogLevel(LogLevel level);
 LogLevel Settings_GetLogLevel(void);
 const char* Settings_GetLogLevelName(LogLevel level);
 
-// Convenient logging macros
-#define LOG_ERROR(...) Settings_WriteLogLevel(LOG_ERROR, __VA_ARGS__)
-#define LOG_WARN(...) Settings_WriteLogLevel(LOG_WARN, __VA_ARGS__)
-#define LOG_INFO(...) Settings_WriteLogLevel(LOG_INFO, __VA_ARGS__)
-#define LOG_DEBUG(...) Settings_WriteLogLevel(LOG_DEBUG, __VA_ARGS__)
-#define LOG_TRACE(...) Settings_WriteLogLevel(LOG_TRACE, __VA_ARGS__)
+// LogLevel and the LOG_* macros come from the core platform interface;
+// on Windows they end up in Settings_WriteLogLevelV
 
 #endif // SETTINGS_H
\ No newline at end of file
@@ -0,0 +1,139 @@
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+// Deferred-formatting log (.mslog). A call site's format string is written
+// once per session; after that each call stores only the site id, a
+// timestamp and its raw arguments, and printf-style formatting happens
+// offline in the decoder (tools/logdecode.c). Sessions may be appended to
+// one file; each starts with a header and numbers its sites from 1.
+//
+// Header:  "MSLG" | u16 version | u16 header size | u64 start time
+// Record:  u8 BinaryLogRecordType | u16 payload length | payload
+//   DEFINE  u32 site id | u8 level | format, NUL-terminated
+//   EVENT   u32 site id | u64 time | arguments
+//   TEXT    u8 level | u64 time | message (already formatted)
+// Arguments follow the format's conversions in order: integers, pointers
+// and doubles as 8 bytes, strings as u16 length + bytes. Times are opaque
+// to the log (the Win32 host stores FILETIMEs). All integers little-endian.
+// A zero byte where a record would start ends the log: segments are
+// preallocated (log_sink.h), and one left by a crash ends in zeros.
+
+#define BINARY_LOG_MAGIC "MSLG"
+#define BINARY_LOG_VERSION 1
+#define BINARY_LOG_HEADER_SIZE 16
+#define BINARY_LOG_RECORD_HEADER_SIZE 3
+#define BINARY_LOG_MAX_SITES 1024       // Site ids per session
+#define BINARY_LOG_TEXT_SIZE 1024       // Longest decoded message
+
+typedef enum {
+    LOG_SITE_UNPARSED = 0,
+    LOG_SITE_PARSING,
+    LOG_SITE_READY,             // arg_count/arg_types valid
+    LOG_SITE_UNSUPPORTED        // Format cannot be deferred (%n, wide strings, too many args)
+} LogSiteState;
+
+typedef enum {
+    BINARY_ARG_INT = 1,         // int and smaller, char
+    BINARY_ARG_LONG,            // long (width differs between hosts)
+    BINARY_ARG_LLONG,           // long long, intmax_t, __int64
+    BINARY_ARG_SIZE,            // size_t, ptrdiff_t
+    BINARY_ARG_DOUBLE,
+    BINARY_ARG_STRING,
+    BINARY_ARG_POINTER
+} BinaryLogArgType;
+
+typedef enum {
+    BINARY_LOG_DEFINE = 1,
+    BINARY_LOG_EVENT = 2,
+    BINARY_LOG_TEXT = 3
+} BinaryLogRecordType;
+
+/**
+ * Parse a printf format into argument types
+ * @return false if the format cannot be recorded as raw arguments
+ */
+bool BinaryLog_ParseFormat(const char* format, uint8_t* types, uint8_t* count);
+
+/**
+ * Argument layout of a call site, parsed on first use and cached in the site
+ * Thread-safe: a caller that races the first parse parses into its own copy.
+ * @param scratch Holds the layout for such a caller (LOG_SITE_MAX_ARGS types)
+ * @return The types to encode with (site->arg_types or scratch), NULL if unsupported
+ */
+const uint8_t* BinaryLog_SiteTypes(LogSite* site, uint8_t* scratch, uint8_t* count);
+
+/**
+ * Copy a call's arguments out of its va_list
+ * Strings are truncated so the arguments always fit.
+ * @return Bytes written, 0 if even truncated strings do not fit
+ */
+size_t BinaryLog_EncodeArgs(const uint8_t* types, uint8_t count, uint8_t* out, size_t capacity,
+                            va_list args);
+
+/**
+ * Format recorded arguments with printf semantics
+ * @return Characters written (excluding the terminator); decoding stops at
+ *         missing or malformed arguments
+ */
+size_t BinaryLog_Format(const char* format, const uint8_t* args, size_t length, char* out,
+                        size_t size);
+
+// Record writers; each returns the bytes written, 0 if capacity is too small
+size_t BinaryLog_PutHeader(uint8_t* out, size_t capacity, uint64_t time);
+size_t BinaryLog_PutDefine(uint8_t* out, size_t capacity, uint32_t id, LogLevel level,
+                           const char* format);
+size_t BinaryLog_PutEvent(uint8_t* out, size_t capacity, uint32_t id, uint64_t time,
+                          const uint8_t* args, size_t length);
+size_t BinaryLog_PutText(uint8_t* out, size_t capacity, LogLevel level, uint64_t time,
+                         const char* message, size_t length);
+
+typedef struct {
+    const char* format;         // Points into the log data, NULL if undefined
+    LogLevel level;
+} BinaryLogDefinition;
+
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    size_t offset;
+    bool corrupt;
+    uint64_t sessions;
+    BinaryLogDefinition sites[BINARY_LOG_MAX_SITES + 1];   // Current session, by id
+} BinaryLogReader;
+
+typedef enum {
+    BINARY_LOG_ENTRY_SESSION,   // A session header: time only
+    BINARY_LOG_ENTRY_MESSAGE
+} BinaryLogEntryType;
+
+typedef struct {
+    BinaryLogEntryType type;
+    LogLevel level;
+    uint64_t time;
+    uint32_t site;              // 0 for TEXT records
+    size_t length;
+    char text[BINARY_LOG_TEXT_SIZE];
+} BinaryLogEntry;
+
+/**
+ * Start reading a log
+ * @return false if it does not begin with a session header
+ */
+bool BinaryLog_Open(BinaryLogReader* reader, const void* data, size_t length);
+
+/**
+ * Decode the next session start or message
+ * DEFINE records are absorbed. Events of unknown sites come back as a
+ * placeholder message.
+ * @return false at the end or on a malformed record (reader->corrupt)
+ */
+bool BinaryLog_Next(BinaryLogReader* reader, BinaryLogEntry* entry);
+
+#endif // BINARY_LOG_H
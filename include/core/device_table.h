@@ -0,0 +1,94 @@
+#ifndef DEVICE_TABLE_H
+#define DEVICE_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "stabilizer_core.h"
+
+// Fixed-capacity open-addressing table of per-device stabilizer state.
+// Keyed by RAWINPUTHEADER.hDevice; never allocates, so lookups and inserts
+// are safe on the raw input hot path.
+
+// Must be a power of two
+#define DEVICE_TABLE_CAPACITY 16
+
+// Which physical device drives the cursor when several are attached
+typedef enum {
+    DEVICE_POLICY_LAST_ACTIVE,  // Most recently moved device, locked while the owner is mid-stroke
+    DEVICE_POLICY_FIRST_ACTIVE, // First device that moved keeps the cursor until it is removed
+    DEVICE_POLICY_MERGE         // All devices feed one stabilizer (legacy behaviour)
+} DevicePolicy;
+
+#define DEFAULT_DEVICE_POLICY DEVICE_POLICY_LAST_ACTIVE
+
+// DeviceSettings.set bits: which parameters a device overrides
+#define DEVICE_SETTING_FOLLOW_STRENGTH 0x01
+#define DEVICE_SETTING_MIN_DISTANCE    0x02
+#define DEVICE_SETTING_EASE_TYPE       0x04
+#define DEVICE_SETTING_DUAL_MODE       0x08
+#define DEVICE_SETTING_DELAY_START     0x10
+#define DEVICE_SETTING_DRAG_ONLY       0x20
+#define DEVICE_SETTING_DRAG_BUTTON     0x40
+
+// Parameters a device uses instead of the global ones; fields whose bit is
+// clear follow the global settings
+typedef struct {
+    unsigned int set;               // DEVICE_SETTING_* bits
+    float follow_strength;
+    float min_distance;
+    EaseType ease_type;
+    bool dual_mode;
+    uint32_t delay_start_ms;
+    bool drag_only;
+    DragButton drag_button;
+} DeviceSettings;
+
+// One slot per physical device
+typedef struct {
+    void* device;                   // Raw input device handle, NULL marks an empty slot
+    SmoothStabilizer stabilizer;    // Independent filter state and parameters
+    DeviceSettings settings;        // This device's overrides (none in a new slot)
+    uint32_t last_input_time;       // Tick count of the last packet from this device
+} DeviceEntry;
+
+typedef struct {
+    DeviceEntry entries[DEVICE_TABLE_CAPACITY];
+    int count;
+} DeviceTable;
+
+/**
+ * Clear all slots
+ */
+void DeviceTable_Initialize(DeviceTable* table);
+
+/**
+ * Look up a device
+ * @return Entry for the device, or NULL if it is not in the table
+ */
+DeviceEntry* DeviceTable_Find(DeviceTable* table, void* device);
+
+/**
+ * Look up a device, claiming an empty slot for it if needed
+ * New entries are zeroed apart from the key; the caller initializes the stabilizer.
+ * @param created Set to true when a new slot was claimed (may be NULL)
+ * @return Entry for the device, or NULL if the table is full
+ */
+DeviceEntry* DeviceTable_Insert(DeviceTable* table, void* device, bool* created);
+
+/**
+ * Remove a device
+ * Uses backward-shift deletion, so pointers to other entries may move.
+ * @return true if the device was present
+ */
+bool DeviceTable_Remove(DeviceTable* table, void* device);
+
+/**
+ * Give the entry's stabilizer the global parameters plus the device's overrides
+ * The result is clamped to the ranges the settings file accepts; motion state
+ * and host bindings are left alone.
+ * @param defaults Instance holding the global settings
+ */
+void DeviceTable_ApplySettings(DeviceEntry* entry, const SmoothStabilizer* defaults);
+
+#endif // DEVICE_TABLE_H
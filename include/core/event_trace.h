@@ -0,0 +1,70 @@
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Timeline events in the Chrome trace event format (JSON), loadable in
+// chrome://tracing, Perfetto (ui.perfetto.dev) and speedscope. Each thread
+// records into its own EventTraceBuffer, so recording needs no locks; the
+// buffers are written out together once recording has stopped.
+//
+// A full buffer drops further events and counts them. Spans still open at
+// the end of a buffer are closed at its last timestamp when written, so a
+// truncated recording still renders.
+
+typedef enum {
+    EVENT_TRACE_BEGIN = 'B',    // Span start; nests on its thread
+    EVENT_TRACE_END = 'E',      // Ends the innermost open span
+    EVENT_TRACE_COUNTER = 'C',  // Sampled value, drawn as a graph track
+    EVENT_TRACE_INSTANT = 'i'   // Point in time on its thread
+} EventTracePhase;
+
+typedef struct {
+    const char* name;           // Must outlive the buffer (string literals)
+    uint64_t time_us;
+    int64_t value;              // Counter value, unused otherwise
+    uint8_t phase;              // EventTracePhase
+} EventTraceEvent;
+
+typedef struct {
+    EventTraceEvent* events;    // Caller-provided storage
+    uint32_t capacity;
+    uint32_t count;
+    uint64_t dropped;           // Events lost to a full buffer
+    uint32_t thread_id;
+    const char* thread_name;    // Track label, NULL for "Thread <id>"
+} EventTraceBuffer;
+
+/**
+ * Bind a buffer to its storage and thread; any previous events are discarded
+ */
+void EventTrace_Initialize(EventTraceBuffer* buffer, EventTraceEvent* events, uint32_t capacity,
+                           uint32_t thread_id, const char* thread_name);
+
+/**
+ * Append one event; only the owning thread may call this
+ * @return false (and counted as dropped) if the buffer is full
+ */
+bool EventTrace_Add(EventTraceBuffer* buffer, EventTracePhase phase, const char* name,
+                    uint64_t time_us, int64_t value);
+
+/**
+ * Sink for the JSON text
+ * @return false to abort writing
+ */
+typedef bool (*EventTraceWriteFn)(void* context, const char* data, size_t length);
+
+/**
+ * Write buffers as one Chrome trace JSON object
+ * Timestamps are written relative to origin_us. Buffers must not be
+ * recorded into while they are written.
+ * @param process_name Label of the process track
+ * @return false if the sink failed
+ */
+bool EventTrace_WriteJson(const EventTraceBuffer* const* buffers, int count, uint32_t process_id,
+                          const char* process_name, uint64_t origin_us, EventTraceWriteFn write,
+                          void* context);
+
+#endif // EVENT_TRACE_H
@@ -0,0 +1,63 @@
+#ifndef EVENT_TRACER_H
+#define EVENT_TRACER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "event_trace.h"
+
+// Opt-in timeline tracing (tray menu). While active, instrumented spots
+// record begin/end and counter events into a buffer owned by the calling
+// thread (event_trace.h); Stop writes everything to a Chrome trace JSON
+// file next to the executable, to be opened in ui.perfetto.dev or
+// chrome://tracing. While inactive every hook is a single flag test.
+
+#define EVENT_TRACER_THREADS 4                      // Threads given a buffer; later ones untraced
+#define EVENT_TRACER_EVENTS_PER_THREAD (256 * 1024) // ~15 s of 8 kHz input on the message thread
+
+/**
+ * Allocate the buffers and start recording
+ * @return false if already active or the buffers could not be allocated
+ */
+bool EventTracer_Start(void);
+
+/**
+ * Stop recording, write the trace file and free the buffers
+ */
+void EventTracer_Stop(void);
+
+/**
+ * Start or stop tracing (tray menu)
+ */
+void EventTracer_Toggle(void);
+
+bool EventTracer_IsActive(void);
+
+/**
+ * Label the calling thread's track; may be called before tracing starts
+ * @param name Must stay valid (string literal)
+ */
+void EventTracer_NameThread(const char* name);
+
+/**
+ * Open a span on the calling thread
+ * @param name Must stay valid (string literal)
+ */
+void EventTracer_Begin(const char* name);
+
+/**
+ * Close the calling thread's innermost span
+ */
+void EventTracer_End(void);
+
+/**
+ * Sample a value shown as a counter track
+ */
+void EventTracer_Counter(const char* name, int64_t value);
+
+/**
+ * Current or last trace file path; empty before the first trace
+ */
+const char* EventTracer_GetPath(void);
+
+#endif // EVENT_TRACER_H
@@ -0,0 +1,92 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Always-on in-memory history of raw input packets, engine positions and
+// update tick timing. Records are fixed-size and stored unencoded in a
+// ring, so recording is one 32-byte store and the oldest records are
+// simply overwritten. On demand the most recent window is written as an
+// input trace (input_trace.h) that the replay tools read like any
+// recording, plus the tick timing as CSV. Single-threaded: record and
+// write from the same thread.
+
+#define FLIGHT_RECORDER_CAPACITY (256 * 1024)       // Records (8 MB, power of two): ~30 s at 8 kHz
+#define FLIGHT_RECORDER_DEFAULT_WINDOW_MS 30000     // Longest history a dump covers
+
+typedef enum {
+    FLIGHT_RECORD_PACKET = 1,
+    FLIGHT_RECORD_OUTPUT,       // Engine position after a tick that moved it
+    FLIGHT_RECORD_TICK          // One update tick
+} FlightRecordType;
+
+typedef struct {
+    uint64_t time_us;           // Platform clock; TICK: tick start
+    uint64_t device;            // PACKET: source device
+    int32_t a, b;               // PACKET: dx, dy; OUTPUT: x, y in 1/INPUT_TRACE_POSITION_SCALE px;
+                                // TICK: duration (us), distance to target in
+                                // 1/INPUT_TRACE_POSITION_SCALE px
+    uint8_t type;               // FlightRecordType
+    uint8_t pressed;            // PACKET: STABILIZER_BUTTON_* bits; TICK: 1 if engaged
+    uint8_t released;           // PACKET: STABILIZER_BUTTON_* bits
+} FlightRecord;
+
+typedef struct {
+    FlightRecord records[FLIGHT_RECORDER_CAPACITY];
+    uint64_t head;              // Records ever written; the newest is at (head - 1) % capacity
+    int32_t output_x, output_y; // Last recorded OUTPUT, to skip unchanged positions
+    bool has_output;
+} FlightRecorder;
+
+typedef struct {
+    uint64_t packets;
+    uint64_t outputs;
+    uint64_t ticks;
+    uint64_t first_us, last_us; // Time span written
+    uint64_t bytes;
+} FlightRecorderSummary;
+
+/**
+ * Receives dump output in order; return false to abort
+ */
+typedef bool (*FlightRecorderWriteFn)(void* context, const uint8_t* data, size_t length);
+
+void FlightRecorder_Initialize(FlightRecorder* recorder);
+
+void FlightRecorder_RecordPacket(FlightRecorder* recorder, uint64_t time_us, uint64_t device,
+                                 int32_t dx, int32_t dy, unsigned int pressed,
+                                 unsigned int released);
+
+/**
+ * Record the engine position; unchanged positions are skipped like in traces
+ */
+void FlightRecorder_RecordOutput(FlightRecorder* recorder, uint64_t time_us, float x, float y);
+
+/**
+ * Record one update tick
+ * @param distance Distance from the cursor to the target after the tick, in px
+ */
+void FlightRecorder_RecordTick(FlightRecorder* recorder, uint64_t start_us, uint32_t duration_us,
+                               bool engaged, float distance);
+
+/**
+ * Write the packets and outputs of the last window_us before now_us as an input trace
+ * The trace starts at the oldest record written.
+ * @param summary Optional; receives what was written
+ * @return false if the sink failed
+ */
+bool FlightRecorder_WriteTrace(const FlightRecorder* recorder, uint64_t now_us, uint64_t window_us,
+                               FlightRecorderWriteFn write, void* context,
+                               FlightRecorderSummary* summary);
+
+/**
+ * Write the ticks of the same window as CSV:
+ * time_ms,interval_us,duration_us,engaged,distance_px (time relative to the window start)
+ * @return false if the sink failed
+ */
+bool FlightRecorder_WriteTicks(const FlightRecorder* recorder, uint64_t now_us, uint64_t window_us,
+                               FlightRecorderWriteFn write, void* context);
+
+#endif // FLIGHT_RECORDER_H
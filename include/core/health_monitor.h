@@ -0,0 +1,39 @@
+#ifndef HEALTH_MONITOR_H
+#define HEALTH_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Scheduler health checks on the message thread. Every
+// HEALTH_MONITOR_INTERVAL_MS the watchdog timer reads the activity
+// counters (its own perf monitor reader) and feeds the hook watchdog
+// (hook_watchdog.h): raw input packets against hook calls, the slowest
+// hook callback against LowLevelHooksTimeout, and the engine tick
+// interval peak and jitter.
+//
+// When raw input keeps arriving but the hook has gone quiet, Windows has
+// dropped the hook: it is reinstalled, the incident is logged with the
+// recent timing history, and the flight recorder is dumped. Hook
+// callbacks past half the timeout and tick intervals past
+// HEALTH_MONITOR_STALL_MS are logged as warnings, rate limited.
+
+#define HEALTH_MONITOR_INTERVAL_MS 500      // WATCHDOG_TIMER_ID period
+#define HEALTH_MONITOR_STALL_MS 100         // Tick interval reported as a stall
+
+/**
+ * Reset the watchdog and set its thresholds from LowLevelHooksTimeout
+ * Call once the hook is installed.
+ */
+void HealthMonitor_Initialize(void);
+
+/**
+ * Run one check; called from the watchdog timer
+ */
+void HealthMonitor_Check(void);
+
+/**
+ * Times the hook was reinstalled since startup
+ */
+uint32_t HealthMonitor_GetReinstalls(void);
+
+#endif // HEALTH_MONITOR_H
@@ -0,0 +1,96 @@
+#ifndef HOOK_WATCHDOG_H
+#define HOOK_WATCHDOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Health checks for the input scheduling. The host feeds one sample per
+// check interval: raw input packets and mouse hook calls in the interval,
+// the slowest hook callback, and the engine tick interval peak and
+// jitter. The watchdog keeps the last HOOK_WATCHDOG_HISTORY samples as
+// timing context and reports three conditions:
+//
+//   hook dead    Raw input keeps arriving but the low-level hook has not
+//                been called for HOOK_WATCHDOG_QUIET_MS. Windows removes a
+//                WH_MOUSE_LL hook without notice once a callback overruns
+//                LowLevelHooksTimeout, and every physical move reaches both
+//                paths, so silence on one side means the hook is gone. The
+//                host reinstalls it; repeated incidents without the hook
+//                coming back double the wait before the next attempt.
+//   slow hook    A callback used at least the given share of the timeout.
+//   tick stall   Two engine ticks were further apart than the stall limit.
+//
+// Slow hooks and stalls are reported at most once per
+// HOOK_WATCHDOG_WARN_INTERVAL_MS each, so a bad minute is one log line.
+
+#define HOOK_WATCHDOG_HISTORY 16            // Samples kept for incident context
+#define HOOK_WATCHDOG_QUIET_MS 1000         // Hook silence with raw input arriving = dead hook
+#define HOOK_WATCHDOG_MIN_PACKETS 50        // Packets that must have arrived in that silence
+#define HOOK_WATCHDOG_BACKOFF_MS 5000       // Least time between reinstalls
+#define HOOK_WATCHDOG_MAX_BACKOFF_MS 60000
+#define HOOK_WATCHDOG_WARN_INTERVAL_MS 60000
+
+// HookWatchdog_Observe result bits
+#define HOOK_WATCHDOG_HOOK_DEAD 0x01
+#define HOOK_WATCHDOG_SLOW_HOOK 0x02
+#define HOOK_WATCHDOG_TICK_STALL 0x04
+
+typedef struct {
+    uint64_t time_us;           // End of the interval
+    uint64_t packets;           // Raw input packets in the interval
+    uint64_t hook_calls;        // Hook callbacks in the interval
+    uint32_t hook_max_us;       // Slowest callback
+    uint32_t tick_max_us;       // Longest tick interval
+    uint32_t tick_jitter_us;    // Standard deviation of the tick interval
+} HookWatchdogSample;
+
+// Timing context of the history, for the incident record
+typedef struct {
+    uint64_t window_us;         // Time the history covers
+    uint64_t quiet_us;          // Since the last interval with hook calls
+    uint64_t packets_unhooked;  // Raw input packets since then, or since the last reinstall
+    uint32_t hook_max_us;       // Slowest callback in the window
+    uint64_t hook_max_age_us;   // How long before the latest sample it was seen
+    uint32_t tick_max_us;
+    uint32_t tick_jitter_us;    // Worst interval jitter in the window
+    uint32_t reinstalls;        // Reinstalls so far
+} HookWatchdogContext;
+
+typedef struct {
+    uint32_t slow_hook_us;      // SLOW_HOOK threshold
+    uint32_t stall_us;          // TICK_STALL threshold
+    HookWatchdogSample history[HOOK_WATCHDOG_HISTORY];
+    uint32_t history_count;
+    uint32_t history_next;
+    bool started;
+    uint64_t last_hook_us;      // End of the last interval with hook calls
+    uint64_t packets_unhooked;
+    uint64_t backoff_us;        // Current wait between reinstalls
+    uint64_t last_reinstall_us;
+    bool reinstalled;           // last_reinstall_us is valid
+    uint64_t last_slow_warn_us;
+    uint64_t last_stall_warn_us;
+    bool slow_warned, stall_warned;
+    uint32_t reinstalls;
+} HookWatchdog;
+
+/**
+ * @param slow_hook_us Callback time that counts as slow, e.g. half of LowLevelHooksTimeout
+ * @param stall_us Tick interval that counts as a stall
+ */
+void HookWatchdog_Initialize(HookWatchdog* watchdog, uint32_t slow_hook_us, uint32_t stall_us);
+
+/**
+ * Add one interval's sample
+ * @return HOOK_WATCHDOG_* bits for the conditions to act on now
+ */
+unsigned int HookWatchdog_Observe(HookWatchdog* watchdog, const HookWatchdogSample* sample);
+
+/**
+ * The host reinstalled the hook after a HOOK_WATCHDOG_HOOK_DEAD report
+ */
+void HookWatchdog_Reinstalled(HookWatchdog* watchdog, uint64_t now_us);
+
+void HookWatchdog_GetContext(const HookWatchdog* watchdog, HookWatchdogContext* context);
+
+#endif // HOOK_WATCHDOG_H
@@ -0,0 +1,121 @@
+#ifndef INPUT_TRACE_H
+#define INPUT_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary input trace format (.mstrace).
+// A 16-byte header followed by a stream of variable-length records. Fields
+// are delta-coded against the previous record of the same kind and stored
+// as zig-zag LEB128 varints. Packet times are delta-of-delta coded, so a
+// steady polling rate costs one byte whatever the rate, and small motion
+// packs both axes into one byte: a typical 8 kHz packet takes 3 bytes.
+// The codec is portable: the Win32 recorder (trace_recorder.c) writes
+// traces, offline tools read them.
+//
+// Header:  "MSTR" | u16 version | u16 header size | u64 start time (us)
+// Record:  tag byte, low 2 bits = InputTraceRecordType
+//   PACKET  tag | interval change | motion | [pressed | released << 8]
+//           bit 2 of tag: buttons follow
+//           bit 3 of tag: motion is one byte, dx and dy as signed nibbles;
+//                         otherwise two varints
+//   OUTPUT  tag | time delta | dx | dy of current_pos in 1/INPUT_TRACE_POSITION_SCALE px
+//   DEVICE  tag | device handle; applies to the packets that follow
+//   GAP     tag | number of packets the recorder dropped here
+
+#define INPUT_TRACE_MAGIC "MSTR"
+#define INPUT_TRACE_VERSION 1
+#define INPUT_TRACE_HEADER_SIZE 16
+#define INPUT_TRACE_MAX_RECORD_SIZE 48     // Upper bound for one Encode* call
+#define INPUT_TRACE_POSITION_SCALE 256.0f  // Output positions are stored in 1/256 px
+
+#define INPUT_TRACE_FLAG_BUTTONS 0x04
+#define INPUT_TRACE_FLAG_PACKED 0x08
+
+typedef enum {
+    INPUT_TRACE_PACKET = 0,     // One raw input packet
+    INPUT_TRACE_OUTPUT = 1,     // Engine cursor position after a tick
+    INPUT_TRACE_DEVICE = 2,     // Source device switch
+    INPUT_TRACE_GAP = 3         // Recorder overflow marker
+} InputTraceRecordType;
+
+// Running delta state, identical on the encode and decode side
+typedef struct {
+    uint64_t packet_time_us;    // Previous packet
+    int64_t packet_interval_us; // Previous packet-to-packet interval
+    uint64_t output_time_us;    // Previous output
+    uint64_t device;            // Current source device
+    int32_t output_x, output_y; // Previous output position (fixed point)
+} InputTraceState;
+
+// One decoded record; fields not used by the record type are zero
+typedef struct {
+    InputTraceRecordType type;
+    uint64_t time_us;
+    uint64_t device;
+    int32_t dx, dy;             // PACKET: raw counts
+    unsigned int pressed;       // PACKET: STABILIZER_BUTTON_* bits
+    unsigned int released;
+    float x, y;                 // OUTPUT: engine position
+    uint32_t dropped;           // GAP: packets lost
+} InputTraceRecord;
+
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    size_t offset;              // Next record
+    uint64_t start_us;
+    uint16_t version;
+    bool corrupt;               // Set when a record ran past the end or was malformed
+    InputTraceState state;
+} InputTraceReader;
+
+/**
+ * Reset the delta state to the start of a trace
+ */
+void InputTrace_ResetState(InputTraceState* state, uint64_t start_us);
+
+/**
+ * Write the file header
+ * @param out At least INPUT_TRACE_HEADER_SIZE bytes
+ * @return Bytes written
+ */
+size_t InputTrace_WriteHeader(uint8_t* out, uint64_t start_us);
+
+/**
+ * Encode one raw input packet, preceded by a DEVICE record if the source changed
+ * @param out At least INPUT_TRACE_MAX_RECORD_SIZE bytes
+ * @return Bytes written
+ */
+size_t InputTrace_EncodePacket(InputTraceState* state, uint8_t* out, uint64_t time_us,
+                               uint64_t device, int32_t dx, int32_t dy, unsigned int pressed,
+                               unsigned int released);
+
+/**
+ * Encode the engine's cursor position
+ * @return Bytes written; 0 if the position did not change since the last output
+ */
+size_t InputTrace_EncodeOutput(InputTraceState* state, uint8_t* out, uint64_t time_us, float x,
+                               float y);
+
+/**
+ * Encode an overflow marker for packets that never reached the trace
+ * @return Bytes written
+ */
+size_t InputTrace_EncodeGap(uint8_t* out, uint32_t dropped);
+
+/**
+ * Validate the header and position the reader on the first record
+ * @param data Whole trace, e.g. a file mapping; must stay valid while reading
+ * @return false if the header is missing or of an unknown version
+ */
+bool InputTrace_OpenReader(InputTraceReader* reader, const void* data, size_t length);
+
+/**
+ * Decode the next record
+ * @return false at the end of the trace or on a malformed record (reader->corrupt)
+ */
+bool InputTrace_Read(InputTraceReader* reader, InputTraceRecord* record);
+
+#endif // INPUT_TRACE_H
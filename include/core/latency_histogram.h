@@ -0,0 +1,89 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Log-linear latency histogram in microseconds, after HdrHistogram. Values
+// below 2^SUB_BITS are counted exactly; above that every power of two is
+// split into 2^(SUB_BITS-1) equal buckets, so a bucket is never wider than
+// 1/64 of its values (under 1.6%) anywhere from 1 us to about 71 minutes.
+// Larger values are counted at the top of the range.
+//
+// Recording is lock-free: counters are updated with relaxed atomic adds
+// (GCC/Clang __atomic builtins), so any number of threads may record into
+// one histogram while another takes snapshots. Queries read plain memory
+// and belong on a snapshot, or on a histogram no thread is recording into.
+
+#define LATENCY_HISTOGRAM_SUB_BITS 7
+#define LATENCY_HISTOGRAM_MAX_VALUE 0xFFFFFFFFull
+#define LATENCY_HISTOGRAM_BUCKETS \
+    ((32 - LATENCY_HISTOGRAM_SUB_BITS + 2) << (LATENCY_HISTOGRAM_SUB_BITS - 1))
+
+typedef struct {
+    uint64_t count;             // Values recorded
+    uint64_t sum;               // Their total, for the mean
+    uint64_t max;               // Exact largest value
+    uint64_t counts[LATENCY_HISTOGRAM_BUCKETS];
+} LatencyHistogram;
+
+typedef struct {
+    uint64_t count;
+    double mean;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+} LatencySummary;
+
+/**
+ * Empty a histogram
+ * Not atomic: values recorded by other threads during the reset may survive.
+ */
+void LatencyHistogram_Reset(LatencyHistogram* histogram);
+
+/**
+ * Count one value; lock-free and safe from any thread
+ * @param value_us Latency in microseconds
+ */
+void LatencyHistogram_Record(LatencyHistogram* histogram, uint64_t value_us);
+
+/**
+ * Copy a histogram that may be recorded into concurrently
+ * The copy's count is the sum of the copied buckets, so its percentiles
+ * are consistent even when a record lands halfway through.
+ */
+void LatencyHistogram_Snapshot(const LatencyHistogram* histogram, LatencyHistogram* out);
+
+// Bucket layout: index of a value and the range of values a bucket holds
+int LatencyHistogram_BucketIndex(uint64_t value_us);
+uint64_t LatencyHistogram_BucketLow(int index);
+uint64_t LatencyHistogram_BucketHigh(int index);
+
+/**
+ * Value at or below which a percentage of the recorded values fall
+ * Reports the top of the bucket holding that rank (never above the exact
+ * maximum), so the true value is at most one bucket width lower.
+ * @param percentile 0 to 100
+ * @return 0 for an empty histogram
+ */
+uint64_t LatencyHistogram_Percentile(const LatencyHistogram* histogram, double percentile);
+
+/**
+ * Count, mean, p50, p99, p99.9 and max in one pass over the buckets
+ */
+void LatencyHistogram_Summarize(const LatencyHistogram* histogram, LatencySummary* summary);
+
+/**
+ * Write the percentile distribution in HdrHistogram's text layout (.hgrm)
+ * Rows list value (ms), percentile, cumulative count and 1/(1-percentile),
+ * five per halving of the distance to 100%, as the HdrHistogram plotter
+ * expects.
+ * @return Characters written (excluding the terminator); output that does
+ *         not fit is cut at a row boundary
+ */
+size_t LatencyHistogram_FormatDistribution(const LatencyHistogram* histogram, char* out,
+                                           size_t size);
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,84 @@
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "latency_histogram.h"
+
+// Per-stage latency of the input-to-cursor pipeline. Each raw input packet
+// that moves the target is timestamped on arrival and after the target
+// update; the update tick that first writes the cursor after it adds the
+// tick start, the moment the filter output reaches the cursor writer, and
+// the return of SetCursorPos / SendInput. The differences go into one
+// latency histogram per stage. Marks come from the message thread only;
+// the histograms can be read from any thread, one snapshot buffer per reader.
+
+#define LATENCY_PROBE_PENDING 256   // Packets awaiting a cursor write; later ones are not timed
+
+typedef enum {
+    LATENCY_STAGE_INPUT,        // WM_INPUT arrival -> target updated
+    LATENCY_STAGE_TIMER,        // Target updated -> start of the tick that writes the cursor
+    LATENCY_STAGE_FILTER,       // Tick start -> filter output handed to the cursor writer
+    LATENCY_STAGE_WRITE,        // Cursor writer entry -> SetCursorPos / SendInput returned
+    LATENCY_STAGE_TOTAL,        // WM_INPUT arrival -> SetCursorPos / SendInput returned
+    LATENCY_STAGE_COUNT
+} LatencyStage;
+
+/**
+ * A packet moved the engine's target
+ * @param arrival_us WM_INPUT arrival on the platform clock
+ */
+void LatencyProbe_MarkTarget(uint64_t arrival_us);
+
+/**
+ * An update tick starts; writes before LatencyProbe_EndTick complete pending packets
+ */
+void LatencyProbe_BeginTick(void);
+
+/**
+ * The cursor writer received a position (called on entry)
+ */
+void LatencyProbe_MarkOutput(void);
+
+/**
+ * The cursor write returned successfully; times every pending packet
+ */
+void LatencyProbe_MarkWritten(void);
+
+/**
+ * An update tick ends
+ * @param engaged Whether the engine still owns the cursor; packets left
+ *        pending by a tick that hands the cursor back are never written
+ *        by the engine and are discarded
+ */
+void LatencyProbe_EndTick(bool engaged);
+
+const char* LatencyProbe_GetStageName(LatencyStage stage);
+
+/**
+ * Percentiles of one stage, taken from a snapshot of its histogram
+ * @param reader PERF_MONITOR_READER_*; each reader has its own snapshot
+ *        buffer, so readers on different threads do not disturb each other
+ */
+void LatencyProbe_GetSummary(int reader, LatencyStage stage, LatencySummary* summary);
+
+/**
+ * Packets that could not be timed because too many were pending
+ */
+uint64_t LatencyProbe_GetOverflow(void);
+
+/**
+ * Clear all histograms
+ */
+void LatencyProbe_Reset(void);
+
+/**
+ * Write every stage's percentile distribution (.hgrm layout) next to the executable
+ * @param path Receives the file name written
+ * @return false if the file could not be written
+ */
+bool LatencyProbe_Dump(char* path, size_t size);
+
+#endif // LATENCY_PROBE_H
@@ -0,0 +1,83 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+// Bounded multi-producer, single-consumer ring of log records.
+// Producers claim a slot with one compare-and-swap, format the message
+// into it and publish it; they never block and never wait for the disk.
+// When the ring is full the record is dropped and counted instead. One
+// consumer (the log writer thread) reads records in claim order and hands
+// the slots back. Each slot carries a sequence number (after Vyukov's
+// bounded queue), so producers and the consumer never touch the same
+// slot at the same time. Uses the GCC/Clang __atomic builtins.
+
+#define LOG_RING_CAPACITY 1024          // Records; must be a power of two
+#define LOG_RING_MESSAGE_SIZE 232       // Longer messages are truncated
+
+typedef struct {
+    uint64_t sequence;          // Claim position + 1 once published
+    uint64_t time;              // Host timestamp, opaque to the ring
+    LogSite* site;              // Binary record: its call site, message holds raw arguments
+    uint8_t level;              // LogLevel
+    uint16_t length;            // Message bytes, excluding the terminator
+    char message[LOG_RING_MESSAGE_SIZE];
+} LogRecord;
+
+typedef struct {
+    LogRecord slots[LOG_RING_CAPACITY];
+    uint64_t head;              // Next position to claim (producers)
+    uint8_t head_pad[56];       // Keep producers off the consumer's cache line
+    uint64_t tail;              // Next position to read (consumer only)
+    uint64_t dropped;           // Records lost to a full ring, not yet reported
+    uint64_t written;           // Records published
+} LogRing;
+
+void LogRing_Initialize(LogRing* ring);
+
+/**
+ * Format a record into the ring; safe from any number of threads
+ * @param time Timestamp stored with the record (e.g. a FILETIME)
+ * @return false if the ring was full and the record was dropped
+ */
+bool LogRing_Write(LogRing* ring, LogLevel level, uint64_t time, const char* format, va_list args);
+
+/**
+ * Claim a slot to fill in place; safe from any number of threads
+ * Every claimed slot must be published, or the consumer stalls on it.
+ * @param position Receives the claim position for LogRing_Publish
+ * @return NULL if the ring was full (the record is counted as dropped)
+ */
+LogRecord* LogRing_Claim(LogRing* ring, uint64_t* position);
+
+/**
+ * Hand a filled slot to the consumer
+ */
+void LogRing_Publish(LogRing* ring, LogRecord* record, uint64_t position);
+
+/**
+ * Oldest published record, or NULL if none is ready (consumer only)
+ */
+const LogRecord* LogRing_Peek(LogRing* ring);
+
+/**
+ * Release the record returned by LogRing_Peek (consumer only)
+ */
+void LogRing_Pop(LogRing* ring);
+
+/**
+ * Records claimed but not yet popped; approximate while producers run
+ */
+uint32_t LogRing_Pending(const LogRing* ring);
+
+/**
+ * Number of records dropped since the last call
+ */
+uint64_t LogRing_TakeDropped(LogRing* ring);
+
+#endif // LOG_RING_H
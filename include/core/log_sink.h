@@ -0,0 +1,90 @@
+#ifndef LOG_SINK_H
+#define LOG_SINK_H
+
+#include <windows.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Size- and time-capped log file written through a mapped view. The
+// current segment (base + extension) is created at its full size and
+// mapped once, so a write is a copy into memory: no write call, no
+// flush, and readers of the file see the data at once. When a record
+// would not fit, or the segment is older than its age limit, the segment
+// is truncated to what was written and renamed base.1 + extension; older
+// segments move up and the oldest is deleted. The first write of a run
+// rotates a previous run's segment away the same way.
+//
+// A process killed mid-segment leaves the unused tail as zero bytes;
+// text segments drop it when they are rotated away, binary readers stop
+// at it (binary_log.h).
+
+#define LOG_SINK_DEFAULT_SEGMENT_BYTES (4u * 1024 * 1024)
+#define LOG_SINK_DEFAULT_MAX_FILES 5
+#define LOG_SINK_DEFAULT_MAX_AGE_SECONDS (24u * 60 * 60)
+
+typedef struct {
+    uint32_t segment_bytes;     // File size cap
+    uint32_t max_files;         // Rotated segments kept next to the current one
+    uint32_t max_age_seconds;   // 0 = rotate on size only
+    bool trim_padding;          // Text: drop a crashed run's zero tail when rotating
+} LogSinkOptions;
+
+typedef struct {
+    char base[MAX_PATH];        // Path without extension
+    char extension[16];
+    LogSinkOptions options;
+
+    HANDLE file;
+    HANDLE mapping;
+    uint8_t* view;
+    size_t capacity;            // Mapped size of the current segment
+    size_t used;
+    uint64_t opened_second;     // Caller's clock when the segment was created
+    bool started;               // A previous run's segment has been rotated away
+
+    uint64_t segments;          // Segments created
+    uint64_t bytes;             // Bytes committed over all segments
+    uint64_t failures;          // Segments that could not be created
+} LogSink;
+
+void LogSink_DefaultOptions(LogSinkOptions* options);
+
+/**
+ * Set up a sink; no file is touched before the first reserve
+ * @param base Path without extension, e.g. C:\...\mouse_stabilizer
+ * @param extension Including the dot, e.g. ".log"
+ */
+void LogSink_Initialize(LogSink* sink, const char* base, const char* extension,
+                        const LogSinkOptions* options);
+
+/**
+ * Change limits; the segment size applies from the next segment
+ */
+void LogSink_Configure(LogSink* sink, const LogSinkOptions* options);
+
+/**
+ * Room for the next record in the current segment, rotating first if needed
+ * @param now_second Caller's wall clock in seconds, for the age limit
+ * @param new_segment Set when the returned space starts a fresh segment
+ * @return At least length writable bytes, NULL if no segment can be created
+ *         or length exceeds the segment size
+ */
+uint8_t* LogSink_Reserve(LogSink* sink, size_t length, uint64_t now_second, bool* new_segment);
+
+/**
+ * Keep length bytes of the space returned by LogSink_Reserve
+ */
+void LogSink_Commit(LogSink* sink, size_t length);
+
+/**
+ * Ask the OS to write the dirty pages of the current segment to disk
+ */
+void LogSink_Flush(LogSink* sink);
+
+/**
+ * Truncate the current segment to its contents and close it
+ */
+void LogSink_Close(LogSink* sink);
+
+#endif // LOG_SINK_H
@@ -0,0 +1,29 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <stdbool.h>
+
+// Optional HTTP endpoint on 127.0.0.1 that serves the health figures in
+// the Prometheus text format (metrics_text.h) at /metrics. A lowest
+// priority thread of its own accepts one connection at a time, reads the
+// activity counters (its own perf monitor reader), latency summaries and
+// queue statistics, and answers; nothing runs on the input or engine
+// threads on its behalf. Off unless the MetricsPort ini key is set.
+
+#define METRICS_SERVER_REQUEST_SIZE 2048    // Longer requests are refused
+#define METRICS_SERVER_PAGE_SIZE (16 * 1024)
+#define METRICS_SERVER_IO_TIMEOUT_MS 1000   // Per connection; a stuck client cannot hold the thread
+#define METRICS_SERVER_MIN_PORT 1024
+
+// MetricsPort ini key; 0 keeps the endpoint off
+extern int g_metrics_port;
+
+/**
+ * Listen on 127.0.0.1:g_metrics_port and start the server thread
+ * @return false if the port is off or taken, or the thread could not start
+ */
+bool MetricsServer_Start(void);
+
+void MetricsServer_Stop(void);
+
+#endif // METRICS_SERVER_H
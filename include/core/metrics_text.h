@@ -0,0 +1,102 @@
+#ifndef METRICS_TEXT_H
+#define METRICS_TEXT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "latency_histogram.h"
+
+// The stabilizer's health figures as a page in the Prometheus text
+// exposition format (version 0.0.4): families with # HELP and # TYPE
+// lines, then "name{labels} value" samples. Formatting, the HTTP request
+// check and a format validator for scrapers are here; serving the page is
+// up to the host. Everything writes into caller-provided buffers.
+
+#define METRICS_TEXT_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+#define METRICS_TEXT_PATH "/metrics"
+#define METRICS_TEXT_MAX_STAGES 8
+
+typedef enum {
+    METRICS_TYPE_COUNTER,
+    METRICS_TYPE_GAUGE,
+    METRICS_TYPE_SUMMARY
+} MetricsType;
+
+typedef enum {
+    METRICS_REQUEST_INCOMPLETE,     // Headers not complete yet
+    METRICS_REQUEST_METRICS,        // GET /metrics
+    METRICS_REQUEST_NOT_FOUND,      // GET of another path
+    METRICS_REQUEST_BAD             // Not a GET request line
+} MetricsRequest;
+
+typedef struct {
+    const char* stage;          // Label value
+    LatencySummary summary;     // Microseconds
+} MetricsLatency;
+
+// Figures for one page; rates cover the time since the previous scrape
+typedef struct {
+    bool enabled;
+    double packets_per_s;
+    double steps_per_s;
+    uint64_t packets_total;
+    uint64_t ticks_total;
+    double tick_mean_ms;
+    double tick_max_ms;
+    double tick_jitter_ms;      // Standard deviation of the tick interval
+    double cursor_issued_per_s;
+    double cursor_skipped_per_s;
+    uint32_t log_pending;
+    uint64_t log_dropped;
+    uint64_t trace_dropped;
+    uint64_t latency_overflow;
+    double hook_mean_us;
+    double hook_max_us;
+    uint64_t hook_timeouts;     // Callbacks that outlived the system hook timeout
+    uint64_t hook_reinstalls;   // Times the watchdog replaced a dropped hook
+    double cpu_percent;
+    int latency_count;
+    MetricsLatency latency[METRICS_TEXT_MAX_STAGES];
+} MetricsSnapshot;
+
+typedef struct {
+    char* data;
+    size_t capacity;
+    size_t length;
+    bool truncated;             // Something did not fit; data ends at the last whole line
+} MetricsText;
+
+void MetricsText_Initialize(MetricsText* text, char* buffer, size_t capacity);
+
+/**
+ * Start a metric family: its # HELP and # TYPE lines
+ */
+void MetricsText_Family(MetricsText* text, const char* name, MetricsType type, const char* help);
+
+/**
+ * One sample line
+ * @param labels Label pairs without braces (stage="total"), or NULL
+ */
+void MetricsText_Sample(MetricsText* text, const char* name, const char* labels, double value);
+
+/**
+ * The whole page for a snapshot
+ * @return Page length; text->truncated tells whether it was cut short
+ */
+size_t MetricsText_FormatPage(MetricsText* text, const MetricsSnapshot* snapshot);
+
+/**
+ * Classify an HTTP request from its first bytes
+ */
+MetricsRequest MetricsText_ParseRequest(const char* data, size_t length);
+
+/**
+ * Check a page against the exposition format: metric and label syntax,
+ * values, and a # TYPE line before each family's first sample
+ * @param error Receives the first problem and its line, may be NULL
+ * @return Samples on the page, or -1 if it is malformed
+ */
+int MetricsText_Validate(const char* data, size_t length, char* error, size_t error_size);
+
+#endif // METRICS_TEXT_H
@@ -4,16 +4,55 @@
 #include <windows.h>
 #include <stdbool.h>
 
+// Default stabilizer instance, owns the user settings
+extern SmoothStabilizer g_stabilizer;
+
 // Global window handles
 extern HWND g_hidden_window;
 extern bool g_running;
 
+// Multi-device policy (see DevicePolicy)
+extern DevicePolicy g_device_policy;
+
 // Mouse input processing functions
 bool MouseInput_RegisterRawInput(void);
 void MouseInput_ProcessRawInput(LPARAM lParam);
 LRESULT CALLBACK MouseInput_LowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam);
 LRESULT CALLBACK MouseInput_WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
+/**
+ * Install MouseInput_LowLevelMouseProc as the WH_MOUSE_LL hook
+ * Call on the message thread; the hook runs on the thread that installs it.
+ */
+bool MouseInput_InstallHook(void);
+
+void MouseInput_RemoveHook(void);
+
+/**
+ * Replace a hook Windows has dropped (see health_monitor.h)
+ */
+bool MouseInput_ReinstallHook(void);
+
+/**
+ * Handle WM_INPUT_DEVICE_CHANGE arrival/removal notifications
+ * @param wParam GIDC_ARRIVAL or GIDC_REMOVAL
+ * @param lParam Raw input device handle
+ */
+void MouseInput_HandleDeviceChange(WPARAM wParam, LPARAM lParam);
+
+/**
+ * Get the stabilizer instance currently driving the cursor
+ * Falls back to g_stabilizer when no device owns the cursor.
+ */
+SmoothStabilizer* MouseInput_GetActiveStabilizer(void);
+
+/**
+ * Push g_stabilizer's parameters to every per-device instance
+ * Parameters a device overrides in its [Device ...] section are kept.
+ * Call after settings change (UI, hotkey toggle, settings load).
+ */
+void MouseInput_SyncDeviceSettings(void);
+
 // Hotkey and window management
 void MouseInput_ToggleStabilizer(void);
 
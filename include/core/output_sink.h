@@ -0,0 +1,82 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+// Output layer between the engine and the OS cursor.
+// The engine hands over float positions; the sink rounds them so the
+// pixels follow the line between consecutive positions, drops moves that
+// would not change the cursor and forwards the rest to a pluggable writer. OS writers live with the
+// platform (platform_win32.h); the recording writer here serves tests.
+
+#define OUTPUT_RECORDING_CAPACITY 4096
+#define OUTPUT_SINK_HYSTERESIS 0.05f    // Px past a pixel edge before the minor axis moves in place
+
+/**
+ * Writer callback: move the cursor to an integer desktop position
+ * @return false if the OS rejected the move
+ */
+typedef bool (*OutputWriteFn)(void* context, int x, int y);
+
+typedef struct {
+    OutputWriteFn write;
+    void* context;
+
+    // Line-following rounding
+    bool has_position;          // False until the first move after a reset
+    int last_x, last_y;         // Last position handed to the writer
+    float source_x, source_y;   // Last float position requested
+
+    // Statistics
+    uint64_t issued;            // Writer calls that succeeded
+    uint64_t skipped;           // Moves dropped because the pixel did not change
+    uint64_t failed;            // Writer calls the OS rejected
+} OutputSink;
+
+// One captured move for the recording writer
+typedef struct {
+    int x, y;
+} OutputPoint;
+
+typedef struct {
+    OutputPoint points[OUTPUT_RECORDING_CAPACITY];
+    int count;
+    int dropped;                // Moves lost after the buffer filled
+} OutputRecording;
+
+/**
+ * Set up a sink with a writer and clear its state and counters
+ */
+void OutputSink_Initialize(OutputSink* sink, OutputWriteFn write, void* context);
+
+/**
+ * Forget the last position
+ * Call when something other than the sink moved the cursor.
+ */
+void OutputSink_Reset(OutputSink* sink);
+
+/**
+ * Move the cursor towards a float position
+ * The axis that moved further is rounded; the rounding error it leaves is
+ * carried over to the other axis along the direction of the move, so the
+ * pixel is the one on the line through the previous position. Slow shallow
+ * lines then step diagonally at each column instead of in L-shaped stairs.
+ * @return true if the cursor is at the requested pixel (written or already there)
+ */
+bool OutputSink_MoveTo(OutputSink* sink, float x, float y);
+
+/**
+ * Write issued/skipped/failed counters to the platform log
+ */
+void OutputSink_LogStats(const OutputSink* sink, const Platform* platform);
+
+/**
+ * Writer that appends every move to an OutputRecording
+ * @param context OutputRecording to append to
+ */
+bool OutputSink_WriteRecording(void* context, int x, int y);
+
+#endif // OUTPUT_SINK_H
@@ -0,0 +1,74 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Cheap always-on activity counters. Each recording thread owns one
+// PerfCounterBlock and is its only writer, so a count is a plain load and
+// store with no locked instruction; readers add the blocks up when they
+// want a figure (GCC/Clang __atomic builtins keep the 64-bit loads and
+// stores whole). Nothing is aggregated while nobody reads.
+//
+// Maxima are per reader: every reader slot holds the largest value since
+// that reader last collected, so a settings panel, a metrics scraper and a
+// watchdog can each see their own interval's peak.
+
+#define PERF_COUNTER_READERS 4
+
+typedef enum {
+    PERF_COUNT_PACKETS,         // Raw input packets handled
+    PERF_COUNT_TICKS,           // Engine update ticks
+    PERF_COUNT_TICK_INTERVAL,   // Sum of tick-to-tick intervals (us)
+    PERF_COUNT_TICK_INTERVALS,  // Intervals in that sum
+    PERF_COUNT_TICK_SQUARES,    // Sum of squared intervals (us^2), for the jitter
+    PERF_COUNT_HOOK_CALLS,      // Low-level mouse hook callbacks
+    PERF_COUNT_HOOK_TIME,       // Time spent in them (ns)
+    PERF_COUNT_HOOK_TIMEOUTS,   // Callbacks that ran past the system's hook timeout
+    PERF_COUNT_COUNT
+} PerfCount;
+
+typedef enum {
+    PERF_MAX_TICK_INTERVAL,     // us
+    PERF_MAX_HOOK_TIME,         // ns
+    PERF_MAX_COUNT
+} PerfMax;
+
+typedef struct {
+    uint64_t counts[PERF_COUNT_COUNT];
+    uint64_t maxima[PERF_COUNTER_READERS][PERF_MAX_COUNT];
+    uint64_t last_tick_us;      // Writer only; 0 before the first tick
+    uint8_t pad[56];            // 192 bytes, so blocks never share a cache line
+} PerfCounterBlock;
+
+// Totals over all blocks plus the maxima since the reader's last collect
+typedef struct {
+    uint64_t counts[PERF_COUNT_COUNT];
+    uint64_t maxima[PERF_MAX_COUNT];
+} PerfCounterSample;
+
+void PerfCounters_Initialize(PerfCounterBlock* block);
+
+/**
+ * Add to a counter; owning thread only
+ */
+void PerfCounters_Add(PerfCounterBlock* block, PerfCount counter, uint64_t value);
+
+/**
+ * Raise a maximum for every reader; owning thread only
+ */
+void PerfCounters_Max(PerfCounterBlock* block, PerfMax maximum, uint64_t value);
+
+/**
+ * Count an engine tick and the interval since the previous one; owning thread only
+ */
+void PerfCounters_MarkTick(PerfCounterBlock* block, uint64_t now_us);
+
+/**
+ * Add up blocks and take (and clear) this reader's maxima; safe while the owners record
+ * @param reader 0 .. PERF_COUNTER_READERS-1, one per independent consumer
+ */
+void PerfCounters_Collect(PerfCounterBlock* const* blocks, int count, int reader,
+                          PerfCounterSample* sample);
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,80 @@
+#ifndef PERF_MONITOR_H
+#define PERF_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "perf_counters.h"
+
+// Live activity figures for the Debug tab. Input packets, engine ticks and
+// mouse hook callbacks are counted into a per-thread counter block
+// (perf_counters.h), claimed on the thread's first count; cursor writes,
+// queues and drops come from the modules that already keep them. A read
+// turns everything into rates over the time since the same reader's
+// previous read, so each consumer gets its own interval.
+
+#define PERF_MONITOR_THREADS 4              // Threads that get a block; later ones are not counted
+
+#define PERF_MONITOR_READER_PANEL 0         // Settings window Debug tab
+#define PERF_MONITOR_READER_METRICS 1       // Loopback metrics endpoint
+#define PERF_MONITOR_READER_WATCHDOG 2      // Hook watchdog (health_monitor.h)
+
+// LowLevelHooksTimeout when the registry does not set it, and the most
+// Windows honours; a callback that runs longer is abandoned by the system
+#define PERF_MONITOR_HOOK_TIMEOUT_MS 300
+#define PERF_MONITOR_HOOK_TIMEOUT_MAX_MS 1000
+
+typedef struct {
+    double seconds;             // Interval covered
+    double packets_per_s;
+    double steps_per_s;
+    double tick_mean_ms;        // Measured WM_TIMER interval
+    double tick_max_ms;
+    double tick_jitter_ms;      // Standard deviation of the interval
+    uint64_t packets_total;     // Since startup
+    uint64_t ticks_total;
+    double cursor_issued_per_s; // Cursor writes that reached the OS
+    double cursor_skipped_per_s;// Moves dropped because the pixel did not change
+    uint32_t log_pending;       // Log queue depth
+    uint64_t log_dropped;       // Since startup
+    uint64_t trace_dropped;     // Recording overruns since its start
+    uint64_t latency_overflow;  // Packets the latency probe could not queue
+    uint64_t hook_calls;        // In the interval
+    double hook_mean_us;
+    double hook_max_us;
+    uint64_t hook_timeouts;     // Since startup
+    double cpu_percent;         // Process CPU time over wall time, 100 = one core
+} PerfMonitorReading;
+
+/**
+ * Allocate the TLS slot; call once before any thread counts
+ */
+bool PerfMonitor_Initialize(void);
+
+void PerfMonitor_CountPacket(void);
+
+/**
+ * Count an engine tick
+ * @param start_us Platform time the tick started
+ */
+void PerfMonitor_CountTick(uint64_t start_us);
+
+/**
+ * Timestamp for PerfMonitor_HookLeave; call on entering the mouse hook
+ */
+int64_t PerfMonitor_HookEnter(void);
+
+void PerfMonitor_HookLeave(int64_t enter);
+
+/**
+ * Hook callback time past which a call counts as a timeout (LowLevelHooksTimeout)
+ */
+uint32_t PerfMonitor_GetHookTimeoutMs(void);
+
+/**
+ * Figures since this reader's previous read (since startup on the first)
+ * @param reader PERF_MONITOR_READER_*; one caller thread per reader
+ */
+void PerfMonitor_Read(int reader, PerfMonitorReading* reading);
+
+#endif // PERF_MONITOR_H
@@ -0,0 +1,118 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Platform interface for the portable stabilizer core.
+// The core never calls the OS directly: time, cursor reads, the monitor
+// layout and logging come through the callbacks below, and cursor writes
+// go through an OutputSink (output_sink.h). Every stabilizer instance
+// carries its own Platform pointer, so instances with different clocks or
+// hosts can run side by side. The Win32 host uses platform_win32.c; tests
+// and tools supply their own.
+
+// Log levels for debugging and output control
+typedef enum {
+    LOG_ERROR,      // Critical errors only
+    LOG_WARN,       // Warnings and errors
+    LOG_INFO,       // General information (default)
+    LOG_DEBUG,      // Detailed debugging information
+    LOG_TRACE       // Very detailed trace information
+} LogLevel;
+
+#define LOG_SITE_MAX_ARGS 16
+
+// One logging call site. The LOG_* macros give every call its own static
+// site, so a host can record the format once and afterwards only the raw
+// arguments (binary_log.h). The argument layout is parsed from the format
+// on first use and cached here; it only depends on the format.
+typedef struct {
+    LogLevel level;
+    const char* format;
+    volatile int32_t state;     // LogSiteState
+    uint8_t arg_count;
+    uint8_t arg_types[LOG_SITE_MAX_ARGS];   // BinaryLogArgType
+} LogSite;
+
+// Monitor rectangle in virtual-desktop pixels, right/bottom exclusive
+typedef struct {
+    int left, top, right, bottom;
+} ScreenRect;
+
+typedef struct {
+    void* context;              // Passed back to every callback
+
+    // Monotonic clock in microseconds since an arbitrary origin
+    uint64_t (*now_us)(void* context);
+
+    // Current OS cursor position; false if unavailable
+    bool (*get_cursor)(void* context, int* x, int* y);
+
+    // Fill up to max monitor rectangles, return how many were written
+    int (*query_monitors)(void* context, ScreenRect* monitors, int max);
+
+    // Write one formatted log line; filtering by level is up to the host
+    void (*log)(void* context, LogLevel level, const char* format, va_list args);
+
+    // Optional: log a call from a LogSite (args follow site->format); hosts
+    // without it get the same call through log
+    void (*log_site)(void* context, LogSite* site, va_list args);
+
+    // Optional: the host's current level. LOG_AT reads it before building the
+    // call, so filtered calls cost one load; NULL passes everything to the host
+    const volatile LogLevel* log_level;
+} Platform;
+
+// Wrappers that tolerate a NULL platform or callback: the clock reads 0,
+// the cursor is unknown, no monitors are reported and log lines are dropped
+uint64_t Platform_NowMicros(const Platform* platform);
+bool Platform_GetCursor(const Platform* platform, int* x, int* y);
+int Platform_QueryMonitors(const Platform* platform, ScreenRect* monitors, int max);
+void Platform_Log(const Platform* platform, LogLevel level, const char* format, ...);
+void Platform_LogSite(const Platform* platform, LogSite* site, const char* format, ...);
+
+/**
+ * Set the host's default platform
+ * Only used by the LOG_* macros in host code that has no instance at hand
+ * (Win32 UI, tools). The engine itself always logs through its instance.
+ */
+void Platform_SetDefault(const Platform* platform);
+const Platform* Platform_GetDefault(void);
+
+// Least severe level compiled in (0 = LOG_ERROR ... 4 = LOG_TRACE). Calls
+// below it are constant-false branches the optimizer removes, arguments
+// and all; the release build lowers it.
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 4
+#endif
+
+#define LOG_FORMAT_(format, ...) format
+
+/**
+ * Whether the platform's host keeps messages of this level
+ */
+static inline bool Platform_LogEnabled(const Platform* platform, LogLevel level) {
+    return platform && (!platform->log_level || level <= *platform->log_level);
+}
+
+/**
+ * Log through a platform from a static call site (format first in the arguments)
+ * Calls the host filters out at run time stop at an inline level check.
+ */
+#define LOG_AT(platform, level, ...) do { \
+    if ((int)(level) <= LOG_COMPILE_LEVEL && Platform_LogEnabled(platform, level)) { \
+        static LogSite log_site_ = {level, LOG_FORMAT_(__VA_ARGS__, 0), 0, 0, {0}}; \
+        Platform_LogSite(platform, &log_site_, __VA_ARGS__); \
+    } \
+} while (0)
+
+// Convenient logging macros for host code (default platform)
+#define LOG_ERROR(...) LOG_AT(Platform_GetDefault(), LOG_ERROR, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(Platform_GetDefault(), LOG_WARN, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(Platform_GetDefault(), LOG_INFO, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(Platform_GetDefault(), LOG_DEBUG, __VA_ARGS__)
+#define LOG_TRACE(...) LOG_AT(Platform_GetDefault(), LOG_TRACE, __VA_ARGS__)
+
+#endif // PLATFORM_H
@@ -0,0 +1,47 @@
+#ifndef PLATFORM_WIN32_H
+#define PLATFORM_WIN32_H
+
+#include <windows.h>
+#include <stdbool.h>
+
+// Win32 implementation of the core platform interface plus the OS cursor
+// writers for the output sink.
+
+typedef enum {
+    OUTPUT_MODE_SET_CURSOR_POS = 0,  // SetCursorPos (synchronous, not seen by hooks)
+    OUTPUT_MODE_SEND_INPUT = 1       // SendInput with absolute virtual-desk coordinates
+} OutputMode;
+
+#define DEFAULT_OUTPUT_MODE OUTPUT_MODE_SET_CURSOR_POS
+
+// dwExtraInfo tag on injected events, so our own hook and raw input skip them
+#define OUTPUT_SINK_EXTRA_INFO ((ULONG_PTR)0x4D534F55)  // 'MSOU'
+
+// Selected cursor writer (OutputMode ini key)
+extern OutputMode g_output_mode;
+
+// Host objects the app's stabilizer instances are bound to
+extern ScreenGeometry g_screen_geometry;   // Monitor layout, refreshed on WM_DISPLAYCHANGE
+extern OutputSink g_output_sink;           // The one OS cursor, shared by all device instances
+
+/**
+ * Win32 platform: QPC clock, GetCursorPos, monitor enumeration and the
+ * settings log file
+ */
+const Platform* PlatformWin32_Get(void);
+
+/**
+ * Make the Win32 platform the default for host-side LOG_* macros
+ */
+void PlatformWin32_Install(void);
+
+/**
+ * Select the Win32 writer for g_output_sink
+ */
+void PlatformWin32_SetOutputMode(OutputMode mode);
+
+// Output sink writers
+bool PlatformWin32_WriteSetCursorPos(void* context, int x, int y);
+bool PlatformWin32_WriteSendInput(void* context, int x, int y);
+
+#endif // PLATFORM_WIN32_H
@@ -0,0 +1,42 @@
+#ifndef SCREEN_GEOMETRY_H
+#define SCREEN_GEOMETRY_H
+
+#include <stdbool.h>
+
+#include "platform.h"
+
+// Cached multi-monitor layout for clamping the stabilizer target.
+// Refreshed on WM_DISPLAYCHANGE; clamping itself never calls into the OS
+// and never writes to the layout, so one cache can serve many instances.
+
+#define SCREEN_GEOMETRY_MAX_MONITORS 16
+
+typedef struct {
+    ScreenRect monitors[SCREEN_GEOMETRY_MAX_MONITORS];
+    int monitor_count;
+    ScreenRect bounds;          // Bounding box of all monitors (includes the gaps between them)
+} ScreenGeometry;
+
+/**
+ * Re-read the monitor layout from the platform
+ * Keeps the previous layout if the platform reports no monitors.
+ * @return true if at least one monitor was reported
+ */
+bool ScreenGeometry_Refresh(ScreenGeometry* geometry, const Platform* platform);
+
+/**
+ * Replace the cached layout with an explicit list of monitor rectangles
+ * @param count Number of rectangles (extra ones beyond the capacity are ignored)
+ */
+void ScreenGeometry_SetMonitors(ScreenGeometry* geometry, const ScreenRect* monitors, int count);
+
+/**
+ * Clamp a point onto the desktop
+ * Points inside a monitor are unchanged; points in a gap between monitors
+ * or outside the desktop move to the nearest pixel of the nearest monitor.
+ * @param hint Caller-owned index of the monitor that held the previous point,
+ *             checked first and updated (may be NULL)
+ */
+void ScreenGeometry_Clamp(const ScreenGeometry* geometry, int* hint, float* x, float* y);
+
+#endif // SCREEN_GEOMETRY_H
@@ -0,0 +1,39 @@
+#ifndef SHARED_TELEMETRY_H
+#define SHARED_TELEMETRY_H
+
+#include <windows.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Publishes the stabilizer to other processes through a named shared
+// memory section holding a TelemetryBlock (telemetry_block.h): target and
+// smoothed positions at full input rate, the current state, and a mailbox
+// through which a tool can change filter settings. Off unless the
+// SharedTelemetry ini key is set; the section lives in the session
+// namespace, so only processes of the same logon see it.
+//
+// Commands are applied on the message thread at the next engine tick and
+// are not saved to the ini file.
+
+// SharedTelemetry ini key
+extern bool g_shared_telemetry;
+
+/**
+ * Create and map the section
+ * @return false if it exists already (another instance) or cannot be created
+ */
+bool SharedTelemetry_Start(void);
+
+void SharedTelemetry_Stop(void);
+
+/**
+ * Publish the target after a raw input packet moved it
+ */
+void SharedTelemetry_OnPacket(const SmoothStabilizer* stabilizer, uint64_t time_us);
+
+/**
+ * Publish the output and state after an engine tick and apply a pending command
+ */
+void SharedTelemetry_OnTick(const SmoothStabilizer* stabilizer, uint64_t time_us);
+
+#endif // SHARED_TELEMETRY_H
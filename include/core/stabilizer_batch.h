@@ -0,0 +1,108 @@
+#ifndef STABILIZER_BATCH_H
+#define STABILIZER_BATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "stabilizer_core.h"
+#include "velocity_estimator.h"
+
+// Structure-of-arrays engine that advances many parameter sets on the
+// same input at once, for sweeps and batch replay.
+// All lanes share one target, one motion estimate and one engage state;
+// each lane has its own cursor position, parameters and delay timer. The
+// per-tick step runs 4/8/16 lanes per instruction with SSE2/AVX2/AVX-512,
+// picked at runtime, or a scalar loop elsewhere.
+//
+// Only normal (not drag-only) mode is modelled: in drag-only mode the
+// release point depends on each lane's own cursor, so lanes would stop
+// sharing their input.
+//
+// Accuracy: the easing is evaluated once per lane with
+// StabilizerCore_ApplyEasing and the step performs the scalar engine's
+// float operations in the same order, so every kernel produces identical
+// results when built without FP contraction (the default with -std=c99).
+// Against separate SmoothStabilizer instances, lanes stay within
+// STABILIZER_BATCH_TOLERANCE_PX: the shared motion estimate is expired on
+// every tick instead of only on ticks that move, which perturbs the speed
+// at rounding level. A speed sitting within that rounding of the 100 px/s
+// dual-mode threshold can still pick the other follow factor for a tick.
+
+// Lane capacity, a multiple of the widest vector
+#define STABILIZER_BATCH_MAX_LANES 1024
+#define STABILIZER_BATCH_TOLERANCE_PX 1e-3f
+
+typedef enum {
+    STABILIZER_BATCH_SCALAR,
+    STABILIZER_BATCH_SSE2,
+    STABILIZER_BATCH_AVX2,
+    STABILIZER_BATCH_AVX512
+} StabilizerBatchIsa;
+
+typedef struct {
+    int count;                      // Lanes in use
+    StabilizerBatchIsa isa;         // Kernel used by StabilizerBatch_UpdatePosition
+
+    // Shared input
+    bool engaged;
+    float target_x, target_y;
+    VelocityEstimator motion;
+
+    // Per-lane state and parameters (lanes past count are inert)
+    float current_x[STABILIZER_BATCH_MAX_LANES];
+    float current_y[STABILIZER_BATCH_MAX_LANES];
+    float min_distance[STABILIZER_BATCH_MAX_LANES];
+    float eased_slow[STABILIZER_BATCH_MAX_LANES];   // Eased follow factor
+    float eased_fast[STABILIZER_BATCH_MAX_LANES];   // Eased factor above the dual-mode speed
+    uint32_t delay_ms[STABILIZER_BATCH_MAX_LANES];
+    uint32_t start_ms[STABILIZER_BATCH_MAX_LANES];  // When the current movement started
+    int32_t moving[STABILIZER_BATCH_MAX_LANES];     // 0 or 1
+} StabilizerBatch;
+
+/**
+ * Best kernel this CPU supports
+ */
+StabilizerBatchIsa StabilizerBatch_DetectIsa(void);
+
+/**
+ * Check whether this CPU and build can run a kernel
+ */
+bool StabilizerBatch_IsaSupported(StabilizerBatchIsa isa);
+
+const char* StabilizerBatch_IsaName(StabilizerBatchIsa isa);
+
+/**
+ * Clear all lanes, park the shared cursor at (x, y) and pick the best kernel
+ * @param count Lanes to use, at most STABILIZER_BATCH_MAX_LANES
+ */
+void StabilizerBatch_Initialize(StabilizerBatch* batch, int count, float x, float y);
+
+/**
+ * Force a kernel, e.g. to compare them
+ * @return false if this CPU or build lacks it
+ */
+bool StabilizerBatch_SetIsa(StabilizerBatch* batch, StabilizerBatchIsa isa);
+
+/**
+ * Load a lane's parameters from an instance (follow strength, min distance,
+ * easing, dual mode and delay; drag-only is ignored)
+ */
+void StabilizerBatch_SetLane(StabilizerBatch* batch, int lane, const SmoothStabilizer* settings);
+
+/**
+ * Take over the cursor at (x, y) on every lane, like StabilizerCore engaging
+ */
+void StabilizerBatch_Engage(StabilizerBatch* batch, float x, float y);
+
+/**
+ * Move the shared target by a raw delta (the batch must be engaged)
+ */
+void StabilizerBatch_AddMouseDelta(StabilizerBatch* batch, float dx, float dy,
+                                   uint64_t timestamp_us);
+
+/**
+ * Advance every lane by one timer tick
+ */
+void StabilizerBatch_UpdatePosition(StabilizerBatch* batch, uint64_t now_us);
+
+#endif // STABILIZER_BATCH_H
@@ -1,15 +1,56 @@
 #ifndef STABILIZER_CORE_H
 #define STABILIZER_CORE_H
 
-#include <windows.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <math.h>
 
+#include "platform.h"
+#include "velocity_estimator.h"
+#include "screen_geometry.h"
+#include "output_sink.h"
+
 // Core stabilizer constants
 #define UPDATE_INTERVAL_MS 8
 #define DEFAULT_FOLLOW_STRENGTH 0.15f
 #define DEFAULT_MIN_DISTANCE 0.5f
 #define DEFAULT_DELAY_START_MS 150
+#define DEFAULT_DRAG_ONLY false
+#define DEFAULT_DRAG_BUTTON DRAG_BUTTON_LEFT
+#define STABILIZER_RELEASE_TICKS 4          // Update ticks from drag release to pass-through
+
+// Parameter ranges the settings file accepts, and the fixed-point units it stores them in
+#define STABILIZER_FOLLOW_STRENGTH_MIN 0.05f
+#define STABILIZER_FOLLOW_STRENGTH_MAX 1.0f
+#define STABILIZER_MIN_DISTANCE_MIN 0.1f
+#define STABILIZER_MIN_DISTANCE_MAX 5.0f
+#define STABILIZER_DELAY_START_MAX_MS 1000
+#define STABILIZER_INI_FOLLOW_SCALE 100     // FollowStrength in hundredths
+#define STABILIZER_INI_DISTANCE_SCALE 10    // MinDistance in tenths
+
+// Target pointer defaults
+#define DEFAULT_TARGET_SHOW_DISTANCE 5.0f
+#define DEFAULT_POINTER_TYPE POINTER_CIRCLE
+#define DEFAULT_TARGET_SIZE 8
+#define DEFAULT_TARGET_ALPHA 180
+#define DEFAULT_TARGET_COLOR 0x006464FFu    // COLORREF layout 0x00BBGGRR: RGB(255, 100, 100)
+#define DEFAULT_TARGET_ALWAYS_VISIBLE false
+#define DEFAULT_EXCLUDE_FROM_CAPTURE true
+#define DEFAULT_CAPTURE_COMPATIBILITY_MODE false
+
+// Button state bits tracked from the raw input stream
+#define STABILIZER_BUTTON_LEFT   0x01
+#define STABILIZER_BUTTON_RIGHT  0x02
+#define STABILIZER_BUTTON_MIDDLE 0x04
+#define STABILIZER_BUTTON_X1     0x08
+#define STABILIZER_BUTTON_X2     0x10
+
+// Engine state snapshots: "MSES" | u16 version | u16 reserved | u32 payload length | payload
+#define STABILIZER_STATE_MAGIC 0x5345534Du     // "MSES" read as a little-endian u32
+#define STABILIZER_STATE_VERSION 2
+#define STABILIZER_STATE_HEADER_SIZE 12
+#define STABILIZER_STATE_MAX_SIZE (STABILIZER_STATE_HEADER_SIZE + 256 + VELOCITY_RING_CAPACITY * 16)
 
 // Easing types for smooth movement
 typedef enum {
@@ -25,6 +66,14 @@ typedef enum {
     POINTER_CROSS
 } PointerType;
 
+// Button that engages smoothing in drag-only mode
+typedef enum {
+    DRAG_BUTTON_LEFT,
+    DRAG_BUTTON_RIGHT,
+    DRAG_BUTTON_MIDDLE,
+    DRAG_BUTTON_ANY
+} DragButton;
+
 // 2D position structure
 typedef struct {
     float x, y;
@@ -41,19 +90,32 @@ typedef struct {
     bool enabled;               // Whether stabilizer is active
     
     // Movement tracking
-    float velocity;             // Current movement velocity
-    DWORD last_update_time;     // Last velocity calculation time
-    DWORD movement_start_time;  // When current movement started
+    float velocity;             // Current speed in px/s (mirrors motion.speed)
+    VelocityEstimator motion;   // Windowed regression over timestamped target samples
+    uint32_t movement_start_time;  // When current movement started (ms)
     bool first_update;          // First update flag
     bool is_moving;             // Currently in motion
     
+    // Button-aware smoothing
+    bool drag_only;             // Only smooth while drag_button is held
+    DragButton drag_button;     // Button that engages smoothing in drag-only mode
+    unsigned int buttons_down;  // Currently held buttons (STABILIZER_BUTTON_* bits)
+    bool engaged;               // Engine currently owns the cursor (swallows OS moves)
+    uint32_t release_ticks;     // Ticks left to catch up after the drag button went up
+    
+    // Host bindings: the only way an instance reaches anything outside itself
+    const Platform* platform;       // Clock, cursor reads and logging
+    const ScreenGeometry* geometry; // Monitor layout for clamping (read-only, may be shared)
+    OutputSink* output;             // Where cursor moves go
+    int monitor_hint;               // Monitor that held the previous target (clamp fast path)
+    
     // Delay and visual feedback
-    DWORD delay_start_ms;       // Delay before following starts
+    uint32_t delay_start_ms;    // Delay before following starts
     float target_show_distance; // Distance threshold for showing target pointer
     PointerType pointer_type;   // Target pointer type (circle or cross)
     int target_size;            // Target pointer size
     int target_alpha;           // Target pointer transparency
-    COLORREF target_color;      // Target pointer color
+    uint32_t target_color;      // Target pointer color (COLORREF layout)
     bool target_always_visible; // Always show target pointer (disable auto-hide)
     
     // Screen capture exclusion settings
@@ -61,18 +123,110 @@ typedef struct {
     bool capture_compatibility_mode; // Use compatibility mode for older capture software
 } SmoothStabilizer;
 
-// Global stabilizer instance
-extern SmoothStabilizer g_stabilizer;
+/**
+ * Set defaults and bind an instance to its host
+ * The engine keeps no state of its own: everything lives in the instance
+ * and the objects passed here. Instances that share a geometry or an
+ * output sink must be driven from one thread; otherwise any number of
+ * instances can run side by side.
+ * @param platform Clock, cursor and log callbacks (NULL runs headless)
+ * @param geometry Monitor layout for clamping (NULL disables clamping)
+ * @param output Cursor sink for this instance
+ */
+void StabilizerCore_Initialize(SmoothStabilizer* stabilizer, const Platform* platform,
+                               const ScreenGeometry* geometry, OutputSink* output);
 
 // Core stabilizer functions
-void StabilizerCore_Initialize(SmoothStabilizer* stabilizer);
 void StabilizerCore_UpdatePosition(SmoothStabilizer* stabilizer);
 void StabilizerCore_SetTargetPosition(SmoothStabilizer* stabilizer, float x, float y);
-void StabilizerCore_AddMouseDelta(SmoothStabilizer* stabilizer, float dx, float dy);
+
+/**
+ * Process a raw movement delta
+ * @param timestamp_us Packet arrival time on the instance's platform clock
+ */
+void StabilizerCore_AddMouseDelta(SmoothStabilizer* stabilizer, float dx, float dy,
+                                  uint64_t timestamp_us);
+
+/**
+ * Update held-button state from the input stream
+ * Engages smoothing immediately when the drag button goes down. After the
+ * release the cursor keeps catching up for at most STABILIZER_RELEASE_TICKS
+ * update ticks, then StabilizerCore_UpdatePosition puts it on the target and
+ * hands it back to the OS, so moves after the release pass through raw.
+ * @param pressed Buttons that went down (STABILIZER_BUTTON_* bits)
+ * @param released Buttons that went up (STABILIZER_BUTTON_* bits)
+ */
+void StabilizerCore_UpdateButtons(SmoothStabilizer* stabilizer, unsigned int pressed,
+                                  unsigned int released);
+
+/**
+ * Update held-button state of an instance that does not drive the cursor
+ * Never engages, so the state is right when the instance takes over later.
+ */
+void StabilizerCore_TrackButtons(SmoothStabilizer* stabilizer, unsigned int pressed,
+                                 unsigned int released);
+
+/**
+ * Check whether the engine currently drives the cursor
+ * @return false while the cursor should pass through unmodified
+ */
+bool StabilizerCore_IsEngaged(const SmoothStabilizer* stabilizer);
+
+/**
+ * Check whether the instance is mid-stroke (button held or cursor still catching up)
+ * A busy instance keeps cursor ownership when another device starts moving.
+ */
+bool StabilizerCore_IsBusy(const SmoothStabilizer* stabilizer);
+
+/**
+ * Copy user-configurable parameters, leaving motion state and host bindings untouched
+ */
+void StabilizerCore_CopySettings(SmoothStabilizer* dst, const SmoothStabilizer* src);
+
+/**
+ * Clamp user-configurable parameters to the ranges the settings file accepts
+ * Unknown ease types and drag buttons fall back to their defaults.
+ */
+void StabilizerCore_ClampSettings(SmoothStabilizer* stabilizer);
+
+/**
+ * Round follow strength and min distance to the settings file's units, then clamp
+ * A snapped instance loads back from the file unchanged.
+ */
+void StabilizerCore_SnapSettings(SmoothStabilizer* stabilizer);
+
+/**
+ * Continue from where another instance left the cursor
+ * Used when cursor ownership moves between devices; the previous owner is
+ * disengaged so it re-syncs if it takes the cursor back later.
+ */
+void StabilizerCore_TakeOver(SmoothStabilizer* stabilizer, SmoothStabilizer* previous);
+
+/**
+ * Serialize the full engine state: settings, motion and filter history
+ * Host bindings are not part of the snapshot. The format is versioned and
+ * byte-order independent; restoring into an instance bound to a host that
+ * reports the same clock continues bit for bit where the snapshot left off.
+ * @param capacity At least STABILIZER_STATE_MAX_SIZE bytes always suffices
+ * @return Bytes written, 0 if out is too small
+ */
+size_t StabilizerCore_SaveState(const SmoothStabilizer* stabilizer, uint8_t* out, size_t capacity);
+
+/**
+ * Load a snapshot from StabilizerCore_SaveState, keeping the instance's host bindings
+ * @return false (instance unchanged) if the data is truncated, malformed or of another version
+ */
+bool StabilizerCore_RestoreState(SmoothStabilizer* stabilizer, const uint8_t* data, size_t length);
 
 // Utility functions
 float StabilizerCore_ApplyEasing(float t, EaseType ease_type);
 float StabilizerCore_CalculateDistance(MousePos a, MousePos b);
-float StabilizerCore_CalculateVelocity(SmoothStabilizer* stabilizer, MousePos new_target);
+
+/**
+ * High-resolution monotonic time used for motion estimation
+ * Reads the instance's platform clock.
+ * @return Microseconds since an arbitrary origin
+ */
+uint64_t StabilizerCore_GetTimeMicros(const SmoothStabilizer* stabilizer);
 
 #endif // STABILIZER_CORE_H
\ No newline at end of file
@@ -0,0 +1,195 @@
+#ifndef TELEMETRY_BLOCK_H
+#define TELEMETRY_BLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Layout and lock-free protocol of the shared telemetry block: a fixed
+// structure placed in shared memory by the stabilizer (the only writer)
+// and mapped read-mostly by external tools. Three areas, each on its own
+// cache lines:
+//
+//   state    Latest positions, target speed and acceleration, engine flags
+//            and filter settings behind a
+//            seqlock: the writer makes the sequence odd, updates, makes
+//            it even; a reader retries while it is odd or changed under it.
+//   ring     One sample per input packet and per engine tick. Every slot
+//            carries its own sequence, so a reader that falls behind
+//            detects overwritten slots and counts them as lost instead of
+//            returning torn samples.
+//   command  A one-slot mailbox for changing settings. The client fills
+//            the fields and bumps request; the writer applies the command
+//            on its next tick and echoes the ticket in completed with a
+//            status. One controlling client at a time.
+//
+// Readers never write to the state or the ring, so any number of them can
+// poll at full input rate without a system call per sample. The header
+// carries the version and the offset of every area; a reader accepts a
+// block only if magic and version match. All fields are little-endian and
+// naturally aligned. Uses the GCC/Clang __atomic builtins.
+
+#define TELEMETRY_MAGIC "MSTL"
+#define TELEMETRY_VERSION 2
+#define TELEMETRY_RING_CAPACITY 4096       // Samples; a power of two, about 0.5 s at 8 kHz
+#define TELEMETRY_READ_ATTEMPTS 64         // Seqlock retries before a read gives up
+
+// Where the block is published: the app's Win32 section (session-local)
+// and the POSIX shared memory object the test tool uses elsewhere
+#define TELEMETRY_SECTION_NAME "Local\\MouseStabilizerTelemetry"
+#define TELEMETRY_SHM_NAME "/mouse_stabilizer_telemetry"
+
+// TelemetryState.flags and TelemetrySample.flags
+#define TELEMETRY_FLAG_ENABLED 0x01
+#define TELEMETRY_FLAG_ENGAGED 0x02
+#define TELEMETRY_FLAG_DRAG_ONLY 0x04
+#define TELEMETRY_FLAG_DUAL 0x08
+
+typedef enum {
+    TELEMETRY_SAMPLE_PACKET = 1,    // Target after a raw input packet
+    TELEMETRY_SAMPLE_TICK = 2       // Output after an engine tick
+} TelemetrySampleKind;
+
+typedef enum {
+    TELEMETRY_COMMAND_NONE = 0,
+    TELEMETRY_COMMAND_SET_ENABLED,      // value: 0 or 1
+    TELEMETRY_COMMAND_SET_FOLLOW,       // value: 0.05 - 1.0
+    TELEMETRY_COMMAND_SET_MIN_DISTANCE, // value: 0.1 - 5.0 px
+    TELEMETRY_COMMAND_SET_EASE,         // value: EaseType
+    TELEMETRY_COMMAND_SET_DELAY_MS,     // value: 0 - 1000
+    TELEMETRY_COMMAND_SET_DUAL          // value: 0 or 1
+} TelemetryCommandType;
+
+typedef enum {
+    TELEMETRY_STATUS_OK = 0,
+    TELEMETRY_STATUS_UNKNOWN_COMMAND,
+    TELEMETRY_STATUS_OUT_OF_RANGE
+} TelemetryCommandStatus;
+
+typedef struct {
+    char magic[4];              // TELEMETRY_MAGIC
+    uint16_t version;           // TELEMETRY_VERSION
+    uint16_t header_size;       // sizeof(TelemetryHeader)
+    uint32_t size;              // Whole block
+    uint32_t ring_capacity;
+    uint32_t state_offset;      // Of state_sequence; the state follows on the next cache line
+    uint32_t ring_offset;       // Of ring_head; the slots follow on the next cache line
+    uint32_t command_offset;
+    uint32_t writer_process_id;
+    uint64_t started_us;        // Writer's clock when the block was created
+    uint8_t reserved[24];
+} TelemetryHeader;
+
+typedef struct {
+    uint64_t time_us;           // Writer's clock
+    float target_x, target_y;   // Desktop pixels
+    float output_x, output_y;
+    uint32_t flags;             // TELEMETRY_FLAG_*
+    uint32_t buttons;           // STABILIZER_BUTTON_* held
+    float follow_strength;
+    float min_distance;
+    uint32_t ease_type;
+    uint32_t delay_start_ms;
+    uint64_t packets;           // Totals since the block was created
+    uint64_t ticks;
+    float speed;                // Target speed from the motion estimate, px/s
+    float acceleration;         // Magnitude of the target acceleration, px/s^2
+    uint8_t reserved[56];
+} TelemetryState;
+
+typedef struct {
+    uint64_t time_us;
+    float target_x, target_y;
+    float output_x, output_y;
+    uint32_t sequence;          // Ring index + 1 once written; 0 while being written
+    uint8_t kind;               // TelemetrySampleKind
+    uint8_t flags;              // TELEMETRY_FLAG_*
+    uint16_t buttons;
+} TelemetrySample;
+
+typedef struct {
+    uint32_t request;           // Ticket of the latest command (client)
+    uint32_t command;           // TelemetryCommandType (client)
+    float value;                // Argument (client)
+    uint32_t completed;         // Ticket last handled (writer)
+    uint32_t status;            // TelemetryCommandStatus of that ticket (writer)
+    uint8_t reserved[44];
+} TelemetryCommandArea;
+
+typedef struct {
+    TelemetryHeader header;
+    uint32_t state_sequence;    // Odd while the writer updates the state
+    uint8_t state_pad[60];
+    TelemetryState state;
+    uint64_t ring_head;         // Samples ever written
+    uint8_t ring_pad[56];
+    TelemetrySample ring[TELEMETRY_RING_CAPACITY];
+    TelemetryCommandArea command;
+} TelemetryBlock;
+
+/**
+ * Set up a block for writing; clears state, ring and mailbox
+ */
+void TelemetryBlock_Initialize(TelemetryBlock* block, uint32_t process_id, uint64_t now_us);
+
+/**
+ * Check a mapped block before reading it
+ * @return The block, or NULL if it is too small or of another layout
+ */
+TelemetryBlock* TelemetryBlock_Open(void* memory, size_t size);
+
+/**
+ * Replace the current state (writer only)
+ */
+void TelemetryBlock_PublishState(TelemetryBlock* block, const TelemetryState* state);
+
+/**
+ * Copy a consistent current state
+ * @return false if the writer kept it busy for TELEMETRY_READ_ATTEMPTS tries
+ */
+bool TelemetryBlock_ReadState(const TelemetryBlock* block, TelemetryState* state);
+
+/**
+ * Append a sample, overwriting the oldest (writer only); sequence is filled in
+ */
+void TelemetryBlock_PushSample(TelemetryBlock* block, const TelemetrySample* sample);
+
+/**
+ * Copy the samples written since *cursor, oldest first
+ * Start with *cursor = 0 for everything still in the ring, or ring_head
+ * for new samples only.
+ * @param lost Optional; incremented by samples overwritten before they were read
+ * @return Samples copied; *cursor moves past them
+ */
+size_t TelemetryBlock_ReadSamples(const TelemetryBlock* block, uint64_t* cursor,
+                                  TelemetrySample* samples, size_t capacity, uint64_t* lost);
+
+/**
+ * Post a command (client)
+ * @param ticket Receives the ticket to poll for
+ * @return false if the previous command has not been handled yet
+ */
+bool TelemetryBlock_SendCommand(TelemetryBlock* block, TelemetryCommandType command, float value,
+                                uint32_t* ticket);
+
+/**
+ * Status of a posted command (client)
+ * @return false while the writer has not handled the ticket
+ */
+bool TelemetryBlock_PollCommand(const TelemetryBlock* block, uint32_t ticket,
+                                TelemetryCommandStatus* status);
+
+/**
+ * Fetch a pending command (writer)
+ * @return false if there is none
+ */
+bool TelemetryBlock_TakeCommand(TelemetryBlock* block, TelemetryCommandType* command, float* value,
+                                uint32_t* ticket);
+
+/**
+ * Report the outcome of a command taken with TelemetryBlock_TakeCommand (writer)
+ */
+void TelemetryBlock_CompleteCommand(TelemetryBlock* block, uint32_t ticket,
+                                    TelemetryCommandStatus status);
+
+#endif // TELEMETRY_BLOCK_H
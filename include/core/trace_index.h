@@ -0,0 +1,125 @@
+#ifndef TRACE_INDEX_H
+#define TRACE_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trace_replay.h"
+
+// Seek index for an input trace (.msidx), written next to the .mstrace.
+// Built by one replay of the trace; afterwards a replay can start at any
+// time by resuming from the nearest earlier checkpoint instead of from the
+// first packet, with exactly the results of a full replay. Checkpoints
+// depend on the engine settings and replay options, so the index carries
+// them and a seek always replays with them.
+//
+// Header:  "MSIX" | u16 version | u16 header size | u64 trace length
+//          | u64 trace fingerprint | u32 checkpoint interval (ms)
+//          | u32 tick interval (us) | u32 timer resolution (us) | u32 tail (ms)
+//          | u8 has start | f32 start x | f32 start y | u32 settings length
+//          | settings (StabilizerCore_SaveState snapshot)
+// Record:  u8 TraceIndexEntryType | u32 payload length | payload
+//   CHECKPOINT  TraceReplayCheckpoint fields, little-endian, engine snapshot last
+//   STROKE      u64 start (us) | u64 end (us): one engaged stretch
+// All integers are little-endian.
+
+#define TRACE_INDEX_MAGIC "MSIX"
+#define TRACE_INDEX_VERSION 1
+#define TRACE_INDEX_HEADER_SIZE 53
+#define TRACE_INDEX_DEFAULT_INTERVAL_MS 10000
+#define TRACE_INDEX_MAX_RECORD_SIZE (5 + 160 + STABILIZER_STATE_MAX_SIZE)
+
+typedef enum {
+    TRACE_INDEX_CHECKPOINT = 1,
+    TRACE_INDEX_STROKE = 2
+} TraceIndexEntryType;
+
+// One index record; checkpoint payloads are decoded on demand
+typedef struct {
+    TraceIndexEntryType type;
+    uint64_t time_us;           // CHECKPOINT: virtual clock; STROKE: engage time
+    uint64_t end_us;            // STROKE: release time
+    const uint8_t* payload;
+    uint32_t payload_length;
+} TraceIndexEntry;
+
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    size_t offset;              // Next record
+    size_t first_record;
+    uint16_t version;
+    uint64_t trace_length;
+    uint64_t trace_fingerprint;
+    uint32_t interval_ms;
+    TraceReplayOptions options; // Replay options the checkpoints were taken with
+    const uint8_t* settings;    // Engine snapshot the replay started from
+    uint32_t settings_length;
+    bool corrupt;
+} TraceIndexReader;
+
+typedef struct {
+    uint64_t checkpoints;
+    uint64_t strokes;
+    uint64_t bytes;
+} TraceIndexSummary;
+
+/**
+ * Receives the index as it is built; return false to abort
+ */
+typedef bool (*TraceIndexWriteFn)(void* context, const uint8_t* data, size_t length);
+
+/**
+ * Identify a trace by its length and sampled content
+ */
+uint64_t TraceIndex_Fingerprint(const void* trace, size_t length);
+
+/**
+ * Replay a whole trace and stream its index
+ * @param settings Engine parameters (NULL for defaults)
+ * @param options NULL for TraceReplay_DefaultOptions
+ * @param interval_ms Virtual time between checkpoints (0 = TRACE_INDEX_DEFAULT_INTERVAL_MS)
+ * @param summary Optional counts
+ * @return false if the trace is unreadable or write failed
+ */
+bool TraceIndex_Build(const void* trace, size_t length, const SmoothStabilizer* settings,
+                      const TraceReplayOptions* options, uint32_t interval_ms,
+                      TraceIndexWriteFn write, void* context, TraceIndexSummary* summary);
+
+/**
+ * Validate the header and position the reader on the first record
+ * @return false if the header is missing, truncated or of an unknown version
+ */
+bool TraceIndex_Open(TraceIndexReader* index, const void* data, size_t length);
+
+/**
+ * Check that an index was built from this trace
+ */
+bool TraceIndex_Matches(const TraceIndexReader* index, const void* trace, size_t length);
+
+/**
+ * Read the next record
+ * @return false at the end or on a malformed record (index->corrupt)
+ */
+bool TraceIndex_Next(TraceIndexReader* index, TraceIndexEntry* entry);
+
+/**
+ * Decode a CHECKPOINT record
+ */
+bool TraceIndex_LoadCheckpoint(const TraceIndexEntry* entry, TraceReplayCheckpoint* checkpoint);
+
+/**
+ * Open a replay positioned at a point in time
+ * Resumes from the latest checkpoint at or before time_us (or from the
+ * start of the trace) and replays silently up to the first record at or
+ * after time_us; ticks due before that record still report, so the first
+ * outputs can lie just before time_us. Uses the settings and options
+ * stored in the index.
+ * @param output Trajectory callback for the rest of the replay, may be NULL
+ * @return false if the index does not belong to the trace or cannot be read
+ */
+bool TraceIndex_Seek(const TraceIndexReader* index, TraceReplay* replay, const void* trace,
+                     size_t length, uint64_t time_us, TraceReplayOutputFn output, void* context);
+
+#endif // TRACE_INDEX_H
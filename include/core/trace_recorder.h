@@ -0,0 +1,93 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <windows.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Records raw input packets and engine output to a .mstrace file
+// (input_trace.h) next to the executable. Records are encoded on the input
+// thread into one half of a preallocated double buffer; a background thread
+// writes full halves to disk. If the writer falls behind, packets are
+// dropped and a GAP record marks the spot instead of stalling input.
+//
+// The same packets, outputs and update ticks always feed an in-memory
+// flight recorder (flight_recorder.h), whatever the recording state, so
+// the last FLIGHT_RECORDER_DEFAULT_WINDOW_MS of input can be saved after
+// something odd happened (Ctrl+Alt+D, tray menu).
+
+#define TRACE_RECORDER_BUFFER_SIZE (256 * 1024)  // Per half, about 8s at 8 kHz
+
+typedef struct {
+    uint64_t packets;           // PACKET records encoded
+    uint64_t outputs;           // OUTPUT records encoded
+    uint64_t bytes;             // Trace bytes encoded, header included
+    uint64_t dropped;           // Packets lost because both buffers were full
+    uint64_t write_errors;      // Failed disk writes
+} TraceRecorderStats;
+
+/**
+ * Open a new trace file and start the writer thread
+ * @return false if already recording or the file/thread could not be created
+ */
+bool TraceRecorder_Start(void);
+
+/**
+ * Flush everything encoded so far, stop the writer thread and close the file
+ */
+void TraceRecorder_Stop(void);
+
+/**
+ * Start or stop recording (tray menu, Debug tab)
+ */
+void TraceRecorder_Toggle(void);
+
+bool TraceRecorder_IsRecording(void);
+
+/**
+ * Record one raw input packet
+ * @param time_us Arrival time on the platform clock
+ * @param pressed STABILIZER_BUTTON_* bits pressed in this packet
+ * @param released STABILIZER_BUTTON_* bits released in this packet
+ */
+void TraceRecorder_RecordPacket(uint64_t time_us, HANDLE device, LONG dx, LONG dy,
+                                unsigned int pressed, unsigned int released);
+
+/**
+ * Record the engine position after an update tick; unchanged positions are skipped
+ */
+void TraceRecorder_RecordOutput(const SmoothStabilizer* stabilizer);
+
+/**
+ * Record the end of an update tick for the flight recorder
+ * @param start_us Platform time the tick started
+ */
+void TraceRecorder_RecordTick(const SmoothStabilizer* stabilizer, uint64_t start_us);
+
+/**
+ * Write the flight recorder window as mouse_stabilizer_flight_<time>.mstrace
+ * plus the tick timing as _ticks.csv, and log a replay command line
+ * The ring is copied here; a background thread writes the files and logs
+ * the result, so the caller never waits for the disk.
+ * @return false if the dump could not be started, e.g. while the previous one is still writing
+ */
+bool TraceRecorder_DumpFlight(void);
+
+/**
+ * Wait for a flight recording dump in progress to finish (shutdown)
+ */
+void TraceRecorder_WaitForFlight(void);
+
+/**
+ * Last flight recording path; empty before the first dump
+ */
+const char* TraceRecorder_GetFlightPath(void);
+
+/**
+ * Current or last trace file path; empty before the first recording
+ */
+const char* TraceRecorder_GetPath(void);
+
+void TraceRecorder_GetStats(TraceRecorderStats* stats);
+
+#endif // TRACE_RECORDER_H
@@ -0,0 +1,161 @@
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "platform.h"
+#include "output_sink.h"
+#include "stabilizer_core.h"
+#include "stabilizer_batch.h"
+#include "input_trace.h"
+
+// Offline replay of an input trace through the engine.
+// A virtual clock jumps from packet to packet and through simulated timer
+// ticks, so a trace replays as fast as it decodes, with the same results
+// on every machine. The trace is read in place (e.g. from a file mapping)
+// and the replay keeps no per-packet state, so trace size is unbounded.
+// Packets from all devices feed one instance (the "merge all" policy) and
+// no monitor layout is applied, since traces do not record one.
+
+#define TRACE_REPLAY_WINDOWS_TIMER_US 15625  // Default Windows timer granularity (64 Hz)
+#define TRACE_REPLAY_DEFAULT_TAIL_MS 1000     // Ticks simulated after the last packet
+
+typedef struct {
+    uint32_t tick_interval_us;      // Requested timer period (0 = UPDATE_INTERVAL_MS)
+    uint32_t timer_resolution_us;   // Round the period up to this, like SetTimer (0 = exact)
+    uint32_t tail_ms;               // Keep ticking this long after the last packet
+    bool has_start;                 // Use start_x/start_y instead of the first recorded output
+    float start_x, start_y;         // Cursor position when the trace starts
+} TraceReplayOptions;
+
+/**
+ * Receives the engine position after every tick that moved it
+ */
+typedef void (*TraceReplayOutputFn)(void* context, uint64_t time_us, float x, float y);
+
+/**
+ * Receives the instance after every simulated tick, moved or not
+ */
+typedef void (*TraceReplayTickFn)(void* context, uint64_t time_us,
+                                  const SmoothStabilizer* stabilizer);
+
+/**
+ * Receives the batch after every simulated tick
+ */
+typedef void (*TraceReplayBatchTickFn)(void* context, uint64_t time_us,
+                                       const StabilizerBatch* batch);
+
+typedef struct {
+    uint64_t packets;               // PACKET records fed to the engine
+    uint64_t ticks;                 // Simulated timer ticks
+    uint64_t outputs;               // Ticks that moved the engine position
+    uint64_t recorded_outputs;      // OUTPUT records in the trace (not replayed)
+    uint64_t dropped;               // Packets the recorder reported lost
+    uint64_t first_us, last_us;     // Virtual time span covered
+} TraceReplayStats;
+
+// Everything needed to continue a replay from between two trace records
+typedef struct {
+    uint64_t offset;                // Next record in the trace
+    InputTraceState trace_state;    // Decoder delta state at offset
+    uint64_t now_us;                // Virtual clock
+    uint64_t next_tick_us;
+    int32_t cursor_x, cursor_y;     // Virtual OS cursor
+    float last_x, last_y;           // Last reported output
+    TraceReplayStats stats;
+    uint32_t engine_length;
+    uint8_t engine[STABILIZER_STATE_MAX_SIZE];  // StabilizerCore_SaveState snapshot
+} TraceReplayCheckpoint;
+
+typedef struct {
+    InputTraceReader reader;
+    SmoothStabilizer stabilizer;
+
+    // Virtual host
+    Platform platform;
+    OutputSink sink;
+    uint64_t now_us;
+    int cursor_x, cursor_y;
+
+    uint32_t tick_period_us;        // Effective timer period after quantization
+    uint64_t next_tick_us;
+    uint64_t tail_us;
+    bool finished;
+
+    TraceReplayOutputFn output;
+    void* output_context;
+    float last_x, last_y;
+
+    // Optional per-tick hook for scoring; set after TraceReplay_Open
+    TraceReplayTickFn on_tick;
+    void* tick_context;
+
+    TraceReplayStats stats;
+} TraceReplay;
+
+/**
+ * Default options: UPDATE_INTERVAL_MS ticks, exact timer, 1s tail
+ */
+void TraceReplay_DefaultOptions(TraceReplayOptions* options);
+
+/**
+ * Effective timer period for a requested interval and timer granularity
+ */
+uint32_t TraceReplay_TickPeriod(uint32_t interval_us, uint32_t resolution_us);
+
+/**
+ * Prepare a replay over a trace held in memory
+ * @param settings Engine parameters to replay with (copied; bindings ignored)
+ * @param options NULL for TraceReplay_DefaultOptions
+ * @param output Trajectory callback, may be NULL
+ * @return false if the data is not a readable trace
+ */
+bool TraceReplay_Open(TraceReplay* replay, const void* data, size_t length,
+                      const SmoothStabilizer* settings, const TraceReplayOptions* options,
+                      TraceReplayOutputFn output, void* context);
+
+/**
+ * Replay up to max_records more trace records, then the tail once the trace ends
+ * @return true while there is more to replay
+ */
+bool TraceReplay_Step(TraceReplay* replay, size_t max_records);
+
+/**
+ * Byte offset of the next unread record, for releasing consumed input
+ */
+size_t TraceReplay_Offset(const TraceReplay* replay);
+
+/**
+ * Capture the replay between two TraceReplay_Step calls
+ * @return false if the engine state did not fit (cannot happen with the current format)
+ */
+bool TraceReplay_SaveCheckpoint(const TraceReplay* replay, TraceReplayCheckpoint* checkpoint);
+
+/**
+ * Continue a replay from a checkpoint of the same trace
+ * Stepping on from here gives exactly what the original replay gave after
+ * the checkpoint, as long as the options match the ones it ran with.
+ * Engine settings come from the checkpoint.
+ * @param options NULL for TraceReplay_DefaultOptions
+ * @return false if the data is not a readable trace or the checkpoint does not fit it
+ */
+bool TraceReplay_Resume(TraceReplay* replay, const void* data, size_t length,
+                        const TraceReplayOptions* options, const TraceReplayCheckpoint* checkpoint,
+                        TraceReplayOutputFn output, void* context);
+
+/**
+ * Replay a whole trace through every lane of a batch
+ * Follows the same clock, engage and pass-through rules as TraceReplay_Step,
+ * so each lane tracks a TraceReplay with that lane's settings.
+ * @param batch Lanes loaded after StabilizerBatch_Initialize, not yet engaged
+ * @param options NULL for TraceReplay_DefaultOptions
+ * @param stats Optional totals (outputs are not counted)
+ * @return false if the data is not a readable trace
+ */
+bool TraceReplay_RunBatch(const void* data, size_t length, StabilizerBatch* batch,
+                          const TraceReplayOptions* options, TraceReplayBatchTickFn on_tick,
+                          void* context, TraceReplayStats* stats);
+
+#endif // TRACE_REPLAY_H
@@ -0,0 +1,64 @@
+#ifndef TRAJECTORY_METRICS_H
+#define TRAJECTORY_METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Streaming quality scores for a smoothed trajectory.
+// Fed once per engine tick with the raw target and the smoothed output;
+// O(1) per sample with no buffers, so sweeps can score thousands of
+// parameter sets side by side. Accumulators from several traces merge.
+//
+//   lag        distance from output to target (px)
+//   jitter     RMS of the output's second difference, i.e. the
+//              high-frequency part of the path (px per tick^2)
+//   overshoot  how far the output ran past the target, measured along
+//              the step it just took (px)
+
+typedef struct {
+    uint64_t samples;
+    double lag_sum;
+    double lag_max;
+    double jitter_sq_sum;
+    uint64_t jitter_samples;
+    double overshoot_sum;
+    double overshoot_max;
+    uint64_t overshoot_events;
+
+    // History for the difference terms
+    int history;                // Valid entries in prev/prev2 (0-2)
+    float prev_x, prev_y;       // Output one tick back
+    float prev2_x, prev2_y;     // Output two ticks back
+} TrajectoryMetrics;
+
+typedef struct {
+    uint64_t samples;
+    double mean_lag_px;
+    double max_lag_px;
+    double rms_jitter_px;
+    double mean_overshoot_px;   // Per overshoot event
+    double max_overshoot_px;
+    uint64_t overshoot_events;
+} TrajectoryScore;
+
+void TrajectoryMetrics_Reset(TrajectoryMetrics* metrics);
+
+/**
+ * Add one tick of target and output position
+ */
+void TrajectoryMetrics_AddSample(TrajectoryMetrics* metrics, float target_x, float target_y,
+                                 float output_x, float output_y);
+
+/**
+ * Break the difference history, e.g. between strokes or traces
+ */
+void TrajectoryMetrics_Break(TrajectoryMetrics* metrics);
+
+/**
+ * Add another accumulator's totals (history is not merged)
+ */
+void TrajectoryMetrics_Merge(TrajectoryMetrics* metrics, const TrajectoryMetrics* other);
+
+void TrajectoryMetrics_GetScore(const TrajectoryMetrics* metrics, TrajectoryScore* score);
+
+#endif // TRAJECTORY_METRICS_H
@@ -0,0 +1,83 @@
+#ifndef TRAJECTORY_REPORT_H
+#define TRAJECTORY_REPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Offline quality report for a smoothed trajectory.
+// Takes the whole run of per-tick (target, output) samples, e.g. from a
+// trace replay, and computes the figures behind a parameter preset:
+//
+//   lag        distance to the target (px) and how long ago the target
+//              was where the output is now (ms)
+//   jitter     RMS of the output after a high-pass filter (px), plus its
+//              power spectrum (Welch average of Hann-windowed FFTs)
+//   overshoot  how far the output runs past the target's turning point
+//              when the target reverses direction along an axis (px)
+//   corners    how close the output comes to the target's sharp turns (px)
+//
+// Samples with engaged == false split the input into independent runs;
+// filters, searches and FFT segments never cross a split. Percentiles
+// come from fixed-width histograms, so no scratch memory is needed.
+
+#define TRAJECTORY_FFT_SIZE 256
+#define TRAJECTORY_SPECTRUM_BINS (TRAJECTORY_FFT_SIZE / 2 + 1)
+
+// One engine tick
+typedef struct {
+    uint64_t time_us;
+    float target_x, target_y;
+    float output_x, output_y;
+    bool engaged;               // Engine drove the cursor on this tick
+} TrajectorySample;
+
+typedef struct {
+    float highpass_hz;          // Jitter high-pass cutoff
+    float max_lag_ms;           // Search window for time lag, overshoot and corners
+    float reversal_px;          // Target must swing back this far to count as a reversal
+    float corner_angle_deg;     // Minimum turn for a corner
+    float corner_chord_px;      // Path length on each side used to measure a turn
+} TrajectoryReportOptions;
+
+typedef struct {
+    uint64_t samples;           // Engaged samples analysed
+    double sample_rate_hz;
+
+    double mean_lag_px, p95_lag_px, max_lag_px;
+    double mean_lag_ms, p95_lag_ms, max_lag_ms;
+
+    double rms_jitter_px;       // After the high-pass
+
+    uint64_t reversals;
+    double mean_overshoot_px, max_overshoot_px;
+
+    uint64_t corners;
+    double mean_corner_error_px, max_corner_error_px;
+
+    // One-sided power spectral density of the high-passed output (px^2/Hz)
+    int spectrum_segments;      // 0 if no run held TRAJECTORY_FFT_SIZE samples
+    double spectrum_bin_hz;
+    double spectrum[TRAJECTORY_SPECTRUM_BINS];
+    double spectrum_peak_hz;
+} TrajectoryReport;
+
+/**
+ * Defaults: 10 Hz high-pass, 1 s lag window, 5 px reversals, 60 degree corners over 10 px
+ */
+void TrajectoryReport_DefaultOptions(TrajectoryReportOptions* options);
+
+/**
+ * Analyse a recorded trajectory
+ * @param options NULL for TrajectoryReport_DefaultOptions
+ * @return false if there are fewer than two engaged samples
+ */
+bool TrajectoryReport_Compute(const TrajectorySample* samples, size_t count,
+                              const TrajectoryReportOptions* options, TrajectoryReport* report);
+
+/**
+ * Spectral power between two frequencies (px^2), e.g. the 8-12 Hz tremor band
+ */
+double TrajectoryReport_BandPower(const TrajectoryReport* report, double low_hz, double high_hz);
+
+#endif // TRAJECTORY_REPORT_H
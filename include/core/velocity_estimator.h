@@ -0,0 +1,60 @@
+#ifndef VELOCITY_ESTIMATOR_H
+#define VELOCITY_ESTIMATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sliding-window least-squares velocity/acceleration estimator.
+// Fits x(t) and y(t) with a quadratic over the samples of the last
+// window_us microseconds. Running moment sums make every update O(1);
+// the sums are rebuilt around a fresh time origin now and then to keep
+// the fit well conditioned.
+
+// Ring capacity, must be a power of two (32ms at 8kHz)
+#define VELOCITY_RING_CAPACITY 256
+#define DEFAULT_VELOCITY_WINDOW_MS 32
+
+// One timestamped target position
+typedef struct {
+    uint64_t time_us;
+    float x, y;
+} VelocitySample;
+
+typedef struct {
+    VelocitySample samples[VELOCITY_RING_CAPACITY];
+    int head;                   // Index of the oldest sample
+    int count;                  // Samples currently in the window
+    uint64_t window_us;         // Fit window length
+
+    // Moment sums relative to (base_time_us, base_x, base_y), t in seconds
+    uint64_t base_time_us;
+    double base_x, base_y;
+    double sum_t[5];            // Sum of t^k, k = 0..4
+    double sum_x[3];            // Sum of t^k * x, k = 0..2
+    double sum_y[3];            // Sum of t^k * y, k = 0..2
+
+    // Latest estimate, evaluated at the newest sample
+    float velocity_x, velocity_y;           // px/s
+    float acceleration_x, acceleration_y;   // px/s^2
+    float speed;                            // |velocity| in px/s
+} VelocityEstimator;
+
+/**
+ * Clear all samples
+ * @param window_us Fit window length in microseconds
+ */
+void VelocityEstimator_Reset(VelocityEstimator* estimator, uint64_t window_us);
+
+/**
+ * Add a position sample and refresh the estimate
+ * Timestamps must be non-decreasing.
+ */
+void VelocityEstimator_AddSample(VelocityEstimator* estimator, uint64_t time_us, float x, float y);
+
+/**
+ * Drop samples that fell out of the window without adding a new one
+ * Lets the estimate decay to zero when input stops.
+ */
+void VelocityEstimator_Expire(VelocityEstimator* estimator, uint64_t now_us);
+
+#endif // VELOCITY_ESTIMATOR_H
@@ -7,7 +7,7 @@
 
 // Settings window constants
 #define SETTINGS_WINDOW_WIDTH 480
-#define SETTINGS_WINDOW_HEIGHT 520
+#define SETTINGS_WINDOW_HEIGHT 660
 #define CONTROL_HEIGHT 28
 #define CONTROL_SPACING 45
 #define TAB_HEIGHT 35
@@ -43,6 +43,31 @@
 // Tooltip control ID
 #define IDC_TOOLTIP             2023
 
+// Button-aware smoothing controls (Basic tab)
+#define IDC_DRAG_ONLY_CHECK     2024
+#define IDC_DRAG_BUTTON_COMBO   2025
+#define IDC_DEVICE_POLICY_COMBO 2026
+
+// Cursor output backend (Debug tab)
+#define IDC_OUTPUT_MODE_COMBO   2027
+
+// Input trace recording (Debug tab)
+#define IDC_TRACE_BUTTON        2028
+#define IDC_TRACE_STATUS_LABEL  2029
+
+// Pipeline latency histograms (Debug tab)
+#define IDC_LATENCY_LABEL       2030
+#define IDC_LATENCY_DUMP_BUTTON 2031
+#define IDC_LATENCY_RESET_BUTTON 2032
+#define IDC_LATENCY_STATUS_LABEL 2033
+
+// Live activity counters (Debug tab)
+#define IDC_PERF_LABEL          2034
+
+// Refreshes the latency and activity figures while the Debug tab is shown
+#define LATENCY_REFRESH_TIMER_ID 3
+#define LATENCY_REFRESH_INTERVAL_MS 500
+
 // Tab indices
 #define TAB_BASIC       0
 #define TAB_VISUAL      1
@@ -67,6 +92,8 @@ bool SettingsUI_CreateBasicTab(HWND hwnd);
 bool SettingsUI_CreateVisualTab(HWND hwnd);
 bool SettingsUI_CreateDebugTab(HWND hwnd);
 void SettingsUI_ShowTab(int tab_index);
+void SettingsUI_UpdateLatency(void);
+void SettingsUI_UpdatePerf(void);
 
 // Helper function declaration
 BOOL CALLBACK SettingsUI_ShowTabControls(HWND hwnd, LPARAM lParam);
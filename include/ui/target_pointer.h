@@ -4,15 +4,8 @@
 #include <windows.h>
 #include <stdbool.h>
 
-// Target pointer constants
+// Target pointer constants (visual defaults live in stabilizer_core.h)
 #define DRAW_INTERVAL_MS 16
-#define DEFAULT_TARGET_SHOW_DISTANCE 5.0f
-#define DEFAULT_POINTER_TYPE POINTER_CIRCLE
-#define DEFAULT_TARGET_SIZE 8
-#define DEFAULT_TARGET_ALPHA 180
-#define DEFAULT_TARGET_ALWAYS_VISIBLE false
-#define DEFAULT_EXCLUDE_FROM_CAPTURE true
-#define DEFAULT_CAPTURE_COMPATIBILITY_MODE false
 
 // Windows 10+ constant for excluding from capture
 #ifndef WDA_EXCLUDEFROMCAPTURE
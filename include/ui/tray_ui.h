@@ -22,12 +22,14 @@
 
 // Tray UI constants
 #define HOTKEY_ID 1
+#define DUMP_HOTKEY_ID 2
 #define TRAY_ICON_ID 1
 #define WM_TRAYICON (WM_USER + 1)
 #define WM_UPDATE_TIMER (WM_USER + 2)
 #define WM_DRAW_TIMER (WM_USER + 3)
 #define TIMER_ID 1
 #define DRAW_TIMER_ID 2
+#define WATCHDOG_TIMER_ID 3
 
 // Global tray icon data
 extern NOTIFYICONDATA g_nid;
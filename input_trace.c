@@ -0,0 +1,242 @@
+/**
+ * Input Trace - Binary Trace Codec
+ *
+ * Delta + zig-zag varint encoding of raw input packets and engine output
+ * for the trace recorder and offline tools. Encoding writes into a caller
+ * buffer and never allocates; decoding walks a read-only byte range, so a
+ * memory-mapped file of any size can be streamed record by record.
+ */
+
+#include "include/core/input_trace.h"
+
+#include <math.h>
+#include <string.h>
+
+static size_t InputTrace_PutVarint(uint8_t* out, uint64_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+static uint64_t InputTrace_ZigZag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t InputTrace_UnZigZag(uint64_t value) {
+    return (int64_t)((value >> 1) ^ (0u - (value & 1)));
+}
+
+static int32_t InputTrace_Nibble(unsigned int value) {
+    return (int32_t)(value & 0x0F) - (int32_t)((value & 0x08) << 1);
+}
+
+static bool InputTrace_GetVarint(InputTraceReader* reader, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (reader->offset >= reader->length) return false;
+        uint8_t byte = reader->data[reader->offset++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Timestamps only move forward; a clock step back is stored as zero
+static uint64_t InputTrace_Advance(uint64_t* last_us, uint64_t time_us) {
+    uint64_t delta = time_us > *last_us ? time_us - *last_us : 0;
+    *last_us += delta;
+    return delta;
+}
+
+static int32_t InputTrace_ToFixed(float value) {
+    return (int32_t)floorf(value * INPUT_TRACE_POSITION_SCALE + 0.5f);
+}
+
+void InputTrace_ResetState(InputTraceState* state, uint64_t start_us) {
+    if (!state) return;
+
+    memset(state, 0, sizeof(*state));
+    state->packet_time_us = start_us;
+    state->output_time_us = start_us;
+}
+
+size_t InputTrace_WriteHeader(uint8_t* out, uint64_t start_us) {
+    memcpy(out, INPUT_TRACE_MAGIC, 4);
+    out[4] = (uint8_t)(INPUT_TRACE_VERSION & 0xFF);
+    out[5] = (uint8_t)(INPUT_TRACE_VERSION >> 8);
+    out[6] = (uint8_t)(INPUT_TRACE_HEADER_SIZE & 0xFF);
+    out[7] = (uint8_t)(INPUT_TRACE_HEADER_SIZE >> 8);
+    for (int i = 0; i < 8; i++) {
+        out[8 + i] = (uint8_t)(start_us >> (8 * i));
+    }
+    return INPUT_TRACE_HEADER_SIZE;
+}
+
+size_t InputTrace_EncodePacket(InputTraceState* state, uint8_t* out, uint64_t time_us,
+                               uint64_t device, int32_t dx, int32_t dy, unsigned int pressed,
+                               unsigned int released) {
+    size_t length = 0;
+
+    if (device != state->device) {
+        out[length++] = INPUT_TRACE_DEVICE;
+        length += InputTrace_PutVarint(out + length, device);
+        state->device = device;
+    }
+
+    unsigned int buttons = (pressed & 0xFF) | ((released & 0xFF) << 8);
+    bool packed = dx >= -8 && dx <= 7 && dy >= -8 && dy <= 7;
+    uint8_t tag = INPUT_TRACE_PACKET;
+    if (buttons) tag |= INPUT_TRACE_FLAG_BUTTONS;
+    if (packed) tag |= INPUT_TRACE_FLAG_PACKED;
+    out[length++] = tag;
+
+    int64_t interval = (int64_t)InputTrace_Advance(&state->packet_time_us, time_us);
+    length += InputTrace_PutVarint(out + length,
+                                   InputTrace_ZigZag(interval - state->packet_interval_us));
+    state->packet_interval_us = interval;
+
+    if (packed) {
+        out[length++] = (uint8_t)(((unsigned int)dx & 0x0F) | (((unsigned int)dy & 0x0F) << 4));
+    } else {
+        length += InputTrace_PutVarint(out + length, InputTrace_ZigZag(dx));
+        length += InputTrace_PutVarint(out + length, InputTrace_ZigZag(dy));
+    }
+    if (buttons) {
+        length += InputTrace_PutVarint(out + length, buttons);
+    }
+    return length;
+}
+
+size_t InputTrace_EncodeOutput(InputTraceState* state, uint8_t* out, uint64_t time_us, float x,
+                               float y) {
+    int32_t fixed_x = InputTrace_ToFixed(x);
+    int32_t fixed_y = InputTrace_ToFixed(y);
+    if (fixed_x == state->output_x && fixed_y == state->output_y) return 0;
+
+    size_t length = 0;
+    out[length++] = INPUT_TRACE_OUTPUT;
+    length += InputTrace_PutVarint(out + length,
+                                   InputTrace_Advance(&state->output_time_us, time_us));
+    length += InputTrace_PutVarint(out + length,
+                                   InputTrace_ZigZag((int64_t)fixed_x - state->output_x));
+    length += InputTrace_PutVarint(out + length,
+                                   InputTrace_ZigZag((int64_t)fixed_y - state->output_y));
+    state->output_x = fixed_x;
+    state->output_y = fixed_y;
+    return length;
+}
+
+size_t InputTrace_EncodeGap(uint8_t* out, uint32_t dropped) {
+    out[0] = INPUT_TRACE_GAP;
+    return 1 + InputTrace_PutVarint(out + 1, dropped);
+}
+
+bool InputTrace_OpenReader(InputTraceReader* reader, const void* data, size_t length) {
+    if (!reader) return false;
+
+    memset(reader, 0, sizeof(*reader));
+    const uint8_t* bytes = (const uint8_t*)data;
+    if (!bytes || length < INPUT_TRACE_HEADER_SIZE || memcmp(bytes, INPUT_TRACE_MAGIC, 4) != 0) {
+        return false;
+    }
+
+    uint16_t version = (uint16_t)(bytes[4] | (bytes[5] << 8));
+    uint16_t header_size = (uint16_t)(bytes[6] | (bytes[7] << 8));
+    if (version != INPUT_TRACE_VERSION || header_size < INPUT_TRACE_HEADER_SIZE ||
+        header_size > length) {
+        return false;
+    }
+
+    uint64_t start_us = 0;
+    for (int i = 0; i < 8; i++) {
+        start_us |= (uint64_t)bytes[8 + i] << (8 * i);
+    }
+
+    reader->data = bytes;
+    reader->length = length;
+    reader->offset = header_size;
+    reader->start_us = start_us;
+    reader->version = version;
+    InputTrace_ResetState(&reader->state, start_us);
+    return true;
+}
+
+bool InputTrace_Read(InputTraceReader* reader, InputTraceRecord* record) {
+    if (!reader || !record || !reader->data || reader->corrupt) return false;
+    if (reader->offset >= reader->length) return false;
+
+    memset(record, 0, sizeof(*record));
+    InputTraceState* state = &reader->state;
+    uint8_t tag = reader->data[reader->offset++];
+    uint64_t a = 0, b = 0, c = 0, buttons = 0;
+    bool ok = true;
+
+    record->type = (InputTraceRecordType)(tag & 0x03);
+    switch (record->type) {
+        case INPUT_TRACE_PACKET:
+            ok = InputTrace_GetVarint(reader, &a);
+            if (ok && (tag & INPUT_TRACE_FLAG_PACKED)) {
+                ok = reader->offset < reader->length;
+                if (ok) {
+                    uint8_t motion = reader->data[reader->offset++];
+                    record->dx = InputTrace_Nibble(motion);
+                    record->dy = InputTrace_Nibble(motion >> 4);
+                }
+            } else if (ok) {
+                ok = InputTrace_GetVarint(reader, &b) && InputTrace_GetVarint(reader, &c);
+                record->dx = (int32_t)InputTrace_UnZigZag(b);
+                record->dy = (int32_t)InputTrace_UnZigZag(c);
+            }
+            if (ok && (tag & INPUT_TRACE_FLAG_BUTTONS)) {
+                ok = InputTrace_GetVarint(reader, &buttons);
+            }
+            if (ok) {
+                state->packet_interval_us += InputTrace_UnZigZag(a);
+                state->packet_time_us += (uint64_t)state->packet_interval_us;
+                record->time_us = state->packet_time_us;
+                record->pressed = (unsigned int)(buttons & 0xFF);
+                record->released = (unsigned int)((buttons >> 8) & 0xFF);
+            }
+            break;
+
+        case INPUT_TRACE_OUTPUT:
+            ok = InputTrace_GetVarint(reader, &a) && InputTrace_GetVarint(reader, &b) &&
+                 InputTrace_GetVarint(reader, &c);
+            if (ok) {
+                state->output_time_us += a;
+                state->output_x = (int32_t)(state->output_x + InputTrace_UnZigZag(b));
+                state->output_y = (int32_t)(state->output_y + InputTrace_UnZigZag(c));
+                record->time_us = state->output_time_us;
+                record->x = (float)state->output_x / INPUT_TRACE_POSITION_SCALE;
+                record->y = (float)state->output_y / INPUT_TRACE_POSITION_SCALE;
+            }
+            break;
+
+        case INPUT_TRACE_DEVICE:
+            ok = InputTrace_GetVarint(reader, &a);
+            if (ok) state->device = a;
+            record->time_us = state->packet_time_us;
+            break;
+
+        case INPUT_TRACE_GAP:
+            ok = InputTrace_GetVarint(reader, &a);
+            if (ok) record->dropped = (uint32_t)a;
+            record->time_us = state->packet_time_us;
+            break;
+    }
+
+    if (!ok) {
+        reader->corrupt = true;
+        return false;
+    }
+
+    record->device = state->device;
+    return true;
+}
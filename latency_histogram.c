@@ -0,0 +1,212 @@
+/**
+ * Latency Histogram - Lock-Free Log-Linear Latency Buckets
+ *
+ * Fixed-size HdrHistogram-style histogram for per-stage pipeline latency.
+ * Recording is a bucket lookup and a few relaxed atomic adds, cheap enough
+ * for every input packet; percentiles and the .hgrm distribution are
+ * computed from a snapshot off the hot path.
+ */
+
+#include "include/core/latency_histogram.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LATENCY_HISTOGRAM_SUB_COUNT (1 << LATENCY_HISTOGRAM_SUB_BITS)
+#define LATENCY_HISTOGRAM_HALF_COUNT (1 << (LATENCY_HISTOGRAM_SUB_BITS - 1))
+#define LATENCY_HISTOGRAM_TICKS_PER_HALF 5      // Distribution rows per halving of the gap to 100%
+
+void LatencyHistogram_Reset(LatencyHistogram* histogram) {
+    if (!histogram) return;
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+int LatencyHistogram_BucketIndex(uint64_t value_us) {
+    if (value_us > LATENCY_HISTOGRAM_MAX_VALUE) value_us = LATENCY_HISTOGRAM_MAX_VALUE;
+    if (value_us < LATENCY_HISTOGRAM_SUB_COUNT) return (int)value_us;
+
+    // The top SUB_BITS bits of the value select the bucket within its power of two
+    int magnitude = 31 - __builtin_clz((uint32_t)value_us);
+    int shift = magnitude - LATENCY_HISTOGRAM_SUB_BITS + 1;
+    return shift * LATENCY_HISTOGRAM_HALF_COUNT + (int)(value_us >> shift);
+}
+
+uint64_t LatencyHistogram_BucketLow(int index) {
+    if (index < LATENCY_HISTOGRAM_SUB_COUNT) return index < 0 ? 0 : (uint64_t)index;
+    int shift = index / LATENCY_HISTOGRAM_HALF_COUNT - 1;
+    uint64_t mantissa = (uint64_t)(index - shift * LATENCY_HISTOGRAM_HALF_COUNT);
+    return mantissa << shift;
+}
+
+uint64_t LatencyHistogram_BucketHigh(int index) {
+    if (index < LATENCY_HISTOGRAM_SUB_COUNT) return LatencyHistogram_BucketLow(index);
+    int shift = index / LATENCY_HISTOGRAM_HALF_COUNT - 1;
+    return LatencyHistogram_BucketLow(index) + ((uint64_t)1 << shift) - 1;
+}
+
+void LatencyHistogram_Record(LatencyHistogram* histogram, uint64_t value_us) {
+    if (!histogram) return;
+
+    __atomic_fetch_add(&histogram->counts[LatencyHistogram_BucketIndex(value_us)], 1,
+                       __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sum, value_us, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+    while (value_us > max &&
+           !__atomic_compare_exchange_n(&histogram->max, &max, value_us, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+    }
+}
+
+void LatencyHistogram_Snapshot(const LatencyHistogram* histogram, LatencyHistogram* out) {
+    if (!histogram || !out) return;
+
+    uint64_t count = 0;
+    for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+        out->counts[i] = __atomic_load_n(&histogram->counts[i], __ATOMIC_RELAXED);
+        count += out->counts[i];
+    }
+    out->count = count;
+    out->sum = __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED);
+    out->max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+}
+
+// Bucket holding the value of rank ceil(percentile * count); cumulative counts through it
+static int LatencyHistogram_Rank(const LatencyHistogram* histogram, double percentile,
+                                 uint64_t* cumulative) {
+    if (percentile < 0.0) percentile = 0.0;
+    if (percentile > 100.0) percentile = 100.0;
+
+    uint64_t target = (uint64_t)ceil(percentile / 100.0 * (double)histogram->count);
+    if (target < 1) target = 1;
+    if (target > histogram->count) target = histogram->count;
+
+    uint64_t total = 0;
+    int index = 0;
+    for (; index < LATENCY_HISTOGRAM_BUCKETS; index++) {
+        total += histogram->counts[index];
+        if (total >= target) break;
+    }
+    if (index == LATENCY_HISTOGRAM_BUCKETS) index--;
+    *cumulative = total;
+    return index;
+}
+
+static uint64_t LatencyHistogram_ReportedValue(const LatencyHistogram* histogram, int index) {
+    uint64_t value = LatencyHistogram_BucketHigh(index);
+    return value > histogram->max ? histogram->max : value;
+}
+
+uint64_t LatencyHistogram_Percentile(const LatencyHistogram* histogram, double percentile) {
+    if (!histogram || histogram->count == 0) return 0;
+
+    uint64_t cumulative;
+    int index = LatencyHistogram_Rank(histogram, percentile, &cumulative);
+    return LatencyHistogram_ReportedValue(histogram, index);
+}
+
+void LatencyHistogram_Summarize(const LatencyHistogram* histogram, LatencySummary* summary) {
+    if (!summary) return;
+    memset(summary, 0, sizeof(*summary));
+    if (!histogram || histogram->count == 0) return;
+
+    static const double percentiles[3] = {50.0, 99.0, 99.9};
+    uint64_t targets[3];
+    uint64_t values[3] = {0, 0, 0};
+    for (int i = 0; i < 3; i++) {
+        targets[i] = (uint64_t)ceil(percentiles[i] / 100.0 * (double)histogram->count);
+        if (targets[i] < 1) targets[i] = 1;
+    }
+
+    uint64_t total = 0;
+    int next = 0;
+    for (int index = 0; index < LATENCY_HISTOGRAM_BUCKETS && next < 3; index++) {
+        total += histogram->counts[index];
+        while (next < 3 && total >= targets[next]) {
+            values[next++] = LatencyHistogram_ReportedValue(histogram, index);
+        }
+    }
+
+    summary->count = histogram->count;
+    summary->mean = (double)histogram->sum / (double)histogram->count;
+    summary->p50 = values[0];
+    summary->p99 = values[1];
+    summary->p999 = values[2];
+    summary->max = histogram->max;
+}
+
+// Append one formatted row, or nothing if it does not fit
+static bool LatencyHistogram_Append(char* out, size_t size, size_t* length,
+                                    const char* format, ...) {
+    char row[160];
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(row, sizeof(row), format, args);
+    va_end(args);
+
+    if (written < 0 || (size_t)written >= sizeof(row) ||
+        *length + (size_t)written >= size) return false;
+    memcpy(out + *length, row, (size_t)written + 1);
+    *length += (size_t)written;
+    return true;
+}
+
+size_t LatencyHistogram_FormatDistribution(const LatencyHistogram* histogram, char* out,
+                                           size_t size) {
+    if (!histogram || !out || size == 0) return 0;
+    out[0] = '\0';
+
+    size_t length = 0;
+    if (!LatencyHistogram_Append(out, size, &length, "%12s %14s %10s %14s\n\n",
+                                 "Value", "Percentile", "TotalCount", "1/(1-Percentile)")) {
+        return 0;
+    }
+
+    // Percentiles step closer to 100% the way HdrHistogram's percentile iterator does
+    double percentile = 0.0;
+    while (histogram->count > 0) {
+        uint64_t cumulative;
+        int index = LatencyHistogram_Rank(histogram, percentile, &cumulative);
+        double value_ms = (double)LatencyHistogram_ReportedValue(histogram, index) / 1000.0;
+
+        if (cumulative >= histogram->count) {
+            if (!LatencyHistogram_Append(out, size, &length, "%12.3f %2.12f %10llu\n",
+                                         value_ms, 1.0, (unsigned long long)cumulative)) {
+                return length;
+            }
+            break;
+        }
+
+        double fraction = percentile / 100.0;
+        if (!LatencyHistogram_Append(out, size, &length, "%12.3f %2.12f %10llu %14.2f\n",
+                                     value_ms, fraction, (unsigned long long)cumulative,
+                                     1.0 / (1.0 - fraction))) {
+            return length;
+        }
+
+        double halvings = floor(log2(100.0 / (100.0 - percentile))) + 1.0;
+        percentile += 100.0 / (LATENCY_HISTOGRAM_TICKS_PER_HALF * pow(2.0, halvings));
+    }
+
+    // Standard deviation from bucket midpoints, as HdrHistogram computes it
+    double mean = histogram->count > 0 ? (double)histogram->sum / (double)histogram->count : 0.0;
+    double variance = 0.0;
+    for (int index = 0; index < LATENCY_HISTOGRAM_BUCKETS; index++) {
+        if (histogram->counts[index] == 0) continue;
+        double low = (double)LatencyHistogram_BucketLow(index);
+        double middle = (low + (double)LatencyHistogram_BucketHigh(index)) / 2.0;
+        variance += (middle - mean) * (middle - mean) * (double)histogram->counts[index];
+    }
+    double deviation = histogram->count > 0 ? sqrt(variance / (double)histogram->count) : 0.0;
+
+    LatencyHistogram_Append(out, size, &length, "#[Mean    = %12.3f, StdDeviation   = %12.3f]\n",
+                            mean / 1000.0, deviation / 1000.0);
+    LatencyHistogram_Append(out, size, &length, "#[Max     = %12.3f, Total count    = %12llu]\n",
+                            (double)histogram->max / 1000.0, (unsigned long long)histogram->count);
+    LatencyHistogram_Append(out, size, &length, "#[Buckets = %12d, SubBuckets     = %12d]\n",
+                            LATENCY_HISTOGRAM_BUCKETS, LATENCY_HISTOGRAM_SUB_COUNT);
+    return length;
+}
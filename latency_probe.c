@@ -0,0 +1,181 @@
+/**
+ * Latency Probe - Input-to-Cursor Pipeline Timing
+ *
+ * Timestamps raw input packets on their way from WM_INPUT to the cursor
+ * write and records each stage into a lock-free latency histogram. Marks
+ * cost one platform clock read each and never allocate or block; the
+ * Debug tab reads summaries and dumps the full distributions on request.
+ */
+
+#include "mouse_stabilizer.h"
+
+typedef struct {
+    uint64_t arrival_us;
+    uint64_t target_us;
+} LatencyProbe_Packet;
+
+static LatencyHistogram g_latency_histograms[LATENCY_STAGE_COUNT];
+static LatencyHistogram g_latency_snapshots[PERF_COUNTER_READERS];  // One per summary reader
+static LatencyProbe_Packet g_latency_pending[LATENCY_PROBE_PENDING];
+static int g_latency_pending_count = 0;
+static uint64_t g_latency_overflow = 0;
+
+static bool g_latency_in_tick = false;
+static uint64_t g_latency_tick_us = 0;
+static uint64_t g_latency_output_us = 0;
+
+static const char* const g_latency_stage_names[LATENCY_STAGE_COUNT] = {
+    "Input", "Timer", "Filter", "Write", "Total"
+};
+
+static const char* const g_latency_stage_descriptions[LATENCY_STAGE_COUNT] = {
+    "WM_INPUT arrival to target update",
+    "target update to start of the update tick that writes the cursor",
+    "update tick start to filter output",
+    "filter output to SetCursorPos/SendInput return",
+    "WM_INPUT arrival to SetCursorPos/SendInput return"
+};
+
+static uint64_t LatencyProbe_Now(void) {
+    return Platform_NowMicros(PlatformWin32_Get());
+}
+
+// Clock reads on one thread never go backwards, but guard the unsigned difference anyway
+static uint64_t LatencyProbe_Elapsed(uint64_t from, uint64_t to) {
+    return to > from ? to - from : 0;
+}
+
+void LatencyProbe_MarkTarget(uint64_t arrival_us) {
+    if (g_latency_pending_count >= LATENCY_PROBE_PENDING) {
+        g_latency_overflow++;
+        return;
+    }
+
+    LatencyProbe_Packet* packet = &g_latency_pending[g_latency_pending_count++];
+    packet->arrival_us = arrival_us;
+    packet->target_us = LatencyProbe_Now();
+}
+
+void LatencyProbe_BeginTick(void) {
+    g_latency_in_tick = true;
+    g_latency_tick_us = LatencyProbe_Now();
+}
+
+void LatencyProbe_MarkOutput(void) {
+    if (!g_latency_in_tick) return;
+    g_latency_output_us = LatencyProbe_Now();
+}
+
+void LatencyProbe_MarkWritten(void) {
+    // Writes outside a tick (engaging, re-enabling) are not filter output
+    if (!g_latency_in_tick || g_latency_pending_count == 0) return;
+
+    uint64_t written_us = LatencyProbe_Now();
+    uint64_t filter_us = LatencyProbe_Elapsed(g_latency_tick_us, g_latency_output_us);
+    uint64_t write_us = LatencyProbe_Elapsed(g_latency_output_us, written_us);
+
+    for (int i = 0; i < g_latency_pending_count; i++) {
+        const LatencyProbe_Packet* packet = &g_latency_pending[i];
+        LatencyHistogram_Record(&g_latency_histograms[LATENCY_STAGE_INPUT],
+                                LatencyProbe_Elapsed(packet->arrival_us, packet->target_us));
+        LatencyHistogram_Record(&g_latency_histograms[LATENCY_STAGE_TIMER],
+                                LatencyProbe_Elapsed(packet->target_us, g_latency_tick_us));
+        LatencyHistogram_Record(&g_latency_histograms[LATENCY_STAGE_FILTER], filter_us);
+        LatencyHistogram_Record(&g_latency_histograms[LATENCY_STAGE_WRITE], write_us);
+        LatencyHistogram_Record(&g_latency_histograms[LATENCY_STAGE_TOTAL],
+                                LatencyProbe_Elapsed(packet->arrival_us, written_us));
+    }
+    g_latency_pending_count = 0;
+}
+
+void LatencyProbe_EndTick(bool engaged) {
+    g_latency_in_tick = false;
+
+    // Pass-through: the OS already moved the cursor for these packets
+    if (!engaged) g_latency_pending_count = 0;
+}
+
+const char* LatencyProbe_GetStageName(LatencyStage stage) {
+    if (stage < 0 || stage >= LATENCY_STAGE_COUNT) return "Unknown";
+    return g_latency_stage_names[stage];
+}
+
+void LatencyProbe_GetSummary(int reader, LatencyStage stage, LatencySummary* summary) {
+    if (!summary) return;
+    if (reader < 0 || reader >= PERF_COUNTER_READERS || stage < 0 || stage >= LATENCY_STAGE_COUNT) {
+        memset(summary, 0, sizeof(*summary));
+        return;
+    }
+
+    LatencyHistogram* snapshot = &g_latency_snapshots[reader];
+    LatencyHistogram_Snapshot(&g_latency_histograms[stage], snapshot);
+    LatencyHistogram_Summarize(snapshot, summary);
+}
+
+uint64_t LatencyProbe_GetOverflow(void) {
+    return g_latency_overflow;
+}
+
+void LatencyProbe_Reset(void) {
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        LatencyHistogram_Reset(&g_latency_histograms[i]);
+    }
+    g_latency_overflow = 0;
+    LOG_INFO("Latency histograms reset");
+}
+
+static bool LatencyProbe_WriteText(HANDLE file, const char* text, size_t length) {
+    DWORD written = 0;
+    return WriteFile(file, text, (DWORD)length, &written, NULL) && written == (DWORD)length;
+}
+
+bool LatencyProbe_Dump(char* path, size_t size) {
+    if (!path || size == 0) return false;
+
+    SYSTEMTIME now;
+    char name[64];
+    GetLocalTime(&now);
+    sprintf_s(name, sizeof(name), "mouse_stabilizer_latency_%04u%02u%02u_%02u%02u%02u.hgrm",
+              now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond);
+
+    GetModuleFileName(NULL, path, (DWORD)size);
+    char* last_slash = strrchr(path, '\\');
+    if (last_slash) {
+        strcpy_s(last_slash + 1, size - (size_t)(last_slash + 1 - path), name);
+    } else {
+        strcpy_s(path, size, name);
+    }
+
+    HANDLE file = CreateFile(path, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Failed to create latency dump %s: error code %lu", path, GetLastError());
+        return false;
+    }
+
+    // Distributions are formatted from snapshots; recording carries on meanwhile
+    static LatencyHistogram snapshot;
+    static char text[64 * 1024];
+    bool ok = true;
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT && ok; stage++) {
+        LatencyHistogram_Snapshot(&g_latency_histograms[stage], &snapshot);
+        int length = sprintf_s(text, sizeof(text), "%s# Stage %s: %s (values in ms)\n",
+                               stage > 0 ? "\n" : "", g_latency_stage_names[stage],
+                               g_latency_stage_descriptions[stage]);
+        ok = length > 0 && LatencyProbe_WriteText(file, text, (size_t)length);
+        if (ok) {
+            size_t distribution = LatencyHistogram_FormatDistribution(&snapshot, text,
+                                                                      sizeof(text));
+            ok = LatencyProbe_WriteText(file, text, distribution);
+        }
+    }
+    CloseHandle(file);
+
+    if (!ok) {
+        LOG_ERROR("Failed to write latency dump %s: error code %lu", path, GetLastError());
+        return false;
+    }
+    LOG_INFO("Latency histograms written to %s (%llu packets untimed)", path,
+             (unsigned long long)g_latency_overflow);
+    return true;
+}
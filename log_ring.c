@@ -0,0 +1,106 @@
+/**
+ * Log Ring - Lock-Free Log Record Queue
+ *
+ * Bounded MPSC queue for log records. The calling thread only formats the
+ * message into a claimed slot; timestamps are formatted, records batched
+ * and the file written by whoever consumes the ring.
+ */
+
+#include "include/core/log_ring.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_RING_MASK (LOG_RING_CAPACITY - 1)
+
+void LogRing_Initialize(LogRing* ring) {
+    if (!ring) return;
+
+    memset(ring, 0, sizeof(*ring));
+    for (uint64_t i = 0; i < LOG_RING_CAPACITY; i++) {
+        ring->slots[i].sequence = i;
+    }
+}
+
+LogRecord* LogRing_Claim(LogRing* ring, uint64_t* position_out) {
+    if (!ring || !position_out) return NULL;
+
+    // A slot is free for position p when its sequence equals p; it is still
+    // unread from the previous lap when the sequence is behind
+    uint64_t position = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    LogRecord* record;
+    for (;;) {
+        record = &ring->slots[position & LOG_RING_MASK];
+        uint64_t sequence = __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE);
+        int64_t lap = (int64_t)(sequence - position);
+        if (lap == 0) {
+            if (__atomic_compare_exchange_n(&ring->head, &position, position + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (lap < 0) {
+            __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        } else {
+            position = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    *position_out = position;
+    return record;
+}
+
+void LogRing_Publish(LogRing* ring, LogRecord* record, uint64_t position) {
+    if (!ring || !record) return;
+
+    __atomic_store_n(&record->sequence, position + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&ring->written, 1, __ATOMIC_RELAXED);
+}
+
+bool LogRing_Write(LogRing* ring, LogLevel level, uint64_t time, const char* format, va_list args) {
+    if (!ring || !format) return false;
+
+    uint64_t position;
+    LogRecord* record = LogRing_Claim(ring, &position);
+    if (!record) return false;
+
+    int length = vsnprintf(record->message, sizeof(record->message), format, args);
+    if (length < 0) length = 0;
+    if (length >= (int)sizeof(record->message)) length = (int)sizeof(record->message) - 1;
+    record->length = (uint16_t)length;
+    record->level = (uint8_t)level;
+    record->time = time;
+    record->site = NULL;
+
+    LogRing_Publish(ring, record, position);
+    return true;
+}
+
+const LogRecord* LogRing_Peek(LogRing* ring) {
+    if (!ring) return NULL;
+
+    LogRecord* record = &ring->slots[ring->tail & LOG_RING_MASK];
+    uint64_t sequence = __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE);
+    return sequence == ring->tail + 1 ? record : NULL;
+}
+
+void LogRing_Pop(LogRing* ring) {
+    if (!ring) return;
+
+    // Hand the slot to the producer that claims it one lap later
+    LogRecord* record = &ring->slots[ring->tail & LOG_RING_MASK];
+    __atomic_store_n(&record->sequence, ring->tail + LOG_RING_CAPACITY, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELAXED);
+}
+
+uint32_t LogRing_Pending(const LogRing* ring) {
+    if (!ring) return 0;
+
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    return head > tail ? (uint32_t)(head - tail) : 0;
+}
+
+uint64_t LogRing_TakeDropped(LogRing* ring) {
+    return ring ? __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED) : 0;
+}
@@ -0,0 +1,196 @@
+/**
+ * Log Sink - Rotating Mapped Log Segments
+ *
+ * Owns the log files on disk for the log writer: creates each segment at
+ * full size, maps it, hands out space for records and rotates segments
+ * by size and age. Not thread-safe; the log writer serializes access.
+ */
+
+#include "mouse_stabilizer.h"
+
+void LogSink_DefaultOptions(LogSinkOptions* options) {
+    if (!options) return;
+    options->segment_bytes = LOG_SINK_DEFAULT_SEGMENT_BYTES;
+    options->max_files = LOG_SINK_DEFAULT_MAX_FILES;
+    options->max_age_seconds = LOG_SINK_DEFAULT_MAX_AGE_SECONDS;
+    options->trim_padding = false;
+}
+
+void LogSink_Initialize(LogSink* sink, const char* base, const char* extension,
+                        const LogSinkOptions* options) {
+    if (!sink) return;
+
+    memset(sink, 0, sizeof(*sink));
+    sink->file = INVALID_HANDLE_VALUE;
+    strcpy_s(sink->base, sizeof(sink->base), base ? base : "");
+    strcpy_s(sink->extension, sizeof(sink->extension), extension ? extension : "");
+    if (options) {
+        sink->options = *options;
+    } else {
+        LogSink_DefaultOptions(&sink->options);
+    }
+    LogSink_Configure(sink, &sink->options);
+}
+
+void LogSink_Configure(LogSink* sink, const LogSinkOptions* options) {
+    if (!sink || !options) return;
+
+    sink->options = *options;
+    if (sink->options.segment_bytes < 64 * 1024) sink->options.segment_bytes = 64 * 1024;
+    if (sink->options.max_files > 99) sink->options.max_files = 99;
+}
+
+// index 0 is the current segment
+static void LogSink_SegmentPath(const LogSink* sink, uint32_t index, char* path, size_t size) {
+    if (index == 0) {
+        snprintf(path, size, "%s%s", sink->base, sink->extension);
+    } else {
+        snprintf(path, size, "%s.%u%s", sink->base, (unsigned)index, sink->extension);
+    }
+}
+
+// Cut a segment left by a killed process back to its last non-zero byte
+static void LogSink_TrimPadding(const char* path) {
+    HANDLE file = CreateFile(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return;
+
+    LARGE_INTEGER size;
+    uint8_t block[4096];
+    if (GetFileSizeEx(file, &size)) {
+        LONGLONG end = size.QuadPart;
+        bool found = false;
+        while (end > 0 && !found) {
+            LONGLONG start = end > (LONGLONG)sizeof(block) ? end - (LONGLONG)sizeof(block) : 0;
+            LARGE_INTEGER position;
+            DWORD read = 0;
+            position.QuadPart = start;
+            if (!SetFilePointerEx(file, position, NULL, FILE_BEGIN) ||
+                !ReadFile(file, block, (DWORD)(end - start), &read, NULL) ||
+                read != (DWORD)(end - start)) {
+                break;
+            }
+            while (end > start && block[end - start - 1] == 0) end--;
+            found = end > start;
+        }
+
+        if (end < size.QuadPart) {
+            LARGE_INTEGER position;
+            position.QuadPart = end;
+            if (SetFilePointerEx(file, position, NULL, FILE_BEGIN)) SetEndOfFile(file);
+        }
+    }
+    CloseHandle(file);
+}
+
+// Move segments up one index; the oldest beyond max_files is deleted
+static void LogSink_Shift(LogSink* sink) {
+    char from[MAX_PATH], to[MAX_PATH];
+
+    LogSink_SegmentPath(sink, sink->options.max_files, to, sizeof(to));
+    DeleteFile(to);
+    for (uint32_t index = sink->options.max_files; index > 0; index--) {
+        LogSink_SegmentPath(sink, index - 1, from, sizeof(from));
+        LogSink_SegmentPath(sink, index, to, sizeof(to));
+        MoveFileEx(from, to, MOVEFILE_REPLACE_EXISTING);
+    }
+}
+
+static bool LogSink_OpenSegment(LogSink* sink, uint64_t now_second) {
+    char path[MAX_PATH];
+    LogSink_SegmentPath(sink, 0, path, sizeof(path));
+
+    // A previous run's segment becomes .1 like any full one
+    if (!sink->started) {
+        sink->started = true;
+        if (GetFileAttributes(path) != INVALID_FILE_ATTRIBUTES) {
+            if (sink->options.trim_padding) LogSink_TrimPadding(path);
+            LogSink_Shift(sink);
+        }
+    }
+
+    size_t capacity = sink->options.segment_bytes;
+    HANDLE file = CreateFile(path, GENERIC_READ | GENERIC_WRITE,
+                             FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        sink->failures++;
+        return false;
+    }
+
+    // Mapping past the end grows the file to its full size up front
+    HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READWRITE, 0, (DWORD)capacity, NULL);
+    uint8_t* view = NULL;
+    if (mapping) view = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, capacity);
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        DeleteFile(path);
+        sink->failures++;
+        return false;
+    }
+
+    sink->file = file;
+    sink->mapping = mapping;
+    sink->view = view;
+    sink->capacity = capacity;
+    sink->used = 0;
+    sink->opened_second = now_second;
+    sink->segments++;
+    return true;
+}
+
+void LogSink_Close(LogSink* sink) {
+    if (!sink || !sink->view) return;
+
+    UnmapViewOfFile(sink->view);
+    CloseHandle(sink->mapping);
+
+    // Drop the unused preallocated tail
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG)sink->used;
+    if (SetFilePointerEx(sink->file, position, NULL, FILE_BEGIN)) SetEndOfFile(sink->file);
+    CloseHandle(sink->file);
+
+    sink->file = INVALID_HANDLE_VALUE;
+    sink->mapping = NULL;
+    sink->view = NULL;
+    sink->capacity = 0;
+    sink->used = 0;
+
+    // Writing again later starts a new segment instead of overwriting this one
+    sink->started = false;
+}
+
+uint8_t* LogSink_Reserve(LogSink* sink, size_t length, uint64_t now_second, bool* new_segment) {
+    if (!sink || !new_segment) return NULL;
+    *new_segment = false;
+    if (length > sink->options.segment_bytes) return NULL;
+
+    if (sink->view) {
+        bool full = sink->capacity - sink->used < length;
+        bool expired = sink->options.max_age_seconds > 0 && sink->used > 0 &&
+                       now_second >= sink->opened_second &&
+                       now_second - sink->opened_second >= sink->options.max_age_seconds;
+        if (!full && !expired) return sink->view + sink->used;
+
+        LogSink_Close(sink);
+        LogSink_Shift(sink);
+    }
+
+    if (!LogSink_OpenSegment(sink, now_second)) return NULL;
+    *new_segment = true;
+    return sink->view;
+}
+
+void LogSink_Commit(LogSink* sink, size_t length) {
+    if (!sink || !sink->view) return;
+    if (length > sink->capacity - sink->used) length = sink->capacity - sink->used;
+    sink->used += length;
+    sink->bytes += length;
+}
+
+void LogSink_Flush(LogSink* sink) {
+    if (!sink || !sink->view || sink->used == 0) return;
+    FlushViewOfFile(sink->view, sink->used);
+}
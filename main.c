@@ -11,6 +11,11 @@
 
 #include "mouse_stabilizer.h"
 
+// Global application state
+SmoothStabilizer g_stabilizer = {0};  // Main stabilizer instance
+HWND g_hidden_window = NULL;          // Hidden window for message handling
+bool g_running = true;                // Application running flag
+
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
     (void)hPrevInstance;
     (void)lpCmdLine;
@@ -23,10 +28,14 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         ShowWindow(console_window, SW_HIDE);
     }
 #endif
+    // Route core clock, cursor, monitor and log requests to Win32 first
+    PlatformWin32_Install();
+    EventTracer_NameThread("Message thread");
+    Settings_StartLogWriter();
+    
     const char* class_name = "MouseStabilizerWindow";
     WNDCLASS wc = {0};
     MSG msg;
-    HHOOK mouse_hook = NULL;
     
     wc.lpfnWndProc = Hotkey_WindowProc;
     wc.hInstance = hInstance;
@@ -54,11 +63,19 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         return 1;
     }
     
-    StabilizerCore_Initialize(&g_stabilizer);
+    PerfMonitor_Initialize();
+    OutputSink_Initialize(&g_output_sink, PlatformWin32_WriteSetCursorPos, NULL);
+    ScreenGeometry_Refresh(&g_screen_geometry, PlatformWin32_Get());
+    StabilizerCore_Initialize(&g_stabilizer, PlatformWin32_Get(), &g_screen_geometry,
+                              &g_output_sink);
     Settings_Load();
+    PlatformWin32_SetOutputMode(g_output_mode);
+    MouseInput_SyncDeviceSettings();
     
-    // Force DEBUG level for troubleshooting
+#ifdef DEBUG
+    // Debug builds log everything regardless of the ini
     Settings_SetLogLevel(LOG_DEBUG);
+#endif
     
     if (!SettingsUI_Initialize()) {
         LOG_WARN("Failed to initialize settings UI - continuing without settings window");
@@ -70,6 +87,10 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         LOG_INFO("Hotkey Ctrl+Alt+S registered successfully");
     }
     
+    if (!RegisterHotKey(g_hidden_window, DUMP_HOTKEY_ID, MOD_CONTROL | MOD_ALT, 'D')) {
+        LOG_WARN("Failed to register flight recorder hotkey Ctrl+Alt+D");
+    }
+    
     if (!TrayUI_CreateIcon(g_hidden_window)) {
         LOG_ERROR("Failed to create tray icon");
     } else {
@@ -96,8 +117,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         LOG_WARN("Failed to register raw input - using fallback method");
     }
     
-    mouse_hook = SetWindowsHookEx(WH_MOUSE_LL, MouseInput_LowLevelMouseProc, hInstance, 0);
-    if (!mouse_hook) {
+    if (!MouseInput_InstallHook()) {
         LOG_ERROR("Failed to install mouse hook");
         MessageBox(NULL, "Failed to install mouse hook", "Error", MB_ICONERROR);
         return 1;
@@ -110,6 +130,19 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
              g_stabilizer.dual_mode ? "true" : "false", g_stabilizer.delay_start_ms, 
              g_stabilizer.enabled ? "true" : "false");
     
+    // Hook watchdog and scheduling health checks
+    HealthMonitor_Initialize();
+    if (!SetTimer(g_hidden_window, WATCHDOG_TIMER_ID, HEALTH_MONITOR_INTERVAL_MS, NULL)) {
+        LOG_WARN("Failed to create watchdog timer - hook health checks disabled");
+    }
+    
+    if (g_shared_telemetry) {
+        SharedTelemetry_Start();
+    }
+    if (g_metrics_port != 0) {
+        MetricsServer_Start();
+    }
+    
     TrayUI_UpdateIcon();
     
     while (g_running && GetMessage(&msg, NULL, 0, 0)) {
@@ -117,21 +150,28 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         DispatchMessage(&msg);
     }
     
-    if (mouse_hook) {
-        UnhookWindowsHookEx(mouse_hook);
-        Settings_WriteLog("Mouse hook uninstalled");
-    }
+    KillTimer(g_hidden_window, WATCHDOG_TIMER_ID);
+    MouseInput_RemoveHook();
+    Settings_WriteLog("Mouse hook uninstalled");
     
+    TraceRecorder_Stop();
+    TraceRecorder_WaitForFlight();
+    EventTracer_Stop();
+    SharedTelemetry_Stop();
+    MetricsServer_Stop();
     KillTimer(g_hidden_window, TIMER_ID);
     KillTimer(g_hidden_window, DRAW_TIMER_ID);
     if (g_target_window) {
         DestroyWindow(g_target_window);
     }
     UnregisterHotKey(g_hidden_window, HOTKEY_ID);
+    UnregisterHotKey(g_hidden_window, DUMP_HOTKEY_ID);
     Shell_NotifyIcon(NIM_DELETE, &g_nid);
     Settings_Save();
     
+    OutputSink_LogStats(&g_output_sink, PlatformWin32_Get());
     Settings_WriteLog("Mouse Stabilizer terminated");
+    Settings_StopLogWriter();
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+/**
+ * Metrics Server - Loopback Prometheus Endpoint
+ *
+ * A small blocking HTTP server on 127.0.0.1 with a thread of its own at
+ * the lowest priority. Every figure it serves is read from counters and
+ * histograms that are safe to read from any thread, through the metrics
+ * reader's own interval state and snapshot buffers, so a scrape never
+ * takes a lock the input or engine path could be waiting on.
+ */
+
+#include <winsock2.h>
+
+#include "mouse_stabilizer.h"
+
+int g_metrics_port = 0;
+
+static SOCKET g_metrics_socket = INVALID_SOCKET;
+static HANDLE g_metrics_thread = NULL;
+static volatile LONG g_metrics_stop = 0;
+static bool g_metrics_winsock = false;
+
+static char g_metrics_request[METRICS_SERVER_REQUEST_SIZE];
+static char g_metrics_page[METRICS_SERVER_PAGE_SIZE];
+static char g_metrics_header[256];
+
+static void MetricsServer_Snapshot(MetricsSnapshot* snapshot) {
+    PerfMonitorReading reading;
+    PerfMonitor_Read(PERF_MONITOR_READER_METRICS, &reading);
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->enabled = g_stabilizer.enabled;
+    snapshot->packets_per_s = reading.packets_per_s;
+    snapshot->steps_per_s = reading.steps_per_s;
+    snapshot->packets_total = reading.packets_total;
+    snapshot->ticks_total = reading.ticks_total;
+    snapshot->tick_mean_ms = reading.tick_mean_ms;
+    snapshot->tick_max_ms = reading.tick_max_ms;
+    snapshot->tick_jitter_ms = reading.tick_jitter_ms;
+    snapshot->cursor_issued_per_s = reading.cursor_issued_per_s;
+    snapshot->cursor_skipped_per_s = reading.cursor_skipped_per_s;
+    snapshot->log_pending = reading.log_pending;
+    snapshot->log_dropped = reading.log_dropped;
+    snapshot->trace_dropped = reading.trace_dropped;
+    snapshot->latency_overflow = reading.latency_overflow;
+    snapshot->hook_mean_us = reading.hook_mean_us;
+    snapshot->hook_max_us = reading.hook_max_us;
+    snapshot->hook_timeouts = reading.hook_timeouts;
+    snapshot->hook_reinstalls = HealthMonitor_GetReinstalls();
+    snapshot->cpu_percent = reading.cpu_percent;
+
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT && stage < METRICS_TEXT_MAX_STAGES; stage++) {
+        snapshot->latency[stage].stage = LatencyProbe_GetStageName((LatencyStage)stage);
+        LatencyProbe_GetSummary(PERF_MONITOR_READER_METRICS, (LatencyStage)stage,
+                                &snapshot->latency[stage].summary);
+        snapshot->latency_count++;
+    }
+}
+
+static void MetricsServer_Send(SOCKET client, const char* data, size_t length) {
+    while (length > 0) {
+        int sent = send(client, data, (int)length, 0);
+        if (sent <= 0) return;
+        data += sent;
+        length -= (size_t)sent;
+    }
+}
+
+static void MetricsServer_Respond(SOCKET client, const char* status, const char* body,
+                                  size_t length) {
+    int header = sprintf_s(g_metrics_header, sizeof(g_metrics_header),
+                           "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n"
+                           "Connection: close\r\n\r\n",
+                           status, METRICS_TEXT_CONTENT_TYPE, (unsigned int)length);
+    if (header <= 0) return;
+    MetricsServer_Send(client, g_metrics_header, (size_t)header);
+    MetricsServer_Send(client, body, length);
+}
+
+static void MetricsServer_Serve(SOCKET client) {
+    DWORD timeout = METRICS_SERVER_IO_TIMEOUT_MS;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+
+    size_t length = 0;
+    MetricsRequest request = METRICS_REQUEST_INCOMPLETE;
+    while (request == METRICS_REQUEST_INCOMPLETE && length < sizeof(g_metrics_request)) {
+        int received = recv(client, g_metrics_request + length,
+                            (int)(sizeof(g_metrics_request) - length), 0);
+        if (received <= 0) return;
+        length += (size_t)received;
+        request = MetricsText_ParseRequest(g_metrics_request, length);
+    }
+
+    if (request == METRICS_REQUEST_METRICS) {
+        EventTracer_Begin("Metrics scrape");
+        MetricsSnapshot snapshot;
+        MetricsServer_Snapshot(&snapshot);
+        MetricsText text;
+        MetricsText_Initialize(&text, g_metrics_page, sizeof(g_metrics_page));
+        MetricsText_FormatPage(&text, &snapshot);
+        if (text.truncated) {
+            LOG_WARN("Metrics page truncated at %u bytes", (unsigned int)text.length);
+        }
+        MetricsServer_Respond(client, "200 OK", text.data, text.length);
+        EventTracer_End();
+    } else if (request == METRICS_REQUEST_NOT_FOUND) {
+        static const char body[] = "Not found; metrics are at " METRICS_TEXT_PATH "\n";
+        MetricsServer_Respond(client, "404 Not Found", body, sizeof(body) - 1);
+    } else {
+        static const char body[] = "Bad request\n";
+        MetricsServer_Respond(client, "400 Bad Request", body, sizeof(body) - 1);
+    }
+}
+
+static DWORD WINAPI MetricsServer_Thread(LPVOID parameter) {
+    (void)parameter;
+
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+    EventTracer_NameThread("Metrics server");
+
+    // Poll the stop flag between connections
+    while (InterlockedCompareExchange(&g_metrics_stop, 0, 0) == 0) {
+        fd_set ready;
+        FD_ZERO(&ready);
+        FD_SET(g_metrics_socket, &ready);
+        struct timeval wait = {0, 250000};
+        if (select(0, &ready, NULL, NULL, &wait) <= 0) continue;
+
+        SOCKET client = accept(g_metrics_socket, NULL, NULL);
+        if (client == INVALID_SOCKET) continue;
+        MetricsServer_Serve(client);
+        shutdown(client, SD_SEND);
+        closesocket(client);
+    }
+    return 0;
+}
+
+bool MetricsServer_Start(void) {
+    if (g_metrics_thread) return true;
+    if (g_metrics_port < METRICS_SERVER_MIN_PORT || g_metrics_port > 65535) return false;
+
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        LOG_WARN("Metrics endpoint disabled: Winsock unavailable");
+        return false;
+    }
+    g_metrics_winsock = true;
+
+    g_metrics_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (g_metrics_socket == INVALID_SOCKET) {
+        LOG_WARN("Metrics endpoint disabled: socket failed with error %d", WSAGetLastError());
+        MetricsServer_Stop();
+        return false;
+    }
+
+    // Loopback only, and no other process may share the port
+    BOOL exclusive = TRUE;
+    setsockopt(g_metrics_socket, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, (const char*)&exclusive,
+               sizeof(exclusive));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((unsigned short)g_metrics_port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(g_metrics_socket, (const struct sockaddr*)&address, sizeof(address)) == SOCKET_ERROR ||
+        listen(g_metrics_socket, 4) == SOCKET_ERROR) {
+        LOG_WARN("Metrics endpoint disabled: cannot listen on 127.0.0.1:%d (error %d)",
+                 g_metrics_port, WSAGetLastError());
+        MetricsServer_Stop();
+        return false;
+    }
+
+    InterlockedExchange(&g_metrics_stop, 0);
+    g_metrics_thread = CreateThread(NULL, 0, MetricsServer_Thread, NULL, 0, NULL);
+    if (!g_metrics_thread) {
+        LOG_WARN("Metrics endpoint disabled: failed to create server thread: error code %lu",
+                 GetLastError());
+        MetricsServer_Stop();
+        return false;
+    }
+
+    LOG_INFO("Metrics endpoint listening on http://127.0.0.1:%d%s",
+             g_metrics_port, METRICS_TEXT_PATH);
+    return true;
+}
+
+void MetricsServer_Stop(void) {
+    if (g_metrics_thread) {
+        InterlockedExchange(&g_metrics_stop, 1);
+        WaitForSingleObject(g_metrics_thread, INFINITE);
+        CloseHandle(g_metrics_thread);
+        g_metrics_thread = NULL;
+    }
+    if (g_metrics_socket != INVALID_SOCKET) {
+        closesocket(g_metrics_socket);
+        g_metrics_socket = INVALID_SOCKET;
+    }
+    if (g_metrics_winsock) {
+        WSACleanup();
+        g_metrics_winsock = false;
+    }
+}
@@ -0,0 +1,399 @@
+/**
+ * Metrics Text - Prometheus Text Exposition of the Health Figures
+ *
+ * Turns a metrics snapshot into a scrape page, recognizes the one HTTP
+ * request the endpoint answers and checks pages the way a scraper would.
+ * No allocation: pages go into the caller's buffer and the validator
+ * keeps its family table on the stack.
+ */
+
+#include "include/core/metrics_text.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define METRICS_TEXT_MAX_FAMILIES 64
+#define METRICS_TEXT_MAX_NAME 96
+
+void MetricsText_Initialize(MetricsText* text, char* buffer, size_t capacity) {
+    text->data = buffer;
+    text->capacity = capacity;
+    text->length = 0;
+    text->truncated = false;
+    if (buffer && capacity > 0) buffer[0] = '\0';
+}
+
+// Whole lines only: one that does not fit is dropped and marks the page truncated
+static void MetricsText_Append(MetricsText* text, const char* format, ...) {
+    if (text->truncated || !text->data) {
+        text->truncated = true;
+        return;
+    }
+
+    size_t room = text->capacity - text->length;
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(text->data + text->length, room, format, args);
+    va_end(args);
+
+    if (written < 0 || (size_t)written >= room) {
+        text->data[text->length] = '\0';
+        text->truncated = true;
+        return;
+    }
+    text->length += (size_t)written;
+}
+
+static void MetricsText_FormatValue(double value, char* out, size_t size) {
+    if (isnan(value)) {
+        snprintf(out, size, "NaN");
+    } else if (isinf(value)) {
+        snprintf(out, size, value > 0 ? "+Inf" : "-Inf");
+    } else if (value == floor(value) && fabs(value) < 1e15) {
+        snprintf(out, size, "%.0f", value);
+    } else {
+        snprintf(out, size, "%.9g", value);
+    }
+}
+
+void MetricsText_Family(MetricsText* text, const char* name, MetricsType type, const char* help) {
+    static const char* const type_names[] = {"counter", "gauge", "summary"};
+    MetricsText_Append(text, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type_names[type]);
+}
+
+void MetricsText_Sample(MetricsText* text, const char* name, const char* labels, double value) {
+    char number[32];
+    MetricsText_FormatValue(value, number, sizeof(number));
+    if (labels && labels[0]) {
+        MetricsText_Append(text, "%s{%s} %s\n", name, labels, number);
+    } else {
+        MetricsText_Append(text, "%s %s\n", name, number);
+    }
+}
+
+// Label values are lower-case and never need escaping
+static void MetricsText_StageLabel(const char* stage, char* out, size_t size) {
+    size_t i = 0;
+    for (; stage && stage[i] && i + 1 < size; i++) {
+        char c = stage[i];
+        out[i] = isalnum((unsigned char)c) ? (char)tolower((unsigned char)c) : '_';
+    }
+    out[i] = '\0';
+}
+
+static void MetricsText_Latency(MetricsText* text, const MetricsSnapshot* snapshot) {
+    const char* name = "mouse_stabilizer_latency_seconds";
+    static const struct {
+        const char* quantile;
+        size_t offset;
+    } quantiles[] = {
+        {"0.5", offsetof(LatencySummary, p50)},
+        {"0.99", offsetof(LatencySummary, p99)},
+        {"0.999", offsetof(LatencySummary, p999)}
+    };
+
+    MetricsText_Family(text, name, METRICS_TYPE_SUMMARY,
+                       "Input-to-cursor latency per pipeline stage since startup or "
+                       "the last reset");
+    char stage[32], labels[96];
+    for (int s = 0; s < snapshot->latency_count && s < METRICS_TEXT_MAX_STAGES; s++) {
+        const LatencySummary* summary = &snapshot->latency[s].summary;
+        MetricsText_StageLabel(snapshot->latency[s].stage, stage, sizeof(stage));
+        for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++) {
+            uint64_t value_us = *(const uint64_t*)((const char*)summary + quantiles[q].offset);
+            snprintf(labels, sizeof(labels), "stage=\"%s\",quantile=\"%s\"", stage,
+                     quantiles[q].quantile);
+            MetricsText_Sample(text, name, labels,
+                               summary->count > 0 ? (double)value_us / 1e6 : NAN);
+        }
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", stage);
+        MetricsText_Sample(text, "mouse_stabilizer_latency_seconds_sum", labels,
+                           summary->mean * (double)summary->count / 1e6);
+        MetricsText_Sample(text, "mouse_stabilizer_latency_seconds_count",
+                           labels, (double)summary->count);
+    }
+
+    MetricsText_Family(text, "mouse_stabilizer_latency_max_seconds", METRICS_TYPE_GAUGE,
+                       "Largest latency per pipeline stage since startup or the last reset");
+    for (int s = 0; s < snapshot->latency_count && s < METRICS_TEXT_MAX_STAGES; s++) {
+        MetricsText_StageLabel(snapshot->latency[s].stage, stage, sizeof(stage));
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", stage);
+        MetricsText_Sample(text, "mouse_stabilizer_latency_max_seconds", labels,
+                           (double)snapshot->latency[s].summary.max / 1e6);
+    }
+}
+
+static void MetricsText_Single(MetricsText* text, const char* name, MetricsType type,
+                               const char* help, double value) {
+    MetricsText_Family(text, name, type, help);
+    MetricsText_Sample(text, name, NULL, value);
+}
+
+size_t MetricsText_FormatPage(MetricsText* text, const MetricsSnapshot* snapshot) {
+    if (!text || !snapshot) return 0;
+
+    MetricsText_Single(text, "mouse_stabilizer_enabled", METRICS_TYPE_GAUGE,
+                       "1 while the stabilizer is enabled", snapshot->enabled ? 1.0 : 0.0);
+    MetricsText_Single(text, "mouse_stabilizer_input_packets_total", METRICS_TYPE_COUNTER,
+                       "Raw input packets handled", (double)snapshot->packets_total);
+    MetricsText_Single(text, "mouse_stabilizer_input_packets_per_second", METRICS_TYPE_GAUGE,
+                       "Raw input packet rate since the previous scrape", snapshot->packets_per_s);
+    MetricsText_Single(text, "mouse_stabilizer_engine_ticks_total", METRICS_TYPE_COUNTER,
+                       "Engine update ticks", (double)snapshot->ticks_total);
+    MetricsText_Single(text, "mouse_stabilizer_engine_ticks_per_second", METRICS_TYPE_GAUGE,
+                       "Engine update tick rate since the previous scrape", snapshot->steps_per_s);
+    MetricsText_Single(text, "mouse_stabilizer_tick_interval_mean_seconds", METRICS_TYPE_GAUGE,
+                       "Mean measured tick interval since the previous scrape",
+                       snapshot->tick_mean_ms / 1e3);
+    MetricsText_Single(text, "mouse_stabilizer_tick_interval_max_seconds", METRICS_TYPE_GAUGE,
+                       "Longest tick interval since the previous scrape",
+                       snapshot->tick_max_ms / 1e3);
+    MetricsText_Single(text, "mouse_stabilizer_tick_jitter_seconds", METRICS_TYPE_GAUGE,
+                       "Standard deviation of the tick interval since the previous scrape",
+                       snapshot->tick_jitter_ms / 1e3);
+
+    MetricsText_Family(text, "mouse_stabilizer_cursor_writes_per_second", METRICS_TYPE_GAUGE,
+                       "Cursor moves since the previous scrape, by whether they reached the OS");
+    MetricsText_Sample(text, "mouse_stabilizer_cursor_writes_per_second", "result=\"issued\"",
+                       snapshot->cursor_issued_per_s);
+    MetricsText_Sample(text, "mouse_stabilizer_cursor_writes_per_second", "result=\"skipped\"",
+                       snapshot->cursor_skipped_per_s);
+
+    MetricsText_Latency(text, snapshot);
+
+    MetricsText_Single(text, "mouse_stabilizer_log_queue_depth", METRICS_TYPE_GAUGE,
+                       "Log records waiting for the writer thread", (double)snapshot->log_pending);
+    MetricsText_Family(text, "mouse_stabilizer_dropped_total", METRICS_TYPE_COUNTER,
+                       "Records lost because a queue or buffer was full");
+    MetricsText_Sample(text, "mouse_stabilizer_dropped_total",
+                       "source=\"log\"", (double)snapshot->log_dropped);
+    MetricsText_Sample(text, "mouse_stabilizer_dropped_total",
+                       "source=\"trace\"", (double)snapshot->trace_dropped);
+    MetricsText_Sample(text, "mouse_stabilizer_dropped_total", "source=\"latency_probe\"",
+                       (double)snapshot->latency_overflow);
+
+    MetricsText_Single(text, "mouse_stabilizer_hook_duration_mean_seconds", METRICS_TYPE_GAUGE,
+                       "Mean mouse hook callback time since the previous scrape",
+                       snapshot->hook_mean_us / 1e6);
+    MetricsText_Single(text, "mouse_stabilizer_hook_duration_max_seconds", METRICS_TYPE_GAUGE,
+                       "Longest mouse hook callback since the previous scrape",
+                       snapshot->hook_max_us / 1e6);
+    MetricsText_Single(text, "mouse_stabilizer_hook_timeouts_total", METRICS_TYPE_COUNTER,
+                       "Mouse hook callbacks that ran past the system's low-level hook timeout",
+                       (double)snapshot->hook_timeouts);
+    MetricsText_Single(text, "mouse_stabilizer_hook_reinstalls_total", METRICS_TYPE_COUNTER,
+                       "Times the watchdog reinstalled a mouse hook the system had dropped",
+                       (double)snapshot->hook_reinstalls);
+    MetricsText_Single(text, "mouse_stabilizer_process_cpu_ratio", METRICS_TYPE_GAUGE,
+                       "Process CPU time over wall time since the previous scrape, 1 = one core",
+                       snapshot->cpu_percent / 100.0);
+    return text->length;
+}
+
+MetricsRequest MetricsText_ParseRequest(const char* data, size_t length) {
+    if (!data) return METRICS_REQUEST_INCOMPLETE;
+
+    bool complete = false;
+    for (size_t i = 0; i + 1 < length && !complete; i++) {
+        if (data[i] == '\n' && data[i + 1] == '\n') complete = true;
+        if (i + 3 < length && memcmp(data + i, "\r\n\r\n", 4) == 0) complete = true;
+    }
+    if (!complete) return METRICS_REQUEST_INCOMPLETE;
+
+    if (length < 4 || memcmp(data, "GET ", 4) != 0) return METRICS_REQUEST_BAD;
+    const char* path = data + 4;
+    size_t path_length = 0;
+    while (4 + path_length < length && path[path_length] != ' ' && path[path_length] != '\r' &&
+           path[path_length] != '\n') {
+        path_length++;
+    }
+    if (path_length == 0 || path[0] != '/') return METRICS_REQUEST_BAD;
+
+    size_t metrics_length = strlen(METRICS_TEXT_PATH);
+    if (path_length >= metrics_length && memcmp(path, METRICS_TEXT_PATH, metrics_length) == 0 &&
+        (path_length == metrics_length || path[metrics_length] == '?')) {
+        return METRICS_REQUEST_METRICS;
+    }
+    return METRICS_REQUEST_NOT_FOUND;
+}
+
+static bool MetricsText_NameStart(char c) {
+    return isalpha((unsigned char)c) || c == '_' || c == ':';
+}
+
+static bool MetricsText_NameChar(char c) {
+    return isalnum((unsigned char)c) || c == '_' || c == ':';
+}
+
+// Length of the metric name at line, 0 if there is none
+static size_t MetricsText_NameLength(const char* line, size_t length) {
+    if (length == 0 || !MetricsText_NameStart(line[0])) return 0;
+    size_t n = 1;
+    while (n < length && MetricsText_NameChar(line[n])) n++;
+    return n;
+}
+
+// Length of {labels} at line, 0 on a syntax error
+static size_t MetricsText_LabelsLength(const char* line, size_t length) {
+    size_t i = 1;  // Past '{'
+    while (i < length && line[i] != '}') {
+        if (!MetricsText_NameStart(line[i]) || line[i] == ':') return 0;
+        while (i < length && MetricsText_NameChar(line[i]) && line[i] != ':') i++;
+        if (i + 1 >= length || line[i] != '=' || line[i + 1] != '"') return 0;
+        i += 2;
+        while (i < length && line[i] != '"') {
+            if (line[i] == '\\') {
+                if (i + 1 >= length || (line[i + 1] != '\\' && line[i + 1] != '"' &&
+                                        line[i + 1] != 'n')) return 0;
+                i++;
+            }
+            i++;
+        }
+        if (i >= length) return 0;
+        i++;  // Closing quote
+        if (i < length && line[i] == ',') i++;
+    }
+    return i < length ? i + 1 : 0;
+}
+
+static bool MetricsText_IsValue(const char* token, size_t length) {
+    char buffer[64];
+    if (length == 0 || length >= sizeof(buffer)) return false;
+    memcpy(buffer, token, length);
+    buffer[length] = '\0';
+    if (strcmp(buffer, "NaN") == 0 || strcmp(buffer, "+Inf") == 0 ||
+        strcmp(buffer, "-Inf") == 0) return true;
+
+    char* end;
+    strtod(buffer, &end);
+    return end == buffer + length && !isalpha((unsigned char)buffer[0]);
+}
+
+static int MetricsText_Fail(char* error, size_t error_size, int line, const char* problem) {
+    if (error && error_size > 0) snprintf(error, error_size, "line %d: %s", line, problem);
+    return -1;
+}
+
+int MetricsText_Validate(const char* data, size_t length, char* error, size_t error_size) {
+    static const char* const suffixes[] = {"_sum", "_count", "_bucket"};
+    char families[METRICS_TEXT_MAX_FAMILIES][METRICS_TEXT_MAX_NAME];
+    bool grouped[METRICS_TEXT_MAX_FAMILIES];     // Summary or histogram: owns suffixed samples
+    int family_count = 0;
+    int samples = 0;
+    int line_number = 0;
+
+    if (error && error_size > 0) error[0] = '\0';
+    if (!data) return MetricsText_Fail(error, error_size, 0, "no page");
+    if (length > 0 && data[length - 1] != '\n') {
+        return MetricsText_Fail(error, error_size, 0, "page does not end with a newline");
+    }
+
+    size_t position = 0;
+    while (position < length) {
+        const char* line = data + position;
+        size_t line_length = 0;
+        while (position + line_length < length && line[line_length] != '\n') line_length++;
+        position += line_length + 1;
+        line_number++;
+        if (line_length == 0) continue;
+
+        if (line[0] == '#') {
+            bool help = line_length > 7 && memcmp(line, "# HELP ", 7) == 0;
+            bool type = line_length > 7 && memcmp(line, "# TYPE ", 7) == 0;
+            if (!help && !type) continue;  // Plain comment
+
+            const char* name = line + 7;
+            size_t rest = line_length - 7;
+            size_t name_length = MetricsText_NameLength(name, rest);
+            if (name_length == 0 || name_length >= METRICS_TEXT_MAX_NAME) {
+                return MetricsText_Fail(error, error_size, line_number, "bad metric name");
+            }
+            if (help) continue;
+
+            if (name_length + 1 >= rest || name[name_length] != ' ') {
+                return MetricsText_Fail(error, error_size, line_number, "missing type");
+            }
+            const char* kind = name + name_length + 1;
+            size_t kind_length = rest - name_length - 1;
+            static const char* const kinds[] = {
+                "counter", "gauge", "summary", "histogram", "untyped"
+            };
+            int kind_index = -1;
+            for (int k = 0; k < 5; k++) {
+                if (strlen(kinds[k]) == kind_length &&
+                    memcmp(kind, kinds[k], kind_length) == 0) kind_index = k;
+            }
+            if (kind_index < 0) {
+                return MetricsText_Fail(error, error_size, line_number, "unknown type");
+            }
+
+            for (int f = 0; f < family_count; f++) {
+                if (strlen(families[f]) == name_length &&
+                    memcmp(families[f], name, name_length) == 0) {
+                    return MetricsText_Fail(error, error_size, line_number,
+                                            "second # TYPE for a family");
+                }
+            }
+            if (family_count == METRICS_TEXT_MAX_FAMILIES) {
+                return MetricsText_Fail(error, error_size, line_number, "too many families");
+            }
+            memcpy(families[family_count], name, name_length);
+            families[family_count][name_length] = '\0';
+            grouped[family_count] = kind_index == 2 || kind_index == 3;
+            family_count++;
+            continue;
+        }
+
+        size_t name_length = MetricsText_NameLength(line, line_length);
+        if (name_length == 0) {
+            return MetricsText_Fail(error, error_size, line_number, "bad metric name");
+        }
+        size_t i = name_length;
+        if (i < line_length && line[i] == '{') {
+            size_t labels = MetricsText_LabelsLength(line + i, line_length - i);
+            if (labels == 0) return MetricsText_Fail(error, error_size, line_number, "bad labels");
+            i += labels;
+        }
+        if (i >= line_length || line[i] != ' ') {
+            return MetricsText_Fail(error, error_size, line_number, "missing value");
+        }
+        while (i < line_length && line[i] == ' ') i++;
+        size_t value_start = i;
+        while (i < line_length && line[i] != ' ') i++;
+        if (!MetricsText_IsValue(line + value_start, i - value_start)) {
+            return MetricsText_Fail(error, error_size, line_number, "bad value");
+        }
+        while (i < line_length && line[i] == ' ') i++;
+        if (i < line_length) {
+            // Optional timestamp in milliseconds
+            size_t timestamp_start = i;
+            if (line[i] == '-') i++;
+            while (i < line_length && isdigit((unsigned char)line[i])) i++;
+            if (i != line_length || i == timestamp_start) {
+                return MetricsText_Fail(error, error_size, line_number, "bad timestamp");
+            }
+        }
+
+        bool typed = false;
+        for (int f = 0; f < family_count && !typed; f++) {
+            size_t family_length = strlen(families[f]);
+            if (family_length == name_length &&
+                memcmp(families[f], line, name_length) == 0) typed = true;
+            for (int s = 0; s < 3 && grouped[f] && !typed; s++) {
+                size_t suffix_length = strlen(suffixes[s]);
+                typed = family_length + suffix_length == name_length &&
+                        memcmp(families[f], line, family_length) == 0 &&
+                        memcmp(line + family_length, suffixes[s], suffix_length) == 0;
+            }
+        }
+        if (!typed) {
+            return MetricsText_Fail(error, error_size, line_number, "sample without # TYPE");
+        }
+        samples++;
+    }
+    return samples;
+}
@@ -7,8 +7,38 @@
 
 #include "mouse_stabilizer.h"
 
+// Any raw button-down transition; used to decide whether a packet may claim the cursor
+#define RI_BUTTON_DOWN_FLAGS (RI_MOUSE_LEFT_BUTTON_DOWN | RI_MOUSE_RIGHT_BUTTON_DOWN | \
+                              RI_MOUSE_MIDDLE_BUTTON_DOWN | RI_MOUSE_BUTTON_4_DOWN | \
+                              RI_MOUSE_BUTTON_5_DOWN)
+
+DevicePolicy g_device_policy = DEFAULT_DEVICE_POLICY;  // Which device drives the cursor
+
 static bool g_in_stabilizer_update = false;  // Prevent infinite recursion
 static RAWINPUTDEVICE g_rid[1];              // Raw input device registration
+static DeviceTable g_devices = {0};          // Per-device stabilizers keyed by hDevice
+static SmoothStabilizer* g_active_stabilizer = &g_stabilizer;  // Instance driving the cursor
+static HANDLE g_active_device = NULL;        // Device owning the cursor (NULL = default instance)
+static bool g_device_table_full_logged = false;
+static HHOOK g_mouse_hook = NULL;            // WH_MOUSE_LL hook on the message thread
+
+// New devices share the default instance's host bindings, start from the
+// global settings plus any [Device ...] section matching their name, and
+// re-sync to the cursor on first use
+static void MouseInput_InitializeDevice(DeviceEntry* entry) {
+    StabilizerCore_Initialize(&entry->stabilizer, g_stabilizer.platform, g_stabilizer.geometry,
+                              g_stabilizer.output);
+    
+    char name[SETTINGS_DEVICE_NAME_SIZE];
+    UINT length = sizeof(name);
+    if (GetRawInputDeviceInfoA((HANDLE)entry->device, RIDI_DEVICENAME, name, &length) != (UINT)-1 &&
+        Settings_GetDeviceSettings(name, &entry->settings)) {
+        LOG_INFO("Mouse device %p (%s) uses its own settings", entry->device, name);
+    }
+    DeviceTable_ApplySettings(entry, &g_stabilizer);
+    entry->stabilizer.current_pos = g_active_stabilizer->current_pos;
+    entry->stabilizer.target_pos = g_active_stabilizer->current_pos;
+}
 
 bool MouseInput_RegisterRawInput(void) {
     if (!g_hidden_window) {
@@ -18,7 +48,7 @@ bool MouseInput_RegisterRawInput(void) {
     
     g_rid[0].usUsagePage = 0x01;    // HID_USAGE_PAGE_GENERIC
     g_rid[0].usUsage = 0x02;        // HID_USAGE_GENERIC_MOUSE  
-    g_rid[0].dwFlags = RIDEV_INPUTSINK;
+    g_rid[0].dwFlags = RIDEV_INPUTSINK | RIDEV_DEVNOTIFY;  // DEVNOTIFY: WM_INPUT_DEVICE_CHANGE
     g_rid[0].hwndTarget = g_hidden_window;
     
     if (!RegisterRawInputDevices(g_rid, 1, sizeof(g_rid[0]))) {
@@ -31,53 +61,254 @@ bool MouseInput_RegisterRawInput(void) {
     return true;
 }
 
+/**
+ * Translate raw input button transitions into STABILIZER_BUTTON_* bits
+ * Raw input reports physical buttons, so honour the user's primary/secondary swap.
+ */
+static void MouseInput_TranslateButtonFlags(USHORT flags, unsigned int* pressed,
+                                            unsigned int* released) {
+    unsigned int primary = STABILIZER_BUTTON_LEFT;
+    unsigned int secondary = STABILIZER_BUTTON_RIGHT;
+    
+    *pressed = 0;
+    *released = 0;
+    
+    if (flags & (RI_MOUSE_LEFT_BUTTON_DOWN | RI_MOUSE_LEFT_BUTTON_UP |
+                 RI_MOUSE_RIGHT_BUTTON_DOWN | RI_MOUSE_RIGHT_BUTTON_UP)) {
+        if (GetSystemMetrics(SM_SWAPBUTTON)) {
+            primary = STABILIZER_BUTTON_RIGHT;
+            secondary = STABILIZER_BUTTON_LEFT;
+        }
+    }
+    
+    if (flags & RI_MOUSE_LEFT_BUTTON_DOWN)   *pressed |= primary;
+    if (flags & RI_MOUSE_LEFT_BUTTON_UP)     *released |= primary;
+    if (flags & RI_MOUSE_RIGHT_BUTTON_DOWN)  *pressed |= secondary;
+    if (flags & RI_MOUSE_RIGHT_BUTTON_UP)    *released |= secondary;
+    if (flags & RI_MOUSE_MIDDLE_BUTTON_DOWN) *pressed |= STABILIZER_BUTTON_MIDDLE;
+    if (flags & RI_MOUSE_MIDDLE_BUTTON_UP)   *released |= STABILIZER_BUTTON_MIDDLE;
+    if (flags & RI_MOUSE_BUTTON_4_DOWN)      *pressed |= STABILIZER_BUTTON_X1;
+    if (flags & RI_MOUSE_BUTTON_4_UP)        *released |= STABILIZER_BUTTON_X1;
+    if (flags & RI_MOUSE_BUTTON_5_DOWN)      *pressed |= STABILIZER_BUTTON_X2;
+    if (flags & RI_MOUSE_BUTTON_5_UP)        *released |= STABILIZER_BUTTON_X2;
+}
+
+/**
+ * Resolve the stabilizer a device's packets should feed
+ * Devices are added on first sight as well as on arrival, so ones present
+ * before registration work too. Unknown or injected sources (hDevice NULL)
+ * and table overflow fall back to the default instance.
+ */
+static SmoothStabilizer* MouseInput_GetDeviceStabilizer(HANDLE device) {
+    if (g_device_policy == DEVICE_POLICY_MERGE || !device) {
+        return &g_stabilizer;
+    }
+    
+    bool created = false;
+    DeviceEntry* entry = DeviceTable_Insert(&g_devices, device, &created);
+    if (!entry) {
+        if (!g_device_table_full_logged) {
+            LOG_WARN("Device table full (%d devices), extra devices share the default stabilizer",
+                     DEVICE_TABLE_CAPACITY);
+            g_device_table_full_logged = true;
+        }
+        return &g_stabilizer;
+    }
+    
+    if (created) {
+        MouseInput_InitializeDevice(entry);
+    }
+    entry->last_input_time = GetTickCount();
+    return &entry->stabilizer;
+}
+
+/**
+ * Apply the device policy before a device's packet is processed
+ * @return true if the device drives the cursor after the policy decision
+ */
+static bool MouseInput_ClaimCursor(HANDLE device, SmoothStabilizer* stabilizer) {
+    if (stabilizer == g_active_stabilizer) return true;
+    
+    switch (g_device_policy) {
+        case DEVICE_POLICY_FIRST_ACTIVE:
+            // Owner only changes when the owning device goes away
+            if (g_active_device) return false;
+            break;
+        case DEVICE_POLICY_LAST_ACTIVE:
+            // Never steal the cursor in the middle of another device's stroke
+            if (StabilizerCore_IsBusy(g_active_stabilizer)) return false;
+            break;
+        case DEVICE_POLICY_MERGE:
+        default:
+            return true;
+    }
+    
+    StabilizerCore_TakeOver(stabilizer, g_active_stabilizer);
+    g_active_stabilizer = stabilizer;
+    g_active_device = device;
+    LOG_DEBUG("Cursor ownership moved to device %p", (void*)device);
+    return true;
+}
+
 void MouseInput_ProcessRawInput(LPARAM lParam) {
     if (g_in_stabilizer_update) return;
     
-    UINT dwSize = 0;
-    UINT result = GetRawInputData((HRAWINPUT)lParam, RID_INPUT, NULL, &dwSize, sizeof(RAWINPUTHEADER));
+    // Timestamp before any other work so motion estimation sees arrival time
+    uint64_t timestamp_us = Platform_NowMicros(PlatformWin32_Get());
+    
+    // Mouse packets always fit in a RAWINPUT, so no per-packet allocation is needed
+    RAWINPUT raw;
+    UINT dwSize = sizeof(raw);
+    UINT result = GetRawInputData((HRAWINPUT)lParam, RID_INPUT, &raw, &dwSize,
+                                  sizeof(RAWINPUTHEADER));
     
-    if (result != 0) {
-        LOG_WARN("GetRawInputData size query failed: result=%u, error=%lu", result, GetLastError());
+    if (result == (UINT)-1 || result == 0) {
+        LOG_WARN("GetRawInputData failed: result=%u, error=%lu", result, GetLastError());
         return;
     }
     
-    if (dwSize == 0) {
-        LOG_DEBUG("Raw input data size is zero");
-        return;
+    if (raw.header.dwType != RIM_TYPEMOUSE) return;
+    
+    // Our own SendInput output echoes back as raw input; it is not user motion
+    if (raw.data.mouse.ulExtraInformation == OUTPUT_SINK_EXTRA_INFO) return;
+    
+    PerfMonitor_CountPacket();
+    HANDLE device = raw.header.hDevice;
+    unsigned int pressed = 0, released = 0;
+    if (raw.data.mouse.usButtonFlags != 0) {
+        MouseInput_TranslateButtonFlags(raw.data.mouse.usButtonFlags, &pressed, &released);
     }
+    TraceRecorder_RecordPacket(timestamp_us, device, raw.data.mouse.lLastX, raw.data.mouse.lLastY,
+                               pressed, released);
     
-    BYTE* lpb = malloc(dwSize);
-    if (!lpb) {
-        LOG_ERROR("Failed to allocate %u bytes for raw input data", dwSize);
-        return;
+    SmoothStabilizer* stabilizer = MouseInput_GetDeviceStabilizer(device);
+    bool has_motion = raw.data.mouse.lLastX != 0 || raw.data.mouse.lLastY != 0;
+    bool drives_cursor = true;
+    
+    // Only motion or a press can claim the cursor; a stray release never does
+    if (has_motion || (raw.data.mouse.usButtonFlags & RI_BUTTON_DOWN_FLAGS)) {
+        drives_cursor = MouseInput_ClaimCursor(device, stabilizer);
     }
     
-    if (GetRawInputData((HRAWINPUT)lParam, RID_INPUT, lpb, &dwSize, sizeof(RAWINPUTHEADER)) != dwSize) {
-        LOG_WARN("GetRawInputData failed to read expected data size");
-        free(lpb);
-        return;
+    // Movement first: a packet that carries both a move and a press moved the
+    // cursor before the button went down, and the final move of a drag belongs to it
+    if (drives_cursor && g_stabilizer.enabled && has_motion) {
+        g_in_stabilizer_update = true;
+        StabilizerCore_AddMouseDelta(stabilizer, (float)raw.data.mouse.lLastX,
+                                     (float)raw.data.mouse.lLastY, timestamp_us);
+        g_in_stabilizer_update = false;
+        SharedTelemetry_OnPacket(stabilizer, timestamp_us);
+        
+        // Only moves the engine will write are timed; pass-through ones never reach it
+        if (StabilizerCore_IsEngaged(stabilizer)) {
+            LatencyProbe_MarkTarget(timestamp_us);
+        }
     }
     
-    RAWINPUT* raw = (RAWINPUT*)lpb;
+    // Button state is tracked even while disabled or not driving, so it is
+    // accurate when the device takes over or the stabilizer is re-enabled
+    if (pressed || released) {
+        if (drives_cursor) {
+            StabilizerCore_UpdateButtons(stabilizer, pressed, released);
+        } else {
+            StabilizerCore_TrackButtons(stabilizer, pressed, released);
+        }
+    }
+}
+
+void MouseInput_HandleDeviceChange(WPARAM wParam, LPARAM lParam) {
+    HANDLE device = (HANDLE)lParam;
     
-    if (raw->header.dwType == RIM_TYPEMOUSE && g_stabilizer.enabled) {
-        if (raw->data.mouse.lLastX != 0 || raw->data.mouse.lLastY != 0) {
-            g_in_stabilizer_update = true;
-            StabilizerCore_AddMouseDelta(&g_stabilizer, (float)raw->data.mouse.lLastX, (float)raw->data.mouse.lLastY);
-            g_in_stabilizer_update = false;
+    if (wParam == GIDC_ARRIVAL) {
+        if (g_device_policy == DEVICE_POLICY_MERGE) return;
+        
+        bool created = false;
+        DeviceEntry* entry = DeviceTable_Insert(&g_devices, device, &created);
+        if (!entry) {
+            LOG_WARN("Device table full, device %p will share the default stabilizer",
+                     (void*)device);
+        } else if (created) {
+            MouseInput_InitializeDevice(entry);
+            LOG_INFO("Mouse device %p attached (%d tracked)", (void*)device, g_devices.count);
+        }
+    } else if (wParam == GIDC_REMOVAL) {
+        bool was_active = (device == g_active_device);
+        
+        // Hand the cursor back to the default instance before the slot goes away
+        if (was_active) {
+            StabilizerCore_TakeOver(&g_stabilizer, g_active_stabilizer);
+        }
+        
+        if (DeviceTable_Remove(&g_devices, device)) {
+            LOG_INFO("Mouse device %p removed (%d tracked)", (void*)device, g_devices.count);
+        }
+        
+        if (was_active) {
+            g_active_stabilizer = &g_stabilizer;
+            g_active_device = NULL;
+        } else if (g_active_device) {
+            // Backward-shift deletion may have moved the active entry
+            DeviceEntry* active = DeviceTable_Find(&g_devices, g_active_device);
+            g_active_stabilizer = active ? &active->stabilizer : &g_stabilizer;
+            if (!active) g_active_device = NULL;
         }
     }
+}
+
+SmoothStabilizer* MouseInput_GetActiveStabilizer(void) {
+    return g_active_stabilizer;
+}
+
+void MouseInput_SyncDeviceSettings(void) {
+    for (int i = 0; i < DEVICE_TABLE_CAPACITY; i++) {
+        DeviceEntry* entry = &g_devices.entries[i];
+        if (entry->device) {
+            DeviceTable_ApplySettings(entry, &g_stabilizer);
+        }
+    }
+    
+    // Switching to merged input hands the cursor back to the default instance
+    if (g_device_policy == DEVICE_POLICY_MERGE && g_active_stabilizer != &g_stabilizer) {
+        StabilizerCore_TakeOver(&g_stabilizer, g_active_stabilizer);
+        g_active_stabilizer = &g_stabilizer;
+        g_active_device = NULL;
+    }
+}
+
+bool MouseInput_InstallHook(void) {
+    if (g_mouse_hook) return true;
     
-    free(lpb);
+    g_mouse_hook = SetWindowsHookEx(WH_MOUSE_LL, MouseInput_LowLevelMouseProc,
+                                    GetModuleHandle(NULL), 0);
+    return g_mouse_hook != NULL;
+}
+
+void MouseInput_RemoveHook(void) {
+    if (g_mouse_hook) {
+        UnhookWindowsHookEx(g_mouse_hook);
+        g_mouse_hook = NULL;
+    }
+}
+
+bool MouseInput_ReinstallHook(void) {
+    // The old handle may already be dead; unhooking it then just fails
+    MouseInput_RemoveHook();
+    return MouseInput_InstallHook();
 }
 
 LRESULT CALLBACK MouseInput_LowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
-    if (nCode >= 0 && g_stabilizer.enabled && !g_in_stabilizer_update) {
-        if (wParam == WM_MOUSEMOVE) {
+    int64_t enter = PerfMonitor_HookEnter();
+    
+    // Only swallow OS moves while the engine owns the cursor; otherwise pass through untouched
+    if (nCode >= 0 && StabilizerCore_IsEngaged(g_active_stabilizer) && !g_in_stabilizer_update) {
+        const MSLLHOOKSTRUCT* info = (const MSLLHOOKSTRUCT*)lParam;
+        if (wParam == WM_MOUSEMOVE && info->dwExtraInfo != OUTPUT_SINK_EXTRA_INFO) {
+            PerfMonitor_HookLeave(enter);
             return 1;
         }
     }
     
-    return CallNextHookEx(NULL, nCode, wParam, lParam);
+    LRESULT result = CallNextHookEx(NULL, nCode, wParam, lParam);
+    PerfMonitor_HookLeave(enter);
+    return result;
 }
\ No newline at end of file
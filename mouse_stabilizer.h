@@ -6,10 +6,36 @@
 // Resources
 #include "resource.h"
 
-// Core functionality
+// Portable core (builds without windows.h)
+#include "include/core/platform.h"
+#include "include/core/velocity_estimator.h"
+#include "include/core/screen_geometry.h"
+#include "include/core/output_sink.h"
 #include "include/core/stabilizer_core.h"
+#include "include/core/device_table.h"
+#include "include/core/input_trace.h"
+#include "include/core/flight_recorder.h"
+#include "include/core/log_ring.h"
+#include "include/core/binary_log.h"
+#include "include/core/latency_histogram.h"
+#include "include/core/event_trace.h"
+#include "include/core/perf_counters.h"
+#include "include/core/telemetry_block.h"
+#include "include/core/metrics_text.h"
+#include "include/core/hook_watchdog.h"
+
+// Win32 host
+#include "include/core/platform_win32.h"
 #include "include/core/mouse_input.h"
 #include "include/core/hotkey.h"
+#include "include/core/trace_recorder.h"
+#include "include/core/latency_probe.h"
+#include "include/core/event_tracer.h"
+#include "include/core/perf_monitor.h"
+#include "include/core/shared_telemetry.h"
+#include "include/core/metrics_server.h"
+#include "include/core/health_monitor.h"
+#include "include/core/log_sink.h"
 
 // User interface
 #include "include/ui/target_pointer.h"
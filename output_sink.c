@@ -0,0 +1,115 @@
+/**
+ * Output Sink - Cursor Write Layer
+ *
+ * Turns the engine's float cursor path into integer cursor moves. The
+ * rounding error of the leading axis biases the other one along the move,
+ * so slow lines keep their slope without stair steps, a resting cursor
+ * never dithers, and moves that land on the current pixel never reach the OS.
+ */
+
+#include "include/core/output_sink.h"
+
+#include <math.h>
+#include <string.h>
+
+void OutputSink_Initialize(OutputSink* sink, OutputWriteFn write, void* context) {
+    if (!sink) return;
+
+    memset(sink, 0, sizeof(*sink));
+    sink->write = write;
+    sink->context = context;
+}
+
+void OutputSink_Reset(OutputSink* sink) {
+    if (!sink) return;
+
+    sink->has_position = false;
+}
+
+// floorf keeps rounding symmetric on monitors with negative coordinates
+static int OutputSink_Round(float value) {
+    return (int)floorf(value + 0.5f);
+}
+
+// Minor axis pixel for a point on the line; while the leading axis stays on
+// its pixel, a line running along a pixel edge does not flip between the two
+static int OutputSink_Follow(float value, int last, bool same_column) {
+    if (same_column && fabsf(value - (float)last) < 0.5f + OUTPUT_SINK_HYSTERESIS) return last;
+    return OutputSink_Round(value);
+}
+
+bool OutputSink_MoveTo(OutputSink* sink, float x, float y) {
+    if (!sink || !sink->write) return false;
+
+    int new_x, new_y;
+    if (!sink->has_position) {
+        new_x = OutputSink_Round(x);
+        new_y = OutputSink_Round(y);
+    } else {
+        float dx = x - sink->source_x;
+        float dy = y - sink->source_y;
+        if (fabsf(dx) >= fabsf(dy) && dx != 0.0f) {
+            new_x = OutputSink_Round(x);
+            new_y = OutputSink_Follow(y + ((float)new_x - x) * (dy / dx), sink->last_y,
+                                      new_x == sink->last_x);
+        } else if (dy != 0.0f) {
+            new_y = OutputSink_Round(y);
+            new_x = OutputSink_Follow(x + ((float)new_y - y) * (dx / dy), sink->last_x,
+                                      new_y == sink->last_y);
+        } else {
+            new_x = sink->last_x;
+            new_y = sink->last_y;
+        }
+
+        if (new_x == sink->last_x && new_y == sink->last_y) {
+            sink->source_x = x;
+            sink->source_y = y;
+            sink->skipped++;
+            return true;
+        }
+    }
+
+    sink->source_x = x;
+    sink->source_y = y;
+
+    if (!sink->write(sink->context, new_x, new_y)) {
+        // Unknown cursor position now; resync on the next move
+        sink->has_position = false;
+        sink->failed++;
+        return false;
+    }
+
+    sink->has_position = true;
+    sink->last_x = new_x;
+    sink->last_y = new_y;
+    sink->issued++;
+    return true;
+}
+
+void OutputSink_LogStats(const OutputSink* sink, const Platform* platform) {
+    if (!sink) return;
+
+    uint64_t requested = sink->issued + sink->skipped + sink->failed;
+    Platform_Log(platform, LOG_INFO,
+                 "Cursor output: %llu moves requested, %llu issued, %llu skipped (%.1f%%), "
+                 "%llu failed",
+                 (unsigned long long)requested, (unsigned long long)sink->issued,
+                 (unsigned long long)sink->skipped,
+                 requested > 0 ? 100.0 * (double)sink->skipped / (double)requested : 0.0,
+                 (unsigned long long)sink->failed);
+}
+
+bool OutputSink_WriteRecording(void* context, int x, int y) {
+    OutputRecording* recording = (OutputRecording*)context;
+    if (!recording) return false;
+
+    if (recording->count >= OUTPUT_RECORDING_CAPACITY) {
+        recording->dropped++;
+        return true;
+    }
+
+    recording->points[recording->count].x = x;
+    recording->points[recording->count].y = y;
+    recording->count++;
+    return true;
+}
@@ -0,0 +1,72 @@
+/**
+ * Perf Counters - Per-Thread Activity Counters
+ *
+ * Single-writer counter blocks that readers sum on demand. Writers never
+ * use a locked instruction except to raise a maximum, which only happens
+ * when a new peak is seen.
+ */
+
+#include "include/core/perf_counters.h"
+
+#include <string.h>
+
+void PerfCounters_Initialize(PerfCounterBlock* block) {
+    if (!block) return;
+    memset(block, 0, sizeof(*block));
+}
+
+void PerfCounters_Add(PerfCounterBlock* block, PerfCount counter, uint64_t value) {
+    if (!block || counter < 0 || counter >= PERF_COUNT_COUNT) return;
+
+    uint64_t* slot = &block->counts[counter];
+    __atomic_store_n(slot, __atomic_load_n(slot, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+void PerfCounters_Max(PerfCounterBlock* block, PerfMax maximum, uint64_t value) {
+    if (!block || maximum < 0 || maximum >= PERF_MAX_COUNT) return;
+
+    // Readers swap their slot back to zero, so raising it needs a compare-and-swap
+    for (int reader = 0; reader < PERF_COUNTER_READERS; reader++) {
+        uint64_t* slot = &block->maxima[reader][maximum];
+        uint64_t current = __atomic_load_n(slot, __ATOMIC_RELAXED);
+        while (value > current &&
+               !__atomic_compare_exchange_n(slot, &current, value, true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+void PerfCounters_MarkTick(PerfCounterBlock* block, uint64_t now_us) {
+    if (!block) return;
+
+    PerfCounters_Add(block, PERF_COUNT_TICKS, 1);
+    if (block->last_tick_us != 0 && now_us > block->last_tick_us) {
+        uint64_t interval = now_us - block->last_tick_us;
+        PerfCounters_Add(block, PERF_COUNT_TICK_INTERVAL, interval);
+        PerfCounters_Add(block, PERF_COUNT_TICK_INTERVALS, 1);
+        PerfCounters_Add(block, PERF_COUNT_TICK_SQUARES, interval * interval);
+        PerfCounters_Max(block, PERF_MAX_TICK_INTERVAL, interval);
+    }
+    block->last_tick_us = now_us;
+}
+
+void PerfCounters_Collect(PerfCounterBlock* const* blocks, int count, int reader,
+                          PerfCounterSample* sample) {
+    if (!sample) return;
+
+    memset(sample, 0, sizeof(*sample));
+    if (!blocks || reader < 0 || reader >= PERF_COUNTER_READERS) return;
+
+    for (int i = 0; i < count; i++) {
+        PerfCounterBlock* block = blocks[i];
+        if (!block) continue;
+
+        for (int c = 0; c < PERF_COUNT_COUNT; c++) {
+            sample->counts[c] += __atomic_load_n(&block->counts[c], __ATOMIC_RELAXED);
+        }
+        for (int m = 0; m < PERF_MAX_COUNT; m++) {
+            uint64_t value = __atomic_exchange_n(&block->maxima[reader][m], 0, __ATOMIC_RELAXED);
+            if (value > sample->maxima[m]) sample->maxima[m] = value;
+        }
+    }
+}
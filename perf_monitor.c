@@ -0,0 +1,223 @@
+/**
+ * Perf Monitor - Live Activity Counters for the Win32 Host
+ *
+ * Hands each counting thread its own counter block through a TLS slot and
+ * turns the blocks, the cursor sink's counters and the process CPU time
+ * into per-second figures when a reader asks. Counting is a TLS lookup
+ * and a plain store; nothing is summed while no reader is looking.
+ */
+
+#include "mouse_stabilizer.h"
+
+#include <stdlib.h>
+
+typedef struct {
+    PerfCounterSample sample;
+    uint64_t time_us;
+    uint64_t cursor_issued;
+    uint64_t cursor_skipped;
+    uint64_t cpu_100ns;
+} PerfMonitor_ReaderState;
+
+static PerfCounterBlock g_perf_blocks[PERF_MONITOR_THREADS];
+static PerfCounterBlock* g_perf_block_list[PERF_MONITOR_THREADS];
+static volatile LONG g_perf_claimed = 0;
+static DWORD g_perf_tls = TLS_OUT_OF_INDEXES;
+static LARGE_INTEGER g_perf_frequency = {0};
+static PerfMonitor_ReaderState g_perf_readers[PERF_COUNTER_READERS];
+static uint32_t g_perf_hook_timeout_ms = PERF_MONITOR_HOOK_TIMEOUT_MS;
+static uint64_t g_perf_hook_timeout_ns = PERF_MONITOR_HOOK_TIMEOUT_MS * 1000000ull;
+
+static uint64_t PerfMonitor_ProcessCpu(void) {
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0;
+
+    uint64_t kernel_time = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+    uint64_t user_time = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+    return kernel_time + user_time;
+}
+
+// HKCU\Control Panel\Desktop\LowLevelHooksTimeout, stored as a string or a DWORD
+static uint32_t PerfMonitor_ReadHookTimeout(void) {
+    HKEY key;
+    if (RegOpenKeyEx(HKEY_CURRENT_USER, "Control Panel\\Desktop",
+                     0, KEY_QUERY_VALUE, &key) != ERROR_SUCCESS) {
+        return PERF_MONITOR_HOOK_TIMEOUT_MS;
+    }
+
+    char data[32] = "";
+    DWORD type = 0, size = sizeof(data) - 1;
+    uint32_t timeout_ms = PERF_MONITOR_HOOK_TIMEOUT_MS;
+    if (RegQueryValueEx(key, "LowLevelHooksTimeout",
+                        NULL, &type, (LPBYTE)data, &size) == ERROR_SUCCESS) {
+        if (type == REG_DWORD && size == sizeof(DWORD)) {
+            memcpy(&timeout_ms, data, sizeof(DWORD));
+        } else if (type == REG_SZ) {
+            timeout_ms = (uint32_t)strtoul(data, NULL, 10);
+        }
+    }
+    RegCloseKey(key);
+
+    if (timeout_ms == 0) timeout_ms = PERF_MONITOR_HOOK_TIMEOUT_MS;
+    if (timeout_ms > PERF_MONITOR_HOOK_TIMEOUT_MAX_MS) {
+        timeout_ms = PERF_MONITOR_HOOK_TIMEOUT_MAX_MS;
+    }
+    return timeout_ms;
+}
+
+// The sink counters are written on the message thread; read them whole from any thread
+static uint64_t PerfMonitor_Load(uint64_t* value) {
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)value, 0, 0);
+}
+
+bool PerfMonitor_Initialize(void) {
+    if (g_perf_tls != TLS_OUT_OF_INDEXES) return true;
+
+    g_perf_tls = TlsAlloc();
+    if (g_perf_tls == TLS_OUT_OF_INDEXES) {
+        LOG_ERROR("Failed to allocate performance counter TLS slot: error code %lu",
+                  GetLastError());
+        return false;
+    }
+    QueryPerformanceFrequency(&g_perf_frequency);
+    g_perf_hook_timeout_ms = PerfMonitor_ReadHookTimeout();
+    g_perf_hook_timeout_ns = (uint64_t)g_perf_hook_timeout_ms * 1000000ull;
+
+    for (int i = 0; i < PERF_MONITOR_THREADS; i++) {
+        PerfCounters_Initialize(&g_perf_blocks[i]);
+        g_perf_block_list[i] = &g_perf_blocks[i];
+    }
+
+    uint64_t now_us = Platform_NowMicros(PlatformWin32_Get());
+    uint64_t cpu = PerfMonitor_ProcessCpu();
+    for (int reader = 0; reader < PERF_COUNTER_READERS; reader++) {
+        memset(&g_perf_readers[reader], 0, sizeof(g_perf_readers[reader]));
+        g_perf_readers[reader].time_us = now_us;
+        g_perf_readers[reader].cpu_100ns = cpu;
+    }
+    return true;
+}
+
+// TLS value: block index + 1, or PERF_MONITOR_THREADS + 1 once none was left
+static PerfCounterBlock* PerfMonitor_ThreadBlock(void) {
+    if (g_perf_tls == TLS_OUT_OF_INDEXES) return NULL;
+
+    uintptr_t tag = (uintptr_t)TlsGetValue(g_perf_tls);
+    if (tag != 0) {
+        return tag <= PERF_MONITOR_THREADS ? &g_perf_blocks[tag - 1] : NULL;
+    }
+
+    LONG index = InterlockedIncrement(&g_perf_claimed) - 1;
+    if (index >= PERF_MONITOR_THREADS) {
+        TlsSetValue(g_perf_tls, (LPVOID)(uintptr_t)(PERF_MONITOR_THREADS + 1));
+        return NULL;
+    }
+    TlsSetValue(g_perf_tls, (LPVOID)(uintptr_t)(index + 1));
+    return &g_perf_blocks[index];
+}
+
+void PerfMonitor_CountPacket(void) {
+    PerfCounters_Add(PerfMonitor_ThreadBlock(), PERF_COUNT_PACKETS, 1);
+}
+
+void PerfMonitor_CountTick(uint64_t start_us) {
+    PerfCounters_MarkTick(PerfMonitor_ThreadBlock(), start_us);
+}
+
+int64_t PerfMonitor_HookEnter(void) {
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+void PerfMonitor_HookLeave(int64_t enter) {
+    PerfCounterBlock* block = PerfMonitor_ThreadBlock();
+    if (!block || g_perf_frequency.QuadPart == 0) return;
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    uint64_t elapsed = counter.QuadPart > enter ? (uint64_t)(counter.QuadPart - enter) : 0;
+    uint64_t elapsed_ns = elapsed * 1000000000ull / (uint64_t)g_perf_frequency.QuadPart;
+
+    PerfCounters_Add(block, PERF_COUNT_HOOK_CALLS, 1);
+    PerfCounters_Add(block, PERF_COUNT_HOOK_TIME, elapsed_ns);
+    PerfCounters_Max(block, PERF_MAX_HOOK_TIME, elapsed_ns);
+    if (elapsed_ns >= g_perf_hook_timeout_ns) {
+        PerfCounters_Add(block, PERF_COUNT_HOOK_TIMEOUTS, 1);
+    }
+}
+
+uint32_t PerfMonitor_GetHookTimeoutMs(void) {
+    return g_perf_hook_timeout_ms;
+}
+
+// Per second over the interval, from cumulative totals
+static double PerfMonitor_Rate(uint64_t current, uint64_t previous, double seconds) {
+    return current > previous && seconds > 0.0 ? (double)(current - previous) / seconds : 0.0;
+}
+
+void PerfMonitor_Read(int reader, PerfMonitorReading* reading) {
+    if (!reading) return;
+
+    memset(reading, 0, sizeof(*reading));
+    if (reader < 0 || reader >= PERF_COUNTER_READERS || g_perf_tls == TLS_OUT_OF_INDEXES) return;
+
+    PerfMonitor_ReaderState* state = &g_perf_readers[reader];
+    PerfMonitor_ReaderState now;
+    PerfCounters_Collect(g_perf_block_list, PERF_MONITOR_THREADS, reader, &now.sample);
+    now.time_us = Platform_NowMicros(PlatformWin32_Get());
+    now.cursor_issued = PerfMonitor_Load(&g_output_sink.issued);
+    now.cursor_skipped = PerfMonitor_Load(&g_output_sink.skipped);
+    now.cpu_100ns = PerfMonitor_ProcessCpu();
+
+    const uint64_t* counts = now.sample.counts;
+    const uint64_t* before = state->sample.counts;
+    double seconds = 0.0;
+    if (now.time_us > state->time_us) seconds = (double)(now.time_us - state->time_us) / 1e6;
+    reading->seconds = seconds;
+    reading->packets_per_s = PerfMonitor_Rate(counts[PERF_COUNT_PACKETS],
+                                              before[PERF_COUNT_PACKETS], seconds);
+    reading->steps_per_s = PerfMonitor_Rate(counts[PERF_COUNT_TICKS], before[PERF_COUNT_TICKS],
+                                            seconds);
+
+    uint64_t intervals = counts[PERF_COUNT_TICK_INTERVALS] - before[PERF_COUNT_TICK_INTERVALS];
+    if (intervals > 0) {
+        uint64_t total = counts[PERF_COUNT_TICK_INTERVAL] - before[PERF_COUNT_TICK_INTERVAL];
+        uint64_t squares = counts[PERF_COUNT_TICK_SQUARES] - before[PERF_COUNT_TICK_SQUARES];
+        double mean_us = (double)total / (double)intervals;
+        double mean_square = (double)squares / (double)intervals;
+        double variance = mean_square - mean_us * mean_us;
+        reading->tick_mean_ms = mean_us / 1000.0;
+        reading->tick_jitter_ms = variance > 0.0 ? sqrt(variance) / 1000.0 : 0.0;
+    }
+    reading->packets_total = counts[PERF_COUNT_PACKETS];
+    reading->ticks_total = counts[PERF_COUNT_TICKS];
+    reading->tick_max_ms = (double)now.sample.maxima[PERF_MAX_TICK_INTERVAL] / 1000.0;
+
+    reading->cursor_issued_per_s = PerfMonitor_Rate(now.cursor_issued, state->cursor_issued,
+                                                    seconds);
+    reading->cursor_skipped_per_s = PerfMonitor_Rate(now.cursor_skipped, state->cursor_skipped,
+                                                     seconds);
+
+    reading->hook_calls = counts[PERF_COUNT_HOOK_CALLS] - before[PERF_COUNT_HOOK_CALLS];
+    if (reading->hook_calls > 0) {
+        uint64_t hook_time = counts[PERF_COUNT_HOOK_TIME] - before[PERF_COUNT_HOOK_TIME];
+        reading->hook_mean_us = (double)hook_time / (double)reading->hook_calls / 1000.0;
+    }
+    reading->hook_max_us = (double)now.sample.maxima[PERF_MAX_HOOK_TIME] / 1000.0;
+    reading->hook_timeouts = counts[PERF_COUNT_HOOK_TIMEOUTS];
+
+    // FILETIME counts 100 ns units: one core busy for a second is 1e7, i.e. 100%
+    if (seconds > 0.0 && now.cpu_100ns >= state->cpu_100ns) {
+        reading->cpu_percent = (double)(now.cpu_100ns - state->cpu_100ns) / (seconds * 1e5);
+    }
+
+    TraceRecorderStats trace;
+    TraceRecorder_GetStats(&trace);
+    reading->trace_dropped = trace.dropped;
+    reading->latency_overflow = LatencyProbe_GetOverflow();
+    reading->log_pending = Settings_GetLogPending();
+    reading->log_dropped = Settings_GetLogDropped();
+
+    *state = now;
+}
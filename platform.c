@@ -0,0 +1,62 @@
+/**
+ * Platform - Core Host Interface
+ *
+ * Forwards core requests to the platform an instance was created with.
+ * Every wrapper has a safe answer for a missing platform or callback, so
+ * the core can be driven by a bare test harness.
+ */
+
+#include "include/core/platform.h"
+
+#include <stddef.h>
+
+// Host convenience for the LOG_* macros; the engine never reads it
+static const Platform* g_default_platform = NULL;
+
+void Platform_SetDefault(const Platform* platform) {
+    g_default_platform = platform;
+}
+
+const Platform* Platform_GetDefault(void) {
+    return g_default_platform;
+}
+
+uint64_t Platform_NowMicros(const Platform* platform) {
+    if (!platform || !platform->now_us) return 0;
+    return platform->now_us(platform->context);
+}
+
+bool Platform_GetCursor(const Platform* platform, int* x, int* y) {
+    if (!x || !y || !platform || !platform->get_cursor) return false;
+    return platform->get_cursor(platform->context, x, y);
+}
+
+int Platform_QueryMonitors(const Platform* platform, ScreenRect* monitors, int max) {
+    if (!monitors || max <= 0 || !platform || !platform->query_monitors) return 0;
+
+    int count = platform->query_monitors(platform->context, monitors, max);
+    if (count < 0) return 0;
+    return count > max ? max : count;
+}
+
+void Platform_Log(const Platform* platform, LogLevel level, const char* format, ...) {
+    if (!format || !platform || !platform->log) return;
+
+    va_list args;
+    va_start(args, format);
+    platform->log(platform->context, level, format, args);
+    va_end(args);
+}
+
+void Platform_LogSite(const Platform* platform, LogSite* site, const char* format, ...) {
+    if (!site || !format || !platform) return;
+
+    va_list args;
+    va_start(args, format);
+    if (platform->log_site) {
+        platform->log_site(platform->context, site, args);
+    } else if (platform->log) {
+        platform->log(platform->context, site->level, format, args);
+    }
+    va_end(args);
+}
@@ -0,0 +1,180 @@
+/**
+ * Platform Win32 - Core Host Interface for Windows
+ *
+ * Backs the portable core with QueryPerformanceCounter, GetCursorPos,
+ * EnumDisplayMonitors and the settings log file, and provides the
+ * SetCursorPos / SendInput writers for the output sink.
+ */
+
+#include "mouse_stabilizer.h"
+
+OutputMode g_output_mode = DEFAULT_OUTPUT_MODE;
+ScreenGeometry g_screen_geometry = {0};
+OutputSink g_output_sink = {0};
+
+static uint64_t PlatformWin32_NowMicros(void* context) {
+    (void)context;
+
+    static LARGE_INTEGER frequency = {0};
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0 && !QueryPerformanceFrequency(&frequency)) {
+        return (uint64_t)GetTickCount64() * 1000;
+    }
+
+    QueryPerformanceCounter(&counter);
+
+    // Split to avoid overflowing counter * 1e6
+    uint64_t seconds = (uint64_t)(counter.QuadPart / frequency.QuadPart);
+    uint64_t remainder = (uint64_t)(counter.QuadPart % frequency.QuadPart);
+    return seconds * 1000000 + remainder * 1000000 / (uint64_t)frequency.QuadPart;
+}
+
+static bool PlatformWin32_GetCursor(void* context, int* x, int* y) {
+    (void)context;
+
+    POINT cursor;
+    if (!GetCursorPos(&cursor)) {
+        LOG_WARN("GetCursorPos failed: error code %lu", GetLastError());
+        return false;
+    }
+    *x = cursor.x;
+    *y = cursor.y;
+    return true;
+}
+
+typedef struct {
+    ScreenRect* monitors;
+    int max;
+    int count;
+} PlatformWin32_MonitorList;
+
+static BOOL CALLBACK PlatformWin32_EnumMonitor(HMONITOR monitor, HDC hdc, LPRECT rect,
+                                               LPARAM lParam) {
+    (void)monitor;
+    (void)hdc;
+
+    PlatformWin32_MonitorList* list = (PlatformWin32_MonitorList*)lParam;
+    if (list->count >= list->max) return FALSE;
+
+    ScreenRect* out = &list->monitors[list->count++];
+    out->left = rect->left;
+    out->top = rect->top;
+    out->right = rect->right;
+    out->bottom = rect->bottom;
+    return TRUE;
+}
+
+static int PlatformWin32_QueryMonitors(void* context, ScreenRect* monitors, int max) {
+    (void)context;
+
+    PlatformWin32_MonitorList list = {monitors, max, 0};
+    EnumDisplayMonitors(NULL, NULL, PlatformWin32_EnumMonitor, (LPARAM)&list);
+
+    if (list.count == 0) {
+        LOG_WARN("Monitor enumeration failed: error code %lu, using primary screen size",
+                 GetLastError());
+        monitors[0].left = 0;
+        monitors[0].top = 0;
+        monitors[0].right = GetSystemMetrics(SM_CXSCREEN);
+        monitors[0].bottom = GetSystemMetrics(SM_CYSCREEN);
+        return 1;
+    }
+    return list.count;
+}
+
+static void PlatformWin32_Log(void* context, LogLevel level, const char* format, va_list args) {
+    (void)context;
+    Settings_WriteLogLevelV(level, format, args);
+}
+
+static void PlatformWin32_LogSite(void* context, LogSite* site, va_list args) {
+    (void)context;
+    Settings_WriteLogSiteV(site, args);
+}
+
+static const Platform g_platform_win32 = {
+    NULL,
+    PlatformWin32_NowMicros,
+    PlatformWin32_GetCursor,
+    PlatformWin32_QueryMonitors,
+    PlatformWin32_Log,
+    PlatformWin32_LogSite,
+    &g_log_level
+};
+
+const Platform* PlatformWin32_Get(void) {
+    return &g_platform_win32;
+}
+
+void PlatformWin32_Install(void) {
+    Platform_SetDefault(&g_platform_win32);
+}
+
+void PlatformWin32_SetOutputMode(OutputMode mode) {
+    if (mode == OUTPUT_MODE_SEND_INPUT) {
+        g_output_sink.write = PlatformWin32_WriteSendInput;
+    } else {
+        mode = OUTPUT_MODE_SET_CURSOR_POS;
+        g_output_sink.write = PlatformWin32_WriteSetCursorPos;
+    }
+    g_output_sink.context = NULL;
+    g_output_mode = mode;
+    OutputSink_Reset(&g_output_sink);
+
+    LOG_INFO("Cursor output mode: %s",
+             mode == OUTPUT_MODE_SEND_INPUT ? "SendInput" : "SetCursorPos");
+}
+
+bool PlatformWin32_WriteSetCursorPos(void* context, int x, int y) {
+    (void)context;
+
+    LatencyProbe_MarkOutput();
+    EventTracer_Begin("SetCursorPos");
+    BOOL written = SetCursorPos(x, y);
+    EventTracer_End();
+    if (!written) {
+        LOG_WARN("Failed to set cursor position to (%d, %d): error code %lu", x, y, GetLastError());
+        return false;
+    }
+    LatencyProbe_MarkWritten();
+    return true;
+}
+
+bool PlatformWin32_WriteSendInput(void* context, int x, int y) {
+    (void)context;
+
+    LatencyProbe_MarkOutput();
+
+    // Absolute coordinates are normalized to 0..65535 across the virtual desktop
+    ScreenRect desktop = g_screen_geometry.bounds;
+    if (desktop.right <= desktop.left || desktop.bottom <= desktop.top) {
+        desktop.left = GetSystemMetrics(SM_XVIRTUALSCREEN);
+        desktop.top = GetSystemMetrics(SM_YVIRTUALSCREEN);
+        desktop.right = desktop.left + GetSystemMetrics(SM_CXVIRTUALSCREEN);
+        desktop.bottom = desktop.top + GetSystemMetrics(SM_CYVIRTUALSCREEN);
+    }
+
+    int64_t span_x = desktop.right - desktop.left - 1;
+    int64_t span_y = desktop.bottom - desktop.top - 1;
+    if (span_x < 1) span_x = 1;
+    if (span_y < 1) span_y = 1;
+
+    INPUT input = {0};
+    input.type = INPUT_MOUSE;
+    input.mi.dx = (LONG)(((int64_t)(x - desktop.left) * 65535 + span_x / 2) / span_x);
+    input.mi.dy = (LONG)(((int64_t)(y - desktop.top) * 65535 + span_y / 2) / span_y);
+    input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
+    input.mi.dwExtraInfo = OUTPUT_SINK_EXTRA_INFO;
+
+    EventTracer_Begin("SendInput");
+    UINT sent = SendInput(1, &input, sizeof(input));
+    EventTracer_End();
+    if (sent != 1) {
+        LOG_WARN("SendInput failed for cursor position (%d, %d): error code %lu",
+                 x, y, GetLastError());
+        return false;
+    }
+    LatencyProbe_MarkWritten();
+    return true;
+}
@@ -0,0 +1,118 @@
+/**
+ * Screen Geometry - Cached Monitor Layout
+ *
+ * Keeps the rectangle of every monitor so target clamping is a short scan
+ * over cached data instead of GetSystemMetrics calls on every packet, and
+ * so the target can travel across every monitor instead of the primary only.
+ */
+
+#include "include/core/screen_geometry.h"
+
+#include <string.h>
+
+static bool ScreenGeometry_Contains(const ScreenRect* rect, float x, float y) {
+    return x >= (float)rect->left && x <= (float)(rect->right - 1) &&
+           y >= (float)rect->top && y <= (float)(rect->bottom - 1);
+}
+
+static float ScreenGeometry_ClampAxis(float value, int low, int high_exclusive) {
+    if (value < (float)low) return (float)low;
+    if (value > (float)(high_exclusive - 1)) return (float)(high_exclusive - 1);
+    return value;
+}
+
+void ScreenGeometry_SetMonitors(ScreenGeometry* geometry, const ScreenRect* monitors, int count) {
+    if (!geometry) return;
+
+    if (count > SCREEN_GEOMETRY_MAX_MONITORS) count = SCREEN_GEOMETRY_MAX_MONITORS;
+    if (count < 0 || !monitors) count = 0;
+
+    geometry->monitor_count = 0;
+    for (int i = 0; i < count; i++) {
+        // Skip empty rectangles so every cached monitor has at least one pixel
+        if (monitors[i].right <= monitors[i].left ||
+            monitors[i].bottom <= monitors[i].top) continue;
+        geometry->monitors[geometry->monitor_count++] = monitors[i];
+    }
+
+    if (geometry->monitor_count == 0) {
+        memset(&geometry->bounds, 0, sizeof(geometry->bounds));
+        return;
+    }
+
+    geometry->bounds = geometry->monitors[0];
+    for (int i = 1; i < geometry->monitor_count; i++) {
+        const ScreenRect* rect = &geometry->monitors[i];
+        if (rect->left < geometry->bounds.left) geometry->bounds.left = rect->left;
+        if (rect->top < geometry->bounds.top) geometry->bounds.top = rect->top;
+        if (rect->right > geometry->bounds.right) geometry->bounds.right = rect->right;
+        if (rect->bottom > geometry->bounds.bottom) geometry->bounds.bottom = rect->bottom;
+    }
+}
+
+bool ScreenGeometry_Refresh(ScreenGeometry* geometry, const Platform* platform) {
+    if (!geometry) {
+        Platform_Log(platform, LOG_ERROR, "ScreenGeometry_Refresh: null geometry parameter");
+        return false;
+    }
+
+    ScreenRect monitors[SCREEN_GEOMETRY_MAX_MONITORS];
+    int count = Platform_QueryMonitors(platform, monitors, SCREEN_GEOMETRY_MAX_MONITORS);
+
+    if (count == 0) {
+        Platform_Log(platform, LOG_WARN, "Platform reported no monitors, keeping previous layout");
+        return false;
+    }
+
+    ScreenGeometry_SetMonitors(geometry, monitors, count);
+
+    Platform_Log(platform, LOG_INFO,
+                 "Monitor layout cached: %d monitor(s), desktop (%d, %d)-(%d, %d)",
+                 geometry->monitor_count, geometry->bounds.left, geometry->bounds.top,
+                 geometry->bounds.right, geometry->bounds.bottom);
+    for (int i = 0; i < geometry->monitor_count; i++) {
+        Platform_Log(platform, LOG_DEBUG, "  Monitor %d: (%d, %d)-(%d, %d)", i,
+                  geometry->monitors[i].left, geometry->monitors[i].top,
+                  geometry->monitors[i].right, geometry->monitors[i].bottom);
+    }
+    return true;
+}
+
+void ScreenGeometry_Clamp(const ScreenGeometry* geometry, int* hint, float* x, float* y) {
+    if (!geometry || !x || !y || geometry->monitor_count == 0) return;
+
+    // Fast path: still on the monitor that held the previous point
+    if (hint && *hint >= 0 && *hint < geometry->monitor_count &&
+        ScreenGeometry_Contains(&geometry->monitors[*hint], *x, *y)) {
+        return;
+    }
+
+    for (int i = 0; i < geometry->monitor_count; i++) {
+        if (ScreenGeometry_Contains(&geometry->monitors[i], *x, *y)) {
+            if (hint) *hint = i;
+            return;
+        }
+    }
+
+    // Off-desktop or in a gap between monitors: snap to the closest monitor
+    int best = 0;
+    float best_x = *x;
+    float best_y = *y;
+    float best_distance = -1.0f;
+    for (int i = 0; i < geometry->monitor_count; i++) {
+        const ScreenRect* rect = &geometry->monitors[i];
+        float cx = ScreenGeometry_ClampAxis(*x, rect->left, rect->right);
+        float cy = ScreenGeometry_ClampAxis(*y, rect->top, rect->bottom);
+        float distance = (cx - *x) * (cx - *x) + (cy - *y) * (cy - *y);
+        if (best_distance < 0.0f || distance < best_distance) {
+            best = i;
+            best_x = cx;
+            best_y = cy;
+            best_distance = distance;
+        }
+    }
+
+    if (hint) *hint = best;
+    *x = best_x;
+    *y = best_y;
+}
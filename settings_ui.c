@@ -108,6 +108,11 @@ void SettingsUI_ShowWindow(void) {
     LOG_DEBUG("Showing settings window");
     ShowWindow(g_settings_window, SW_SHOW);
     SetForegroundWindow(g_settings_window);
+    if (g_current_tab == TAB_DEBUG) {
+        SettingsUI_UpdateLatency();
+        SettingsUI_UpdatePerf();
+        SetTimer(g_settings_window, LATENCY_REFRESH_TIMER_ID, LATENCY_REFRESH_INTERVAL_MS, NULL);
+    }
     LOG_DEBUG("Settings window shown successfully");
 }
 
@@ -162,6 +167,7 @@ void SettingsUI_AddTooltip(HWND control, const char* text) {
 void SettingsUI_HideWindow(void) {
     if (g_settings_window) {
         ShowWindow(g_settings_window, SW_HIDE);
+        KillTimer(g_settings_window, LATENCY_REFRESH_TIMER_ID);
         LOG_DEBUG("Settings window hidden");
     }
 }
@@ -351,6 +357,77 @@ bool SettingsUI_CreateBasicTab(HWND hwnd) {
     SettingsUI_ApplyFont(control);
     SettingsUI_AddTooltip(control, "Adapt stabilization based on mouse movement velocity");
     
+    y_pos += CONTROL_SPACING;
+    
+    // Drag-only Mode
+    control = CreateWindow("BUTTON", "Smooth only while dragging",
+                           WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX, x_label, y_pos,
+                           LABEL_WIDTH + CONTROL_WIDTH, CONTROL_HEIGHT, parent,
+                           (HMENU)IDC_DRAG_ONLY_CHECK, GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create Drag Only checkbox");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    SettingsUI_AddTooltip(control, "Pass the cursor through with no added latency unless the drag "
+                          "button is held");
+    
+    y_pos += CONTROL_SPACING;
+    
+    // Drag Button
+    control = CreateWindow("STATIC", "Drag Button:", WS_CHILD | WS_VISIBLE,
+        x_label, y_pos + 5, LABEL_WIDTH, CONTROL_HEIGHT, parent, NULL, GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create Drag Button label");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    
+    HWND drag_combo = CreateWindow("COMBOBOX", NULL,
+        WS_CHILD | WS_VISIBLE | CBS_DROPDOWNLIST,
+        x_control, y_pos, CONTROL_WIDTH, 120, parent, (HMENU)IDC_DRAG_BUTTON_COMBO,
+        GetModuleHandle(NULL), NULL);
+    if (!drag_combo) {
+        LOG_ERROR("Failed to create Drag Button combo");
+        return false;
+    }
+    SettingsUI_ApplyFont(drag_combo);
+    SettingsUI_AddTooltip(drag_combo, "Button that engages smoothing in drag-only mode");
+    
+    // Populate drag button combo
+    ComboBox_AddString(drag_combo, "Left");
+    ComboBox_AddString(drag_combo, "Right");
+    ComboBox_AddString(drag_combo, "Middle");
+    ComboBox_AddString(drag_combo, "Any");
+    
+    y_pos += CONTROL_SPACING;
+    
+    // Multiple Devices
+    control = CreateWindow("STATIC", "Multiple Mice:", WS_CHILD | WS_VISIBLE,
+        x_label, y_pos + 5, LABEL_WIDTH, CONTROL_HEIGHT, parent, NULL, GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create Device Policy label");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    
+    HWND policy_combo = CreateWindow("COMBOBOX", NULL,
+        WS_CHILD | WS_VISIBLE | CBS_DROPDOWNLIST,
+        x_control, y_pos, CONTROL_WIDTH, 120, parent, (HMENU)IDC_DEVICE_POLICY_COMBO,
+        GetModuleHandle(NULL), NULL);
+    if (!policy_combo) {
+        LOG_ERROR("Failed to create Device Policy combo");
+        return false;
+    }
+    SettingsUI_ApplyFont(policy_combo);
+    SettingsUI_AddTooltip(policy_combo, "Which device drives the cursor when several mice "
+                          "are attached");
+    
+    // Populate device policy combo
+    ComboBox_AddString(policy_combo, "Last active");
+    ComboBox_AddString(policy_combo, "First active only");
+    ComboBox_AddString(policy_combo, "Merge all");
+    
     LOG_DEBUG("Basic tab controls created successfully");
     return true;
 }
@@ -556,6 +633,112 @@ bool SettingsUI_CreateDebugTab(HWND hwnd) {
     SettingsUI_ApplyFont(control);
     SettingsUI_AddTooltip(control, "Current status of screen capture exclusion");
     
+    y_pos += CONTROL_SPACING;
+    
+    // Cursor Output backend
+    control = CreateWindow("STATIC", "Cursor Output:", WS_CHILD,
+        x_label, y_pos + 5, LABEL_WIDTH, CONTROL_HEIGHT, parent, NULL, GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create Cursor Output label");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    
+    HWND output_combo = CreateWindow("COMBOBOX", NULL,
+        WS_CHILD | CBS_DROPDOWNLIST,
+        x_control, y_pos, CONTROL_WIDTH, 120, parent, (HMENU)IDC_OUTPUT_MODE_COMBO,
+        GetModuleHandle(NULL), NULL);
+    if (!output_combo) {
+        LOG_ERROR("Failed to create Cursor Output combo");
+        return false;
+    }
+    SettingsUI_ApplyFont(output_combo);
+    SettingsUI_AddTooltip(output_combo, "How the stabilized position is written to the "
+                          "system cursor");
+    
+    ComboBox_AddString(output_combo, "SetCursorPos");
+    ComboBox_AddString(output_combo, "SendInput (absolute)");
+    
+    y_pos += CONTROL_SPACING;
+    
+    // Input trace recording
+    control = CreateWindow("BUTTON", "Start Recording", WS_CHILD | BS_PUSHBUTTON,
+        x_label, y_pos, LABEL_WIDTH, CONTROL_HEIGHT, parent, (HMENU)IDC_TRACE_BUTTON,
+        GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create Input Recording button");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    SettingsUI_AddTooltip(control, "Record raw mouse input and stabilizer output to a .mstrace "
+                          "file for offline tuning");
+    
+    control = CreateWindow("STATIC", "Not recording",
+                           WS_CHILD | SS_LEFT | SS_PATHELLIPSIS, x_control, y_pos + 5,
+                           CONTROL_WIDTH * 2, CONTROL_HEIGHT, parent, (HMENU)IDC_TRACE_STATUS_LABEL,
+                           GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create Input Recording status");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    
+    y_pos += CONTROL_SPACING;
+    
+    // Pipeline latency: one row per stage, columns separated by tabs
+    control = CreateWindow("STATIC", "No latency samples yet", WS_CHILD | SS_LEFT | SS_NOPREFIX,
+        x_label, y_pos, LABEL_WIDTH + CONTROL_WIDTH * 2, 100, parent, (HMENU)IDC_LATENCY_LABEL,
+        GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create Latency display");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    
+    y_pos += 105;
+    
+    control = CreateWindow("BUTTON", "Save Latency", WS_CHILD | BS_PUSHBUTTON,
+        x_label, y_pos, LABEL_WIDTH, CONTROL_HEIGHT, parent, (HMENU)IDC_LATENCY_DUMP_BUTTON,
+        GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create Save Latency button");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    SettingsUI_AddTooltip(control, "Write the full latency distribution of every stage to "
+                          "a .hgrm file");
+    
+    control = CreateWindow("BUTTON", "Reset", WS_CHILD | BS_PUSHBUTTON,
+        x_control, y_pos, EDIT_WIDTH + 20, CONTROL_HEIGHT, parent, (HMENU)IDC_LATENCY_RESET_BUTTON,
+        GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create Reset Latency button");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    SettingsUI_AddTooltip(control, "Clear the latency histograms");
+    
+    control = CreateWindow("STATIC", "", WS_CHILD | SS_LEFT | SS_PATHELLIPSIS,
+        x_control + EDIT_WIDTH + 30, y_pos + 5, CONTROL_WIDTH + 50, CONTROL_HEIGHT, parent,
+        (HMENU)IDC_LATENCY_STATUS_LABEL, GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create Latency status");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    
+    y_pos += CONTROL_SPACING;
+    
+    // Live activity counters, same tab-separated layout as the latency table
+    control = CreateWindow("STATIC", "", WS_CHILD | SS_LEFT | SS_NOPREFIX,
+        x_label, y_pos, LABEL_WIDTH + CONTROL_WIDTH * 2, 130, parent, (HMENU)IDC_PERF_LABEL,
+        GetModuleHandle(NULL), NULL);
+    if (!control) {
+        LOG_ERROR("Failed to create activity counters display");
+        return false;
+    }
+    SettingsUI_ApplyFont(control);
+    
     LOG_DEBUG("Debug tab controls created successfully");
     return true;
 }
@@ -571,13 +754,18 @@ BOOL CALLBACK SettingsUI_ShowTabControls(HWND hwnd, LPARAM lParam) {
     bool should_show = false;
     
     // Determine if control should be visible for this tab
-    if (tab == TAB_BASIC && ((id >= IDC_FOLLOW_SLIDER && id <= IDC_DUAL_CHECK) || id == IDC_ENABLE_CHECK)) {
+    if (tab == TAB_BASIC && ((id >= IDC_FOLLOW_SLIDER && id <= IDC_DUAL_CHECK) ||
+                             id == IDC_ENABLE_CHECK || id == IDC_DRAG_ONLY_CHECK ||
+                             id == IDC_DRAG_BUTTON_COMBO || id == IDC_DEVICE_POLICY_COMBO)) {
         should_show = true;
     } else if (tab == TAB_VISUAL && ((id >= IDC_TARGET_COLOR_BUTTON && id <= IDC_TARGET_ALPHA_EDIT) || 
                                      id == IDC_POINTER_TYPE_COMBO || id == IDC_TARGET_ALWAYS_VISIBLE_CHECK ||
                                      id == IDC_EXCLUDE_CAPTURE_CHECK || id == IDC_CAPTURE_COMPAT_CHECK)) {
         should_show = true;
-    } else if (tab == TAB_DEBUG && (id >= IDC_LOG_LEVEL_COMBO || id == IDC_CAPTURE_STATUS_LABEL)) {
+    } else if (tab == TAB_DEBUG && (id == IDC_LOG_LEVEL_COMBO || id == IDC_CAPTURE_STATUS_LABEL ||
+                                    id == IDC_OUTPUT_MODE_COMBO || id == IDC_TRACE_BUTTON ||
+                                    id == IDC_TRACE_STATUS_LABEL ||
+                                    (id >= IDC_LATENCY_LABEL && id <= IDC_PERF_LABEL))) {
         should_show = true;
     }
     
@@ -589,6 +777,73 @@ void SettingsUI_ShowTab(int tab_index) {
     // Update visibility for all child controls
     EnumChildWindows(g_settings_window, SettingsUI_ShowTabControls, (LPARAM)tab_index);
     g_current_tab = tab_index;
+    
+    // Latency figures only tick while someone can see them
+    if (tab_index == TAB_DEBUG) {
+        SettingsUI_UpdateLatency();
+        SettingsUI_UpdatePerf();
+        SetTimer(g_settings_window, LATENCY_REFRESH_TIMER_ID, LATENCY_REFRESH_INTERVAL_MS, NULL);
+    } else {
+        KillTimer(g_settings_window, LATENCY_REFRESH_TIMER_ID);
+    }
+}
+
+void SettingsUI_UpdateLatency(void) {
+    if (!g_settings_window) return;
+    
+    HWND label = GetDlgItem(g_settings_window, IDC_LATENCY_LABEL);
+    if (!label) return;
+    
+    char text[512];
+    int length = sprintf_s(text, sizeof(text), "Latency (ms)\tp50\tp99\tp99.9\tmax\tsamples");
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT && length > 0; stage++) {
+        LatencySummary summary;
+        LatencyProbe_GetSummary(PERF_MONITOR_READER_PANEL, (LatencyStage)stage, &summary);
+        int row = sprintf_s(text + length, sizeof(text) - (size_t)length,
+                            "\r\n%s\t%.3f\t%.3f\t%.3f\t%.3f\t%llu",
+                            LatencyProbe_GetStageName((LatencyStage)stage), summary.p50 / 1000.0,
+                            summary.p99 / 1000.0, summary.p999 / 1000.0, summary.max / 1000.0,
+                            (unsigned long long)summary.count);
+        length = row > 0 ? length + row : -1;
+    }
+    if (length > 0) {
+        SetWindowText(label, text);
+    }
+}
+
+void SettingsUI_UpdatePerf(void) {
+    if (!g_settings_window) return;
+    
+    HWND label = GetDlgItem(g_settings_window, IDC_PERF_LABEL);
+    if (!label) return;
+    
+    PerfMonitorReading reading;
+    PerfMonitor_Read(PERF_MONITOR_READER_PANEL, &reading);
+    
+    // Same thread as raw input, so the estimate can be read directly
+    const VelocityEstimator* motion = &MouseInput_GetActiveStabilizer()->motion;
+    
+    char text[640];
+    int length = sprintf_s(text, sizeof(text),
+        "Input\t%.0f packets/s\tEngine\t%.0f steps/s\r\n"
+        "Tick interval\tmean %.2f ms\tmax %.2f ms\r\n"
+        "Cursor writes\t%.0f/s issued\t%.0f/s skipped\r\n"
+        "Log queue\t%u queued\t%llu dropped\r\n"
+        "Overruns\t%llu recording\t%llu latency\r\n"
+        "Mouse hook\tmean %.1f us\tmax %.1f us\r\n"
+        "Target motion\t%.0f px/s\t%.0f px/s^2\r\n"
+        "Process CPU\t%.1f%%",
+        reading.packets_per_s, reading.steps_per_s,
+        reading.tick_mean_ms, reading.tick_max_ms,
+        reading.cursor_issued_per_s, reading.cursor_skipped_per_s,
+        reading.log_pending, (unsigned long long)reading.log_dropped,
+        (unsigned long long)reading.trace_dropped, (unsigned long long)reading.latency_overflow,
+        reading.hook_mean_us, reading.hook_max_us,
+        motion->speed, hypotf(motion->acceleration_x, motion->acceleration_y),
+        reading.cpu_percent);
+    if (length > 0) {
+        SetWindowText(label, text);
+    }
 }
 
 LRESULT CALLBACK SettingsUI_WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
@@ -644,6 +899,32 @@ LRESULT CALLBACK SettingsUI_WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPAR
                 break;
             }
             
+            // Input recording is an action, not a setting
+            if (id == IDC_TRACE_BUTTON && code == BN_CLICKED) {
+                TraceRecorder_Toggle();
+                SettingsUI_UpdateControls();
+                break;
+            }
+            
+            if (id == IDC_LATENCY_DUMP_BUTTON && code == BN_CLICKED) {
+                char path[MAX_PATH];
+                char status[MAX_PATH + 16];
+                if (LatencyProbe_Dump(path, sizeof(path))) {
+                    sprintf_s(status, sizeof(status), "Saved: %s", path);
+                } else {
+                    strcpy_s(status, sizeof(status), "Could not save latency file");
+                }
+                SetWindowText(GetDlgItem(g_settings_window, IDC_LATENCY_STATUS_LABEL), status);
+                break;
+            }
+            
+            if (id == IDC_LATENCY_RESET_BUTTON && code == BN_CLICKED) {
+                LatencyProbe_Reset();
+                SettingsUI_UpdateLatency();
+                SetWindowText(GetDlgItem(g_settings_window, IDC_LATENCY_STATUS_LABEL), "");
+                break;
+            }
+            
             // Handle real-time updates - but avoid feedback loops
             if ((code == CBN_SELCHANGE || code == BN_CLICKED || code == EN_CHANGE) && !g_updating_controls) {
                 LOG_DEBUG("Control change detected, applying settings");
@@ -655,6 +936,13 @@ LRESULT CALLBACK SettingsUI_WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPAR
             break;
         }
         
+        case WM_TIMER:
+            if (wParam == LATENCY_REFRESH_TIMER_ID && IsWindowVisible(hwnd)) {
+                SettingsUI_UpdateLatency();
+                SettingsUI_UpdatePerf();
+            }
+            break;
+            
         case WM_HSCROLL: {
             // Handle slider changes - but avoid feedback loops
             if (!g_updating_controls) {
@@ -728,6 +1016,22 @@ void SettingsUI_UpdateControls(void) {
         Button_SetCheck(check, g_stabilizer.dual_mode ? BST_CHECKED : BST_UNCHECKED);
     }
     
+    // Update Drag-only Mode
+    check = GetDlgItem(g_settings_window, IDC_DRAG_ONLY_CHECK);
+    if (check) {
+        Button_SetCheck(check, g_stabilizer.drag_only ? BST_CHECKED : BST_UNCHECKED);
+    }
+    
+    combo = GetDlgItem(g_settings_window, IDC_DRAG_BUTTON_COMBO);
+    if (combo) {
+        ComboBox_SetCurSel(combo, g_stabilizer.drag_button);
+    }
+    
+    combo = GetDlgItem(g_settings_window, IDC_DEVICE_POLICY_COMBO);
+    if (combo) {
+        ComboBox_SetCurSel(combo, g_device_policy);
+    }
+    
     // Update Pointer Type
     combo = GetDlgItem(g_settings_window, IDC_POINTER_TYPE_COMBO);
     if (combo) {
@@ -791,6 +1095,11 @@ void SettingsUI_UpdateControls(void) {
         ComboBox_SetCurSel(combo, Settings_GetLogLevel());
     }
     
+    combo = GetDlgItem(g_settings_window, IDC_OUTPUT_MODE_COMBO);
+    if (combo) {
+        ComboBox_SetCurSel(combo, g_output_mode);
+    }
+    
     // Update Capture Status display
     HWND status_label = GetDlgItem(g_settings_window, IDC_CAPTURE_STATUS_LABEL);
     if (status_label) {
@@ -817,6 +1126,26 @@ void SettingsUI_UpdateControls(void) {
         LOG_WARN("Capture status label not found");
     }
     
+    // Update Input Recording controls
+    HWND trace_button = GetDlgItem(g_settings_window, IDC_TRACE_BUTTON);
+    if (trace_button) {
+        SetWindowText(trace_button,
+                      TraceRecorder_IsRecording() ? "Stop Recording" : "Start Recording");
+    }
+    HWND trace_label = GetDlgItem(g_settings_window, IDC_TRACE_STATUS_LABEL);
+    if (trace_label) {
+        const char* path = TraceRecorder_GetPath();
+        if (TraceRecorder_IsRecording()) {
+            SetWindowText(trace_label, path);
+        } else if (path[0]) {
+            char trace_text[MAX_PATH + 16];
+            sprintf_s(trace_text, sizeof(trace_text), "Saved: %s", path);
+            SetWindowText(trace_label, trace_text);
+        } else {
+            SetWindowText(trace_label, "Not recording");
+        }
+    }
+    
     LOG_DEBUG("Settings controls updated");
     g_updating_controls = false;
 }
@@ -883,6 +1212,36 @@ void SettingsUI_ApplySettings(void) {
         g_stabilizer.dual_mode = (Button_GetCheck(check) == BST_CHECKED);
     }
     
+    // Apply Drag-only Mode
+    check = GetDlgItem(g_settings_window, IDC_DRAG_ONLY_CHECK);
+    if (check) {
+        bool was_drag_only = g_stabilizer.drag_only;
+        g_stabilizer.drag_only = (Button_GetCheck(check) == BST_CHECKED);
+        if (was_drag_only != g_stabilizer.drag_only) {
+            LOG_DEBUG("Drag-only mode changed to: %s",
+                      g_stabilizer.drag_only ? "enabled" : "disabled");
+        }
+    }
+    
+    combo = GetDlgItem(g_settings_window, IDC_DRAG_BUTTON_COMBO);
+    if (combo) {
+        int sel = ComboBox_GetCurSel(combo);
+        if (sel >= DRAG_BUTTON_LEFT && sel <= DRAG_BUTTON_ANY) {
+            g_stabilizer.drag_button = (DragButton)sel;
+        }
+    }
+    
+    // Apply Device Policy
+    combo = GetDlgItem(g_settings_window, IDC_DEVICE_POLICY_COMBO);
+    if (combo) {
+        int sel = ComboBox_GetCurSel(combo);
+        if (sel >= DEVICE_POLICY_LAST_ACTIVE && sel <= DEVICE_POLICY_MERGE &&
+            (DevicePolicy)sel != g_device_policy) {
+            g_device_policy = (DevicePolicy)sel;
+            LOG_DEBUG("Device policy changed to: %d", g_device_policy);
+        }
+    }
+    
     // Apply Target Size from slider only
     HWND size_slider = GetDlgItem(g_settings_window, IDC_TARGET_SIZE_SLIDER);
     if (size_slider) {
@@ -946,5 +1305,18 @@ void SettingsUI_ApplySettings(void) {
         }
     }
     
+    // Apply Cursor Output mode
+    combo = GetDlgItem(g_settings_window, IDC_OUTPUT_MODE_COMBO);
+    if (combo) {
+        int sel = ComboBox_GetCurSel(combo);
+        if (sel >= OUTPUT_MODE_SET_CURSOR_POS && sel <= OUTPUT_MODE_SEND_INPUT &&
+            (OutputMode)sel != g_output_mode) {
+            PlatformWin32_SetOutputMode((OutputMode)sel);
+        }
+    }
+    
+    // Per-device instances follow the global parameters
+    MouseInput_SyncDeviceSettings();
+    
     LOG_DEBUG("Settings applied from UI controls");
 }
\ No newline at end of file
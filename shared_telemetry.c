@@ -0,0 +1,177 @@
+/**
+ * Shared Telemetry - Live Engine State for Other Processes
+ *
+ * Owns the named section behind the telemetry block and feeds it from the
+ * input and tick paths. Publishing is a handful of plain stores into the
+ * mapped view: no system call, no lock and no wait on any reader.
+ */
+
+#include "mouse_stabilizer.h"
+
+bool g_shared_telemetry = false;
+
+static HANDLE g_telemetry_mapping = NULL;
+static TelemetryBlock* g_telemetry = NULL;
+static uint64_t g_telemetry_packets = 0;
+static uint64_t g_telemetry_ticks = 0;
+
+static uint8_t SharedTelemetry_Flags(const SmoothStabilizer* stabilizer) {
+    uint8_t flags = 0;
+    if (g_stabilizer.enabled) flags |= TELEMETRY_FLAG_ENABLED;
+    if (StabilizerCore_IsEngaged(stabilizer)) flags |= TELEMETRY_FLAG_ENGAGED;
+    if (g_stabilizer.drag_only) flags |= TELEMETRY_FLAG_DRAG_ONLY;
+    if (g_stabilizer.dual_mode) flags |= TELEMETRY_FLAG_DUAL;
+    return flags;
+}
+
+static void SharedTelemetry_FillSample(TelemetrySample* sample, const SmoothStabilizer* stabilizer,
+                                       uint64_t time_us, TelemetrySampleKind kind) {
+    sample->time_us = time_us;
+    sample->target_x = stabilizer->target_pos.x;
+    sample->target_y = stabilizer->target_pos.y;
+    sample->output_x = stabilizer->current_pos.x;
+    sample->output_y = stabilizer->current_pos.y;
+    sample->sequence = 0;
+    sample->kind = (uint8_t)kind;
+    sample->flags = SharedTelemetry_Flags(stabilizer);
+    sample->buttons = (uint16_t)stabilizer->buttons_down;
+}
+
+bool SharedTelemetry_Start(void) {
+    if (g_telemetry) return true;
+
+    g_telemetry_mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0,
+                                            (DWORD)sizeof(TelemetryBlock), TELEMETRY_SECTION_NAME);
+    if (!g_telemetry_mapping) {
+        LOG_WARN("Failed to create shared telemetry section: error code %lu", GetLastError());
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        LOG_WARN("Shared telemetry section %s is already owned by another process",
+                 TELEMETRY_SECTION_NAME);
+        CloseHandle(g_telemetry_mapping);
+        g_telemetry_mapping = NULL;
+        return false;
+    }
+
+    g_telemetry = (TelemetryBlock*)MapViewOfFile(g_telemetry_mapping, FILE_MAP_ALL_ACCESS, 0, 0,
+                                                 sizeof(TelemetryBlock));
+    if (!g_telemetry) {
+        LOG_WARN("Failed to map shared telemetry section: error code %lu", GetLastError());
+        CloseHandle(g_telemetry_mapping);
+        g_telemetry_mapping = NULL;
+        return false;
+    }
+
+    g_telemetry_packets = 0;
+    g_telemetry_ticks = 0;
+    TelemetryBlock_Initialize(g_telemetry, GetCurrentProcessId(),
+                              Platform_NowMicros(PlatformWin32_Get()));
+    LOG_INFO("Shared telemetry published as %s (%u bytes)",
+             TELEMETRY_SECTION_NAME, (unsigned int)sizeof(TelemetryBlock));
+    return true;
+}
+
+void SharedTelemetry_Stop(void) {
+    if (!g_telemetry) return;
+
+    UnmapViewOfFile(g_telemetry);
+    CloseHandle(g_telemetry_mapping);
+    g_telemetry = NULL;
+    g_telemetry_mapping = NULL;
+}
+
+void SharedTelemetry_OnPacket(const SmoothStabilizer* stabilizer, uint64_t time_us) {
+    if (!g_telemetry || !stabilizer) return;
+
+    TelemetrySample sample;
+    SharedTelemetry_FillSample(&sample, stabilizer, time_us, TELEMETRY_SAMPLE_PACKET);
+    TelemetryBlock_PushSample(g_telemetry, &sample);
+    g_telemetry_packets++;
+}
+
+/**
+ * Apply a mailbox command to the global settings
+ * Same ranges as the ini file; the devices pick the change up via
+ * MouseInput_SyncDeviceSettings.
+ */
+static TelemetryCommandStatus SharedTelemetry_Apply(TelemetryCommandType command, float value) {
+    switch (command) {
+        case TELEMETRY_COMMAND_SET_ENABLED:
+            if (value != 0.0f && value != 1.0f) return TELEMETRY_STATUS_OUT_OF_RANGE;
+            g_stabilizer.enabled = value != 0.0f;
+            break;
+        case TELEMETRY_COMMAND_SET_FOLLOW:
+            if (!(value >= 0.05f && value <= 1.0f)) return TELEMETRY_STATUS_OUT_OF_RANGE;
+            g_stabilizer.follow_strength = value;
+            break;
+        case TELEMETRY_COMMAND_SET_MIN_DISTANCE:
+            if (!(value >= 0.1f && value <= 5.0f)) return TELEMETRY_STATUS_OUT_OF_RANGE;
+            g_stabilizer.min_distance = value;
+            break;
+        case TELEMETRY_COMMAND_SET_EASE:
+            if (!(value >= EASE_LINEAR && value <= EASE_IN_OUT) || value != (float)(int)value) {
+                return TELEMETRY_STATUS_OUT_OF_RANGE;
+            }
+            g_stabilizer.ease_type = (EaseType)(int)value;
+            break;
+        case TELEMETRY_COMMAND_SET_DELAY_MS:
+            if (!(value >= 0.0f && value <= 1000.0f)) return TELEMETRY_STATUS_OUT_OF_RANGE;
+            g_stabilizer.delay_start_ms = (uint32_t)(value + 0.5f);
+            break;
+        case TELEMETRY_COMMAND_SET_DUAL:
+            if (value != 0.0f && value != 1.0f) return TELEMETRY_STATUS_OUT_OF_RANGE;
+            g_stabilizer.dual_mode = value != 0.0f;
+            break;
+        default:
+            return TELEMETRY_STATUS_UNKNOWN_COMMAND;
+    }
+
+    MouseInput_SyncDeviceSettings();
+    if (command == TELEMETRY_COMMAND_SET_ENABLED) {
+        Settings_WriteLog("Mouse stabilizer %s (shared telemetry)",
+                          g_stabilizer.enabled ? "enabled" : "disabled");
+        TrayUI_UpdateIcon();
+    }
+    SettingsUI_UpdateControls();
+    return TELEMETRY_STATUS_OK;
+}
+
+void SharedTelemetry_OnTick(const SmoothStabilizer* stabilizer, uint64_t time_us) {
+    if (!g_telemetry || !stabilizer) return;
+
+    g_telemetry_ticks++;
+    TelemetrySample sample;
+    SharedTelemetry_FillSample(&sample, stabilizer, time_us, TELEMETRY_SAMPLE_TICK);
+    TelemetryBlock_PushSample(g_telemetry, &sample);
+
+    TelemetryCommandType command;
+    float value;
+    uint32_t ticket;
+    if (TelemetryBlock_TakeCommand(g_telemetry, &command, &value, &ticket)) {
+        TelemetryCommandStatus status = SharedTelemetry_Apply(command, value);
+        TelemetryBlock_CompleteCommand(g_telemetry, ticket, status);
+        LOG_DEBUG("Shared telemetry command %d (%.3f): status %d",
+                  (int)command, value, (int)status);
+    }
+
+    TelemetryState state;
+    memset(&state, 0, sizeof(state));
+    state.time_us = time_us;
+    state.target_x = stabilizer->target_pos.x;
+    state.target_y = stabilizer->target_pos.y;
+    state.output_x = stabilizer->current_pos.x;
+    state.output_y = stabilizer->current_pos.y;
+    state.flags = SharedTelemetry_Flags(stabilizer);
+    state.buttons = stabilizer->buttons_down;
+    state.follow_strength = g_stabilizer.follow_strength;
+    state.min_distance = g_stabilizer.min_distance;
+    state.ease_type = (uint32_t)g_stabilizer.ease_type;
+    state.delay_start_ms = g_stabilizer.delay_start_ms;
+    state.packets = g_telemetry_packets;
+    state.ticks = g_telemetry_ticks;
+    state.speed = stabilizer->motion.speed;
+    state.acceleration = hypotf(stabilizer->motion.acceleration_x,
+                                stabilizer->motion.acceleration_y);
+    TelemetryBlock_PublishState(g_telemetry, &state);
+}
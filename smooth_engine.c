@@ -3,35 +3,38 @@
  * 
  * Implements paint-style following smoothing where the Windows cursor
  * smoothly follows a target position with configurable delay and easing.
+ * OS access goes through the platform interface, so the engine builds and
+ * runs on any host.
  */
 
-#include "mouse_stabilizer.h"
+#include "include/core/stabilizer_core.h"
 
-// Global application state
-SmoothStabilizer g_stabilizer = {0};  // Main stabilizer instance
-HWND g_hidden_window = NULL;          // Hidden window for message handling
-HWND g_target_window = NULL;          // Overlay window for target pointer
-NOTIFYICONDATA g_nid = {0};          // System tray icon data
-bool g_running = true;                // Application running flag
+#include <string.h>
 
-void StabilizerCore_Initialize(SmoothStabilizer* stabilizer) {
-    if (!stabilizer) {
-        LOG_ERROR("StabilizerCore_Initialize: null stabilizer parameter");
-        return;
-    }
-    
-    POINT current_pos;
-    if (!GetCursorPos(&current_pos)) {
-        LOG_ERROR("Failed to get cursor position: error code %lu", GetLastError());
+// Every log line goes to the instance's own platform
+#define STABILIZER_LOG(stabilizer, level, ...) LOG_AT((stabilizer)->platform, level, __VA_ARGS__)
+
+void StabilizerCore_Initialize(SmoothStabilizer* stabilizer, const Platform* platform,
+                               const ScreenGeometry* geometry, OutputSink* output) {
+    if (!stabilizer) return;
+    
+    stabilizer->platform = platform;
+    stabilizer->geometry = geometry;
+    stabilizer->output = output;
+    stabilizer->monitor_hint = 0;
+    
+    int cursor_x, cursor_y;
+    if (!Platform_GetCursor(platform, &cursor_x, &cursor_y)) {
+        STABILIZER_LOG(stabilizer, LOG_ERROR, "Failed to get cursor position");
         // Use fallback position
-        current_pos.x = 100;
-        current_pos.y = 100;
+        cursor_x = 100;
+        cursor_y = 100;
     }
     
-    stabilizer->target_pos.x = (float)current_pos.x;
-    stabilizer->target_pos.y = (float)current_pos.y;
-    stabilizer->current_pos.x = (float)current_pos.x;
-    stabilizer->current_pos.y = (float)current_pos.y;
+    stabilizer->target_pos.x = (float)cursor_x;
+    stabilizer->target_pos.y = (float)cursor_y;
+    stabilizer->current_pos.x = (float)cursor_x;
+    stabilizer->current_pos.y = (float)cursor_y;
     
     stabilizer->follow_strength = DEFAULT_FOLLOW_STRENGTH;
     stabilizer->min_distance = DEFAULT_MIN_DISTANCE;
@@ -40,16 +43,22 @@ void StabilizerCore_Initialize(SmoothStabilizer* stabilizer) {
     stabilizer->enabled = true;
     
     stabilizer->velocity = 0.0f;
-    stabilizer->last_update_time = GetTickCount();
+    VelocityEstimator_Reset(&stabilizer->motion, (uint64_t)DEFAULT_VELOCITY_WINDOW_MS * 1000);
     stabilizer->movement_start_time = 0;
     stabilizer->first_update = true;
     stabilizer->is_moving = false;
     
+    stabilizer->drag_only = DEFAULT_DRAG_ONLY;
+    stabilizer->drag_button = DEFAULT_DRAG_BUTTON;
+    stabilizer->buttons_down = 0;
+    stabilizer->engaged = false;
+    stabilizer->release_ticks = 0;
+    
     stabilizer->delay_start_ms = DEFAULT_DELAY_START_MS;
     stabilizer->target_show_distance = DEFAULT_TARGET_SHOW_DISTANCE;
     stabilizer->target_size = DEFAULT_TARGET_SIZE;
     stabilizer->target_alpha = DEFAULT_TARGET_ALPHA;
-    stabilizer->target_color = RGB(255, 100, 100);
+    stabilizer->target_color = DEFAULT_TARGET_COLOR;
     stabilizer->pointer_type = DEFAULT_POINTER_TYPE;
     stabilizer->target_always_visible = DEFAULT_TARGET_ALWAYS_VISIBLE;
     
@@ -57,8 +66,8 @@ void StabilizerCore_Initialize(SmoothStabilizer* stabilizer) {
     stabilizer->exclude_from_capture = DEFAULT_EXCLUDE_FROM_CAPTURE;
     stabilizer->capture_compatibility_mode = DEFAULT_CAPTURE_COMPATIBILITY_MODE;
     
-    Settings_WriteLog("Stabilizer initialized at position (%.1f, %.1f)", 
-             stabilizer->current_pos.x, stabilizer->current_pos.y);
+    STABILIZER_LOG(stabilizer, LOG_INFO, "Stabilizer initialized at position (%.1f, %.1f)", 
+                   stabilizer->current_pos.x, stabilizer->current_pos.y);
 }
 
 float StabilizerCore_ApplyEasing(float t, EaseType ease_type) {
@@ -89,19 +98,173 @@ float StabilizerCore_CalculateDistance(MousePos a, MousePos b) {
     return sqrtf(dx * dx + dy * dy);
 }
 
-float StabilizerCore_CalculateVelocity(SmoothStabilizer* stabilizer, MousePos new_target) {
-    DWORD current_time = GetTickCount();
-    float dt = (current_time - stabilizer->last_update_time) / 1000.0f;
+uint64_t StabilizerCore_GetTimeMicros(const SmoothStabilizer* stabilizer) {
+    return stabilizer ? Platform_NowMicros(stabilizer->platform) : 0;
+}
+
+static unsigned int StabilizerCore_DragButtonMask(DragButton button) {
+    switch (button) {
+        case DRAG_BUTTON_LEFT:
+            return STABILIZER_BUTTON_LEFT;
+        case DRAG_BUTTON_RIGHT:
+            return STABILIZER_BUTTON_RIGHT;
+        case DRAG_BUTTON_MIDDLE:
+            return STABILIZER_BUTTON_MIDDLE;
+        case DRAG_BUTTON_ANY:
+        default:
+            return STABILIZER_BUTTON_LEFT | STABILIZER_BUTTON_RIGHT | STABILIZER_BUTTON_MIDDLE |
+                   STABILIZER_BUTTON_X1 | STABILIZER_BUTTON_X2;
+    }
+}
+
+// Smoothing is wanted always in normal mode, only while the drag button is held in drag-only mode
+static bool StabilizerCore_WantsEngage(const SmoothStabilizer* stabilizer) {
+    if (!stabilizer->drag_only) return true;
+    return (stabilizer->buttons_down & StabilizerCore_DragButtonMask(stabilizer->drag_button)) != 0;
+}
+
+/**
+ * Take over the cursor from the OS
+ * Target and current position restart at the real cursor so the hand-off
+ * from pass-through to smoothing is seamless.
+ */
+static void StabilizerCore_Engage(SmoothStabilizer* stabilizer) {
+    int cursor_x, cursor_y;
+    if (Platform_GetCursor(stabilizer->platform, &cursor_x, &cursor_y)) {
+        stabilizer->target_pos.x = (float)cursor_x;
+        stabilizer->target_pos.y = (float)cursor_y;
+        stabilizer->current_pos.x = (float)cursor_x;
+        stabilizer->current_pos.y = (float)cursor_y;
+    } else {
+        STABILIZER_LOG(stabilizer, LOG_WARN, "Failed to get cursor position on engage");
+    }
     
-    if (dt <= 0.001f) return stabilizer->velocity;
+    stabilizer->velocity = 0.0f;
+    VelocityEstimator_Reset(&stabilizer->motion, stabilizer->motion.window_us);
+    stabilizer->is_moving = false;
+    stabilizer->first_update = false;
+    stabilizer->engaged = true;
+    stabilizer->release_ticks = 0;
     
-    float distance = StabilizerCore_CalculateDistance(stabilizer->target_pos, new_target);
-    float velocity = distance / dt;
+    // The OS moved the cursor while we were idle; its last pixel is stale
+    OutputSink_Reset(stabilizer->output);
     
-    stabilizer->velocity = velocity * 0.7f + stabilizer->velocity * 0.3f;
-    stabilizer->last_update_time = current_time;
+    STABILIZER_LOG(stabilizer, LOG_DEBUG, "Smoothing engaged at (%.1f, %.1f)",
+                   stabilizer->current_pos.x, stabilizer->current_pos.y);
+}
+
+bool StabilizerCore_IsEngaged(const SmoothStabilizer* stabilizer) {
+    return stabilizer && stabilizer->enabled && stabilizer->engaged;
+}
+
+bool StabilizerCore_IsBusy(const SmoothStabilizer* stabilizer) {
+    if (!StabilizerCore_IsEngaged(stabilizer)) return false;
+    if (stabilizer->buttons_down != 0) return true;
+    return StabilizerCore_CalculateDistance(stabilizer->current_pos,
+                                            stabilizer->target_pos) >= stabilizer->min_distance;
+}
+
+void StabilizerCore_CopySettings(SmoothStabilizer* dst, const SmoothStabilizer* src) {
+    if (!dst || !src) return;
+    
+    dst->follow_strength = src->follow_strength;
+    dst->min_distance = src->min_distance;
+    dst->ease_type = src->ease_type;
+    dst->dual_mode = src->dual_mode;
+    dst->enabled = src->enabled;
+    dst->delay_start_ms = src->delay_start_ms;
+    dst->drag_only = src->drag_only;
+    dst->drag_button = src->drag_button;
+}
+
+void StabilizerCore_ClampSettings(SmoothStabilizer* stabilizer) {
+    if (!stabilizer) return;
     
-    return stabilizer->velocity;
+    if (stabilizer->follow_strength < STABILIZER_FOLLOW_STRENGTH_MIN) {
+        stabilizer->follow_strength = STABILIZER_FOLLOW_STRENGTH_MIN;
+    }
+    if (stabilizer->follow_strength > STABILIZER_FOLLOW_STRENGTH_MAX) {
+        stabilizer->follow_strength = STABILIZER_FOLLOW_STRENGTH_MAX;
+    }
+    if (stabilizer->min_distance < STABILIZER_MIN_DISTANCE_MIN) {
+        stabilizer->min_distance = STABILIZER_MIN_DISTANCE_MIN;
+    }
+    if (stabilizer->min_distance > STABILIZER_MIN_DISTANCE_MAX) {
+        stabilizer->min_distance = STABILIZER_MIN_DISTANCE_MAX;
+    }
+    if (stabilizer->ease_type < EASE_LINEAR || stabilizer->ease_type > EASE_IN_OUT) {
+        stabilizer->ease_type = EASE_OUT;
+    }
+    if (stabilizer->delay_start_ms > STABILIZER_DELAY_START_MAX_MS) {
+        stabilizer->delay_start_ms = STABILIZER_DELAY_START_MAX_MS;
+    }
+    if (stabilizer->drag_button < DRAG_BUTTON_LEFT || stabilizer->drag_button > DRAG_BUTTON_ANY) {
+        stabilizer->drag_button = DEFAULT_DRAG_BUTTON;
+    }
+}
+
+void StabilizerCore_SnapSettings(SmoothStabilizer* stabilizer) {
+    if (!stabilizer) return;
+    
+    // Same rounding as the file's integer units; clamping afterwards keeps the
+    // result on the grid because every limit is a whole number of units
+    float follow = floorf(stabilizer->follow_strength * STABILIZER_INI_FOLLOW_SCALE + 0.5f);
+    float distance = floorf(stabilizer->min_distance * STABILIZER_INI_DISTANCE_SCALE + 0.5f);
+    stabilizer->follow_strength = follow / (float)STABILIZER_INI_FOLLOW_SCALE;
+    stabilizer->min_distance = distance / (float)STABILIZER_INI_DISTANCE_SCALE;
+    StabilizerCore_ClampSettings(stabilizer);
+}
+
+void StabilizerCore_TakeOver(SmoothStabilizer* stabilizer, SmoothStabilizer* previous) {
+    if (!stabilizer || !previous) return;
+    
+    // The cursor sits where the previous owner put it, so start from there
+    stabilizer->target_pos = previous->current_pos;
+    stabilizer->current_pos = previous->current_pos;
+    stabilizer->velocity = 0.0f;
+    VelocityEstimator_Reset(&stabilizer->motion, stabilizer->motion.window_us);
+    stabilizer->is_moving = false;
+    stabilizer->first_update = false;
+    stabilizer->engaged = previous->engaged && StabilizerCore_WantsEngage(stabilizer);
+    stabilizer->release_ticks = 0;
+    
+    previous->engaged = false;
+    previous->is_moving = false;
+}
+
+void StabilizerCore_UpdateButtons(SmoothStabilizer* stabilizer, unsigned int pressed,
+                                  unsigned int released) {
+    if (!stabilizer) return;
+    
+    stabilizer->buttons_down |= pressed;
+    stabilizer->buttons_down &= ~released;
+    
+    // Press engages right away so the first dragged move is already smoothed;
+    // release starts a short catch-up that StabilizerCore_UpdatePosition finishes
+    if (stabilizer->enabled && !stabilizer->engaged && StabilizerCore_WantsEngage(stabilizer)) {
+        StabilizerCore_Engage(stabilizer);
+    } else if (stabilizer->engaged && released != 0 && !StabilizerCore_WantsEngage(stabilizer)) {
+        stabilizer->release_ticks = STABILIZER_RELEASE_TICKS;
+    }
+}
+
+void StabilizerCore_TrackButtons(SmoothStabilizer* stabilizer, unsigned int pressed,
+                                 unsigned int released) {
+    if (!stabilizer) return;
+    
+    stabilizer->buttons_down |= pressed;
+    stabilizer->buttons_down &= ~released;
+}
+
+// Put the cursor on the target and hand it back to the OS
+static void StabilizerCore_Release(SmoothStabilizer* stabilizer) {
+    stabilizer->current_pos = stabilizer->target_pos;
+    OutputSink_MoveTo(stabilizer->output, stabilizer->current_pos.x, stabilizer->current_pos.y);
+    stabilizer->is_moving = false;
+    stabilizer->engaged = false;
+    stabilizer->release_ticks = 0;
+    STABILIZER_LOG(stabilizer, LOG_DEBUG, "Smoothing released at (%.1f, %.1f)",
+                   stabilizer->current_pos.x, stabilizer->current_pos.y);
 }
 
 /**
@@ -109,21 +272,34 @@ float StabilizerCore_CalculateVelocity(SmoothStabilizer* stabilizer, MousePos ne
  * Core function that moves Windows cursor towards target with easing
  */
 void StabilizerCore_UpdatePosition(SmoothStabilizer* stabilizer) {
-    if (!stabilizer) {
-        LOG_ERROR("StabilizerCore_UpdatePosition: null stabilizer parameter");
+    if (!stabilizer) return;
+    
+    if (!stabilizer->enabled) {
+        // Re-sync with the real cursor on the next packet after re-enabling
+        stabilizer->engaged = false;
         return;
     }
     
-    if (!stabilizer->enabled) return;
+    if (!stabilizer->engaged) return;
     
     float distance = StabilizerCore_CalculateDistance(stabilizer->current_pos, stabilizer->target_pos);
     
+    // Drag button released: the target keeps running ahead as the user moves
+    // on, so catching up is bounded and the rest of the gap is closed at once
+    if (!StabilizerCore_WantsEngage(stabilizer)) {
+        if (distance < stabilizer->min_distance || stabilizer->release_ticks <= 1) {
+            StabilizerCore_Release(stabilizer);
+            return;
+        }
+        stabilizer->release_ticks--;
+    }
+    
     if (distance < stabilizer->min_distance) {
         stabilizer->is_moving = false;
         return;
     }
     
-    DWORD current_time = GetTickCount();
+    uint32_t current_time = (uint32_t)(Platform_NowMicros(stabilizer->platform) / 1000);
     
     if (!stabilizer->is_moving) {
         stabilizer->movement_start_time = current_time;
@@ -131,11 +307,15 @@ void StabilizerCore_UpdatePosition(SmoothStabilizer* stabilizer) {
     }
     
     // Implement delay start - wait before beginning to follow
-    DWORD elapsed_since_start = current_time - stabilizer->movement_start_time;
+    uint32_t elapsed_since_start = current_time - stabilizer->movement_start_time;
     if (elapsed_since_start < stabilizer->delay_start_ms) {
         return;
     }
     
+    // Let the speed estimate decay once packets stop arriving
+    VelocityEstimator_Expire(&stabilizer->motion, StabilizerCore_GetTimeMicros(stabilizer));
+    stabilizer->velocity = stabilizer->motion.speed;
+    
     // Calculate follow strength with optional velocity adaptation
     float follow_factor = stabilizer->follow_strength;
     if (stabilizer->dual_mode && stabilizer->velocity > 100.0f) {
@@ -150,20 +330,14 @@ void StabilizerCore_UpdatePosition(SmoothStabilizer* stabilizer) {
     stabilizer->current_pos.x += dx * eased_factor;
     stabilizer->current_pos.y += dy * eased_factor;
     
-    int new_x = (int)(stabilizer->current_pos.x + 0.5f);
-    int new_y = (int)(stabilizer->current_pos.y + 0.5f);
-    
-    LOG_TRACE("Moving cursor to (%d, %d)", new_x, new_y);
-    
-    if (!SetCursorPos(new_x, new_y)) {
-        LOG_WARN("Failed to set cursor position to (%d, %d): error code %lu", 
-                 new_x, new_y, GetLastError());
-    }
+    // The sink rounds, drops no-op moves and reports its own failures
+    OutputSink_MoveTo(stabilizer->output, stabilizer->current_pos.x, stabilizer->current_pos.y);
 }
 
 void StabilizerCore_SetTargetPosition(SmoothStabilizer* stabilizer, float x, float y) {
     if (!stabilizer->enabled) {
-        SetCursorPos((int)x, (int)y);
+        OutputSink_Reset(stabilizer->output);
+        OutputSink_MoveTo(stabilizer->output, x, y);
         return;
     }
     
@@ -173,60 +347,276 @@ void StabilizerCore_SetTargetPosition(SmoothStabilizer* stabilizer, float x, flo
         stabilizer->current_pos.x = x;
         stabilizer->current_pos.y = y;
         stabilizer->first_update = false;
-        SetCursorPos((int)x, (int)y);
+        OutputSink_Reset(stabilizer->output);
+        OutputSink_MoveTo(stabilizer->output, x, y);
         return;
     }
     
-    MousePos new_target = {x, y};
-    StabilizerCore_CalculateVelocity(stabilizer, new_target);
-    
     stabilizer->target_pos.x = x;
     stabilizer->target_pos.y = y;
+    
+    uint64_t now_us = StabilizerCore_GetTimeMicros(stabilizer);
+    VelocityEstimator_AddSample(&stabilizer->motion, now_us, x, y);
+    stabilizer->velocity = stabilizer->motion.speed;
 }
 
 /**
  * Process raw mouse movement delta from Windows Raw Input
  * Updates target position that the cursor will smoothly follow
  */
-void StabilizerCore_AddMouseDelta(SmoothStabilizer* stabilizer, float dx, float dy) {
-    if (!stabilizer) {
-        LOG_ERROR("StabilizerCore_AddMouseDelta: null stabilizer parameter");
-        return;
-    }
+void StabilizerCore_AddMouseDelta(SmoothStabilizer* stabilizer, float dx, float dy,
+                                  uint64_t timestamp_us) {
+    if (!stabilizer) return;
     
     if (!stabilizer->enabled) {
         return;
     }
     
-    LOG_DEBUG("Processing mouse delta: dx=%.1f, dy=%.1f", dx, dy);
+    STABILIZER_LOG(stabilizer, LOG_DEBUG, "Processing mouse delta: dx=%.1f, dy=%.1f", dx, dy);
     
-    
-    // Initialize positions on first update
-    if (stabilizer->first_update) {
-        POINT current_cursor;
-        GetCursorPos(&current_cursor);
-        stabilizer->target_pos.x = (float)current_cursor.x;
-        stabilizer->target_pos.y = (float)current_cursor.y;
-        stabilizer->current_pos.x = (float)current_cursor.x;
-        stabilizer->current_pos.y = (float)current_cursor.y;
-        stabilizer->first_update = false;
+    // Not engaged: the OS already moved the cursor for this packet. Either stay in
+    // pass-through (drag-only mode, no button held) or take over from the cursor's position.
+    if (!stabilizer->engaged) {
+        if (StabilizerCore_WantsEngage(stabilizer)) {
+            StabilizerCore_Engage(stabilizer);
+        }
         return;
     }
     
     float new_x = stabilizer->target_pos.x + dx;
     float new_y = stabilizer->target_pos.y + dy;
     
-    int screen_width = GetSystemMetrics(SM_CXSCREEN);
-    int screen_height = GetSystemMetrics(SM_CYSCREEN);
-    
-    if (new_x < 0) new_x = 0;
-    if (new_y < 0) new_y = 0;
-    if (new_x >= screen_width) new_x = screen_width - 1;
-    if (new_y >= screen_height) new_y = screen_height - 1;
-    
+    // Cached layout: no system calls per packet, and monitors left of or
+    // above the primary (negative coordinates) stay reachable
+    ScreenGeometry_Clamp(stabilizer->geometry, &stabilizer->monitor_hint, &new_x, &new_y);
     
     stabilizer->target_pos.x = new_x;
     stabilizer->target_pos.y = new_y;
     
-    StabilizerCore_CalculateVelocity(stabilizer, stabilizer->target_pos);
-}
\ No newline at end of file
+    VelocityEstimator_AddSample(&stabilizer->motion, timestamp_us, new_x, new_y);
+    stabilizer->velocity = stabilizer->motion.speed;
+    
+    STABILIZER_LOG(stabilizer, LOG_TRACE,
+                   "Motion estimate: v=(%.0f, %.0f) px/s, a=(%.0f, %.0f) px/s^2, samples=%d",
+                   stabilizer->motion.velocity_x, stabilizer->motion.velocity_y,
+                   stabilizer->motion.acceleration_x, stabilizer->motion.acceleration_y,
+                   stabilizer->motion.count);
+}
+
+// ---------------------------------------------------------------------------
+// State snapshots: explicit little-endian fields, so a snapshot taken on one
+// build restores on any other build of the same format version
+
+typedef struct {
+    uint8_t* data;
+    size_t capacity, length;
+    bool overflow;
+} StateWriter;
+
+typedef struct {
+    const uint8_t* data;
+    size_t length, offset;
+    bool underflow;
+} StateReader;
+
+static void StateWriter_Put(StateWriter* writer, uint64_t value, int bytes) {
+    if (writer->length + (size_t)bytes > writer->capacity) {
+        writer->overflow = true;
+        return;
+    }
+    for (int i = 0; i < bytes; i++) {
+        writer->data[writer->length++] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void StateWriter_PutFloat(StateWriter* writer, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    StateWriter_Put(writer, bits, 4);
+}
+
+static void StateWriter_PutDouble(StateWriter* writer, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    StateWriter_Put(writer, bits, 8);
+}
+
+static uint64_t StateReader_Get(StateReader* reader, int bytes) {
+    if (reader->offset + (size_t)bytes > reader->length) {
+        reader->underflow = true;
+        return 0;
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)reader->data[reader->offset++] << (8 * i);
+    }
+    return value;
+}
+
+static float StateReader_GetFloat(StateReader* reader) {
+    uint32_t bits = (uint32_t)StateReader_Get(reader, 4);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static double StateReader_GetDouble(StateReader* reader) {
+    uint64_t bits = StateReader_Get(reader, 8);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+size_t StabilizerCore_SaveState(const SmoothStabilizer* stabilizer, uint8_t* out, size_t capacity) {
+    if (!stabilizer || !out) return 0;
+
+    StateWriter writer = {out, capacity, 0, false};
+    const VelocityEstimator* motion = &stabilizer->motion;
+
+    // Header; the payload length is patched in at the end
+    StateWriter_Put(&writer, STABILIZER_STATE_MAGIC, 4);
+    StateWriter_Put(&writer, STABILIZER_STATE_VERSION, 2);
+    StateWriter_Put(&writer, 0, 2);
+    StateWriter_Put(&writer, 0, 4);
+
+    // Settings
+    StateWriter_PutFloat(&writer, stabilizer->follow_strength);
+    StateWriter_PutFloat(&writer, stabilizer->min_distance);
+    StateWriter_Put(&writer, (uint64_t)stabilizer->ease_type, 1);
+    StateWriter_Put(&writer, stabilizer->dual_mode, 1);
+    StateWriter_Put(&writer, stabilizer->enabled, 1);
+    StateWriter_Put(&writer, stabilizer->drag_only, 1);
+    StateWriter_Put(&writer, (uint64_t)stabilizer->drag_button, 1);
+    StateWriter_Put(&writer, stabilizer->delay_start_ms, 4);
+    StateWriter_PutFloat(&writer, stabilizer->target_show_distance);
+    StateWriter_Put(&writer, (uint64_t)stabilizer->pointer_type, 1);
+    StateWriter_Put(&writer, (uint32_t)stabilizer->target_size, 4);
+    StateWriter_Put(&writer, (uint32_t)stabilizer->target_alpha, 4);
+    StateWriter_Put(&writer, stabilizer->target_color, 4);
+    StateWriter_Put(&writer, stabilizer->target_always_visible, 1);
+    StateWriter_Put(&writer, stabilizer->exclude_from_capture, 1);
+    StateWriter_Put(&writer, stabilizer->capture_compatibility_mode, 1);
+
+    // Motion state
+    StateWriter_PutFloat(&writer, stabilizer->target_pos.x);
+    StateWriter_PutFloat(&writer, stabilizer->target_pos.y);
+    StateWriter_PutFloat(&writer, stabilizer->current_pos.x);
+    StateWriter_PutFloat(&writer, stabilizer->current_pos.y);
+    StateWriter_PutFloat(&writer, stabilizer->velocity);
+    StateWriter_Put(&writer, stabilizer->movement_start_time, 4);
+    StateWriter_Put(&writer, stabilizer->first_update, 1);
+    StateWriter_Put(&writer, stabilizer->is_moving, 1);
+    StateWriter_Put(&writer, stabilizer->buttons_down, 4);
+    StateWriter_Put(&writer, stabilizer->engaged, 1);
+    StateWriter_Put(&writer, stabilizer->release_ticks, 4);
+    StateWriter_Put(&writer, (uint32_t)stabilizer->monitor_hint, 4);
+
+    // Velocity estimator: the running sums carry the whole history, so they
+    // go out bit for bit together with the live part of the ring
+    StateWriter_Put(&writer, motion->window_us, 8);
+    StateWriter_Put(&writer, motion->base_time_us, 8);
+    StateWriter_PutDouble(&writer, motion->base_x);
+    StateWriter_PutDouble(&writer, motion->base_y);
+    for (int k = 0; k < 5; k++) StateWriter_PutDouble(&writer, motion->sum_t[k]);
+    for (int k = 0; k < 3; k++) StateWriter_PutDouble(&writer, motion->sum_x[k]);
+    for (int k = 0; k < 3; k++) StateWriter_PutDouble(&writer, motion->sum_y[k]);
+    StateWriter_PutFloat(&writer, motion->velocity_x);
+    StateWriter_PutFloat(&writer, motion->velocity_y);
+    StateWriter_PutFloat(&writer, motion->acceleration_x);
+    StateWriter_PutFloat(&writer, motion->acceleration_y);
+    StateWriter_PutFloat(&writer, motion->speed);
+    StateWriter_Put(&writer, (uint32_t)motion->head, 2);
+    StateWriter_Put(&writer, (uint32_t)motion->count, 2);
+    for (int i = 0; i < motion->count; i++) {
+        int index = (motion->head + i) & (VELOCITY_RING_CAPACITY - 1);
+        const VelocitySample* sample = &motion->samples[index];
+        StateWriter_Put(&writer, sample->time_us, 8);
+        StateWriter_PutFloat(&writer, sample->x);
+        StateWriter_PutFloat(&writer, sample->y);
+    }
+
+    if (writer.overflow) return 0;
+
+    size_t payload = writer.length - STABILIZER_STATE_HEADER_SIZE;
+    for (int i = 0; i < 4; i++) {
+        out[8 + i] = (uint8_t)(payload >> (8 * i));
+    }
+    return writer.length;
+}
+
+bool StabilizerCore_RestoreState(SmoothStabilizer* stabilizer, const uint8_t* data, size_t length) {
+    if (!stabilizer || !data) return false;
+
+    StateReader reader = {data, length, 0, false};
+    if (StateReader_Get(&reader, 4) != STABILIZER_STATE_MAGIC) return false;
+    if (StateReader_Get(&reader, 2) != STABILIZER_STATE_VERSION) return false;
+    StateReader_Get(&reader, 2);
+    uint64_t payload = StateReader_Get(&reader, 4);
+    if (reader.underflow || payload > length - STABILIZER_STATE_HEADER_SIZE) return false;
+    reader.length = STABILIZER_STATE_HEADER_SIZE + (size_t)payload;
+
+    // Decode into a copy so a bad snapshot leaves the instance untouched
+    SmoothStabilizer state = *stabilizer;
+    VelocityEstimator* motion = &state.motion;
+
+    state.follow_strength = StateReader_GetFloat(&reader);
+    state.min_distance = StateReader_GetFloat(&reader);
+    state.ease_type = (EaseType)StateReader_Get(&reader, 1);
+    state.dual_mode = StateReader_Get(&reader, 1) != 0;
+    state.enabled = StateReader_Get(&reader, 1) != 0;
+    state.drag_only = StateReader_Get(&reader, 1) != 0;
+    state.drag_button = (DragButton)StateReader_Get(&reader, 1);
+    state.delay_start_ms = (uint32_t)StateReader_Get(&reader, 4);
+    state.target_show_distance = StateReader_GetFloat(&reader);
+    state.pointer_type = (PointerType)StateReader_Get(&reader, 1);
+    state.target_size = (int32_t)StateReader_Get(&reader, 4);
+    state.target_alpha = (int32_t)StateReader_Get(&reader, 4);
+    state.target_color = (uint32_t)StateReader_Get(&reader, 4);
+    state.target_always_visible = StateReader_Get(&reader, 1) != 0;
+    state.exclude_from_capture = StateReader_Get(&reader, 1) != 0;
+    state.capture_compatibility_mode = StateReader_Get(&reader, 1) != 0;
+
+    state.target_pos.x = StateReader_GetFloat(&reader);
+    state.target_pos.y = StateReader_GetFloat(&reader);
+    state.current_pos.x = StateReader_GetFloat(&reader);
+    state.current_pos.y = StateReader_GetFloat(&reader);
+    state.velocity = StateReader_GetFloat(&reader);
+    state.movement_start_time = (uint32_t)StateReader_Get(&reader, 4);
+    state.first_update = StateReader_Get(&reader, 1) != 0;
+    state.is_moving = StateReader_Get(&reader, 1) != 0;
+    state.buttons_down = (unsigned int)StateReader_Get(&reader, 4);
+    state.engaged = StateReader_Get(&reader, 1) != 0;
+    state.release_ticks = (uint32_t)StateReader_Get(&reader, 4);
+    state.monitor_hint = (int32_t)StateReader_Get(&reader, 4);
+
+    memset(motion->samples, 0, sizeof(motion->samples));
+    motion->window_us = StateReader_Get(&reader, 8);
+    motion->base_time_us = StateReader_Get(&reader, 8);
+    motion->base_x = StateReader_GetDouble(&reader);
+    motion->base_y = StateReader_GetDouble(&reader);
+    for (int k = 0; k < 5; k++) motion->sum_t[k] = StateReader_GetDouble(&reader);
+    for (int k = 0; k < 3; k++) motion->sum_x[k] = StateReader_GetDouble(&reader);
+    for (int k = 0; k < 3; k++) motion->sum_y[k] = StateReader_GetDouble(&reader);
+    motion->velocity_x = StateReader_GetFloat(&reader);
+    motion->velocity_y = StateReader_GetFloat(&reader);
+    motion->acceleration_x = StateReader_GetFloat(&reader);
+    motion->acceleration_y = StateReader_GetFloat(&reader);
+    motion->speed = StateReader_GetFloat(&reader);
+    motion->head = (int)StateReader_Get(&reader, 2);
+    motion->count = (int)StateReader_Get(&reader, 2);
+    if (motion->head >= VELOCITY_RING_CAPACITY ||
+        motion->count > VELOCITY_RING_CAPACITY) return false;
+    for (int i = 0; i < motion->count; i++) {
+        int index = (motion->head + i) & (VELOCITY_RING_CAPACITY - 1);
+        VelocitySample* sample = &motion->samples[index];
+        sample->time_us = StateReader_Get(&reader, 8);
+        sample->x = StateReader_GetFloat(&reader);
+        sample->y = StateReader_GetFloat(&reader);
+    }
+
+    if (reader.underflow || reader.offset != reader.length) return false;
+
+    // Host bindings stay with the instance being restored
+    *stabilizer = state;
+    return true;
+}
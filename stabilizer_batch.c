@@ -0,0 +1,322 @@
+/**
+ * Stabilizer Batch - Structure-of-Arrays Engine
+ *
+ * Runs StabilizerCore_UpdatePosition for many parameter sets per call.
+ * Easing is loop-invariant per lane, so it is evaluated once when a lane
+ * is loaded and the per-tick step is branch-free arithmetic over plain
+ * float and integer arrays: distance, dead zone, delay timer and lerp.
+ */
+
+#include "include/core/stabilizer_batch.h"
+
+#include <float.h>
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define STABILIZER_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+// The 256/512-bit kernels are left out of Windows builds: GCC does not
+// align spilled AVX registers on the Win64 stack
+#if defined(STABILIZER_BATCH_X86) && !defined(_WIN32)
+#define STABILIZER_BATCH_WIDE 1
+#endif
+
+// Dual mode switches to the fast follow factor above this speed (px/s)
+#define STABILIZER_BATCH_FAST_SPEED 100.0f
+
+typedef void (*StabilizerBatchKernel)(StabilizerBatch* batch, int lanes, uint32_t now_ms,
+                                      const float* factor);
+
+static void StabilizerBatch_StepScalar(StabilizerBatch* batch, int lanes, uint32_t now_ms,
+                                       const float* factor) {
+    for (int i = 0; i < lanes; i++) {
+        float dx = batch->target_x - batch->current_x[i];
+        float dy = batch->target_y - batch->current_y[i];
+        float distance = sqrtf(dx * dx + dy * dy);
+
+        if (distance < batch->min_distance[i]) {
+            batch->moving[i] = 0;
+            continue;
+        }
+        if (!batch->moving[i]) {
+            batch->start_ms[i] = now_ms;
+            batch->moving[i] = 1;
+        }
+        if (now_ms - batch->start_ms[i] < batch->delay_ms[i]) {
+            continue;
+        }
+
+        batch->current_x[i] += dx * factor[i];
+        batch->current_y[i] += dy * factor[i];
+    }
+}
+
+#ifdef STABILIZER_BATCH_X86
+
+__attribute__((target("sse2")))
+static void StabilizerBatch_StepSse2(StabilizerBatch* batch, int lanes, uint32_t now_ms,
+                                     const float* factor) {
+    const __m128 target_x = _mm_set1_ps(batch->target_x);
+    const __m128 target_y = _mm_set1_ps(batch->target_y);
+    const __m128i now = _mm_set1_epi32((int32_t)now_ms);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i sign = _mm_set1_epi32(INT32_MIN);  // Biases unsigned compares onto signed ones
+
+    for (int i = 0; i < lanes; i += 4) {
+        __m128 current_x = _mm_loadu_ps(batch->current_x + i);
+        __m128 current_y = _mm_loadu_ps(batch->current_y + i);
+        __m128 dx = _mm_sub_ps(target_x, current_x);
+        __m128 dy = _mm_sub_ps(target_y, current_y);
+        __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        __m128 min_distance = _mm_loadu_ps(batch->min_distance + i);
+        __m128i far = _mm_castps_si128(_mm_cmpnlt_ps(distance, min_distance));
+
+        __m128i moving = _mm_loadu_si128((const __m128i*)(batch->moving + i));
+        __m128i start = _mm_loadu_si128((const __m128i*)(batch->start_ms + i));
+        __m128i starting = _mm_andnot_si128(_mm_cmpeq_epi32(moving, one), far);
+        start = _mm_or_si128(_mm_and_si128(starting, now), _mm_andnot_si128(starting, start));
+        moving = _mm_and_si128(far, one);
+
+        __m128i elapsed = _mm_xor_si128(_mm_sub_epi32(now, start), sign);
+        __m128i delay_ms = _mm_loadu_si128((const __m128i*)(batch->delay_ms + i));
+        __m128i delay = _mm_xor_si128(delay_ms, sign);
+        __m128 go = _mm_castsi128_ps(_mm_andnot_si128(_mm_cmplt_epi32(elapsed, delay), far));
+
+        __m128 f = _mm_loadu_ps(factor + i);
+        __m128 moved_x = _mm_add_ps(current_x, _mm_mul_ps(dx, f));
+        __m128 moved_y = _mm_add_ps(current_y, _mm_mul_ps(dy, f));
+        current_x = _mm_or_ps(_mm_and_ps(go, moved_x), _mm_andnot_ps(go, current_x));
+        current_y = _mm_or_ps(_mm_and_ps(go, moved_y), _mm_andnot_ps(go, current_y));
+
+        _mm_storeu_ps(batch->current_x + i, current_x);
+        _mm_storeu_ps(batch->current_y + i, current_y);
+        _mm_storeu_si128((__m128i*)(batch->moving + i), moving);
+        _mm_storeu_si128((__m128i*)(batch->start_ms + i), start);
+    }
+}
+
+#endif // STABILIZER_BATCH_X86
+
+#ifdef STABILIZER_BATCH_WIDE
+
+__attribute__((target("avx2")))
+static void StabilizerBatch_StepAvx2(StabilizerBatch* batch, int lanes, uint32_t now_ms,
+                                     const float* factor) {
+    const __m256 target_x = _mm256_set1_ps(batch->target_x);
+    const __m256 target_y = _mm256_set1_ps(batch->target_y);
+    const __m256i now = _mm256_set1_epi32((int32_t)now_ms);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+
+    for (int i = 0; i < lanes; i += 8) {
+        __m256 current_x = _mm256_loadu_ps(batch->current_x + i);
+        __m256 current_y = _mm256_loadu_ps(batch->current_y + i);
+        __m256 dx = _mm256_sub_ps(target_x, current_x);
+        __m256 dy = _mm256_sub_ps(target_y, current_y);
+        __m256 squared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        __m256 distance = _mm256_sqrt_ps(squared);
+        __m256 min_distance = _mm256_loadu_ps(batch->min_distance + i);
+        __m256i far = _mm256_castps_si256(_mm256_cmp_ps(distance, min_distance, _CMP_NLT_UQ));
+
+        __m256i moving = _mm256_loadu_si256((const __m256i*)(batch->moving + i));
+        __m256i start = _mm256_loadu_si256((const __m256i*)(batch->start_ms + i));
+        __m256i starting = _mm256_andnot_si256(_mm256_cmpeq_epi32(moving, one), far);
+        start = _mm256_blendv_epi8(start, now, starting);
+        moving = _mm256_and_si256(far, one);
+
+        __m256i elapsed = _mm256_xor_si256(_mm256_sub_epi32(now, start), sign);
+        __m256i delay_ms = _mm256_loadu_si256((const __m256i*)(batch->delay_ms + i));
+        __m256i delay = _mm256_xor_si256(delay_ms, sign);
+        __m256i waiting = _mm256_cmpgt_epi32(delay, elapsed);
+        __m256 go = _mm256_castsi256_ps(_mm256_andnot_si256(waiting, far));
+
+        __m256 f = _mm256_loadu_ps(factor + i);
+        current_x = _mm256_blendv_ps(current_x, _mm256_add_ps(current_x, _mm256_mul_ps(dx, f)), go);
+        current_y = _mm256_blendv_ps(current_y, _mm256_add_ps(current_y, _mm256_mul_ps(dy, f)), go);
+
+        _mm256_storeu_ps(batch->current_x + i, current_x);
+        _mm256_storeu_ps(batch->current_y + i, current_y);
+        _mm256_storeu_si256((__m256i*)(batch->moving + i), moving);
+        _mm256_storeu_si256((__m256i*)(batch->start_ms + i), start);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void StabilizerBatch_StepAvx512(StabilizerBatch* batch, int lanes, uint32_t now_ms,
+                                       const float* factor) {
+    const __m512 target_x = _mm512_set1_ps(batch->target_x);
+    const __m512 target_y = _mm512_set1_ps(batch->target_y);
+    const __m512i now = _mm512_set1_epi32((int32_t)now_ms);
+    const __m512i one = _mm512_set1_epi32(1);
+
+    for (int i = 0; i < lanes; i += 16) {
+        __m512 current_x = _mm512_loadu_ps(batch->current_x + i);
+        __m512 current_y = _mm512_loadu_ps(batch->current_y + i);
+        __m512 dx = _mm512_sub_ps(target_x, current_x);
+        __m512 dy = _mm512_sub_ps(target_y, current_y);
+        __m512 squared = _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy));
+        __m512 distance = _mm512_sqrt_ps(squared);
+        __m512 min_distance = _mm512_loadu_ps(batch->min_distance + i);
+        __mmask16 far = _mm512_cmp_ps_mask(distance, min_distance, _CMP_NLT_UQ);
+
+        __m512i moving = _mm512_loadu_si512(batch->moving + i);
+        __m512i start = _mm512_loadu_si512(batch->start_ms + i);
+        __mmask16 starting = far & (__mmask16)~_mm512_cmpeq_epi32_mask(moving, one);
+        start = _mm512_mask_mov_epi32(start, starting, now);
+        moving = _mm512_maskz_mov_epi32(far, one);
+
+        __m512i elapsed = _mm512_sub_epi32(now, start);
+        __m512i delay = _mm512_loadu_si512(batch->delay_ms + i);
+        __mmask16 go = far & (__mmask16)~_mm512_cmplt_epu32_mask(elapsed, delay);
+
+        __m512 f = _mm512_loadu_ps(factor + i);
+        current_x = _mm512_mask_add_ps(current_x, go, current_x, _mm512_mul_ps(dx, f));
+        current_y = _mm512_mask_add_ps(current_y, go, current_y, _mm512_mul_ps(dy, f));
+
+        _mm512_storeu_ps(batch->current_x + i, current_x);
+        _mm512_storeu_ps(batch->current_y + i, current_y);
+        _mm512_storeu_si512(batch->moving + i, moving);
+        _mm512_storeu_si512(batch->start_ms + i, start);
+    }
+}
+
+#endif // STABILIZER_BATCH_WIDE
+
+bool StabilizerBatch_IsaSupported(StabilizerBatchIsa isa) {
+    switch (isa) {
+        case STABILIZER_BATCH_SCALAR:
+            return true;
+#ifdef STABILIZER_BATCH_X86
+        case STABILIZER_BATCH_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+#endif
+#ifdef STABILIZER_BATCH_WIDE
+        case STABILIZER_BATCH_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        case STABILIZER_BATCH_AVX512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+static StabilizerBatchKernel StabilizerBatch_Kernel(StabilizerBatchIsa isa, int* width) {
+    switch (isa) {
+#ifdef STABILIZER_BATCH_X86
+        case STABILIZER_BATCH_SSE2:
+            *width = 4;
+            return StabilizerBatch_StepSse2;
+#endif
+#ifdef STABILIZER_BATCH_WIDE
+        case STABILIZER_BATCH_AVX2:
+            *width = 8;
+            return StabilizerBatch_StepAvx2;
+        case STABILIZER_BATCH_AVX512:
+            *width = 16;
+            return StabilizerBatch_StepAvx512;
+#endif
+        default:
+            *width = 1;
+            return StabilizerBatch_StepScalar;
+    }
+}
+
+StabilizerBatchIsa StabilizerBatch_DetectIsa(void) {
+    if (StabilizerBatch_IsaSupported(STABILIZER_BATCH_AVX512)) return STABILIZER_BATCH_AVX512;
+    if (StabilizerBatch_IsaSupported(STABILIZER_BATCH_AVX2)) return STABILIZER_BATCH_AVX2;
+    if (StabilizerBatch_IsaSupported(STABILIZER_BATCH_SSE2)) return STABILIZER_BATCH_SSE2;
+    return STABILIZER_BATCH_SCALAR;
+}
+
+const char* StabilizerBatch_IsaName(StabilizerBatchIsa isa) {
+    switch (isa) {
+        case STABILIZER_BATCH_SCALAR: return "scalar";
+        case STABILIZER_BATCH_SSE2: return "sse2";
+        case STABILIZER_BATCH_AVX2: return "avx2";
+        case STABILIZER_BATCH_AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+void StabilizerBatch_Initialize(StabilizerBatch* batch, int count, float x, float y) {
+    if (!batch) return;
+
+    memset(batch, 0, sizeof(*batch));
+    if (count < 0) count = 0;
+    if (count > STABILIZER_BATCH_MAX_LANES) count = STABILIZER_BATCH_MAX_LANES;
+    batch->count = count;
+    batch->isa = StabilizerBatch_DetectIsa();
+    batch->target_x = x;
+    batch->target_y = y;
+    VelocityEstimator_Reset(&batch->motion, (uint64_t)DEFAULT_VELOCITY_WINDOW_MS * 1000);
+
+    for (int i = 0; i < STABILIZER_BATCH_MAX_LANES; i++) {
+        batch->current_x[i] = x;
+        batch->current_y[i] = y;
+        // Unused lanes ride along in the last vector but never leave the dead zone
+        batch->min_distance[i] = (i < count) ? DEFAULT_MIN_DISTANCE : FLT_MAX;
+        batch->delay_ms[i] = DEFAULT_DELAY_START_MS;
+    }
+}
+
+bool StabilizerBatch_SetIsa(StabilizerBatch* batch, StabilizerBatchIsa isa) {
+    if (!batch || !StabilizerBatch_IsaSupported(isa)) return false;
+
+    batch->isa = isa;
+    return true;
+}
+
+void StabilizerBatch_SetLane(StabilizerBatch* batch, int lane, const SmoothStabilizer* settings) {
+    if (!batch || !settings || lane < 0 || lane >= batch->count) return;
+
+    // Same follow factors StabilizerCore_UpdatePosition picks per tick
+    float fast = settings->follow_strength;
+    if (settings->dual_mode) fast = fminf(settings->follow_strength * 3.0f, 0.8f);
+    batch->eased_slow[lane] = StabilizerCore_ApplyEasing(settings->follow_strength,
+                                                         settings->ease_type);
+    batch->eased_fast[lane] = StabilizerCore_ApplyEasing(fast, settings->ease_type);
+    batch->min_distance[lane] = settings->min_distance;
+    batch->delay_ms[lane] = settings->delay_start_ms;
+}
+
+void StabilizerBatch_Engage(StabilizerBatch* batch, float x, float y) {
+    if (!batch) return;
+
+    batch->target_x = x;
+    batch->target_y = y;
+    for (int i = 0; i < batch->count; i++) {
+        batch->current_x[i] = x;
+        batch->current_y[i] = y;
+        batch->moving[i] = 0;
+    }
+    VelocityEstimator_Reset(&batch->motion, batch->motion.window_us);
+    batch->engaged = true;
+}
+
+void StabilizerBatch_AddMouseDelta(StabilizerBatch* batch, float dx, float dy,
+                                   uint64_t timestamp_us) {
+    if (!batch || !batch->engaged) return;
+
+    batch->target_x += dx;
+    batch->target_y += dy;
+    VelocityEstimator_AddSample(&batch->motion, timestamp_us, batch->target_x, batch->target_y);
+}
+
+void StabilizerBatch_UpdatePosition(StabilizerBatch* batch, uint64_t now_us) {
+    if (!batch || !batch->engaged || batch->count == 0) return;
+
+    VelocityEstimator_Expire(&batch->motion, now_us);
+    const float* factor = batch->motion.speed > STABILIZER_BATCH_FAST_SPEED ? batch->eased_fast
+                                                                             : batch->eased_slow;
+
+    int width;
+    StabilizerBatchKernel kernel = StabilizerBatch_Kernel(batch->isa, &width);
+    int lanes = (batch->count + width - 1) / width * width;
+    kernel(batch, lanes, (uint32_t)(now_us / 1000), factor);
+}
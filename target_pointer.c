@@ -7,6 +7,7 @@
 
 #include "mouse_stabilizer.h"
 
+HWND g_target_window = NULL;           // Overlay window for target pointer
 static bool g_target_visible = false;  // Current visibility state
 static DWORD g_last_draw_time = 0;     // Throttle drawing updates
 static bool g_capture_excluded = false; // Current capture exclusion state
@@ -62,11 +63,14 @@ bool TargetPointer_CreateWindow(void) {
 void TargetPointer_UpdateWindow(void) {
     if (!g_target_window) return;
     
-    // If stabilizer is disabled, force hide the target pointer
-    if (!g_stabilizer.enabled) {
+    // Positions come from the device instance driving the cursor; appearance from global settings
+    const SmoothStabilizer* active = MouseInput_GetActiveStabilizer();
+    
+    // If stabilizer is disabled or passing through (drag-only mode), force hide the target pointer
+    if (!StabilizerCore_IsEngaged(active)) {
         if (g_target_visible) {
             TargetPointer_Show(false);
-            LOG_DEBUG("Target pointer hidden because stabilizer is disabled");
+            LOG_DEBUG("Target pointer hidden because smoothing is not engaged");
         }
         return;
     }
@@ -81,7 +85,7 @@ void TargetPointer_UpdateWindow(void) {
         should_show = true;
     } else {
         // Auto-hide mode - show only when target is far from current position
-        float distance = StabilizerCore_CalculateDistance(g_stabilizer.target_pos, g_stabilizer.current_pos);
+        float distance = StabilizerCore_CalculateDistance(active->target_pos, active->current_pos);
         should_show = distance >= g_stabilizer.target_show_distance;
     }
     
@@ -94,8 +98,8 @@ void TargetPointer_UpdateWindow(void) {
     
     if (g_target_visible) {
         int size = g_stabilizer.target_size * 3;
-        int x = (int)(g_stabilizer.target_pos.x - size / 2);
-        int y = (int)(g_stabilizer.target_pos.y - size / 2);
+        int x = (int)(active->target_pos.x - size / 2);
+        int y = (int)(active->target_pos.y - size / 2);
         
         SetWindowPos(g_target_window, HWND_TOPMOST, x, y, size, size, 
                      SWP_NOACTIVATE | SWP_SHOWWINDOW);
@@ -115,9 +119,10 @@ void TargetPointer_UpdateSettings(void) {
     
     // Update window size if currently visible
     if (g_target_visible) {
+        const SmoothStabilizer* active = MouseInput_GetActiveStabilizer();
         int size = g_stabilizer.target_size * 3;
-        int x = (int)(g_stabilizer.target_pos.x - size / 2);
-        int y = (int)(g_stabilizer.target_pos.y - size / 2);
+        int x = (int)(active->target_pos.x - size / 2);
+        int y = (int)(active->target_pos.y - size / 2);
         
         SetWindowPos(g_target_window, HWND_TOPMOST, x, y, size, size, 
                      SWP_NOACTIVATE | SWP_SHOWWINDOW);
@@ -0,0 +1,179 @@
+/**
+ * Telemetry Block - Shared-Memory State, Sample Ring and Command Mailbox
+ *
+ * The lock-free protocol behind the shared telemetry block. The writer
+ * side never waits on readers; readers copy what they need and validate
+ * it afterwards with sequence numbers, so a slow or crashed reader cannot
+ * hold up the stabilizer.
+ */
+
+#include "include/core/telemetry_block.h"
+
+#include <string.h>
+
+#define TELEMETRY_RING_MASK (TELEMETRY_RING_CAPACITY - 1)
+
+void TelemetryBlock_Initialize(TelemetryBlock* block, uint32_t process_id, uint64_t now_us) {
+    if (!block) return;
+
+    memset(block, 0, sizeof(*block));
+    TelemetryHeader* header = &block->header;
+    header->version = TELEMETRY_VERSION;
+    header->header_size = (uint16_t)sizeof(TelemetryHeader);
+    header->size = (uint32_t)sizeof(TelemetryBlock);
+    header->ring_capacity = TELEMETRY_RING_CAPACITY;
+    header->state_offset = (uint32_t)offsetof(TelemetryBlock, state_sequence);
+    header->ring_offset = (uint32_t)offsetof(TelemetryBlock, ring_head);
+    header->command_offset = (uint32_t)offsetof(TelemetryBlock, command);
+    header->writer_process_id = process_id;
+    header->started_us = now_us;
+
+    // Magic last: a reader that sees it sees a finished header
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(header->magic, TELEMETRY_MAGIC, 4);
+}
+
+TelemetryBlock* TelemetryBlock_Open(void* memory, size_t size) {
+    if (!memory || size < sizeof(TelemetryBlock)) return NULL;
+
+    TelemetryBlock* block = (TelemetryBlock*)memory;
+    const TelemetryHeader* header = &block->header;
+    if (memcmp(header->magic, TELEMETRY_MAGIC, 4) != 0) return NULL;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (header->version != TELEMETRY_VERSION || header->header_size != sizeof(TelemetryHeader) ||
+        header->size != sizeof(TelemetryBlock) ||
+        header->ring_capacity != TELEMETRY_RING_CAPACITY) {
+        return NULL;
+    }
+    return block;
+}
+
+void TelemetryBlock_PublishState(TelemetryBlock* block, const TelemetryState* state) {
+    if (!block || !state) return;
+
+    uint32_t sequence = block->state_sequence;
+    __atomic_store_n(&block->state_sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&block->state, state, sizeof(*state));
+    __atomic_store_n(&block->state_sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+bool TelemetryBlock_ReadState(const TelemetryBlock* block, TelemetryState* state) {
+    if (!block || !state) return false;
+
+    for (int attempt = 0; attempt < TELEMETRY_READ_ATTEMPTS; attempt++) {
+        uint32_t before = __atomic_load_n(&block->state_sequence, __ATOMIC_ACQUIRE);
+        if (before & 1) continue;
+        memcpy(state, &block->state, sizeof(*state));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&block->state_sequence, __ATOMIC_RELAXED) == before) return true;
+    }
+    return false;
+}
+
+void TelemetryBlock_PushSample(TelemetryBlock* block, const TelemetrySample* sample) {
+    if (!block || !sample) return;
+
+    uint64_t head = block->ring_head;
+    TelemetrySample* slot = &block->ring[head & TELEMETRY_RING_MASK];
+    __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->time_us = sample->time_us;
+    slot->target_x = sample->target_x;
+    slot->target_y = sample->target_y;
+    slot->output_x = sample->output_x;
+    slot->output_y = sample->output_y;
+    slot->kind = sample->kind;
+    slot->flags = sample->flags;
+    slot->buttons = sample->buttons;
+    __atomic_store_n(&slot->sequence, (uint32_t)(head + 1), __ATOMIC_RELEASE);
+    __atomic_store_n(&block->ring_head, head + 1, __ATOMIC_RELEASE);
+}
+
+size_t TelemetryBlock_ReadSamples(const TelemetryBlock* block, uint64_t* cursor,
+                                  TelemetrySample* samples, size_t capacity, uint64_t* lost) {
+    if (!block || !cursor || !samples) return 0;
+
+    uint64_t head = __atomic_load_n(&block->ring_head, __ATOMIC_ACQUIRE);
+    uint64_t next = *cursor;
+    uint64_t skipped = 0;
+
+    // A restarted writer begins again at zero
+    if (next > head) next = head;
+    if (head - next > TELEMETRY_RING_CAPACITY) {
+        skipped += head - TELEMETRY_RING_CAPACITY - next;
+        next = head - TELEMETRY_RING_CAPACITY;
+    }
+
+    size_t count = 0;
+    while (next < head && count < capacity) {
+        const TelemetrySample* slot = &block->ring[next & TELEMETRY_RING_MASK];
+        uint32_t expected = (uint32_t)(next + 1);
+        next++;
+
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != expected) {
+            skipped++;
+            continue;
+        }
+        memcpy(&samples[count], slot, sizeof(*slot));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) != expected) {
+            skipped++;  // Overwritten while copying
+            continue;
+        }
+        samples[count].sequence = expected;
+        count++;
+    }
+
+    *cursor = next;
+    if (lost) *lost += skipped;
+    return count;
+}
+
+bool TelemetryBlock_SendCommand(TelemetryBlock* block, TelemetryCommandType command, float value,
+                                uint32_t* ticket) {
+    if (!block) return false;
+
+    TelemetryCommandArea* area = &block->command;
+    uint32_t request = __atomic_load_n(&area->request, __ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&area->completed, __ATOMIC_ACQUIRE) != request) return false;
+
+    // Published by the release store of request below
+    area->command = (uint32_t)command;
+    area->value = value;
+    __atomic_store_n(&area->request, request + 1, __ATOMIC_RELEASE);
+    if (ticket) *ticket = request + 1;
+    return true;
+}
+
+bool TelemetryBlock_PollCommand(const TelemetryBlock* block, uint32_t ticket,
+                                TelemetryCommandStatus* status) {
+    if (!block) return false;
+
+    if (__atomic_load_n(&block->command.completed, __ATOMIC_ACQUIRE) != ticket) return false;
+    if (status) *status = (TelemetryCommandStatus)__atomic_load_n(&block->command.status,
+                                                                  __ATOMIC_RELAXED);
+    return true;
+}
+
+bool TelemetryBlock_TakeCommand(TelemetryBlock* block, TelemetryCommandType* command, float* value,
+                                uint32_t* ticket) {
+    if (!block) return false;
+
+    TelemetryCommandArea* area = &block->command;
+    uint32_t request = __atomic_load_n(&area->request, __ATOMIC_ACQUIRE);
+    if (request == area->completed) return false;
+
+    if (command) *command = (TelemetryCommandType)area->command;
+    if (value) *value = area->value;
+    if (ticket) *ticket = request;
+    return true;
+}
+
+void TelemetryBlock_CompleteCommand(TelemetryBlock* block, uint32_t ticket,
+                                    TelemetryCommandStatus status) {
+    if (!block) return;
+
+    __atomic_store_n(&block->command.status, (uint32_t)status, __ATOMIC_RELAXED);
+    __atomic_store_n(&block->command.completed, ticket, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,1989 @@
+/**
+ * Core Tests - Portable Stabilizer Engine
+ *
+ * Drives the core library through a fake platform with a virtual clock and
+ * a recording cursor sink. Builds with plain gcc: make test
+ */
+
+#include "include/core/stabilizer_core.h"
+#include "include/core/device_table.h"
+#include "include/core/log_ring.h"
+#include "include/core/binary_log.h"
+#include "include/core/latency_histogram.h"
+#include "include/core/event_trace.h"
+#include "include/core/perf_counters.h"
+#include "include/core/telemetry_block.h"
+#include "include/core/metrics_text.h"
+#include "include/core/hook_watchdog.h"
+#include "include/core/input_trace.h"
+#include "include/core/flight_recorder.h"
+#include "include/core/trace_replay.h"
+#include "include/core/trace_index.h"
+#include "include/core/trajectory_metrics.h"
+#include "include/core/trajectory_report.h"
+#include "include/core/stabilizer_batch.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int g_checks = 0;
+static int g_failures = 0;
+
+#define CHECK(condition) do { \
+    g_checks++; \
+    if (!(condition)) { \
+        g_failures++; \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+    } \
+} while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    CHECK(fabs((double)(actual) - (double)(expected)) <= (tolerance))
+
+// Fake host: virtual clock, cursor that follows our own writes, two monitors.
+// Each host owns everything an instance is bound to, so several can run at once.
+typedef struct {
+    uint64_t now_us;
+    int cursor_x, cursor_y;
+    OutputRecording recording;
+    Platform platform;
+    ScreenGeometry geometry;
+    OutputSink sink;
+} FakeHost;
+
+static FakeHost g_host;
+
+static uint64_t FakeHost_NowMicros(void* context) {
+    return ((FakeHost*)context)->now_us;
+}
+
+static bool FakeHost_GetCursor(void* context, int* x, int* y) {
+    FakeHost* host = (FakeHost*)context;
+    *x = host->cursor_x;
+    *y = host->cursor_y;
+    return true;
+}
+
+static int FakeHost_QueryMonitors(void* context, ScreenRect* monitors, int max) {
+    (void)context;
+    static const ScreenRect layout[2] = {
+        {0, 0, 1920, 1080},
+        {-1280, 200, 0, 1224}
+    };
+    int count = max < 2 ? max : 2;
+    memcpy(monitors, layout, sizeof(layout[0]) * (size_t)count);
+    return count;
+}
+
+static void FakeHost_Log(void* context, LogLevel level, const char* format, va_list args) {
+    (void)context;
+    if (level > LOG_WARN) return;
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+}
+
+static bool FakeHost_Write(void* context, int x, int y) {
+    FakeHost* host = (FakeHost*)context;
+    host->cursor_x = x;
+    host->cursor_y = y;
+    return OutputSink_WriteRecording(&host->recording, x, y);
+}
+
+static void FakeHost_Initialize(FakeHost* host, int cursor_x, int cursor_y) {
+    memset(host, 0, sizeof(*host));
+    host->now_us = 1000000;
+    host->cursor_x = cursor_x;
+    host->cursor_y = cursor_y;
+    host->platform.context = host;
+    host->platform.now_us = FakeHost_NowMicros;
+    host->platform.get_cursor = FakeHost_GetCursor;
+    host->platform.query_monitors = FakeHost_QueryMonitors;
+    host->platform.log = FakeHost_Log;
+    OutputSink_Initialize(&host->sink, FakeHost_Write, host);
+    ScreenGeometry_Refresh(&host->geometry, &host->platform);
+}
+
+static void FakeHost_Bind(FakeHost* host, SmoothStabilizer* stabilizer) {
+    StabilizerCore_Initialize(stabilizer, &host->platform, &host->geometry, &host->sink);
+}
+
+static void FakeHost_Reset(int cursor_x, int cursor_y) {
+    FakeHost_Initialize(&g_host, cursor_x, cursor_y);
+}
+
+static void FakeHost_Tick(FakeHost* host, SmoothStabilizer* stabilizer, int ticks) {
+    for (int i = 0; i < ticks; i++) {
+        host->now_us += UPDATE_INTERVAL_MS * 1000;
+        StabilizerCore_UpdatePosition(stabilizer);
+    }
+}
+
+static void RunTicks(SmoothStabilizer* stabilizer, int ticks) {
+    FakeHost_Tick(&g_host, stabilizer, ticks);
+}
+
+static void Test_Easing(void) {
+    EaseType types[] = {EASE_LINEAR, EASE_IN, EASE_OUT, EASE_IN_OUT};
+    for (int i = 0; i < 4; i++) {
+        CHECK(StabilizerCore_ApplyEasing(0.0f, types[i]) == 0.0f);
+        CHECK(StabilizerCore_ApplyEasing(1.0f, types[i]) == 1.0f);
+        float previous = 0.0f;
+        for (int step = 1; step <= 10; step++) {
+            float value = StabilizerCore_ApplyEasing((float)step / 10.0f, types[i]);
+            CHECK(value >= previous);
+            previous = value;
+        }
+    }
+}
+
+static void Test_FollowsTarget(void) {
+    FakeHost_Reset(100, 100);
+    SmoothStabilizer stabilizer;
+    FakeHost_Bind(&g_host, &stabilizer);
+    stabilizer.delay_start_ms = 0;
+
+    // First packet engages at the real cursor, the second moves the target
+    StabilizerCore_AddMouseDelta(&stabilizer, 1.0f, 0.0f, g_host.now_us);
+    CHECK(StabilizerCore_IsEngaged(&stabilizer));
+    StabilizerCore_AddMouseDelta(&stabilizer, 50.0f, 0.0f, g_host.now_us);
+    CHECK_NEAR(stabilizer.target_pos.x, 150.0f, 1e-3);
+
+    RunTicks(&stabilizer, 200);
+    CHECK(g_host.recording.count > 1);
+    CHECK_NEAR(g_host.cursor_x, 150, 1);
+    CHECK(g_host.cursor_y == 100);
+
+    // The path never overshoots or steps backwards
+    for (int i = 1; i < g_host.recording.count; i++) {
+        CHECK(g_host.recording.points[i].x >= g_host.recording.points[i - 1].x);
+        CHECK(g_host.recording.points[i].x <= 150);
+    }
+
+    // At rest nothing more reaches the OS
+    int settled = g_host.recording.count;
+    RunTicks(&stabilizer, 50);
+    CHECK(g_host.recording.count == settled);
+}
+
+static void Test_DelayStart(void) {
+    FakeHost_Reset(500, 500);
+    SmoothStabilizer stabilizer;
+    FakeHost_Bind(&g_host, &stabilizer);
+    stabilizer.delay_start_ms = 100;
+
+    StabilizerCore_AddMouseDelta(&stabilizer, 1.0f, 0.0f, g_host.now_us);
+    StabilizerCore_AddMouseDelta(&stabilizer, 0.0f, 40.0f, g_host.now_us);
+
+    RunTicks(&stabilizer, 10);  // 80ms: still inside the delay
+    CHECK(g_host.recording.count == 0);
+
+    RunTicks(&stabilizer, 10);
+    CHECK(g_host.recording.count > 0);
+}
+
+static void Test_DragOnly(void) {
+    FakeHost_Reset(300, 300);
+    SmoothStabilizer stabilizer;
+    FakeHost_Bind(&g_host, &stabilizer);
+    stabilizer.delay_start_ms = 0;
+    stabilizer.drag_only = true;
+    stabilizer.drag_button = DRAG_BUTTON_LEFT;
+
+    StabilizerCore_AddMouseDelta(&stabilizer, 10.0f, 0.0f, g_host.now_us);
+    CHECK(!StabilizerCore_IsEngaged(&stabilizer));
+
+    StabilizerCore_UpdateButtons(&stabilizer, STABILIZER_BUTTON_RIGHT, 0);
+    CHECK(!StabilizerCore_IsEngaged(&stabilizer));
+
+    StabilizerCore_UpdateButtons(&stabilizer, STABILIZER_BUTTON_LEFT, 0);
+    CHECK(StabilizerCore_IsEngaged(&stabilizer));
+
+    StabilizerCore_AddMouseDelta(&stabilizer, 30.0f, 0.0f, g_host.now_us);
+    StabilizerCore_UpdateButtons(&stabilizer, 0, STABILIZER_BUTTON_LEFT);
+    CHECK(StabilizerCore_IsEngaged(&stabilizer));  // Still catching up
+
+    // Moving on after the release: back to pass-through within the bound, on the target
+    for (int i = 0; i < STABILIZER_RELEASE_TICKS; i++) {
+        CHECK(StabilizerCore_IsEngaged(&stabilizer));
+        StabilizerCore_AddMouseDelta(&stabilizer, 5.0f, 0.0f, g_host.now_us);
+        RunTicks(&stabilizer, 1);
+    }
+    CHECK(!StabilizerCore_IsEngaged(&stabilizer));
+    CHECK(g_host.cursor_x == 350 && g_host.cursor_y == 300);
+
+    // From then on the OS moves the cursor and the engine adds nothing
+    uint64_t issued = g_host.sink.issued;
+    for (int i = 0; i < 10; i++) {
+        StabilizerCore_AddMouseDelta(&stabilizer, 5.0f, 0.0f, g_host.now_us);
+        RunTicks(&stabilizer, 1);
+    }
+    CHECK(!StabilizerCore_IsEngaged(&stabilizer));
+    CHECK(g_host.sink.issued == issued);
+
+    // A release with the cursor already on the target hands back on the next tick
+    StabilizerCore_UpdateButtons(&stabilizer, STABILIZER_BUTTON_LEFT, 0);
+    StabilizerCore_UpdateButtons(&stabilizer, 0, STABILIZER_BUTTON_LEFT);
+    RunTicks(&stabilizer, 1);
+    CHECK(!StabilizerCore_IsEngaged(&stabilizer));
+}
+
+static void Test_ClampAcrossMonitors(void) {
+    FakeHost_Reset(10, 10);
+    CHECK(g_host.geometry.monitor_count == 2);
+    CHECK(g_host.geometry.bounds.left == -1280 && g_host.geometry.bounds.bottom == 1224);
+
+    SmoothStabilizer stabilizer;
+    FakeHost_Bind(&g_host, &stabilizer);
+
+    // Onto the left monitor (negative coordinates) is allowed
+    StabilizerCore_AddMouseDelta(&stabilizer, 1.0f, 0.0f, g_host.now_us);
+    StabilizerCore_AddMouseDelta(&stabilizer, -500.0f, 400.0f, g_host.now_us);
+    CHECK_NEAR(stabilizer.target_pos.x, -490.0f, 1e-3);
+    CHECK_NEAR(stabilizer.target_pos.y, 410.0f, 1e-3);
+
+    // Off the bottom of the left monitor snaps to its edge
+    StabilizerCore_AddMouseDelta(&stabilizer, 0.0f, 5000.0f, g_host.now_us);
+    CHECK_NEAR(stabilizer.target_pos.y, 1223.0f, 1e-3);
+
+    // The gap above the left monitor snaps to the nearest monitor
+    float x = -5.0f, y = 100.0f;
+    int hint = 0;
+    ScreenGeometry_Clamp(&g_host.geometry, &hint, &x, &y);
+    CHECK(x == 0.0f && y == 100.0f);
+    CHECK(hint == 0);
+}
+
+static void Test_OutputSink(void) {
+    OutputRecording recording;
+    memset(&recording, 0, sizeof(recording));
+    OutputSink sink;
+    OutputSink_Initialize(&sink, OutputSink_WriteRecording, &recording);
+
+    // Slow diagonal: small steps add up to whole pixels instead of being lost
+    for (int i = 0; i < 20; i++) {
+        OutputSink_MoveTo(&sink, -10.0f + 0.3f * (float)i, 5.0f + 0.1f * (float)i);
+    }
+    CHECK(recording.count == 7);
+    CHECK(recording.points[recording.count - 1].x == -4);
+    CHECK(recording.points[recording.count - 1].y == 7);
+
+    // Repeating the same position is skipped, not dithered
+    for (int i = 0; i < 5; i++) {
+        OutputSink_MoveTo(&sink, -4.3f, 6.9f);
+    }
+    CHECK(recording.count == 7);
+    CHECK(sink.issued == 7);
+    CHECK(sink.skipped == 18);
+    CHECK(sink.failed == 0);
+
+    // Slow shallow line y = 0.4x + 0.2: rounding each axis on its own puts
+    // pixels more than half a pixel off the line and steps in L shapes; the
+    // sink keeps every pixel within half a pixel of it, one column per move
+    memset(&recording, 0, sizeof(recording));
+    OutputSink_Initialize(&sink, OutputSink_WriteRecording, &recording);
+    int rounded_x = 0, rounded_y = 0, rounded_moves = 0, rounded_l_steps = 0;
+    double rounded_error = 0.0;
+    for (int i = 0; i <= 400; i++) {
+        float x = 0.05f * (float)i;
+        float y = 0.4f * x + 0.2f;
+        OutputSink_MoveTo(&sink, x, y);
+
+        int px = (int)floorf(x + 0.5f), py = (int)floorf(y + 0.5f);
+        if (i == 0 || px != rounded_x || py != rounded_y) {
+            if (i > 0 && px == rounded_x) rounded_l_steps++;
+            double error = fabs((double)py - (0.4 * px + 0.2));
+            if (error > rounded_error) rounded_error = error;
+            rounded_x = px;
+            rounded_y = py;
+            rounded_moves++;
+        }
+    }
+    double line_error = 0.0;
+    bool columns = true;
+    for (int i = 0; i < recording.count; i++) {
+        double error = fabs((double)recording.points[i].y - (0.4 * recording.points[i].x + 0.2));
+        if (error > line_error) line_error = error;
+        if (i > 0) {
+            columns &= recording.points[i].x == recording.points[i - 1].x + 1 &&
+                       abs(recording.points[i].y - recording.points[i - 1].y) <= 1;
+        }
+    }
+    CHECK(rounded_error > 0.55 && rounded_l_steps > 0);
+    CHECK(line_error <= 0.5 + 1e-3);
+    CHECK(columns);
+    CHECK(recording.count == 21 && recording.count < rounded_moves);
+    CHECK(recording.points[recording.count - 1].x == 20);
+    CHECK(recording.points[recording.count - 1].y == 8);
+}
+
+static void Test_VelocityEstimator(void) {
+    VelocityEstimator estimator;
+    VelocityEstimator_Reset(&estimator, 0);
+    CHECK(estimator.window_us == (uint64_t)DEFAULT_VELOCITY_WINDOW_MS * 1000);
+
+    // 1000 px/s right, accelerating 2000 px/s^2 down, one sample per ms
+    uint64_t start = 5000000;
+    for (int i = 0; i <= 100; i++) {
+        double t = (double)i / 1000.0;
+        VelocityEstimator_AddSample(&estimator, start + (uint64_t)i * 1000,
+                                    (float)(1000.0 * t), (float)(1000.0 * t * t));
+    }
+    CHECK_NEAR(estimator.velocity_x, 1000.0, 5.0);
+    CHECK_NEAR(estimator.velocity_y, 200.0, 5.0);
+    CHECK_NEAR(estimator.acceleration_y, 2000.0, 100.0);
+
+    VelocityEstimator_Expire(&estimator, start + 200000);
+    CHECK(estimator.count == 0);
+    CHECK(estimator.speed == 0.0f);
+}
+
+// One scripted stroke: a fixed pattern of deltas and ticks on a private host
+#define MULTI_INSTANCE_COUNT 4
+
+typedef struct {
+    FakeHost host;
+    SmoothStabilizer stabilizer;
+    int seed;
+    int step;
+} InstanceRun;
+
+static void InstanceRun_Start(InstanceRun* run, int seed) {
+    FakeHost_Initialize(&run->host, 200 + seed * 10, 300);
+    FakeHost_Bind(&run->host, &run->stabilizer);
+    run->stabilizer.delay_start_ms = 0;
+    run->stabilizer.ease_type = (EaseType)(seed % 4);
+    run->stabilizer.dual_mode = (seed % 2) == 1;
+    run->seed = seed;
+    run->step = 0;
+}
+
+static bool InstanceRun_Step(InstanceRun* run) {
+    if (run->step >= 120) return false;
+
+    float dx = (float)((run->step * 7 + run->seed * 3) % 11) - 3.0f;
+    float dy = (float)((run->step * 5 + run->seed) % 7) - 2.0f;
+    StabilizerCore_AddMouseDelta(&run->stabilizer, dx, dy, run->host.now_us);
+    FakeHost_Tick(&run->host, &run->stabilizer, 1);
+    run->step++;
+    return true;
+}
+
+static void* InstanceRun_Thread(void* argument) {
+    InstanceRun* run = (InstanceRun*)argument;
+    while (InstanceRun_Step(run)) {}
+    return NULL;
+}
+
+static bool InstanceRun_SameOutput(const InstanceRun* a, const InstanceRun* b) {
+    if (a->host.recording.count != b->host.recording.count) return false;
+    return memcmp(a->host.recording.points, b->host.recording.points,
+                  sizeof(a->host.recording.points[0]) * (size_t)a->host.recording.count) == 0;
+}
+
+// Settings written the way sweep writes its preset must load back unchanged
+static void Test_SettingsRoundTrip(void) {
+    bool all_equal = true;
+    for (int i = 0; i < 400; i++) {
+        SmoothStabilizer written;
+        StabilizerCore_Initialize(&written, NULL, NULL, NULL);
+        written.follow_strength = -0.5f + (float)i * 0.00731f;
+        written.min_distance = -1.0f + (float)i * 0.0377f;
+        written.delay_start_ms = (uint32_t)(i * 9);
+        StabilizerCore_SnapSettings(&written);
+
+        // The ini's integer units, then Settings_Load's conversion and clamps
+        int follow = (int)floorf(written.follow_strength * STABILIZER_INI_FOLLOW_SCALE + 0.5f);
+        int distance = (int)floorf(written.min_distance * STABILIZER_INI_DISTANCE_SCALE + 0.5f);
+        SmoothStabilizer loaded;
+        StabilizerCore_Initialize(&loaded, NULL, NULL, NULL);
+        loaded.follow_strength = (float)follow / (float)STABILIZER_INI_FOLLOW_SCALE;
+        loaded.min_distance = (float)distance / (float)STABILIZER_INI_DISTANCE_SCALE;
+        loaded.delay_start_ms = written.delay_start_ms;
+        StabilizerCore_ClampSettings(&loaded);
+
+        all_equal &= loaded.follow_strength == written.follow_strength &&
+                     loaded.min_distance == written.min_distance &&
+                     loaded.delay_start_ms == written.delay_start_ms;
+    }
+    CHECK(all_equal);
+
+    SmoothStabilizer edge;
+    StabilizerCore_Initialize(&edge, NULL, NULL, NULL);
+    edge.follow_strength = 0.0f;
+    edge.min_distance = 0.0f;
+    edge.delay_start_ms = 5000;
+    edge.ease_type = (EaseType)7;
+    StabilizerCore_SnapSettings(&edge);
+    CHECK(edge.follow_strength == STABILIZER_FOLLOW_STRENGTH_MIN);
+    CHECK(edge.min_distance == STABILIZER_MIN_DISTANCE_MIN);
+    CHECK(edge.delay_start_ms == STABILIZER_DELAY_START_MAX_MS);
+    CHECK(edge.ease_type == EASE_OUT);
+}
+
+static void Test_MultiInstance(void) {
+    static InstanceRun reference[MULTI_INSTANCE_COUNT];
+    static InstanceRun interleaved[MULTI_INSTANCE_COUNT];
+    static InstanceRun threaded[MULTI_INSTANCE_COUNT];
+
+    // Each instance alone is the reference
+    for (int i = 0; i < MULTI_INSTANCE_COUNT; i++) {
+        InstanceRun_Start(&reference[i], i);
+        while (InstanceRun_Step(&reference[i])) {}
+        CHECK(reference[i].host.recording.count > 0);
+    }
+
+    // Round-robin on one thread: no state leaks between instances
+    for (int i = 0; i < MULTI_INSTANCE_COUNT; i++) {
+        InstanceRun_Start(&interleaved[i], i);
+    }
+    bool running = true;
+    while (running) {
+        running = false;
+        for (int i = 0; i < MULTI_INSTANCE_COUNT; i++) {
+            running |= InstanceRun_Step(&interleaved[i]);
+        }
+    }
+
+    // One thread per instance
+    pthread_t threads[MULTI_INSTANCE_COUNT];
+    for (int i = 0; i < MULTI_INSTANCE_COUNT; i++) {
+        InstanceRun_Start(&threaded[i], i);
+        CHECK(pthread_create(&threads[i], NULL, InstanceRun_Thread, &threaded[i]) == 0);
+    }
+    for (int i = 0; i < MULTI_INSTANCE_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (int i = 0; i < MULTI_INSTANCE_COUNT; i++) {
+        CHECK(InstanceRun_SameOutput(&reference[i], &interleaved[i]));
+        CHECK(InstanceRun_SameOutput(&reference[i], &threaded[i]));
+    }
+}
+
+static void Test_InputTrace(void) {
+    static uint8_t buffer[64 * 1024];
+    InputTraceState state;
+    uint64_t start = 7000000;
+    uint64_t time = start;
+    size_t length = InputTrace_WriteHeader(buffer, start);
+    InputTrace_ResetState(&state, start);
+
+    // 8 kHz stream from one device with a button press and an occasional second device
+    for (int i = 0; i < 8000; i++) {
+        time += 120 + (uint64_t)(i % 11);
+        uint64_t device = (i % 1000 == 999) ? 0x2000 : 0x1000;
+        int32_t dx = (i % 7) - 3;
+        int32_t dy = (i % 5) - 2;
+        unsigned int pressed = (i == 100) ? STABILIZER_BUTTON_LEFT : 0;
+        length += InputTrace_EncodePacket(&state, buffer + length, time, device, dx, dy,
+                                          pressed, 0);
+    }
+    CHECK((double)(length - INPUT_TRACE_HEADER_SIZE) / 8000.0 <= 4.0);
+
+    length += InputTrace_EncodeOutput(&state, buffer + length, time + 10, -640.25f, 99.5f);
+    CHECK(InputTrace_EncodeOutput(&state, buffer + length, time + 20, -640.25f, 99.5f) == 0);
+    length += InputTrace_EncodeGap(buffer + length, 42);
+
+    InputTraceReader reader;
+    CHECK(InputTrace_OpenReader(&reader, buffer, length));
+    CHECK(reader.start_us == start);
+
+    InputTraceRecord record;
+    int packets = 0, devices = 0, outputs = 0, gaps = 0;
+    bool match = true;
+    time = start;
+    while (InputTrace_Read(&reader, &record)) {
+        switch (record.type) {
+            case INPUT_TRACE_PACKET:
+                time += 120 + (uint64_t)(packets % 11);
+                match &= record.time_us == time;
+                match &= record.device == ((packets % 1000 == 999) ? 0x2000u : 0x1000u);
+                match &= record.dx == (packets % 7) - 3 && record.dy == (packets % 5) - 2;
+                match &= record.pressed == ((packets == 100) ? STABILIZER_BUTTON_LEFT : 0u);
+                packets++;
+                break;
+            case INPUT_TRACE_DEVICE:
+                devices++;
+                break;
+            case INPUT_TRACE_OUTPUT:
+                outputs++;
+                CHECK(record.x == -640.25f && record.y == 99.5f);
+                CHECK(record.time_us == time + 10);
+                break;
+            case INPUT_TRACE_GAP:
+                gaps++;
+                CHECK(record.dropped == 42);
+                break;
+        }
+    }
+    CHECK(match);
+    CHECK(!reader.corrupt);
+    CHECK(packets == 8000 && outputs == 1 && gaps == 1);
+    CHECK(devices == 16);  // Initial device, eight switches to 0x2000 and seven back
+
+    // A truncated trace stops cleanly and is flagged
+    CHECK(InputTrace_OpenReader(&reader, buffer, length - 1));
+    while (InputTrace_Read(&reader, &record)) {}
+    CHECK(reader.corrupt);
+
+    CHECK(!InputTrace_OpenReader(&reader, buffer + 1, length - 1));
+}
+
+static void Replay_CountOutput(void* context, uint64_t time_us, float x, float y) {
+    (void)time_us;
+    (void)x;
+    (void)y;
+    (*(int*)context)++;
+}
+
+static void Test_TraceReplay(void) {
+    static uint8_t buffer[16 * 1024];
+    InputTraceState state;
+    uint64_t time = 2000000;
+    size_t length = InputTrace_WriteHeader(buffer, time);
+    InputTrace_ResetState(&state, time);
+
+    // 100ms of 1 kHz packets moving right, then a recorded output as the start hint
+    length += InputTrace_EncodeOutput(&state, buffer + length, time, 400.0f, 300.0f);
+    for (int i = 0; i < 100; i++) {
+        time += 1000;
+        length += InputTrace_EncodePacket(&state, buffer + length, time, 0x10, 2, 0, 0, 0);
+    }
+
+    SmoothStabilizer settings;
+    StabilizerCore_Initialize(&settings, NULL, NULL, NULL);
+    settings.delay_start_ms = 0;
+
+    static TraceReplay replay;
+    int outputs = 0;
+    CHECK(TraceReplay_Open(&replay, buffer, length, &settings, NULL, Replay_CountOutput, &outputs));
+    while (TraceReplay_Step(&replay, 7)) {}
+    CHECK(replay.stats.packets == 100);
+    CHECK(replay.stats.recorded_outputs == 1);
+    CHECK(replay.stats.ticks ==
+          (100000 + TRACE_REPLAY_DEFAULT_TAIL_MS * 1000) / (UPDATE_INTERVAL_MS * 1000));
+    CHECK(outputs > 0 && (uint64_t)outputs == replay.stats.outputs);
+    CHECK_NEAR(replay.stabilizer.current_pos.x, 600.0f, 1.0);
+    CHECK(replay.stabilizer.current_pos.y == 300.0f);
+    CHECK(!TraceReplay_Step(&replay, 1));
+
+    // SetTimer-style quantization: 8ms requested on a 15.625ms timer
+    CHECK(TraceReplay_TickPeriod(8000, TRACE_REPLAY_WINDOWS_TIMER_US) == 15625);
+    CHECK(TraceReplay_TickPeriod(16000, TRACE_REPLAY_WINDOWS_TIMER_US) == 31250);
+    CHECK(TraceReplay_TickPeriod(8000, 0) == 8000);
+
+    // Same trace and settings replay to the same trajectory
+    TraceReplayOptions options;
+    TraceReplay_DefaultOptions(&options);
+    options.timer_resolution_us = TRACE_REPLAY_WINDOWS_TIMER_US;
+    static TraceReplay first, second;
+    CHECK(TraceReplay_Open(&first, buffer, length, &settings, &options, NULL, NULL));
+    CHECK(TraceReplay_Open(&second, buffer, length, &settings, &options, NULL, NULL));
+    while (TraceReplay_Step(&first, 1000)) {}
+    while (TraceReplay_Step(&second, 3)) {}
+    CHECK(first.stats.ticks < replay.stats.ticks);
+    CHECK(first.stats.ticks == second.stats.ticks);
+    CHECK(first.stabilizer.current_pos.x == second.stabilizer.current_pos.x);
+}
+
+static void Test_EngineSnapshot(void) {
+    static FakeHost host_a, host_b;
+    static SmoothStabilizer a, b;
+    FakeHost_Initialize(&host_a, 500, 500);
+    FakeHost_Initialize(&host_b, 0, 0);
+    FakeHost_Bind(&host_a, &a);
+    FakeHost_Bind(&host_b, &b);
+    a.delay_start_ms = 20;
+    a.ease_type = EASE_IN_OUT;
+
+    // Mid-stroke, with velocity history and a pending delay
+    for (int i = 0; i < 40; i++) {
+        host_a.now_us += 1000;
+        StabilizerCore_AddMouseDelta(&a, 3.0f, (float)(i % 3) - 1.0f, host_a.now_us);
+        if (i % 8 == 7) StabilizerCore_UpdatePosition(&a);
+    }
+
+    static uint8_t snapshot[STABILIZER_STATE_MAX_SIZE], scratch[STABILIZER_STATE_MAX_SIZE];
+    size_t length = StabilizerCore_SaveState(&a, snapshot, sizeof(snapshot));
+    CHECK(length > STABILIZER_STATE_HEADER_SIZE && length <= STABILIZER_STATE_MAX_SIZE);
+    CHECK(StabilizerCore_SaveState(&a, scratch, length - 1) == 0);
+    CHECK(StabilizerCore_RestoreState(&b, snapshot, length));
+    CHECK(b.platform == &host_b.platform && b.output == &host_b.sink);
+    CHECK(b.ease_type == EASE_IN_OUT && b.delay_start_ms == 20);
+    CHECK(b.motion.count == a.motion.count && b.motion.speed == a.motion.speed);
+
+    // Both continue bit for bit on the same input
+    host_b.now_us = host_a.now_us;
+    host_b.cursor_x = host_a.cursor_x;
+    host_b.cursor_y = host_a.cursor_y;
+    bool same = true;
+    for (int i = 0; i < 200; i++) {
+        host_a.now_us += 1000;
+        host_b.now_us += 1000;
+        if (i < 120) {
+            StabilizerCore_AddMouseDelta(&a, 2.0f, 1.0f, host_a.now_us);
+            StabilizerCore_AddMouseDelta(&b, 2.0f, 1.0f, host_b.now_us);
+        }
+        if (i % 8 == 7) {
+            StabilizerCore_UpdatePosition(&a);
+            StabilizerCore_UpdatePosition(&b);
+        }
+        same &= a.current_pos.x == b.current_pos.x && a.current_pos.y == b.current_pos.y;
+    }
+    CHECK(same);
+    CHECK(host_a.cursor_x == host_b.cursor_x && host_a.cursor_y == host_b.cursor_y);
+
+    // Truncated, corrupted or future snapshots leave the instance alone
+    MousePos before = b.current_pos;
+    CHECK(!StabilizerCore_RestoreState(&b, snapshot, length - 1));
+    snapshot[4] = STABILIZER_STATE_VERSION + 1;
+    CHECK(!StabilizerCore_RestoreState(&b, snapshot, length));
+    snapshot[4] = STABILIZER_STATE_VERSION;
+    snapshot[0] ^= 0xFF;
+    CHECK(!StabilizerCore_RestoreState(&b, snapshot, length));
+    CHECK(b.current_pos.x == before.x && b.current_pos.y == before.y);
+}
+
+#define INDEX_TEST_MAX_OUTPUTS 4096
+
+typedef struct {
+    uint64_t time_us[INDEX_TEST_MAX_OUTPUTS];
+    float x[INDEX_TEST_MAX_OUTPUTS], y[INDEX_TEST_MAX_OUTPUTS];
+    int count;
+} IndexTestPath;
+
+typedef struct {
+    uint8_t data[256 * 1024];
+    size_t length;
+} IndexTestBuffer;
+
+static void IndexTest_Record(void* context, uint64_t time_us, float x, float y) {
+    IndexTestPath* path = (IndexTestPath*)context;
+    if (path->count >= INDEX_TEST_MAX_OUTPUTS) return;
+    path->time_us[path->count] = time_us;
+    path->x[path->count] = x;
+    path->y[path->count] = y;
+    path->count++;
+}
+
+static bool IndexTest_Write(void* context, const uint8_t* data, size_t length) {
+    IndexTestBuffer* buffer = (IndexTestBuffer*)context;
+    if (buffer->length + length > sizeof(buffer->data)) return false;
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return true;
+}
+
+static void Test_TraceIndex(void) {
+    static uint8_t trace[64 * 1024];
+    static IndexTestBuffer index_data;
+    static IndexTestPath full, seeked;
+    InputTraceState state;
+    uint64_t start = 3000000, time = start;
+    size_t length = InputTrace_WriteHeader(trace, time);
+    InputTrace_ResetState(&state, time);
+    length += InputTrace_EncodeOutput(&state, trace + length, time, 800.0f, 400.0f);
+
+    // Two drag strokes at 1 kHz with a second of rest between them
+    for (int i = 0; i < 3000; i++) {
+        time += 1000;
+        bool moving = i < 1000 || i >= 2000;
+        int32_t dx = moving ? (i % 4 == 0 ? 3 : 1) : 0;
+        int32_t dy = moving ? ((i / 250) % 2 ? 1 : -1) : 0;
+        unsigned int pressed = (i == 0 || i == 2000) ? STABILIZER_BUTTON_LEFT : 0;
+        unsigned int released = (i == 999 || i == 2999) ? STABILIZER_BUTTON_LEFT : 0;
+        length += InputTrace_EncodePacket(&state, trace + length, time, 0x10, dx, dy, pressed,
+                                          released);
+    }
+
+    SmoothStabilizer settings;
+    StabilizerCore_Initialize(&settings, NULL, NULL, NULL);
+    settings.drag_only = true;
+    settings.delay_start_ms = 30;
+
+    TraceIndexSummary summary;
+    index_data.length = 0;
+    CHECK(TraceIndex_Build(trace, length, &settings, NULL, 400, IndexTest_Write, &index_data,
+                           &summary));
+    CHECK(summary.checkpoints == 7 && summary.bytes == index_data.length);
+    CHECK(summary.strokes == 2);
+
+    TraceIndexReader index;
+    CHECK(TraceIndex_Open(&index, index_data.data, index_data.length));
+    CHECK(TraceIndex_Matches(&index, trace, length));
+    CHECK(!TraceIndex_Matches(&index, trace, length - 1));
+    CHECK(index.interval_ms == 400 && index.options.tick_interval_us == UPDATE_INTERVAL_MS * 1000);
+
+    TraceIndexEntry entry;
+    int checkpoints = 0, strokes = 0;
+    uint64_t last_checkpoint = 0;
+    while (TraceIndex_Next(&index, &entry)) {
+        if (entry.type == TRACE_INDEX_CHECKPOINT) {
+            CHECK(entry.time_us > last_checkpoint);
+            last_checkpoint = entry.time_us;
+            checkpoints++;
+        } else if (entry.type == TRACE_INDEX_STROKE) {
+            uint64_t expected = strokes == 0 ? start : start + 2000000;
+            CHECK(entry.time_us >= expected && entry.time_us < expected + 20000);
+            CHECK(entry.end_us > entry.time_us + 900000);
+            strokes++;
+        }
+    }
+    CHECK(!index.corrupt);
+    CHECK((uint64_t)checkpoints == summary.checkpoints && strokes == 2);
+
+    // Full replay for reference
+    static TraceReplay replay;
+    full.count = 0;
+    CHECK(TraceReplay_Open(&replay, trace, length, &settings, NULL, IndexTest_Record, &full));
+    while (TraceReplay_Step(&replay, 100)) {}
+    uint64_t full_ticks = replay.stats.ticks;
+    CHECK(full.count > 100);
+
+    // Seeking anywhere continues exactly like the full replay: mid-stroke,
+    // at rest, before the first checkpoint and past the last packet
+    const uint64_t targets[4] = {start + 2345678, start + 1500000, start + 100000, start + 3500000};
+    for (int t = 0; t < 4; t++) {
+        seeked.count = 0;
+        CHECK(TraceIndex_Seek(&index, &replay, trace, length, targets[t], IndexTest_Record,
+                              &seeked));
+        CHECK(replay.now_us <= targets[t]);
+        while (TraceReplay_Step(&replay, 100)) {}
+        CHECK(replay.stats.ticks == full_ticks);
+
+        int offset = 0;
+        while (offset < full.count && seeked.count > 0 &&
+               full.time_us[offset] < seeked.time_us[0]) offset++;
+        bool same = seeked.count > 0 ? offset + seeked.count == full.count
+                                     : targets[t] > full.time_us[full.count - 1];
+        for (int i = 0; same && i < seeked.count; i++) {
+            same = seeked.time_us[i] == full.time_us[offset + i] &&
+                   seeked.x[i] == full.x[offset + i] &&
+                   seeked.y[i] == full.y[offset + i];
+        }
+        CHECK(same);
+        CHECK(seeked.count == 0 || targets[t] > time ||
+              seeked.time_us[0] + UPDATE_INTERVAL_MS * 1000 >= targets[t]);
+    }
+
+    // A different trace, a damaged index or a future format version is refused
+    CHECK(!TraceIndex_Seek(&index, &replay, trace, length - 1, start, NULL, NULL));
+    index_data.data[4] = TRACE_INDEX_VERSION + 1;
+    CHECK(!TraceIndex_Open(&index, index_data.data, index_data.length));
+    index_data.data[4] = TRACE_INDEX_VERSION;
+    CHECK(TraceIndex_Open(&index, index_data.data, index_data.length - 3));
+    while (TraceIndex_Next(&index, &entry)) {}
+    CHECK(index.corrupt);
+}
+
+static void Test_FlightRecorder(void) {
+    static FlightRecorder recorder;
+    static IndexTestBuffer dump;
+    FlightRecorder_Initialize(&recorder);
+
+    // One ring's worth of 8 kHz packets with an output and a tick every 64th
+    // packet: the ring wraps, so the oldest records are gone
+    int count = FLIGHT_RECORDER_CAPACITY;
+    uint64_t now = 0;
+    for (int i = 0; i < count; i++) {
+        now = 2000 + (uint64_t)i * 125;
+        FlightRecorder_RecordPacket(&recorder, now, 0x1000, (i % 7) - 3, (i % 5) - 2, 0, 0);
+        if (i % 64 == 0) {
+            FlightRecorder_RecordOutput(&recorder, now, 10.5f + (float)(i / 64), 20.25f);
+            // Unchanged: skipped
+            FlightRecorder_RecordOutput(&recorder, now, 10.5f + (float)(i / 64), 20.25f);
+            FlightRecorder_RecordTick(&recorder, now, (uint32_t)(i % 100), true, 1.5f);
+        }
+    }
+    CHECK(recorder.head == (uint64_t)count + 2 * (uint64_t)(count / 64));
+
+    // The last second; the position from just before it comes first
+    FlightRecorderSummary summary;
+    memset(&dump, 0, sizeof(dump));
+    CHECK(FlightRecorder_WriteTrace(&recorder, now, 1000000, IndexTest_Write, &dump, &summary));
+    CHECK(summary.packets == 8001 && summary.outputs == 126 && summary.ticks == 125);
+    CHECK(summary.bytes == dump.length);
+    CHECK(summary.last_us == now);
+
+    int first = count - 8001;
+    int anchor = first - first % 64;
+    InputTraceReader reader;
+    InputTraceRecord record;
+    CHECK(InputTrace_OpenReader(&reader, dump.data, dump.length));
+    CHECK(reader.start_us == 2000 + (uint64_t)anchor * 125);
+    CHECK(InputTrace_Read(&reader, &record));
+    CHECK(record.type == INPUT_TRACE_OUTPUT && record.x == 10.5f + (float)(anchor / 64) &&
+          record.y == 20.25f);
+
+    int packets = 0, outputs = 1;
+    bool match = true;
+    while (InputTrace_Read(&reader, &record)) {
+        if (record.type == INPUT_TRACE_PACKET) {
+            int i = first + packets++;
+            match &= record.time_us == 2000 + (uint64_t)i * 125;
+            match &= record.dx == (i % 7) - 3 && record.dy == (i % 5) - 2 &&
+                     record.device == 0x1000;
+        } else if (record.type == INPUT_TRACE_OUTPUT) {
+            outputs++;
+        }
+    }
+    CHECK(match && !reader.corrupt);
+    CHECK(packets == 8001 && outputs == 126);
+
+    // Tick timing of the same window, relative to its first record
+    memset(&dump, 0, sizeof(dump));
+    CHECK(FlightRecorder_WriteTicks(&recorder, now, 1000000, IndexTest_Write, &dump));
+    dump.data[dump.length < sizeof(dump.data) ? dump.length : sizeof(dump.data) - 1] = '\0';
+    const char* csv = (const char*)dump.data;
+    CHECK(strncmp(csv,
+                  "time_ms,interval_us,duration_us,engaged,distance_px\n"
+                  "0.125,0,44,1,1.50\n"
+                  "8.125,8000,8,1,1.50\n", 89) == 0);
+    int lines = 0;
+    for (size_t i = 0; i < dump.length; i++) lines += dump.data[i] == '\n';
+    CHECK(lines == 126);
+
+    // The whole ring does not fit the sink: the write fails instead of truncating silently
+    memset(&dump, 0, sizeof(dump));
+    CHECK(!FlightRecorder_WriteTrace(&recorder, now, UINT64_MAX, IndexTest_Write, &dump, &summary));
+
+    // An empty recorder still writes a valid, empty trace
+    FlightRecorder_Initialize(&recorder);
+    memset(&dump, 0, sizeof(dump));
+    CHECK(FlightRecorder_WriteTrace(&recorder, now, 1000000, IndexTest_Write, &dump, &summary));
+    CHECK(dump.length == INPUT_TRACE_HEADER_SIZE && summary.packets == 0);
+}
+
+static void Test_TrajectoryMetrics(void) {
+    TrajectoryMetrics metrics;
+    TrajectoryScore score;
+    TrajectoryMetrics_Reset(&metrics);
+
+    // Constant velocity 3px behind the target: fixed lag, no jitter, no overshoot
+    for (int i = 0; i < 10; i++) {
+        TrajectoryMetrics_AddSample(&metrics, (float)(i * 2 + 3), 0.0f, (float)(i * 2), 0.0f);
+    }
+    TrajectoryMetrics_GetScore(&metrics, &score);
+    CHECK(score.samples == 10);
+    CHECK_NEAR(score.mean_lag_px, 3.0, 1e-9);
+    CHECK_NEAR(score.rms_jitter_px, 0.0, 1e-9);
+    CHECK(score.overshoot_events == 0);
+
+    // Step 4px past a target that stopped at 20
+    TrajectoryMetrics_AddSample(&metrics, 20.0f, 0.0f, 24.0f, 0.0f);
+    TrajectoryMetrics_GetScore(&metrics, &score);
+    CHECK(score.overshoot_events == 1);
+    CHECK_NEAR(score.max_overshoot_px, 4.0, 1e-9);
+    CHECK(score.rms_jitter_px > 0.0);
+
+    // A break drops the history, so a jump after it is not jitter
+    TrajectoryMetrics other;
+    TrajectoryMetrics_Reset(&other);
+    TrajectoryMetrics_AddSample(&other, 0.0f, 0.0f, 0.0f, 0.0f);
+    TrajectoryMetrics_AddSample(&other, 1.0f, 0.0f, 1.0f, 0.0f);
+    TrajectoryMetrics_Break(&other);
+    TrajectoryMetrics_AddSample(&other, 500.0f, 0.0f, 500.0f, 0.0f);
+    TrajectoryMetrics_AddSample(&other, 501.0f, 0.0f, 501.0f, 0.0f);
+    TrajectoryMetrics_GetScore(&other, &score);
+    CHECK(score.rms_jitter_px == 0.0 && score.mean_lag_px == 0.0);
+
+    TrajectoryMetrics_Merge(&metrics, &other);
+    TrajectoryMetrics_GetScore(&metrics, &score);
+    CHECK(score.samples == 15);
+    CHECK_NEAR(score.mean_lag_px, (30.0 + 4.0) / 15.0, 1e-9);
+}
+
+#define REPORT_TEST_SAMPLES 1000
+
+static void ReportTest_Set(TrajectorySample* s, int i, float tx, float ty, float ox, float oy) {
+    s[i].time_us = 1000000 + (uint64_t)i * 8000;
+    s[i].target_x = tx;
+    s[i].target_y = ty;
+    s[i].output_x = ox;
+    s[i].output_y = oy;
+    s[i].engaged = true;
+}
+
+static void Test_TrajectoryReport(void) {
+    static TrajectorySample samples[REPORT_TEST_SAMPLES];
+    static TrajectoryReport report;
+
+    // Straight line at 2 px/tick, output exactly 3 ticks behind
+    for (int i = 0; i < REPORT_TEST_SAMPLES; i++) {
+        ReportTest_Set(samples, i, (float)i * 2.0f, 100.0f, (float)(i - 3) * 2.0f, 100.0f);
+    }
+    CHECK(TrajectoryReport_Compute(samples, REPORT_TEST_SAMPLES, NULL, &report));
+    CHECK(report.samples == REPORT_TEST_SAMPLES);
+    CHECK_NEAR(report.sample_rate_hz, 125.0, 1e-6);
+    CHECK_NEAR(report.p95_lag_px, 6.0, 0.05);
+    CHECK_NEAR(report.max_lag_px, 6.0, 1e-6);
+    CHECK_NEAR(report.p95_lag_ms, 24.0, 0.25);
+    CHECK_NEAR(report.mean_lag_ms, 24.0, 0.2);
+    CHECK(report.reversals == 0 && report.corners == 0);
+    CHECK(report.rms_jitter_px < 0.01);
+
+    // Stationary target, output shaking 1 px at 20 Hz: jitter passes the 10 Hz high-pass
+    for (int i = 0; i < REPORT_TEST_SAMPLES; i++) {
+        float shake = sinf(2.0f * 3.14159265f * 20.0f * (float)i / 125.0f);
+        ReportTest_Set(samples, i, 500.0f, 500.0f, 500.0f + shake, 500.0f);
+    }
+    CHECK(TrajectoryReport_Compute(samples, REPORT_TEST_SAMPLES, NULL, &report));
+    CHECK(report.spectrum_segments > 0);
+    CHECK_NEAR(report.rms_jitter_px, 0.7071, 0.05);
+    CHECK_NEAR(report.spectrum_peak_hz, 20.0, report.spectrum_bin_hz);
+    CHECK_NEAR(TrajectoryReport_BandPower(&report, 15.0, 25.0), 0.5, 0.05);
+    CHECK(TrajectoryReport_BandPower(&report, 0.0, 5.0) < 0.01);
+
+    // Out to x = 100 and back; the output turns 2 px late at x = 102
+    for (int i = 0; i < 200; i++) {
+        float x = (float)(i <= 100 ? i : 200 - i);
+        ReportTest_Set(samples, i, x, 0.0f, x, 0.0f);
+    }
+    samples[100].output_x = 101.0f;
+    samples[101].output_x = 102.0f;
+    samples[102].output_x = 100.0f;
+    CHECK(TrajectoryReport_Compute(samples, 200, NULL, &report));
+    CHECK(report.reversals == 1);
+    CHECK_NEAR(report.max_overshoot_px, 2.0, 1e-6);
+
+    // Right then down; the output cuts the corner 45 degrees across
+    for (int i = 0; i < 200; i++) {
+        float tx = (float)(i < 100 ? i : 100);
+        float ty = (float)(i < 100 ? 0 : i - 100);
+        ReportTest_Set(samples, i, tx, ty, tx, ty);
+    }
+    for (int i = 96; i <= 104; i++) {
+        // Chamfer from (96, 0) to (100, 4)
+        float t = (float)(i - 96) / 8.0f;
+        samples[i].output_x = 96.0f + 4.0f * t;
+        samples[i].output_y = 4.0f * t;
+    }
+    CHECK(TrajectoryReport_Compute(samples, 200, NULL, &report));
+    CHECK(report.corners == 1);
+    CHECK_NEAR(report.max_corner_error_px, 2.0 * sqrt(2.0), 1e-4);
+
+    // A disengaged tick splits the runs; nothing engaged is an error
+    samples[100].engaged = false;
+    CHECK(TrajectoryReport_Compute(samples, 200, NULL, &report));
+    CHECK(report.samples == 199 && report.corners == 0);
+    for (int i = 0; i < 200; i++) samples[i].engaged = false;
+    CHECK(!TrajectoryReport_Compute(samples, 200, NULL, &report));
+}
+
+#define BATCH_TEST_LANES 123
+#define BATCH_TEST_TICKS 256
+
+typedef struct {
+    float x[BATCH_TEST_TICKS], y[BATCH_TEST_TICKS];
+    int ticks;
+} BatchTestPath;
+
+typedef struct {
+    BatchTestPath* paths;
+    int tick;
+} BatchTestRun;
+
+static void BatchTest_RecordScalar(void* context, uint64_t time_us,
+                                   const SmoothStabilizer* stabilizer) {
+    (void)time_us;
+    BatchTestPath* path = (BatchTestPath*)context;
+    if (path->ticks < BATCH_TEST_TICKS) {
+        path->x[path->ticks] = stabilizer->current_pos.x;
+        path->y[path->ticks] = stabilizer->current_pos.y;
+    }
+    path->ticks++;
+}
+
+static void BatchTest_RecordBatch(void* context, uint64_t time_us, const StabilizerBatch* batch) {
+    (void)time_us;
+    BatchTestRun* run = (BatchTestRun*)context;
+    if (run->tick < BATCH_TEST_TICKS) {
+        for (int lane = 0; lane < batch->count; lane++) {
+            run->paths[lane].x[run->tick] = batch->current_x[lane];
+            run->paths[lane].y[run->tick] = batch->current_y[lane];
+        }
+    }
+    run->tick++;
+}
+
+static void BatchTest_Settings(int lane, SmoothStabilizer* settings) {
+    StabilizerCore_Initialize(settings, NULL, NULL, NULL);
+    settings->follow_strength = 0.05f + (float)(lane % 7) * 0.13f;
+    settings->ease_type = (EaseType)(lane % 4);
+    settings->dual_mode = (lane / 4) % 2 != 0;
+    settings->delay_start_ms = (uint32_t)((lane / 8) % 3) * 30;
+    settings->min_distance = 0.5f + (float)((lane / 24) % 3);
+}
+
+static void Test_StabilizerBatch(void) {
+    static uint8_t buffer[16 * 1024];
+    static BatchTestPath reference[BATCH_TEST_LANES];
+    static BatchTestPath paths[BATCH_TEST_LANES];
+    static BatchTestPath first[BATCH_TEST_LANES];
+    static TraceReplay replay;
+    static StabilizerBatch batch;
+    InputTraceState state;
+    uint64_t time = 5000000;
+    size_t length = InputTrace_WriteHeader(buffer, time);
+    InputTrace_ResetState(&state, time);
+
+    // A curved 150ms stroke, a 200ms pause, then a slow stroke back
+    length += InputTrace_EncodeOutput(&state, buffer + length, time, 400.0f, 300.0f);
+    for (int i = 0; i < 150; i++) {
+        time += 1000;
+        length += InputTrace_EncodePacket(&state, buffer + length, time, 0x10, 1 + i % 4,
+                                          (i / 25) % 3 - 1, 0, 0);
+    }
+    time += 200000;
+    for (int i = 0; i < 150; i++) {
+        time += 2000;
+        length += InputTrace_EncodePacket(&state, buffer + length, time, 0x10, -(i % 2), 1, 0, 0);
+    }
+
+    SmoothStabilizer settings;
+    StabilizerBatch_Initialize(&batch, BATCH_TEST_LANES, 0.0f, 0.0f);
+    for (int lane = 0; lane < BATCH_TEST_LANES; lane++) {
+        BatchTest_Settings(lane, &settings);
+        StabilizerBatch_SetLane(&batch, lane, &settings);
+
+        CHECK(TraceReplay_Open(&replay, buffer, length, &settings, NULL, NULL, NULL));
+        reference[lane].ticks = 0;
+        replay.on_tick = BatchTest_RecordScalar;
+        replay.tick_context = &reference[lane];
+        while (TraceReplay_Step(&replay, 1000)) {}
+    }
+    CHECK(reference[0].ticks > 100 && reference[0].ticks <= BATCH_TEST_TICKS);
+
+    // Every kernel this machine has matches the scalar engine, and each other exactly
+    int kernels = 0;
+    for (int isa = STABILIZER_BATCH_SCALAR; isa <= STABILIZER_BATCH_AVX512; isa++) {
+        StabilizerBatch run_batch = batch;
+        if (!StabilizerBatch_SetIsa(&run_batch, (StabilizerBatchIsa)isa)) continue;
+
+        BatchTestRun run = {paths, 0};
+        TraceReplayStats stats;
+        CHECK(TraceReplay_RunBatch(buffer, length, &run_batch, NULL, BatchTest_RecordBatch, &run,
+                                   &stats));
+        CHECK(run.tick == reference[0].ticks);
+        CHECK(stats.packets == 300);
+
+        double max_error = 0.0;
+        bool identical = true;
+        for (int lane = 0; lane < BATCH_TEST_LANES; lane++) {
+            for (int tick = 0; tick < run.tick; tick++) {
+                double ex = fabs((double)paths[lane].x[tick] - reference[lane].x[tick]);
+                double ey = fabs((double)paths[lane].y[tick] - reference[lane].y[tick]);
+                if (ex > max_error) max_error = ex;
+                if (ey > max_error) max_error = ey;
+                if (kernels > 0 && (paths[lane].x[tick] != first[lane].x[tick] ||
+                                    paths[lane].y[tick] != first[lane].y[tick])) {
+                    identical = false;
+                }
+            }
+        }
+        CHECK(max_error <= STABILIZER_BATCH_TOLERANCE_PX);
+        CHECK(identical);
+        if (kernels == 0) memcpy(first, paths, sizeof(first));
+        kernels++;
+    }
+    CHECK(kernels >= 1);
+}
+
+#define LOG_TEST_PRODUCERS 4
+#define LOG_TEST_MESSAGES 50000
+
+static LogRing g_log_ring;
+
+static bool LogTest_Write(LogRing* ring, LogLevel level, uint64_t time, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    bool written = LogRing_Write(ring, level, time, format, args);
+    va_end(args);
+    return written;
+}
+
+static void* LogTest_Producer(void* argument) {
+    int producer = (int)(intptr_t)argument;
+    for (int i = 0; i < LOG_TEST_MESSAGES; i++) {
+        LogTest_Write(&g_log_ring, LOG_DEBUG, (uint64_t)i, "producer %d message %d", producer, i);
+    }
+    return NULL;
+}
+
+static void Test_LogRing(void) {
+    // One thread: fills, drops when full, reads back in order, truncates
+    LogRing_Initialize(&g_log_ring);
+    int accepted = 0;
+    for (int i = 0; i < LOG_RING_CAPACITY + 10; i++) {
+        if (LogTest_Write(&g_log_ring, LOG_INFO, 100 + (uint64_t)i, "message %d", i)) accepted++;
+    }
+    CHECK(accepted == LOG_RING_CAPACITY);
+    CHECK(LogRing_Pending(&g_log_ring) == LOG_RING_CAPACITY);
+    CHECK(LogRing_TakeDropped(&g_log_ring) == 10);
+    CHECK(LogRing_TakeDropped(&g_log_ring) == 0);
+
+    bool in_order = true;
+    for (int i = 0; i < LOG_RING_CAPACITY; i++) {
+        const LogRecord* record = LogRing_Peek(&g_log_ring);
+        char expected[32];
+        snprintf(expected, sizeof(expected), "message %d", i);
+        in_order &= record && record->time == 100 + (uint64_t)i && record->level == LOG_INFO &&
+                    strcmp(record->message, expected) == 0 && record->length == strlen(expected);
+        LogRing_Pop(&g_log_ring);
+    }
+    CHECK(in_order);
+    CHECK(LogRing_Peek(&g_log_ring) == NULL);
+
+    char long_text[LOG_RING_MESSAGE_SIZE * 2];
+    memset(long_text, 'x', sizeof(long_text) - 1);
+    long_text[sizeof(long_text) - 1] = '\0';
+    CHECK(LogTest_Write(&g_log_ring, LOG_WARN, 0, "%s", long_text));
+    const LogRecord* truncated = LogRing_Peek(&g_log_ring);
+    CHECK(truncated && truncated->length == LOG_RING_MESSAGE_SIZE - 1 &&
+          truncated->message[LOG_RING_MESSAGE_SIZE - 1] == '\0');
+    LogRing_Pop(&g_log_ring);
+
+    // A claimed slot that is not published yet holds back the consumer but
+    // still counts as pending, which is what shutdown waits on
+    uint64_t position;
+    LogRecord* claimed = LogRing_Claim(&g_log_ring, &position);
+    CHECK(LogTest_Write(&g_log_ring, LOG_INFO, 1, "after the claim"));
+    CHECK(claimed && LogRing_Peek(&g_log_ring) == NULL && LogRing_Pending(&g_log_ring) == 2);
+    if (claimed) {
+        claimed->length = 0;
+        claimed->message[0] = '\0';
+        claimed->site = NULL;
+        LogRing_Publish(&g_log_ring, claimed, position);
+    }
+    CHECK(LogRing_Peek(&g_log_ring) == claimed);
+    LogRing_Pop(&g_log_ring);
+    const LogRecord* later = LogRing_Peek(&g_log_ring);
+    CHECK(later && strcmp(later->message, "after the claim") == 0);
+    LogRing_Pop(&g_log_ring);
+    CHECK(LogRing_Pending(&g_log_ring) == 0);
+
+    // Several producers against a live consumer: every record arrives whole,
+    // each producer's records in order, and nothing is lost without being counted
+    LogRing_Initialize(&g_log_ring);
+    pthread_t threads[LOG_TEST_PRODUCERS];
+    for (int p = 0; p < LOG_TEST_PRODUCERS; p++) {
+        CHECK(pthread_create(&threads[p], NULL, LogTest_Producer, (void*)(intptr_t)p) == 0);
+    }
+
+    int next[LOG_TEST_PRODUCERS] = {0};
+    uint64_t received = 0, dropped = 0;
+    bool intact = true;
+    int finished = 0;
+    while (finished < LOG_TEST_PRODUCERS || LogRing_Peek(&g_log_ring)) {
+        const LogRecord* record = LogRing_Peek(&g_log_ring);
+        if (!record) {
+            // Producers are done once everything they wrote or dropped is accounted for
+            uint64_t seen = received + dropped + LogRing_TakeDropped(&g_log_ring);
+            dropped = seen - received;
+            bool all = seen == (uint64_t)LOG_TEST_PRODUCERS * LOG_TEST_MESSAGES;
+            finished = all ? LOG_TEST_PRODUCERS : 0;
+            continue;
+        }
+        int producer = -1, index = -1;
+        intact &= sscanf(record->message, "producer %d message %d", &producer, &index) == 2 &&
+                  producer >= 0 && producer < LOG_TEST_PRODUCERS && (uint64_t)index == record->time;
+        if (intact) {
+            intact &= index >= next[producer];
+            next[producer] = index + 1;
+        }
+        received++;
+        LogRing_Pop(&g_log_ring);
+    }
+    for (int p = 0; p < LOG_TEST_PRODUCERS; p++) {
+        pthread_join(threads[p], NULL);
+    }
+    dropped += LogRing_TakeDropped(&g_log_ring);
+
+    CHECK(intact);
+    CHECK(received + dropped == (uint64_t)LOG_TEST_PRODUCERS * LOG_TEST_MESSAGES);
+    CHECK(g_log_ring.written == received);
+    CHECK(LogRing_Pending(&g_log_ring) == 0);
+}
+
+// Record a call's arguments as the host does, render them back and compare with printf
+static bool BinaryTest_RoundTrip(const char* format, ...) {
+    uint8_t types[LOG_SITE_MAX_ARGS];
+    uint8_t count = 0;
+    uint8_t args[LOG_RING_MESSAGE_SIZE];
+    char expected[256], actual[256];
+    if (!BinaryLog_ParseFormat(format, types, &count)) return false;
+
+    va_list list;
+    va_start(list, format);
+    size_t length = BinaryLog_EncodeArgs(types, count, args, sizeof(args), list);
+    va_end(list);
+    va_start(list, format);
+    vsnprintf(expected, sizeof(expected), format, list);
+    va_end(list);
+
+    BinaryLog_Format(format, args, length, actual, sizeof(actual));
+    if (strcmp(expected, actual) != 0) {
+        fprintf(stderr, "  \"%s\": expected \"%s\", got \"%s\"\n", format, expected, actual);
+        return false;
+    }
+    return true;
+}
+
+static size_t BinaryTest_Encode(const char* format, uint8_t* out, size_t capacity, ...) {
+    uint8_t types[LOG_SITE_MAX_ARGS];
+    uint8_t count = 0;
+    if (!BinaryLog_ParseFormat(format, types, &count)) return 0;
+
+    va_list list;
+    va_start(list, capacity);
+    size_t length = BinaryLog_EncodeArgs(types, count, out, capacity, list);
+    va_end(list);
+    return length;
+}
+
+typedef struct {
+    int site_calls;
+    int text_calls;
+    LogSite* last_site;
+    char text[64];
+} BinaryTestHost;
+
+static void BinaryTest_LogSite(void* context, LogSite* site, va_list args) {
+    BinaryTestHost* host = (BinaryTestHost*)context;
+    (void)args;
+    host->site_calls++;
+    host->last_site = site;
+}
+
+static void BinaryTest_Log(void* context, LogLevel level, const char* format, va_list args) {
+    BinaryTestHost* host = (BinaryTestHost*)context;
+    (void)level;
+    host->text_calls++;
+    vsnprintf(host->text, sizeof(host->text), format, args);
+}
+
+static void Test_BinaryLog(void) {
+    // Deferred formatting reproduces printf for every conversion the code base uses
+    CHECK(BinaryTest_RoundTrip("plain text, 100%% literal"));
+    CHECK(BinaryTest_RoundTrip("d=%d i=%i neg=%d c=%c", 42, -7, INT_MIN, 'q'));
+    CHECK(BinaryTest_RoundTrip("u=%u x=%x X=%08X o=%o", UINT_MAX, 0xdeadbeefu, 0xbeefu, 0777u));
+    CHECK(BinaryTest_RoundTrip("hh=%hhx h=%hd", 0x1ff, 70000));
+    CHECK(BinaryTest_RoundTrip("l=%ld lu=%lu ll=%lld llu=%llu",
+                               LONG_MIN, ULONG_MAX, LLONG_MIN, ULLONG_MAX));
+    CHECK(BinaryTest_RoundTrip("z=%zu t=%td j=%jd",
+                               (size_t)123456789, (ptrdiff_t)-5, (intmax_t)-9));
+    CHECK(BinaryTest_RoundTrip("f=%.2f e=%e g=%g lf=%lf", 3.14159, -0.000123, 1e20, 2.5));
+    CHECK(BinaryTest_RoundTrip("s=[%s] w=[%-8s] p=[%.3s]", "hello", "ab", "truncate"));
+    CHECK(BinaryTest_RoundTrip("star=[%*d] prec=[%.*f] both=[%*.*f]",
+                               6, 42, 3, 1.23456, 9, 2, 7.5));
+    CHECK(BinaryTest_RoundTrip("ptr=%p", (void*)&g_checks));
+
+    uint8_t types[LOG_SITE_MAX_ARGS];
+    uint8_t count = 0;
+    CHECK(BinaryLog_ParseFormat("%d %s %.1f", types, &count) && count == 3);
+    CHECK(!BinaryLog_ParseFormat("%n", types, &count));
+    CHECK(!BinaryLog_ParseFormat("%ls", types, &count));
+    CHECK(!BinaryLog_ParseFormat("%Lf", types, &count));
+    CHECK(!BinaryLog_ParseFormat("%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d",
+                                 types, &count));
+    CHECK(!BinaryLog_ParseFormat("dangling %", types, &count));
+
+    // Strings give way so the fixed-size arguments always fit
+    uint8_t small[2 + 3 + 8];
+    size_t small_length = BinaryTest_Encode("%s %d", small, sizeof(small), "abcdefgh", 7);
+    char rendered[64];
+    CHECK(small_length == sizeof(small));
+    BinaryLog_Format("%s %d", small, small_length, rendered, sizeof(rendered));
+    CHECK(strcmp(rendered, "abc 7") == 0);
+    BinaryLog_Format("%d %d", small + 5, 8, rendered, sizeof(rendered));
+    CHECK(strcmp(rendered, "7 ") == 0);
+
+    // Call sites: one static site per LOG_AT, parsed once, text fallback without log_site
+    BinaryTestHost host;
+    memset(&host, 0, sizeof(host));
+    Platform platform;
+    memset(&platform, 0, sizeof(platform));
+    platform.context = &host;
+    platform.log_site = BinaryTest_LogSite;
+    LogSite* first_site = NULL;
+    for (int i = 0; i < 2; i++) {
+        LOG_AT(&platform, LOG_DEBUG, "value %d", i);
+        if (i == 0) first_site = host.last_site;
+    }
+    CHECK(host.site_calls == 2 && host.last_site == first_site);
+    CHECK(first_site && first_site->level == LOG_DEBUG &&
+          strcmp(first_site->format, "value %d") == 0);
+
+    uint8_t scratch[LOG_SITE_MAX_ARGS];
+    CHECK(first_site && BinaryLog_SiteTypes(first_site, scratch, &count) == first_site->arg_types &&
+          count == 1);
+    CHECK(first_site && first_site->state == LOG_SITE_READY);
+    LogSite unsupported = {LOG_INFO, "%n", 0, 0, {0}};
+    CHECK(BinaryLog_SiteTypes(&unsupported, scratch, &count) == NULL &&
+          unsupported.state == LOG_SITE_UNSUPPORTED);
+
+    // A host level stops filtered calls before they reach the host at all
+    volatile LogLevel host_level = LOG_INFO;
+    platform.log_level = &host_level;
+    LOG_AT(&platform, LOG_DEBUG, "filtered %d", 1);
+    LOG_AT(&platform, LOG_INFO, "kept %d", 2);
+    CHECK(host.site_calls == 3);
+    host_level = LOG_DEBUG;
+    LOG_AT(&platform, LOG_DEBUG, "kept %d", 3);
+    CHECK(host.site_calls == 4);
+    platform.log_level = NULL;
+
+    platform.log_site = NULL;
+    platform.log = BinaryTest_Log;
+    LOG_AT(&platform, LOG_WARN, "fallback %s", "text");
+    CHECK(host.text_calls == 1 && strcmp(host.text, "fallback text") == 0);
+
+    // A log with two sessions; ids restart with each session
+    static uint8_t log[1024];
+    static BinaryLogReader reader;
+    static BinaryLogEntry entry;
+    uint8_t args[LOG_RING_MESSAGE_SIZE];
+    size_t args_length = BinaryTest_Encode("x=%d y=%.1f %s", args, sizeof(args), 3, 2.5, "abc");
+    size_t length = BinaryLog_PutHeader(log, sizeof(log), 1000);
+    length += BinaryLog_PutDefine(log + length, sizeof(log) - length, 1, LOG_INFO,
+                                  "x=%d y=%.1f %s");
+    length += BinaryLog_PutEvent(log + length, sizeof(log) - length, 1, 2000, args, args_length);
+    length += BinaryLog_PutText(log + length, sizeof(log) - length, LOG_WARN, 3000, "plain", 5);
+    length += BinaryLog_PutHeader(log + length, sizeof(log) - length, 4000);
+    length += BinaryLog_PutEvent(log + length, sizeof(log) - length, 1, 5000, args, args_length);
+    CHECK(BinaryLog_PutEvent(log, 10, 1, 0, args, args_length) == 0);
+
+    CHECK(BinaryLog_Open(&reader, log, length));
+    CHECK(BinaryLog_Next(&reader, &entry) && entry.type == BINARY_LOG_ENTRY_SESSION &&
+          entry.time == 1000);
+    CHECK(BinaryLog_Next(&reader, &entry) && entry.type == BINARY_LOG_ENTRY_MESSAGE &&
+          entry.level == LOG_INFO && entry.site == 1 && entry.time == 2000 &&
+          strcmp(entry.text, "x=3 y=2.5 abc") == 0);
+    CHECK(BinaryLog_Next(&reader, &entry) && entry.level == LOG_WARN && entry.site == 0 &&
+          entry.time == 3000 && strcmp(entry.text, "plain") == 0);
+    CHECK(BinaryLog_Next(&reader, &entry) && entry.type == BINARY_LOG_ENTRY_SESSION &&
+          reader.sessions == 2);
+    CHECK(BinaryLog_Next(&reader, &entry) && strcmp(entry.text, "<undefined log site 1>") == 0);
+    CHECK(!BinaryLog_Next(&reader, &entry) && !reader.corrupt);
+
+    // Zero padding after the last record is the end of the log, not damage
+    memset(log + length, 0, 64);
+    CHECK(BinaryLog_Open(&reader, log, length + 64));
+    int padded_entries = 0;
+    while (BinaryLog_Next(&reader, &entry)) padded_entries++;
+    CHECK(padded_entries == 5 && !reader.corrupt);
+
+    // A record cut short by a crash stops the reader
+    CHECK(BinaryLog_Open(&reader, log, length - 1));
+    int entries = 0;
+    while (BinaryLog_Next(&reader, &entry)) entries++;
+    CHECK(entries == 4 && reader.corrupt);
+    CHECK(!BinaryLog_Open(&reader, "MSTR", 4));
+}
+
+#define LATENCY_TEST_THREADS 4
+#define LATENCY_TEST_VALUES 100000
+
+static LatencyHistogram g_latency;
+
+static void* LatencyTest_Recorder(void* argument) {
+    int thread = (int)(intptr_t)argument;
+    for (int i = 0; i < LATENCY_TEST_VALUES; i++) {
+        LatencyHistogram_Record(&g_latency, (uint64_t)(i % 5000) + (uint64_t)thread);
+    }
+    return NULL;
+}
+
+static void Test_LatencyHistogram(void) {
+    // Buckets tile the whole range without gaps and stay within 1/64 of their values
+    bool contiguous = true, bounded = true;
+    for (int i = 0; i + 1 < LATENCY_HISTOGRAM_BUCKETS; i++) {
+        contiguous &= LatencyHistogram_BucketHigh(i) + 1 == LatencyHistogram_BucketLow(i + 1);
+        uint64_t width = LatencyHistogram_BucketHigh(i) - LatencyHistogram_BucketLow(i) + 1;
+        bounded &= width == 1 || width * 64 <= LatencyHistogram_BucketLow(i);
+    }
+    CHECK(contiguous && bounded);
+    for (uint64_t value = 0; value < 5000000; value = value * 3 / 2 + 1) {
+        int index = LatencyHistogram_BucketIndex(value);
+        CHECK(LatencyHistogram_BucketLow(index) <= value &&
+              value <= LatencyHistogram_BucketHigh(index));
+    }
+    const int last_bucket = LATENCY_HISTOGRAM_BUCKETS - 1;
+    CHECK(LatencyHistogram_BucketIndex(LATENCY_HISTOGRAM_MAX_VALUE) == last_bucket);
+    CHECK(LatencyHistogram_BucketIndex(LATENCY_HISTOGRAM_MAX_VALUE * 4) == last_bucket);
+
+    LatencySummary summary;
+    LatencyHistogram_Reset(&g_latency);
+    LatencyHistogram_Summarize(&g_latency, &summary);
+    CHECK(summary.count == 0 && summary.p99 == 0 &&
+          LatencyHistogram_Percentile(&g_latency, 50.0) == 0);
+
+    // 1..10000 us once each: percentiles land within one bucket above the exact rank
+    for (uint64_t value = 1; value <= 10000; value++) {
+        LatencyHistogram_Record(&g_latency, value);
+    }
+    LatencyHistogram_Summarize(&g_latency, &summary);
+    CHECK(summary.count == 10000 && summary.max == 10000);
+    CHECK_NEAR(summary.mean, 5000.5, 1e-9);
+    CHECK(summary.p50 >= 5000 && summary.p50 <= 5000 + 5000 / 64);
+    CHECK(summary.p99 >= 9900 && summary.p99 <= 9900 + 9900 / 64);
+    CHECK(summary.p999 >= 9990 && summary.p999 <= 10000);
+    CHECK(summary.p50 == LatencyHistogram_Percentile(&g_latency, 50.0));
+    CHECK(LatencyHistogram_Percentile(&g_latency, 100.0) == 10000);
+    CHECK(LatencyHistogram_Percentile(&g_latency, 0.0) == 1);
+
+    static char text[16384];
+    size_t length = LatencyHistogram_FormatDistribution(&g_latency, text, sizeof(text));
+    CHECK(length == strlen(text) && strncmp(text, "       Value     Percentile", 27) == 0);
+    CHECK(strstr(text, "      10.000 1.000000000000      10000\n") != NULL);
+    CHECK(strstr(text, "#[Max     =       10.000, Total count    =        10000]") != NULL);
+    size_t short_length = LatencyHistogram_FormatDistribution(&g_latency, text, 200);
+    CHECK(short_length < 200 && short_length == strlen(text) && text[short_length - 1] == '\n');
+
+    // Concurrent recorders lose nothing; a snapshot is internally consistent
+    LatencyHistogram_Reset(&g_latency);
+    pthread_t threads[LATENCY_TEST_THREADS];
+    for (int t = 0; t < LATENCY_TEST_THREADS; t++) {
+        CHECK(pthread_create(&threads[t], NULL, LatencyTest_Recorder, (void*)(intptr_t)t) == 0);
+    }
+    static LatencyHistogram snapshot;
+    LatencyHistogram_Snapshot(&g_latency, &snapshot);
+    uint64_t counted = 0;
+    for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) counted += snapshot.counts[i];
+    CHECK(counted == snapshot.count);
+    for (int t = 0; t < LATENCY_TEST_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    LatencyHistogram_Snapshot(&g_latency, &snapshot);
+    CHECK(snapshot.count == (uint64_t)LATENCY_TEST_THREADS * LATENCY_TEST_VALUES &&
+          g_latency.count == snapshot.count);
+    CHECK(snapshot.max == 4999 + LATENCY_TEST_THREADS - 1);
+}
+
+#define PERF_TEST_THREADS 3
+#define PERF_TEST_COUNTS 200000
+
+static PerfCounterBlock g_perf_blocks[PERF_TEST_THREADS];
+
+static void* PerfTest_Writer(void* argument) {
+    int thread = (int)(intptr_t)argument;
+    PerfCounterBlock* block = &g_perf_blocks[thread];
+    for (int i = 0; i < PERF_TEST_COUNTS; i++) {
+        PerfCounters_Add(block, PERF_COUNT_PACKETS, 1);
+        PerfCounters_Max(block, PERF_MAX_HOOK_TIME, (uint64_t)(i % 1000) + (uint64_t)thread);
+    }
+    return NULL;
+}
+
+static void Test_PerfCounters(void) {
+    CHECK(sizeof(PerfCounterBlock) % 64 == 0);
+
+    PerfCounterBlock* blocks[PERF_TEST_THREADS];
+    for (int t = 0; t < PERF_TEST_THREADS; t++) {
+        PerfCounters_Initialize(&g_perf_blocks[t]);
+        blocks[t] = &g_perf_blocks[t];
+    }
+
+    // Tick intervals start with the second tick; a clock step back is not an interval
+    PerfCounters_MarkTick(blocks[0], 1000);
+    PerfCounters_MarkTick(blocks[0], 9000);
+    PerfCounters_MarkTick(blocks[0], 25000);
+    PerfCounters_MarkTick(blocks[0], 24000);
+    PerfCounters_Add(blocks[1], PERF_COUNT_TICKS, 2);
+
+    PerfCounterSample sample;
+    PerfCounters_Collect(blocks, PERF_TEST_THREADS, 0, &sample);
+    CHECK(sample.counts[PERF_COUNT_TICKS] == 6);
+    CHECK(sample.counts[PERF_COUNT_TICK_INTERVALS] == 2 &&
+          sample.counts[PERF_COUNT_TICK_INTERVAL] == 24000);
+    CHECK(sample.counts[PERF_COUNT_TICK_SQUARES] == 8000ull * 8000 + 16000ull * 16000);
+    CHECK(sample.maxima[PERF_MAX_TICK_INTERVAL] == 16000);
+
+    // Collecting clears only the collecting reader's maxima
+    PerfCounters_Collect(blocks, PERF_TEST_THREADS, 0, &sample);
+    CHECK(sample.counts[PERF_COUNT_TICKS] == 6 && sample.maxima[PERF_MAX_TICK_INTERVAL] == 0);
+    PerfCounters_Collect(blocks, PERF_TEST_THREADS, 1, &sample);
+    CHECK(sample.maxima[PERF_MAX_TICK_INTERVAL] == 16000);
+    PerfCounters_Collect(blocks, PERF_TEST_THREADS, PERF_COUNTER_READERS, &sample);
+    CHECK(sample.counts[PERF_COUNT_TICKS] == 0);
+
+    // Owners count while a reader collects: nothing is lost, no peak is missed
+    pthread_t threads[PERF_TEST_THREADS];
+    for (int t = 0; t < PERF_TEST_THREADS; t++) {
+        CHECK(pthread_create(&threads[t], NULL, PerfTest_Writer, (void*)(intptr_t)t) == 0);
+    }
+    uint64_t peak = 0;
+    for (int i = 0; i < 1000; i++) {
+        PerfCounters_Collect(blocks, PERF_TEST_THREADS, 2, &sample);
+        if (sample.maxima[PERF_MAX_HOOK_TIME] > peak) peak = sample.maxima[PERF_MAX_HOOK_TIME];
+    }
+    for (int t = 0; t < PERF_TEST_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    PerfCounters_Collect(blocks, PERF_TEST_THREADS, 2, &sample);
+    if (sample.maxima[PERF_MAX_HOOK_TIME] > peak) peak = sample.maxima[PERF_MAX_HOOK_TIME];
+    CHECK(sample.counts[PERF_COUNT_PACKETS] == (uint64_t)PERF_TEST_THREADS * PERF_TEST_COUNTS);
+    CHECK(peak == 999 + PERF_TEST_THREADS - 1);
+    PerfCounters_Collect(blocks, PERF_TEST_THREADS, 3, &sample);
+    CHECK(sample.maxima[PERF_MAX_HOOK_TIME] == 999 + PERF_TEST_THREADS - 1);
+}
+
+#define TELEMETRY_TEST_UPDATES 200000
+
+static TelemetryBlock g_telemetry_block;
+static volatile int g_telemetry_writer_done = 0;
+
+// Every field follows from one counter, so a torn copy shows as a mismatch
+static void* TelemetryTest_Writer(void* argument) {
+    (void)argument;
+    for (uint32_t i = 1; i <= TELEMETRY_TEST_UPDATES; i++) {
+        TelemetrySample sample = {0};
+        sample.time_us = i;
+        sample.target_x = (float)i;
+        sample.target_y = (float)i * 2.0f;
+        sample.kind = TELEMETRY_SAMPLE_PACKET;
+        TelemetryBlock_PushSample(&g_telemetry_block, &sample);
+
+        TelemetryState state = {0};
+        state.time_us = i;
+        state.target_x = (float)i;
+        state.output_y = (float)i * 3.0f;
+        state.packets = i;
+        state.ticks = i;
+        TelemetryBlock_PublishState(&g_telemetry_block, &state);
+    }
+    __atomic_store_n(&g_telemetry_writer_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void Test_TelemetryBlock(void) {
+    TelemetryBlock* block = &g_telemetry_block;
+    CHECK(offsetof(TelemetryBlock, state_sequence) % 64 == 0 &&
+          offsetof(TelemetryBlock, state) % 64 == 0);
+    CHECK(offsetof(TelemetryBlock, ring_head) % 64 == 0 &&
+          offsetof(TelemetryBlock, ring) % 64 == 0);
+    CHECK(offsetof(TelemetryBlock, command) % 64 == 0 && sizeof(TelemetryHeader) == 64);
+    CHECK(sizeof(TelemetrySample) == 32 && sizeof(TelemetryState) == 128);
+
+    // Opening checks size, magic and version
+    CHECK(TelemetryBlock_Open(block, sizeof(*block)) == NULL);
+    TelemetryBlock_Initialize(block, 42, 1000);
+    CHECK(TelemetryBlock_Open(block, sizeof(*block) - 1) == NULL);
+    CHECK(TelemetryBlock_Open(block, sizeof(*block)) == block);
+    CHECK(block->header.ring_offset == offsetof(TelemetryBlock, ring_head) &&
+          block->header.writer_process_id == 42);
+    block->header.version++;
+    CHECK(TelemetryBlock_Open(block, sizeof(*block)) == NULL);
+    block->header.version--;
+
+    // A state read while the writer is mid-update gives up instead of tearing
+    TelemetryState state = {0};
+    state.packets = 7;
+    TelemetryBlock_PublishState(block, &state);
+    TelemetryState read;
+    CHECK(TelemetryBlock_ReadState(block, &read) && read.packets == 7);
+    block->state_sequence++;
+    CHECK(!TelemetryBlock_ReadState(block, &read));
+    block->state_sequence++;
+
+    // A reader that falls behind skips to the oldest sample still in the ring
+    static TelemetrySample samples[TELEMETRY_RING_CAPACITY];
+    TelemetrySample sample = {0};
+    for (uint32_t i = 0; i < TELEMETRY_RING_CAPACITY + 10; i++) {
+        sample.time_us = i;
+        TelemetryBlock_PushSample(block, &sample);
+    }
+    uint64_t cursor = 0, lost = 0;
+    size_t count = TelemetryBlock_ReadSamples(block, &cursor, samples, 4, &lost);
+    CHECK(count == 4 && lost == 10 && samples[0].time_us == 10 && samples[0].sequence == 11);
+    count = TelemetryBlock_ReadSamples(block, &cursor, samples, TELEMETRY_RING_CAPACITY, &lost);
+    CHECK(count == TELEMETRY_RING_CAPACITY - 4 && lost == 10 &&
+          cursor == TELEMETRY_RING_CAPACITY + 10);
+    CHECK(TelemetryBlock_ReadSamples(block, &cursor, samples, TELEMETRY_RING_CAPACITY, &lost) == 0);
+
+    // A cursor past the head (writer restarted) catches up without counting losses
+    cursor = 1u << 20;
+    CHECK(TelemetryBlock_ReadSamples(block, &cursor, samples, 4, &lost) == 0 &&
+          cursor == block->ring_head);
+
+    // One command at a time, answered with the client's ticket
+    uint32_t ticket = 0, taken = 0;
+    TelemetryCommandType command;
+    TelemetryCommandStatus status;
+    float value;
+    CHECK(!TelemetryBlock_TakeCommand(block, &command, &value, &taken));
+    CHECK(TelemetryBlock_SendCommand(block, TELEMETRY_COMMAND_SET_FOLLOW, 0.25f, &ticket) &&
+          ticket == 1);
+    CHECK(!TelemetryBlock_SendCommand(block, TELEMETRY_COMMAND_SET_DUAL, 1.0f, NULL));
+    CHECK(!TelemetryBlock_PollCommand(block, ticket, &status));
+    CHECK(TelemetryBlock_TakeCommand(block, &command, &value, &taken));
+    CHECK(command == TELEMETRY_COMMAND_SET_FOLLOW && value == 0.25f && taken == ticket);
+    TelemetryBlock_CompleteCommand(block, taken, TELEMETRY_STATUS_OUT_OF_RANGE);
+    CHECK(TelemetryBlock_PollCommand(block, ticket, &status) &&
+          status == TELEMETRY_STATUS_OUT_OF_RANGE);
+    CHECK(!TelemetryBlock_TakeCommand(block, &command, &value, &taken));
+    CHECK(TelemetryBlock_SendCommand(block, TELEMETRY_COMMAND_SET_DUAL, 1.0f, &ticket) &&
+          ticket == 2);
+
+    // Concurrent writer: every state and sample a reader gets is whole, and
+    // samples read plus samples lost account for everything written
+    TelemetryBlock_Initialize(block, 42, 1000);
+    pthread_t writer;
+    CHECK(pthread_create(&writer, NULL, TelemetryTest_Writer, NULL) == 0);
+    bool consistent = true;
+    uint64_t received = 0, last = 0;
+    cursor = 0;
+    lost = 0;
+    for (;;) {
+        bool done = __atomic_load_n(&g_telemetry_writer_done, __ATOMIC_ACQUIRE) != 0;
+        if (TelemetryBlock_ReadState(block, &read)) {
+            if (read.target_x != (float)read.packets ||
+                read.output_y != (float)read.packets * 3.0f || read.ticks != read.packets ||
+                read.time_us != read.packets) {
+                consistent = false;
+            }
+        }
+        count = TelemetryBlock_ReadSamples(block, &cursor, samples, 64, &lost);
+        for (size_t i = 0; i < count; i++) {
+            if (samples[i].target_y != samples[i].target_x * 2.0f ||
+                samples[i].time_us != samples[i].sequence || samples[i].time_us <= last) {
+                consistent = false;
+            }
+            last = samples[i].time_us;
+        }
+        received += count;
+        if (done && count == 0) break;
+    }
+    pthread_join(writer, NULL);
+    CHECK(consistent);
+    CHECK(received + lost == TELEMETRY_TEST_UPDATES && last == TELEMETRY_TEST_UPDATES);
+}
+
+static void Test_MetricsText(void) {
+    static char page[16384];
+    MetricsSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.enabled = true;
+    snapshot.packets_total = 123456789012ull;
+    snapshot.tick_mean_ms = 8.0;
+    snapshot.log_dropped = 3;
+    snapshot.hook_timeouts = 2;
+    snapshot.hook_reinstalls = 1;
+    snapshot.latency_count = 2;
+    snapshot.latency[0].stage = "Input";
+    snapshot.latency[1].stage = "Total";
+    snapshot.latency[1].summary.count = 4;
+    snapshot.latency[1].summary.mean = 2500.0;
+    snapshot.latency[1].summary.p50 = 2000;
+    snapshot.latency[1].summary.p999 = 9000;
+
+    // Whole counters stay exact; a stage with no samples has NaN quantiles
+    MetricsText text;
+    MetricsText_Initialize(&text, page, sizeof(page));
+    size_t length = MetricsText_FormatPage(&text, &snapshot);
+    CHECK(length > 0 && !text.truncated && length == strlen(page));
+    CHECK(strstr(page, "\nmouse_stabilizer_enabled 1\n") != NULL);
+    CHECK(strstr(page, "\nmouse_stabilizer_input_packets_total 123456789012\n") != NULL);
+    CHECK(strstr(page, "\nmouse_stabilizer_tick_interval_mean_seconds 0.008\n") != NULL);
+    CHECK(strstr(page, "\nmouse_stabilizer_latency_seconds"
+                       "{stage=\"input\",quantile=\"0.5\"} NaN\n") != NULL);
+    CHECK(strstr(page, "\nmouse_stabilizer_latency_seconds"
+                       "{stage=\"total\",quantile=\"0.999\"} 0.009\n") != NULL);
+    CHECK(strstr(page, "\nmouse_stabilizer_latency_seconds_sum{stage=\"total\"} 0.01\n") != NULL);
+    CHECK(strstr(page, "\nmouse_stabilizer_dropped_total{source=\"log\"} 3\n") != NULL);
+    CHECK(strstr(page, "\nmouse_stabilizer_hook_timeouts_total 2\n") != NULL);
+    CHECK(strstr(page, "\nmouse_stabilizer_hook_reinstalls_total 1\n") != NULL);
+
+    char error[128];
+    int samples = MetricsText_Validate(page, length, error, sizeof(error));
+    CHECK(samples > 20);
+
+    // A page that does not fit ends at its last whole line and stays valid
+    static char small[600];
+    MetricsText_Initialize(&text, small, sizeof(small));
+    MetricsText_FormatPage(&text, &snapshot);
+    CHECK(text.truncated && text.length > 0 && text.length < sizeof(small) &&
+          small[text.length - 1] == '\n');
+    int partial = MetricsText_Validate(small, text.length, NULL, 0);
+    CHECK(partial > 0 && partial < samples);
+
+    // The validator rejects what a scraper would
+    static const char* const bad[] = {
+        "up 1\n",                                          // No # TYPE
+        "# TYPE up gauge\nup\n",                          // No value
+        "# TYPE up gauge\nup one\n",                      // Not a number
+        "# TYPE up gauge\nup{job=\"a} 1\n",              // Open label value
+        "# TYPE up gauge\nup{9job=\"a\"} 1\n",          // Bad label name
+        "# TYPE up gauge\n# TYPE up counter\nup 1\n",   // Second # TYPE
+        "# TYPE up meter\nup 1\n",                        // Unknown type
+        "# TYPE up gauge\nup_count 1\n",                  // Suffix on a gauge
+        "# TYPE up gauge\nup 1"                            // No final newline
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        CHECK(MetricsText_Validate(bad[i], strlen(bad[i]), error, sizeof(error)) == -1 &&
+              error[0] != '\0');
+    }
+    static const char good[] = "# HELP rtt Round trip\n# TYPE rtt summary\n"
+                               "rtt{quantile=\"0.5\"} +Inf\n"
+                               "rtt_sum 1.5e3\nrtt_count 2 1700000000000\n\n# plain comment\n";
+    CHECK(MetricsText_Validate(good, strlen(good), error, sizeof(error)) == 3);
+
+    // Requests: only complete GETs of /metrics are served
+    static const char get[] = "GET /metrics HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    CHECK(MetricsText_ParseRequest(get, sizeof(get) - 1) == METRICS_REQUEST_METRICS);
+    CHECK(MetricsText_ParseRequest(get, 20) == METRICS_REQUEST_INCOMPLETE);
+    static const struct {
+        const char* request;
+        MetricsRequest kind;
+    } requests[] = {
+        {"GET /metrics?x=1 HTTP/1.0\n\n", METRICS_REQUEST_METRICS},
+        {"GET /metricsx HTTP/1.1\r\n\r\n", METRICS_REQUEST_NOT_FOUND},
+        {"GET / HTTP/1.1\r\n\r\n", METRICS_REQUEST_NOT_FOUND},
+        {"POST /metrics HTTP/1.1\r\n\r\n", METRICS_REQUEST_BAD}
+    };
+    for (size_t i = 0; i < sizeof(requests) / sizeof(requests[0]); i++) {
+        CHECK(MetricsText_ParseRequest(requests[i].request,
+                                       strlen(requests[i].request)) == requests[i].kind);
+    }
+}
+
+static unsigned int HookTest_Observe(HookWatchdog* watchdog, uint64_t time_ms, uint64_t packets,
+                                     uint64_t hook_calls,
+                                     uint32_t hook_max_us, uint32_t tick_max_us) {
+    HookWatchdogSample sample = {
+        time_ms * 1000, packets, hook_calls, hook_max_us, tick_max_us, 500
+    };
+    return HookWatchdog_Observe(watchdog, &sample);
+}
+
+static void Test_HookWatchdog(void) {
+    HookWatchdog watchdog;
+    HookWatchdogContext context;
+    HookWatchdog_Initialize(&watchdog, 150000, 100000);
+
+    // Hook and raw input in step; then the hook goes quiet while packets keep coming
+    CHECK(HookTest_Observe(&watchdog, 500, 100, 100, 40, 8000) == 0);
+    CHECK(HookTest_Observe(&watchdog, 1000, 100, 0, 0, 8000) == 0);
+    CHECK(HookTest_Observe(&watchdog, 1500, 100, 0, 0, 8000) == HOOK_WATCHDOG_HOOK_DEAD);
+    HookWatchdog_GetContext(&watchdog, &context);
+    CHECK(context.window_us == 1000000);
+    CHECK(context.quiet_us == 1000000);
+    CHECK(context.packets_unhooked == 200);
+    CHECK(context.hook_max_us == 40);
+    CHECK(context.hook_max_age_us == 1000000);
+    CHECK(context.tick_max_us == 8000);
+    HookWatchdog_Reinstalled(&watchdog, 1500000);
+    CHECK(watchdog.reinstalls == 1);
+
+    // Still quiet: retried after the backoff, then after twice the backoff
+    unsigned int events = 0;
+    for (uint64_t t = 2000; t < 6500; t += 500) {
+        events |= HookTest_Observe(&watchdog, t, 100, 0, 0, 8000);
+    }
+    CHECK(events == 0);
+    CHECK(HookTest_Observe(&watchdog, 6500, 100, 0, 0, 8000) == HOOK_WATCHDOG_HOOK_DEAD);
+    HookWatchdog_Reinstalled(&watchdog, 6500000);
+    for (uint64_t t = 7000; t < 16500; t += 500) {
+        events |= HookTest_Observe(&watchdog, t, 100, 0, 0, 8000);
+    }
+    CHECK(events == 0);
+    CHECK(HookTest_Observe(&watchdog, 16500, 100, 0, 0, 8000) == HOOK_WATCHDOG_HOOK_DEAD);
+    HookWatchdog_GetContext(&watchdog, &context);
+    CHECK(context.quiet_us == 16000000);
+    CHECK(context.packets_unhooked == 2000);
+    CHECK(context.window_us == (HOOK_WATCHDOG_HISTORY - 1) * 500000ull);
+    HookWatchdog_Reinstalled(&watchdog, 16500000);
+
+    // Back: a later silence starts over at the short backoff. Silence without
+    // raw input (mouse at rest) is not an incident.
+    CHECK(HookTest_Observe(&watchdog, 17000, 100, 100, 40, 8000) == 0);
+    CHECK(watchdog.backoff_us == HOOK_WATCHDOG_BACKOFF_MS * 1000ull);
+    for (uint64_t t = 17500; t <= 20000; t += 500) {
+        events |= HookTest_Observe(&watchdog, t, 0, 0, 0, 8000);
+    }
+    CHECK(events == 0);
+    CHECK(watchdog.reinstalls == 3);
+
+    // Slow hooks and tick stalls: first report at once, then once per warn interval
+    CHECK(HookTest_Observe(&watchdog, 20500, 10, 10, 200000, 8000) == HOOK_WATCHDOG_SLOW_HOOK);
+    CHECK(HookTest_Observe(&watchdog, 21000, 10, 10, 200000, 250000) == HOOK_WATCHDOG_TICK_STALL);
+    CHECK(HookTest_Observe(&watchdog, 21500, 10, 10, 200000, 250000) == 0);
+    CHECK(HookTest_Observe(&watchdog, 20500 + HOOK_WATCHDOG_WARN_INTERVAL_MS, 10, 10, 200000,
+                           250000) == HOOK_WATCHDOG_SLOW_HOOK);
+    CHECK(HookTest_Observe(&watchdog, 21000 + HOOK_WATCHDOG_WARN_INTERVAL_MS, 10, 10, 100,
+                           99999) == 0);
+    HookWatchdog_GetContext(&watchdog, &context);
+    CHECK(context.hook_max_us == 200000);
+    CHECK(context.hook_max_age_us == 500000);
+    CHECK(context.tick_max_us == 250000);
+}
+
+typedef struct {
+    char text[4096];
+    size_t length;
+    int writes_left;            // Fail after this many writes, -1 never
+} EventTest_Sink;
+
+static bool EventTest_Write(void* context, const char* data, size_t length) {
+    EventTest_Sink* sink = (EventTest_Sink*)context;
+    if (sink->writes_left == 0) return false;
+    if (sink->writes_left > 0) sink->writes_left--;
+    if (sink->length + length >= sizeof(sink->text)) return false;
+    memcpy(sink->text + sink->length, data, length);
+    sink->length += length;
+    sink->text[sink->length] = '\0';
+    return true;
+}
+
+static void Test_EventTrace(void) {
+    static EventTraceEvent main_events[8];
+    static EventTraceEvent writer_events[2];
+    static EventTraceBuffer main_buffer, writer_buffer;
+    EventTrace_Initialize(&main_buffer, main_events, 8, 100, "Message thread");
+    EventTrace_Initialize(&writer_buffer, writer_events, 2, 200, NULL);
+
+    // Nested spans, a counter, an instant and an end whose begin predates the recording
+    CHECK(EventTrace_Add(&main_buffer, EVENT_TRACE_END, NULL, 1000, 0));
+    CHECK(EventTrace_Add(&main_buffer, EVENT_TRACE_BEGIN, "WM_TIMER", 1010, 0));
+    CHECK(EventTrace_Add(&main_buffer, EVENT_TRACE_BEGIN, "Cursor \"write\"", 1012, 0));
+    CHECK(EventTrace_Add(&main_buffer, EVENT_TRACE_END, NULL, 1015, 0));
+    CHECK(EventTrace_Add(&main_buffer, EVENT_TRACE_COUNTER, "Target distance", 1016, -3));
+    CHECK(EventTrace_Add(&main_buffer, EVENT_TRACE_END, NULL, 1020, 0));
+    CHECK(EventTrace_Add(&main_buffer, EVENT_TRACE_INSTANT, "Saved", 1030, 0));
+
+    // A full buffer drops and counts; its open span is closed at the last timestamp
+    CHECK(EventTrace_Add(&writer_buffer, EVENT_TRACE_BEGIN, "Log flush", 1005, 0));
+    CHECK(EventTrace_Add(&writer_buffer, EVENT_TRACE_INSTANT, "Rotate", 1008, 0));
+    CHECK(!EventTrace_Add(&writer_buffer, EVENT_TRACE_END, NULL, 1009, 0));
+    CHECK(writer_buffer.count == 2 && writer_buffer.dropped == 1);
+
+    static EventTest_Sink sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.writes_left = -1;
+    const EventTraceBuffer* buffers[2] = {&main_buffer, &writer_buffer};
+    CHECK(EventTrace_WriteJson(buffers, 2, 7, "Mouse Stabilizer", 1000, EventTest_Write, &sink));
+
+    const char* expected =
+        "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":1},\"traceEvents\":[\n"
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":7,\"tid\":0,"
+        "\"args\":{\"name\":\"Mouse Stabilizer\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":7,\"tid\":100,"
+        "\"args\":{\"name\":\"Message thread\"}},\n"
+        "{\"name\":\"WM_TIMER\",\"ph\":\"B\",\"ts\":10,\"pid\":7,\"tid\":100},\n"
+        "{\"name\":\"Cursor \\\"write\\\"\",\"ph\":\"B\",\"ts\":12,\"pid\":7,\"tid\":100},\n"
+        "{\"ph\":\"E\",\"ts\":15,\"pid\":7,\"tid\":100},\n"
+        "{\"name\":\"Target distance\",\"ph\":\"C\",\"ts\":16,\"pid\":7,\"tid\":100,"
+        "\"args\":{\"value\":-3}},\n"
+        "{\"ph\":\"E\",\"ts\":20,\"pid\":7,\"tid\":100},\n"
+        "{\"name\":\"Saved\",\"ph\":\"i\",\"s\":\"t\",\"ts\":30,\"pid\":7,\"tid\":100},\n"
+        "{\"name\":\"Log flush\",\"ph\":\"B\",\"ts\":5,\"pid\":7,\"tid\":200},\n"
+        "{\"name\":\"Rotate\",\"ph\":\"i\",\"s\":\"t\",\"ts\":8,\"pid\":7,\"tid\":200},\n"
+        "{\"ph\":\"E\",\"ts\":8,\"pid\":7,\"tid\":200}\n"
+        "]}\n";
+    CHECK(strcmp(sink.text, expected) == 0);
+
+    // A failing sink stops the writer
+    memset(&sink, 0, sizeof(sink));
+    sink.writes_left = 3;
+    CHECK(!EventTrace_WriteJson(buffers, 2, 7, NULL, 1000, EventTest_Write, &sink));
+
+    // No buffers is still a valid, empty trace
+    memset(&sink, 0, sizeof(sink));
+    sink.writes_left = -1;
+    CHECK(EventTrace_WriteJson(NULL, 0, 7, NULL, 0, EventTest_Write, &sink));
+    CHECK(strcmp(sink.text, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":0},"
+                            "\"traceEvents\":[\n\n]}\n") == 0);
+}
+
+static void Test_DeviceTable(void) {
+    static DeviceTable table;
+    DeviceTable_Initialize(&table);
+
+    bool created = false;
+    for (int i = 0; i < DEVICE_TABLE_CAPACITY; i++) {
+        void* device = (void*)(uintptr_t)(0x100 + i * 8);
+        DeviceEntry* entry = DeviceTable_Insert(&table, device, &created);
+        CHECK(entry != NULL && created);
+    }
+    CHECK(table.count == DEVICE_TABLE_CAPACITY);
+    CHECK(DeviceTable_Insert(&table, (void*)(uintptr_t)0x9000, &created) == NULL);
+
+    // Removing from the middle of probe chains keeps everything else reachable
+    for (int i = 0; i < DEVICE_TABLE_CAPACITY; i += 3) {
+        CHECK(DeviceTable_Remove(&table, (void*)(uintptr_t)(0x100 + i * 8)));
+    }
+    for (int i = 0; i < DEVICE_TABLE_CAPACITY; i++) {
+        DeviceEntry* entry = DeviceTable_Find(&table, (void*)(uintptr_t)(0x100 + i * 8));
+        CHECK((i % 3 == 0) ? entry == NULL : entry != NULL);
+    }
+    CHECK(!DeviceTable_Remove(&table, (void*)(uintptr_t)0x100));
+
+    // Overrides win over the global settings, the rest follows them, all clamped
+    SmoothStabilizer defaults;
+    StabilizerCore_Initialize(&defaults, NULL, NULL, NULL);
+    defaults.follow_strength = 0.3f;
+    defaults.delay_start_ms = 40;
+    defaults.drag_only = true;
+    DeviceEntry* entry = DeviceTable_Insert(&table, (void*)(uintptr_t)0x100, &created);
+    CHECK(entry != NULL && created && entry->settings.set == 0);
+    StabilizerCore_Initialize(&entry->stabilizer, NULL, NULL, NULL);
+    DeviceTable_ApplySettings(entry, &defaults);
+    CHECK(entry->stabilizer.follow_strength == 0.3f && entry->stabilizer.delay_start_ms == 40);
+    entry->settings.set = DEVICE_SETTING_FOLLOW_STRENGTH | DEVICE_SETTING_MIN_DISTANCE |
+                          DEVICE_SETTING_DRAG_ONLY;
+    entry->settings.follow_strength = 0.6f;
+    entry->settings.min_distance = 50.0f;
+    entry->settings.drag_only = false;
+    DeviceTable_ApplySettings(entry, &defaults);
+    CHECK(entry->stabilizer.follow_strength == 0.6f);
+    CHECK(entry->stabilizer.min_distance == STABILIZER_MIN_DISTANCE_MAX);
+    CHECK(!entry->stabilizer.drag_only);
+    CHECK(entry->stabilizer.delay_start_ms == 40);
+    defaults.delay_start_ms = 90;
+    DeviceTable_ApplySettings(entry, &defaults);
+    CHECK(entry->stabilizer.follow_strength == 0.6f && entry->stabilizer.delay_start_ms == 90);
+
+    // A device that does not drive the cursor tracks its buttons without engaging
+    defaults.drag_only = true;
+    defaults.enabled = true;
+    StabilizerCore_TrackButtons(&defaults, STABILIZER_BUTTON_LEFT | STABILIZER_BUTTON_RIGHT, 0);
+    StabilizerCore_TrackButtons(&defaults, 0, STABILIZER_BUTTON_RIGHT);
+    CHECK(defaults.buttons_down == STABILIZER_BUTTON_LEFT);
+    CHECK(!defaults.engaged);
+}
+
+int main(void) {
+    Test_Easing();
+    Test_FollowsTarget();
+    Test_DelayStart();
+    Test_DragOnly();
+    Test_ClampAcrossMonitors();
+    Test_OutputSink();
+    Test_VelocityEstimator();
+    Test_SettingsRoundTrip();
+    Test_MultiInstance();
+    Test_LogRing();
+    Test_BinaryLog();
+    Test_LatencyHistogram();
+    Test_PerfCounters();
+    Test_TelemetryBlock();
+    Test_MetricsText();
+    Test_HookWatchdog();
+    Test_EventTrace();
+    Test_InputTrace();
+    Test_TraceReplay();
+    Test_EngineSnapshot();
+    Test_TraceIndex();
+    Test_FlightRecorder();
+    Test_TrajectoryMetrics();
+    Test_TrajectoryReport();
+    Test_StabilizerBatch();
+    Test_DeviceTable();
+
+    printf("%d checks, %d failures\n", g_checks, g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
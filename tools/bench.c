@@ -0,0 +1,457 @@
+/**
+ * Bench - Engine Hot Path Microbenchmarks
+ *
+ * Times the per-packet and per-tick engine calls on synthetic input at
+ * common polling rates: easing, velocity estimation, raw delta handling,
+ * the timer step in every filter mode and the batch kernels. Each case
+ * warms up, then takes many short samples on a pinned CPU and reports
+ * ns/op percentiles; results go out as JSON for tracking across releases.
+ *
+ * Usage: bench [-o results.json] [--filter TEXT] [--samples N] [--cpu N]
+ * Build: make bench (builds and writes build/host/bench.json)
+ */
+
+#include "include/core/stabilizer_core.h"
+#include "include/core/stabilizer_batch.h"
+#include "tools/tool_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_SAMPLES 300
+#define BENCH_MAX_SAMPLES 10000
+#define BENCH_WARMUP_NS 20000000ull     // 20 ms per case
+#define BENCH_SAMPLE_NS 20000ull        // Target length of one timed sample
+#define BENCH_MAX_RESULTS 64
+
+static const int g_rates_hz[] = {125, 1000, 4000, 8000};
+#define BENCH_RATE_COUNT ((int)(sizeof(g_rates_hz) / sizeof(g_rates_hz[0])))
+
+// Virtual host: settable clock, two monitors, a sink that only counts
+typedef struct {
+    Platform platform;
+    ScreenGeometry geometry;
+    OutputSink sink;
+    uint64_t now_us;
+    int cursor_x, cursor_y;
+    uint64_t writes;
+} BenchHost;
+
+// One benchmark case: set up once, then run ops in timed samples
+typedef struct BenchCase BenchCase;
+struct BenchCase {
+    const char* group;
+    char name[64];
+    int rate_hz;                    // Input rate, 0 where it does not apply
+    int ops_per_call;               // Operations one run() performs
+    void (*setup)(BenchCase* bench);
+    void (*run)(BenchCase* bench, int calls);
+    // Parameters and state
+    EaseType ease;
+    bool dual_mode;
+    bool drag_only;
+    StabilizerBatchIsa isa;
+    uint64_t step;                  // Packet spacing in us
+    uint64_t time_us;
+    float x, y;                     // Accumulated synthetic position
+    int counter;
+};
+
+typedef struct {
+    char name[96];
+    const char* group;
+    int rate_hz;
+    int samples;
+    uint64_t ops;
+    double mean, min, p50, p90, p99, max;   // ns per op
+} BenchResult;
+
+static BenchHost g_host;
+static SmoothStabilizer g_stabilizer;
+static VelocityEstimator g_estimator;
+static StabilizerBatch g_batch;
+static volatile float g_sink;       // Keeps pure computations alive
+
+static uint64_t BenchHost_NowMicros(void* context) {
+    return ((BenchHost*)context)->now_us;
+}
+
+static bool BenchHost_GetCursor(void* context, int* x, int* y) {
+    BenchHost* host = (BenchHost*)context;
+    *x = host->cursor_x;
+    *y = host->cursor_y;
+    return true;
+}
+
+static int BenchHost_QueryMonitors(void* context, ScreenRect* monitors, int max) {
+    (void)context;
+    static const ScreenRect layout[2] = {
+        {0, 0, 2560, 1440},
+        {-1920, 0, 0, 1080}
+    };
+    int count = max < 2 ? max : 2;
+    memcpy(monitors, layout, sizeof(layout[0]) * (size_t)count);
+    return count;
+}
+
+static bool BenchHost_Write(void* context, int x, int y) {
+    BenchHost* host = (BenchHost*)context;
+    host->cursor_x = x;
+    host->cursor_y = y;
+    host->writes++;
+    return true;
+}
+
+static void BenchHost_Initialize(BenchHost* host) {
+    memset(host, 0, sizeof(*host));
+    host->now_us = 1000000;
+    host->cursor_x = 1280;
+    host->cursor_y = 720;
+    host->platform.context = host;
+    host->platform.now_us = BenchHost_NowMicros;
+    host->platform.get_cursor = BenchHost_GetCursor;
+    host->platform.query_monitors = BenchHost_QueryMonitors;
+    // No log callback: the host drops debug lines, as a release build does
+    OutputSink_Initialize(&host->sink, BenchHost_Write, host);
+    ScreenGeometry_Refresh(&host->geometry, &host->platform);
+}
+
+// Synthetic hand motion: a slow circle with per-packet wobble, in counts
+static void Bench_Motion(int index, int rate_hz, float* dx, float* dy) {
+    static const float wobble[8] = {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 1.0f, 0.0f, -1.0f};
+    float scale = 8000.0f / (float)rate_hz;    // Same hand speed at every rate
+    float phase = (float)(index % 4096) * (6.2831853f / 4096.0f);
+    *dx = roundf(cosf(phase) * scale) + wobble[index & 7];
+    *dy = roundf(sinf(phase) * scale) + wobble[(index + 3) & 7];
+}
+
+// ---------------------------------------------------------------------------
+// Cases
+
+static void Easing_Run(BenchCase* bench, int calls) {
+    float sum = 0.0f;
+    for (int i = 0; i < calls; i++) {
+        float t = (float)((bench->counter + i) & 1023) * (1.0f / 1023.0f);
+        sum += StabilizerCore_ApplyEasing(t, bench->ease);
+    }
+    bench->counter += calls;
+    g_sink = sum;
+}
+
+static void Velocity_Setup(BenchCase* bench) {
+    VelocityEstimator_Reset(&g_estimator, (uint64_t)DEFAULT_VELOCITY_WINDOW_MS * 1000);
+    bench->time_us = 1000000;
+    bench->step = 1000000u / (uint64_t)bench->rate_hz;
+    bench->x = 0.0f;
+    bench->y = 0.0f;
+}
+
+static void Velocity_Run(BenchCase* bench, int calls) {
+    for (int i = 0; i < calls; i++) {
+        float dx, dy;
+        Bench_Motion(bench->counter++, bench->rate_hz, &dx, &dy);
+        bench->time_us += bench->step;
+        bench->x += dx;
+        bench->y += dy;
+        VelocityEstimator_AddSample(&g_estimator, bench->time_us, bench->x, bench->y);
+    }
+    g_sink = g_estimator.speed;
+}
+
+static void Stabilizer_Setup(BenchCase* bench) {
+    BenchHost_Initialize(&g_host);
+    StabilizerCore_Initialize(&g_stabilizer, &g_host.platform, &g_host.geometry, &g_host.sink);
+    g_stabilizer.ease_type = bench->ease;
+    g_stabilizer.dual_mode = bench->dual_mode;
+    g_stabilizer.drag_only = bench->drag_only;
+    g_stabilizer.delay_start_ms = 0;
+    StabilizerCore_UpdateButtons(&g_stabilizer, STABILIZER_BUTTON_LEFT, 0);
+    bench->step = 1000000u / (uint64_t)bench->rate_hz;
+    bench->counter = 0;
+}
+
+static void AddDelta_Run(BenchCase* bench, int calls) {
+    for (int i = 0; i < calls; i++) {
+        float dx, dy;
+        Bench_Motion(bench->counter++, bench->rate_hz, &dx, &dy);
+        g_host.now_us += bench->step;
+        StabilizerCore_AddMouseDelta(&g_stabilizer, dx, dy, g_host.now_us);
+    }
+}
+
+// One timer period of input followed by the timer step, as the host runs them
+static void Tick_Run(BenchCase* bench, int calls) {
+    int packets = bench->rate_hz * UPDATE_INTERVAL_MS / 1000;
+    if (packets < 1) packets = 1;
+    for (int i = 0; i < calls; i++) {
+        AddDelta_Run(bench, packets);
+        StabilizerCore_UpdatePosition(&g_stabilizer);
+    }
+}
+
+static void Batch_Setup(BenchCase* bench) {
+    SmoothStabilizer settings;
+    StabilizerCore_Initialize(&settings, NULL, NULL, NULL);
+    StabilizerBatch_Initialize(&g_batch, STABILIZER_BATCH_MAX_LANES, 1280.0f, 720.0f);
+    StabilizerBatch_SetIsa(&g_batch, bench->isa);
+    for (int lane = 0; lane < STABILIZER_BATCH_MAX_LANES; lane++) {
+        settings.follow_strength = 0.05f + (float)(lane % 20) * 0.05f;
+        settings.ease_type = (EaseType)(lane % 4);
+        settings.dual_mode = (lane / 4) % 2 != 0;
+        settings.delay_start_ms = (uint32_t)(lane % 3) * 50;
+        StabilizerBatch_SetLane(&g_batch, lane, &settings);
+    }
+    StabilizerBatch_Engage(&g_batch, 1280.0f, 720.0f);
+    bench->step = 1000000u / (uint64_t)bench->rate_hz;
+    bench->time_us = 1000000;
+    bench->counter = 0;
+}
+
+// Lane-ticks: ops_per_call covers every lane of one step
+static void Batch_Run(BenchCase* bench, int calls) {
+    int packets = bench->rate_hz * UPDATE_INTERVAL_MS / 1000;
+    for (int i = 0; i < calls; i++) {
+        for (int p = 0; p < packets; p++) {
+            float dx, dy;
+            Bench_Motion(bench->counter++, bench->rate_hz, &dx, &dy);
+            bench->time_us += bench->step;
+            StabilizerBatch_AddMouseDelta(&g_batch, dx, dy, bench->time_us);
+        }
+        StabilizerBatch_UpdatePosition(&g_batch, bench->time_us);
+    }
+}
+
+static int Bench_BuildCases(BenchCase* cases, int max) {
+    static const char* ease_names[4] = {"linear", "in", "out", "inout"};
+    int count = 0;
+    memset(cases, 0, sizeof(BenchCase) * (size_t)max);
+
+    for (int ease = 0; ease < 4 && count < max; ease++) {
+        BenchCase* bench = &cases[count++];
+        bench->group = "easing";
+        snprintf(bench->name, sizeof(bench->name), "%s", ease_names[ease]);
+        bench->ops_per_call = 1;
+        bench->run = Easing_Run;
+        bench->ease = (EaseType)ease;
+    }
+
+    for (int r = 0; r < BENCH_RATE_COUNT && count + 2 <= max; r++) {
+        BenchCase* velocity = &cases[count++];
+        velocity->group = "velocity_estimator";
+        snprintf(velocity->name, sizeof(velocity->name), "add_sample");
+        velocity->rate_hz = g_rates_hz[r];
+        velocity->ops_per_call = 1;
+        velocity->setup = Velocity_Setup;
+        velocity->run = Velocity_Run;
+
+        BenchCase* delta = &cases[count++];
+        delta->group = "add_mouse_delta";
+        snprintf(delta->name, sizeof(delta->name), "engaged");
+        delta->rate_hz = g_rates_hz[r];
+        delta->ops_per_call = 1;
+        delta->setup = Stabilizer_Setup;
+        delta->run = AddDelta_Run;
+        delta->ease = EASE_OUT;
+        delta->dual_mode = true;
+    }
+
+    // Every filter mode at every rate: one op is a whole timer period
+    for (int r = 0; r < BENCH_RATE_COUNT; r++) {
+        for (int mode = 0; mode < 9 && count < max; mode++) {
+            BenchCase* bench = &cases[count++];
+            bench->group = "update_tick";
+            bench->rate_hz = g_rates_hz[r];
+            bench->ops_per_call = 1;
+            bench->setup = Stabilizer_Setup;
+            bench->run = Tick_Run;
+            bench->ease = (EaseType)(mode % 4);
+            bench->dual_mode = mode >= 4 && mode < 8;
+            bench->drag_only = mode == 8;
+            if (bench->drag_only) {
+                snprintf(bench->name, sizeof(bench->name), "drag_only/out");
+                bench->ease = EASE_OUT;
+            } else {
+                snprintf(bench->name, sizeof(bench->name), "%s/%s",
+                         bench->dual_mode ? "dual" : "single", ease_names[bench->ease]);
+            }
+        }
+    }
+
+    for (int isa = STABILIZER_BATCH_SCALAR; isa <= STABILIZER_BATCH_AVX512 && count < max; isa++) {
+        if (!StabilizerBatch_IsaSupported((StabilizerBatchIsa)isa)) continue;
+        BenchCase* bench = &cases[count++];
+        bench->group = "batch_lane_tick";
+        snprintf(bench->name, sizeof(bench->name), "%s",
+                 StabilizerBatch_IsaName((StabilizerBatchIsa)isa));
+        bench->rate_hz = 1000;
+        bench->ops_per_call = STABILIZER_BATCH_MAX_LANES;
+        bench->setup = Batch_Setup;
+        bench->run = Batch_Run;
+        bench->isa = (StabilizerBatchIsa)isa;
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// Measurement
+
+static int Bench_CompareDouble(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+static double Bench_Percentile(const double* sorted, int count, double p) {
+    int index = (int)(p * (double)(count - 1) + 0.5);
+    return sorted[index];
+}
+
+static void Bench_Measure(BenchCase* bench, int samples, BenchResult* result) {
+    static double ns_per_op[BENCH_MAX_SAMPLES];
+
+    if (bench->setup) bench->setup(bench);
+
+    // Warm up caches and branch predictors, and size samples to ~20us
+    int calls = 1;
+    uint64_t warm_start = ToolCommon_Nanos();
+    while (ToolCommon_Nanos() - warm_start < BENCH_WARMUP_NS) {
+        uint64_t t0 = ToolCommon_Nanos();
+        bench->run(bench, calls);
+        uint64_t elapsed = ToolCommon_Nanos() - t0;
+        if (elapsed < BENCH_SAMPLE_NS && calls < (1 << 20)) calls *= 2;
+    }
+
+    double sum = 0.0;
+    for (int s = 0; s < samples; s++) {
+        uint64_t t0 = ToolCommon_Nanos();
+        bench->run(bench, calls);
+        uint64_t elapsed = ToolCommon_Nanos() - t0;
+        ns_per_op[s] = (double)elapsed / ((double)calls * (double)bench->ops_per_call);
+        sum += ns_per_op[s];
+    }
+    qsort(ns_per_op, (size_t)samples, sizeof(double), Bench_CompareDouble);
+
+    memset(result, 0, sizeof(*result));
+    snprintf(result->name, sizeof(result->name), "%s/%s", bench->group, bench->name);
+    result->group = bench->group;
+    result->rate_hz = bench->rate_hz;
+    result->samples = samples;
+    result->ops = (uint64_t)samples * (uint64_t)calls * (uint64_t)bench->ops_per_call;
+    result->mean = sum / samples;
+    result->min = ns_per_op[0];
+    result->p50 = Bench_Percentile(ns_per_op, samples, 0.50);
+    result->p90 = Bench_Percentile(ns_per_op, samples, 0.90);
+    result->p99 = Bench_Percentile(ns_per_op, samples, 0.99);
+    result->max = ns_per_op[samples - 1];
+}
+
+static void Bench_WriteJson(FILE* out, const BenchResult* results, int count, int cpu,
+                            int samples) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"schema\": 1,\n");
+    fprintf(out, "  \"unit\": \"ns_per_op\",\n");
+    fprintf(out, "  \"pinned_cpu\": %d,\n", cpu);
+    fprintf(out, "  \"samples\": %d,\n", samples);
+    fprintf(out, "  \"batch_isa\": \"%s\",\n",
+            StabilizerBatch_IsaName(StabilizerBatch_DetectIsa()));
+    fprintf(out, "  \"update_interval_ms\": %d,\n", UPDATE_INTERVAL_MS);
+    fprintf(out, "  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(out, "    {\"name\": \"%s\", \"group\": \"%s\", \"rate_hz\": %d, \"ops\": %llu, "
+                     "\"mean\": %.3f, \"min\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, "
+                     "\"max\": %.3f, \"ops_per_sec\": %.0f}%s\n",
+                r->name, r->group, r->rate_hz, (unsigned long long)r->ops,
+                r->mean, r->min, r->p50, r->p90, r->p99, r->max,
+                r->p50 > 0.0 ? 1e9 / r->p50 : 0.0, (i + 1 < count) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static void Bench_Usage(void) {
+    fprintf(stderr,
+            "Usage: bench [options]\n"
+            "  -o FILE          Write JSON results (default: stdout)\n"
+            "  --filter TEXT    Only run cases whose name contains TEXT\n"
+            "  --samples N      Timed samples per case (default %d)\n"
+            "  --cpu N          Pin to CPU N (default: the current CPU)\n"
+            "  --list           List case names and exit\n",
+            BENCH_DEFAULT_SAMPLES);
+}
+
+int main(int argc, char** argv) {
+    static BenchCase cases[BENCH_MAX_RESULTS];
+    static BenchResult results[BENCH_MAX_RESULTS];
+    const char* output_path = NULL;
+    const char* filter = NULL;
+    int samples = BENCH_DEFAULT_SAMPLES;
+    int cpu = -1;
+    bool list = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            Bench_Usage();
+            return 0;
+        } else if (strcmp(arg, "--list") == 0) {
+            list = true;
+            continue;
+        } else if (!value) {
+            Bench_Usage();
+            return 2;
+        } else if (strcmp(arg, "-o") == 0) {
+            output_path = value;
+        } else if (strcmp(arg, "--filter") == 0) {
+            filter = value;
+        } else if (strcmp(arg, "--samples") == 0) {
+            samples = atoi(value);
+        } else if (strcmp(arg, "--cpu") == 0) {
+            cpu = atoi(value);
+        } else {
+            fprintf(stderr, "bench: unknown option %s\n", arg);
+            Bench_Usage();
+            return 2;
+        }
+        i++;
+    }
+    if (samples < 10) samples = 10;
+    if (samples > BENCH_MAX_SAMPLES) samples = BENCH_MAX_SAMPLES;
+
+    int case_count = Bench_BuildCases(cases, BENCH_MAX_RESULTS);
+    if (list) {
+        for (int i = 0; i < case_count; i++) {
+            printf("%s/%s @%d Hz\n", cases[i].group, cases[i].name, cases[i].rate_hz);
+        }
+        return 0;
+    }
+
+    int pinned = ToolCommon_PinToCpu(cpu);
+    if (pinned < 0) {
+        fprintf(stderr, "bench: could not pin to a CPU, results will be noisier\n");
+    }
+
+    int count = 0;
+    fprintf(stderr, "%-40s %6s %9s %9s %9s %12s\n", "case", "Hz", "p50 ns", "p90 ns", "p99 ns",
+            "ops/s");
+    for (int i = 0; i < case_count; i++) {
+        char full[96];
+        snprintf(full, sizeof(full), "%s/%s", cases[i].group, cases[i].name);
+        if (filter && !strstr(full, filter)) continue;
+
+        BenchResult* r = &results[count++];
+        Bench_Measure(&cases[i], samples, r);
+        fprintf(stderr, "%-40s %6d %9.2f %9.2f %9.2f %12.0f\n",
+                r->name, r->rate_hz, r->p50, r->p90, r->p99, r->p50 > 0.0 ? 1e9 / r->p50 : 0.0);
+    }
+
+    FILE* out = stdout;
+    if (output_path && !(out = fopen(output_path, "w"))) {
+        fprintf(stderr, "bench: cannot create %s\n", output_path);
+        return 1;
+    }
+    Bench_WriteJson(out, results, count, pinned, samples);
+    if (out != stdout) fclose(out);
+    return 0;
+}
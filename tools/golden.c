@@ -0,0 +1,677 @@
+/**
+ * Golden - Trajectory Regression and Performance Gates
+ *
+ * Replays every trace of a corpus directory through each engine mode and
+ * compares the per-tick cursor position against the golden trajectory
+ * stored next to the trace (NAME.mstrace -> NAME.golden). It then times
+ * the engine calls on the same input and compares ns per packet and p99
+ * ns per timer tick against the stored baseline (baseline.txt). Exits
+ * non-zero on any difference beyond tolerance or any regression.
+ *
+ * Usage: golden [options] CORPUS_DIR
+ * Build: make golden (checks tests/golden), make golden-update (rewrites it)
+ */
+
+#ifndef _WIN32
+#define _DEFAULT_SOURCE
+#endif
+
+#include "include/core/trace_replay.h"
+#include "tools/tool_common.h"
+
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GOLDEN_MODES 9
+#define GOLDEN_MAX_TRACES 256
+#define GOLDEN_DEFAULT_TOLERANCE_PX 0.01f
+#define GOLDEN_DEFAULT_MAX_RATIO 1.5
+#define GOLDEN_SLACK_NS 10.0            // Absolute allowance on top of the ratio
+#define GOLDEN_DEFAULT_REPEAT 5
+#define GOLDEN_REPLAY_RECORDS 65536
+#define GOLDEN_PRINT_SCALE 1000.0f      // Positions are stored to 1/1000 px
+
+// One engine configuration every trace is replayed with
+typedef struct {
+    char name[32];
+    SmoothStabilizer settings;
+} GoldenMode;
+
+// Per-tick cursor positions of one replay
+typedef struct {
+    uint64_t* time_us;
+    float* x;
+    float* y;
+    size_t count, capacity;
+    bool failed;
+} GoldenPath;
+
+// Decoded packets of one trace, for the timing pass
+typedef struct {
+    uint64_t time_us;
+    int32_t dx, dy;
+    unsigned int pressed, released;
+} GoldenPacket;
+
+typedef struct {
+    char name[256];
+    char path[4096];
+    ToolFile file;
+    GoldenPacket* packets;
+    size_t packet_count;
+    uint64_t start_us;
+    float start_x, start_y;
+} GoldenTrace;
+
+typedef struct {
+    double packet_ns;               // Mean AddMouseDelta cost per packet
+    double step_p99_ns;             // 99th percentile UpdatePosition cost
+} GoldenTiming;
+
+// Virtual host for the timing pass, same rules as TraceReplay
+typedef struct {
+    Platform platform;
+    OutputSink sink;
+    uint64_t now_us;
+    int cursor_x, cursor_y;
+} GoldenHost;
+
+static GoldenMode g_modes[GOLDEN_MODES];
+static GoldenTrace g_traces[GOLDEN_MAX_TRACES];
+static int g_trace_count;
+
+// ---------------------------------------------------------------------------
+// Modes and corpus
+
+static void Golden_InitializeModes(void) {
+    static const char* ease_names[4] = {"linear", "in", "out", "inout"};
+    for (int mode = 0; mode < GOLDEN_MODES; mode++) {
+        GoldenMode* entry = &g_modes[mode];
+        StabilizerCore_Initialize(&entry->settings, NULL, NULL, NULL);
+        entry->settings.ease_type = (EaseType)(mode % 4);
+        entry->settings.dual_mode = mode >= 4 && mode < 8;
+        entry->settings.drag_only = mode == 8;
+        const char* kind = entry->settings.dual_mode ? "dual" : "single";
+        if (entry->settings.drag_only) kind = "drag";
+        snprintf(entry->name, sizeof(entry->name), "%s/%s", kind, ease_names[mode % 4]);
+    }
+}
+
+static bool Golden_HasSuffix(const char* name, const char* suffix) {
+    size_t length = strlen(name), suffix_length = strlen(suffix);
+    return length >= suffix_length && strcmp(name + length - suffix_length, suffix) == 0;
+}
+
+static int Golden_CompareTraceNames(const void* a, const void* b) {
+    return strcmp(((const GoldenTrace*)a)->name, ((const GoldenTrace*)b)->name);
+}
+
+static bool Golden_LoadTrace(GoldenTrace* trace) {
+    if (!ToolCommon_MapFile(&trace->file, trace->path)) {
+        fprintf(stderr, "golden: cannot map %s\n", trace->path);
+        return false;
+    }
+
+    InputTraceReader reader;
+    if (!InputTrace_OpenReader(&reader, trace->file.data, trace->file.length)) {
+        fprintf(stderr, "golden: %s is not an input trace\n", trace->path);
+        return false;
+    }
+    trace->start_us = reader.start_us;
+
+    // Count first, then decode into one allocation
+    InputTraceReader scan = reader;
+    InputTraceRecord record;
+    size_t packets = 0;
+    bool has_start = false;
+    while (InputTrace_Read(&scan, &record)) {
+        if (record.type == INPUT_TRACE_PACKET) {
+            packets++;
+        } else if (record.type == INPUT_TRACE_OUTPUT && !has_start) {
+            trace->start_x = record.x;
+            trace->start_y = record.y;
+            has_start = true;
+        }
+    }
+
+    trace->packets = malloc((packets ? packets : 1) * sizeof(GoldenPacket));
+    if (!trace->packets) return false;
+    while (InputTrace_Read(&reader, &record)) {
+        if (record.type != INPUT_TRACE_PACKET) continue;
+        GoldenPacket* packet = &trace->packets[trace->packet_count++];
+        packet->time_us = record.time_us;
+        packet->dx = record.dx;
+        packet->dy = record.dy;
+        packet->pressed = record.pressed;
+        packet->released = record.released;
+    }
+    return true;
+}
+
+static bool Golden_LoadCorpus(const char* directory) {
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        fprintf(stderr, "golden: cannot open %s\n", directory);
+        return false;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL && g_trace_count < GOLDEN_MAX_TRACES) {
+        if (!Golden_HasSuffix(entry->d_name, ".mstrace")) continue;
+        GoldenTrace* trace = &g_traces[g_trace_count++];
+        snprintf(trace->name, sizeof(trace->name), "%.*s",
+                 (int)(strlen(entry->d_name) - strlen(".mstrace")), entry->d_name);
+        snprintf(trace->path, sizeof(trace->path), "%s/%s", directory, entry->d_name);
+    }
+    closedir(dir);
+
+    // Directory order is arbitrary; report in a stable order
+    qsort(g_traces, (size_t)g_trace_count, sizeof(GoldenTrace), Golden_CompareTraceNames);
+    for (int i = 0; i < g_trace_count; i++) {
+        if (!Golden_LoadTrace(&g_traces[i])) return false;
+    }
+    if (g_trace_count == 0) {
+        fprintf(stderr, "golden: no .mstrace files in %s\n", directory);
+        return false;
+    }
+    return true;
+}
+
+static void Golden_FreeCorpus(void) {
+    for (int i = 0; i < g_trace_count; i++) {
+        free(g_traces[i].packets);
+        ToolCommon_UnmapFile(&g_traces[i].file);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Trajectories
+
+static void GoldenPath_Record(void* context, uint64_t time_us, const SmoothStabilizer* stabilizer) {
+    GoldenPath* path = (GoldenPath*)context;
+    if (path->failed) return;
+
+    if (path->count == path->capacity) {
+        size_t capacity = path->capacity ? path->capacity * 2 : 4096;
+        uint64_t* time_us_grown = realloc(path->time_us, capacity * sizeof(uint64_t));
+        if (time_us_grown) path->time_us = time_us_grown;
+        float* x_grown = realloc(path->x, capacity * sizeof(float));
+        if (x_grown) path->x = x_grown;
+        float* y_grown = realloc(path->y, capacity * sizeof(float));
+        if (y_grown) path->y = y_grown;
+        if (!time_us_grown || !x_grown || !y_grown) {
+            path->failed = true;
+            return;
+        }
+        path->capacity = capacity;
+    }
+
+    path->time_us[path->count] = time_us;
+    path->x[path->count] = stabilizer->current_pos.x;
+    path->y[path->count] = stabilizer->current_pos.y;
+    path->count++;
+}
+
+static void GoldenPath_Free(GoldenPath* path) {
+    free(path->time_us);
+    free(path->x);
+    free(path->y);
+    memset(path, 0, sizeof(*path));
+}
+
+static bool Golden_Replay(const GoldenTrace* trace, const GoldenMode* mode, GoldenPath* path) {
+    static TraceReplay replay;
+    memset(path, 0, sizeof(*path));
+    if (!TraceReplay_Open(&replay, trace->file.data, trace->file.length, &mode->settings, NULL,
+                          NULL, NULL)) {
+        return false;
+    }
+    replay.on_tick = GoldenPath_Record;
+    replay.tick_context = path;
+    while (TraceReplay_Step(&replay, GOLDEN_REPLAY_RECORDS)) {}
+    return !path->failed;
+}
+
+static float Golden_Quantize(float value) {
+    return roundf(value * GOLDEN_PRINT_SCALE) / GOLDEN_PRINT_SCALE;
+}
+
+// One header line per mode, then a line per tick that changed the stored position
+static void Golden_WritePath(FILE* out, const GoldenMode* mode, const GoldenPath* path) {
+    fprintf(out, "mode %s ticks %zu\n", mode->name, path->count);
+    float last_x = NAN, last_y = NAN;
+    for (size_t i = 0; i < path->count; i++) {
+        float x = Golden_Quantize(path->x[i]);
+        float y = Golden_Quantize(path->y[i]);
+        if (i > 0 && x == last_x && y == last_y) continue;
+        fprintf(out, "%llu %.3f %.3f\n", (unsigned long long)path->time_us[i], x, y);
+        last_x = x;
+        last_y = y;
+    }
+}
+
+// Compare one mode's replay against the stored lines that follow its header
+static bool Golden_ComparePath(FILE* in, const char* trace_name, const GoldenMode* mode,
+                               const GoldenPath* path, float tolerance_px) {
+    char line[256], name[64];
+    size_t ticks = 0;
+    if (!fgets(line, sizeof(line), in) || sscanf(line, "mode %63s ticks %zu", name, &ticks) != 2 ||
+        strcmp(name, mode->name) != 0) {
+        printf("FAIL %s %s: golden file has no entry for this mode\n", trace_name, mode->name);
+        return false;
+    }
+    if (ticks != path->count) {
+        printf("FAIL %s %s: %zu ticks, golden has %zu\n",
+               trace_name, mode->name, path->count, ticks);
+    }
+
+    // The stored position holds until the next stored tick
+    float golden_x = 0.0f, golden_y = 0.0f;
+    unsigned long long next_time = 0;
+    float next_x = 0.0f, next_y = 0.0f;
+    bool have_next = false;
+    long position = ftell(in);
+    if (fgets(line, sizeof(line), in) &&
+        sscanf(line, "%llu %f %f", &next_time, &next_x, &next_y) == 3) {
+        have_next = true;
+        position = ftell(in);
+    }
+
+    double worst = 0.0;
+    uint64_t worst_time = 0;
+    for (size_t i = 0; i < path->count; i++) {
+        while (have_next && next_time <= path->time_us[i]) {
+            golden_x = next_x;
+            golden_y = next_y;
+            position = ftell(in);
+            have_next = fgets(line, sizeof(line), in) &&
+                        sscanf(line, "%llu %f %f", &next_time, &next_x, &next_y) == 3;
+        }
+        double error = fmax(fabs(path->x[i] - golden_x), fabs(path->y[i] - golden_y));
+        if (error > worst) {
+            worst = error;
+            worst_time = path->time_us[i];
+        }
+    }
+
+    // Skip whatever is left of this mode's lines
+    while (have_next) {
+        position = ftell(in);
+        have_next = fgets(line, sizeof(line), in) &&
+                    sscanf(line, "%llu %f %f", &next_time, &next_x, &next_y) == 3;
+    }
+    fseek(in, position, SEEK_SET);
+
+    // Stored values are rounded to 1/1000 px
+    if (ticks != path->count || worst > tolerance_px + 0.5 / GOLDEN_PRINT_SCALE) {
+        if (ticks == path->count) {
+            printf("FAIL %s %s: off by %.3f px at %.3f s\n", trace_name, mode->name, worst,
+                   (double)(worst_time - path->time_us[0]) / 1e6);
+        }
+        return false;
+    }
+    return true;
+}
+
+// NAME.mstrace -> NAME.golden
+static void Golden_GoldenPath(const GoldenTrace* trace, char* out, size_t size) {
+    size_t stem = strlen(trace->path) - strlen(".mstrace");
+    snprintf(out, size, "%.*s.golden", (int)stem, trace->path);
+}
+
+static bool Golden_CheckTrajectories(bool update, float tolerance_px) {
+    bool passed = true;
+    int compared = 0, matched = 0;
+
+    for (int t = 0; t < g_trace_count; t++) {
+        const GoldenTrace* trace = &g_traces[t];
+        char golden_path[4096];
+        Golden_GoldenPath(trace, golden_path, sizeof(golden_path));
+
+        FILE* file = fopen(golden_path, update ? "w" : "r");
+        if (!file) {
+            printf("FAIL %s: cannot %s %s\n", trace->name, update ? "write" : "read", golden_path);
+            passed = false;
+            continue;
+        }
+        if (update) {
+            fprintf(file,
+                    "# Golden trajectories for %s.mstrace; regenerate with make golden-update\n",
+                    trace->name);
+        } else {
+            char comment[512];
+            if (!fgets(comment, sizeof(comment), file)) comment[0] = '\0';
+        }
+
+        for (int m = 0; m < GOLDEN_MODES; m++) {
+            GoldenPath path;
+            if (!Golden_Replay(trace, &g_modes[m], &path)) {
+                printf("FAIL %s %s: replay failed\n", trace->name, g_modes[m].name);
+                passed = false;
+            } else if (update) {
+                Golden_WritePath(file, &g_modes[m], &path);
+            } else {
+                bool match = Golden_ComparePath(file, trace->name, &g_modes[m], &path,
+                                                tolerance_px);
+                passed &= match;
+                matched += match ? 1 : 0;
+                compared++;
+            }
+            GoldenPath_Free(&path);
+        }
+        fclose(file);
+    }
+
+    if (update) {
+        printf("golden: wrote %d trajectories for %d traces\n",
+               g_trace_count * GOLDEN_MODES, g_trace_count);
+    } else {
+        printf("golden: %d of %d trajectories match within %.3f px\n",
+               matched, compared, tolerance_px);
+    }
+    return passed;
+}
+
+// ---------------------------------------------------------------------------
+// Timing
+
+static uint64_t GoldenHost_NowMicros(void* context) {
+    return ((GoldenHost*)context)->now_us;
+}
+
+static bool GoldenHost_GetCursor(void* context, int* x, int* y) {
+    GoldenHost* host = (GoldenHost*)context;
+    *x = host->cursor_x;
+    *y = host->cursor_y;
+    return true;
+}
+
+static bool GoldenHost_Write(void* context, int x, int y) {
+    GoldenHost* host = (GoldenHost*)context;
+    host->cursor_x = x;
+    host->cursor_y = y;
+    return true;
+}
+
+static int Golden_CompareDouble(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Cost of reading the clock, subtracted from every timed interval
+static double Golden_ClockOverhead(void) {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        uint64_t start = ToolCommon_Nanos();
+        uint64_t end = ToolCommon_Nanos();
+        if (end - start < best) best = end - start;
+    }
+    return (double)best;
+}
+
+/**
+ * Drive one engine over a trace's packets on a virtual clock, timing each
+ * tick and each run of packets between ticks
+ * @return Ticks timed (latencies written to ticks_ns)
+ */
+static size_t Golden_TimeTrace(const GoldenTrace* trace, const GoldenMode* mode, double overhead,
+                               double* ticks_ns, size_t max_ticks, double* packet_ns_total) {
+    static GoldenHost host;
+    static SmoothStabilizer stabilizer;
+    const uint64_t period = UPDATE_INTERVAL_MS * 1000;
+
+    memset(&host, 0, sizeof(host));
+    host.now_us = trace->start_us;
+    host.cursor_x = (int)trace->start_x;
+    host.cursor_y = (int)trace->start_y;
+    host.platform.context = &host;
+    host.platform.now_us = GoldenHost_NowMicros;
+    host.platform.get_cursor = GoldenHost_GetCursor;
+    OutputSink_Initialize(&host.sink, GoldenHost_Write, &host);
+
+    StabilizerCore_Initialize(&stabilizer, &host.platform, NULL, &host.sink);
+    StabilizerCore_CopySettings(&stabilizer, &mode->settings);
+    stabilizer.enabled = true;
+    stabilizer.current_pos.x = trace->start_x;
+    stabilizer.current_pos.y = trace->start_y;
+    stabilizer.target_pos = stabilizer.current_pos;
+
+    uint64_t next_tick_us = host.now_us + period;
+    size_t ticks = 0;
+    double packet_ns = 0.0;
+    size_t i = 0;
+    while (i < trace->packet_count) {
+        while (next_tick_us <= trace->packets[i].time_us && ticks < max_ticks) {
+            host.now_us = next_tick_us;
+            uint64_t start = ToolCommon_Nanos();
+            StabilizerCore_UpdatePosition(&stabilizer);
+            double elapsed = (double)(ToolCommon_Nanos() - start) - overhead;
+            ticks_ns[ticks++] = elapsed > 0.0 ? elapsed : 0.0;
+            next_tick_us += period;
+        }
+
+        // Every packet up to the next tick in one timed run
+        uint64_t start = ToolCommon_Nanos();
+        for (; i < trace->packet_count && trace->packets[i].time_us < next_tick_us; i++) {
+            const GoldenPacket* packet = &trace->packets[i];
+            if (packet->time_us > host.now_us) host.now_us = packet->time_us;
+            if (packet->dx != 0 || packet->dy != 0) {
+                if (!StabilizerCore_IsEngaged(&stabilizer)) {
+                    host.cursor_x += packet->dx;
+                    host.cursor_y += packet->dy;
+                }
+                StabilizerCore_AddMouseDelta(&stabilizer, (float)packet->dx, (float)packet->dy,
+                                             host.now_us);
+            }
+            if (packet->pressed || packet->released) {
+                StabilizerCore_UpdateButtons(&stabilizer, packet->pressed, packet->released);
+            }
+        }
+        double elapsed = (double)(ToolCommon_Nanos() - start) - overhead;
+        packet_ns += elapsed > 0.0 ? elapsed : 0.0;
+    }
+
+    *packet_ns_total += packet_ns;
+    return ticks;
+}
+
+/**
+ * Best of several runs over the whole corpus for one mode
+ */
+static bool Golden_TimeMode(const GoldenMode* mode, int repeat, double overhead,
+                            GoldenTiming* timing) {
+    size_t max_ticks = 0, packets = 0;
+    for (int t = 0; t < g_trace_count; t++) {
+        const GoldenTrace* trace = &g_traces[t];
+        packets += trace->packet_count;
+        if (trace->packet_count > 0) {
+            uint64_t span_us = trace->packets[trace->packet_count - 1].time_us - trace->start_us;
+            max_ticks += (size_t)(span_us / (UPDATE_INTERVAL_MS * 1000)) + 1;
+        }
+    }
+    if (packets == 0) return false;
+
+    double* ticks_ns = malloc((max_ticks ? max_ticks : 1) * sizeof(double));
+    if (!ticks_ns) return false;
+
+    timing->packet_ns = INFINITY;
+    timing->step_p99_ns = INFINITY;
+    for (int run = 0; run < repeat; run++) {
+        size_t ticks = 0;
+        double packet_ns = 0.0;
+        for (int t = 0; t < g_trace_count; t++) {
+            ticks += Golden_TimeTrace(&g_traces[t], mode, overhead, ticks_ns + ticks,
+                                      max_ticks - ticks, &packet_ns);
+        }
+        packet_ns /= (double)packets;
+        if (packet_ns < timing->packet_ns) timing->packet_ns = packet_ns;
+
+        if (ticks > 0) {
+            qsort(ticks_ns, ticks, sizeof(double), Golden_CompareDouble);
+            double p99 = ticks_ns[(size_t)((double)(ticks - 1) * 0.99)];
+            if (p99 < timing->step_p99_ns) timing->step_p99_ns = p99;
+        }
+    }
+    if (!isfinite(timing->step_p99_ns)) timing->step_p99_ns = 0.0;
+
+    free(ticks_ns);
+    return true;
+}
+
+static bool Golden_ReadBaseline(const char* path, GoldenTiming* baseline, bool* present) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[256], name[64];
+    double packet_ns, step_p99_ns;
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%63s %lf %lf", name, &packet_ns, &step_p99_ns) != 3) continue;
+        for (int m = 0; m < GOLDEN_MODES; m++) {
+            if (strcmp(name, g_modes[m].name) == 0) {
+                baseline[m].packet_ns = packet_ns;
+                baseline[m].step_p99_ns = step_p99_ns;
+                present[m] = true;
+            }
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+static bool Golden_CheckPerformance(const char* directory, bool update, int repeat,
+                                    double max_ratio) {
+    char baseline_path[4096];
+    snprintf(baseline_path, sizeof(baseline_path), "%s/baseline.txt", directory);
+
+    GoldenTiming baseline[GOLDEN_MODES];
+    bool present[GOLDEN_MODES] = {false};
+    if (!update && !Golden_ReadBaseline(baseline_path, baseline, present)) {
+        printf("golden: no %s, performance not checked (make golden-update writes one)\n",
+               baseline_path);
+        return true;
+    }
+
+    FILE* out = NULL;
+    if (update) {
+        out = fopen(baseline_path, "w");
+        if (!out) {
+            printf("FAIL cannot write %s\n", baseline_path);
+            return false;
+        }
+        fprintf(out, "# Performance baseline for make golden; machine specific, "
+                "regenerate with make golden-update\n");
+        fprintf(out, "# mode  ns/packet  p99 ns/tick\n");
+    }
+
+    int cpu = ToolCommon_PinToCpu(-1);
+    double overhead = Golden_ClockOverhead();
+    bool passed = true;
+    printf("%-14s %12s %12s %14s %14s\n", "mode", "ns/packet", "baseline", "p99 ns/tick",
+           "baseline");
+    for (int m = 0; m < GOLDEN_MODES; m++) {
+        GoldenTiming timing;
+        if (!Golden_TimeMode(&g_modes[m], repeat, overhead, &timing)) continue;
+
+        if (update) {
+            fprintf(out, "%s %.1f %.1f\n", g_modes[m].name, timing.packet_ns, timing.step_p99_ns);
+            printf("%-14s %12.1f %12s %14.1f %14s\n",
+                   g_modes[m].name, timing.packet_ns, "-", timing.step_p99_ns, "-");
+            continue;
+        }
+        if (!present[m]) {
+            printf("%-14s %12.1f %12s %14.1f %14s  (no baseline)\n",
+                   g_modes[m].name, timing.packet_ns, "-", timing.step_p99_ns, "-");
+            continue;
+        }
+
+        bool packet_ok = timing.packet_ns <= baseline[m].packet_ns * max_ratio + GOLDEN_SLACK_NS;
+        bool step_ok = timing.step_p99_ns <= baseline[m].step_p99_ns * max_ratio + GOLDEN_SLACK_NS;
+        printf("%-14s %12.1f %12.1f %14.1f %14.1f%s%s\n", g_modes[m].name,
+               timing.packet_ns, baseline[m].packet_ns, timing.step_p99_ns, baseline[m].step_p99_ns,
+               packet_ok ? "" : "  FAIL per-packet cost", step_ok ? "" : "  FAIL p99 step latency");
+        passed &= packet_ok && step_ok;
+    }
+    if (out) fclose(out);
+
+    printf("golden: timed on cpu %d, best of %d runs; limit %.2fx baseline + %.0f ns\n",
+           cpu, repeat, max_ratio, GOLDEN_SLACK_NS);
+    return passed;
+}
+
+// ---------------------------------------------------------------------------
+
+static void Golden_Usage(void) {
+    fprintf(stderr,
+            "Usage: golden [options] CORPUS_DIR\n"
+            "  --update             Rewrite the golden trajectories and the performance baseline\n"
+            "  --tolerance-px F     Largest allowed position difference (default 0.01)\n"
+            "  --max-ratio F        Largest allowed slowdown against the baseline (default 1.5)\n"
+            "  --repeat N           Timing runs per mode, best one counts (default 5)\n"
+            "  --no-perf            Check trajectories only\n"
+            "  --no-trajectories    Check performance only\n");
+}
+
+int main(int argc, char** argv) {
+    const char* directory = NULL;
+    bool update = false, check_perf = true, check_trajectories = true;
+    float tolerance_px = GOLDEN_DEFAULT_TOLERANCE_PX;
+    double max_ratio = GOLDEN_DEFAULT_MAX_RATIO;
+    int repeat = GOLDEN_DEFAULT_REPEAT;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--update") == 0) {
+            update = true;
+        } else if (strcmp(arg, "--no-perf") == 0) {
+            check_perf = false;
+        } else if (strcmp(arg, "--no-trajectories") == 0) {
+            check_trajectories = false;
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            Golden_Usage();
+            return 0;
+        } else if (arg[0] != '-') {
+            directory = arg;
+        } else if (!value) {
+            fprintf(stderr, "golden: %s needs a value\n", arg);
+            return 2;
+        } else if (strcmp(arg, "--tolerance-px") == 0) {
+            tolerance_px = strtof(value, NULL);
+            i++;
+        } else if (strcmp(arg, "--max-ratio") == 0) {
+            max_ratio = strtod(value, NULL);
+            i++;
+        } else if (strcmp(arg, "--repeat") == 0) {
+            repeat = atoi(value);
+            if (repeat < 1) repeat = 1;
+            i++;
+        } else {
+            fprintf(stderr, "golden: unknown option %s\n", arg);
+            Golden_Usage();
+            return 2;
+        }
+    }
+
+    if (!directory) {
+        Golden_Usage();
+        return 2;
+    }
+
+    Golden_InitializeModes();
+    if (!Golden_LoadCorpus(directory)) {
+        Golden_FreeCorpus();
+        return 1;
+    }
+
+    bool passed = true;
+    if (check_trajectories) passed &= Golden_CheckTrajectories(update, tolerance_px);
+    if (check_perf) passed &= Golden_CheckPerformance(directory, update, repeat, max_ratio);
+
+    Golden_FreeCorpus();
+    if (!passed) printf("golden: FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/**
+ * Logdecode - Render a Binary Log as Text
+ *
+ * Reads .mslog segments written with BinaryLog=1 and prints them in the
+ * layout of mouse_stabilizer.log: a banner per segment and one
+ * "[HH:MM:SS.mmm LEVEL] message" line per record. All printf formatting
+ * the application skipped at run time happens here.
+ *
+ * Usage: logdecode [--level NAME] [--utc] mouse_stabilizer.mslog...
+ * Build: make tools
+ */
+
+#include "include/core/binary_log.h"
+#include "tools/tool_common.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define FILETIME_UNIX_EPOCH 116444736000000000ULL     // 1970-01-01 in 100 ns ticks since 1601
+#define FILETIME_TICKS_PER_SECOND 10000000ULL
+
+static const char* const g_level_names[] = {"ERROR", "WARN ", "INFO ", "DEBUG", "TRACE"};
+
+static void LogDecode_Usage(void) {
+    fprintf(stderr, "Usage: logdecode [options] log.mslog...\n"
+            "  Segments are printed in the order given, e.g. mouse_stabilizer.2.mslog\n"
+            "  mouse_stabilizer.1.mslog mouse_stabilizer.mslog\n"
+            "  --level NAME   only records at or above error, warn, info, debug or trace "
+            "(default trace)\n"
+            "  --utc          print UTC instead of local time\n");
+}
+
+static bool LogDecode_ParseLevel(const char* name, LogLevel* level) {
+    static const char* const names[] = {"error", "warn", "info", "debug", "trace"};
+    for (int i = 0; i <= LOG_TRACE; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            *level = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Host times are Win32 FILETIMEs
+static bool LogDecode_Time(uint64_t filetime, bool utc, struct tm* out, unsigned* millis) {
+    if (filetime < FILETIME_UNIX_EPOCH) return false;
+    time_t seconds = (time_t)((filetime - FILETIME_UNIX_EPOCH) / FILETIME_TICKS_PER_SECOND);
+    struct tm* parts = utc ? gmtime(&seconds) : localtime(&seconds);
+    if (!parts) return false;
+
+    *out = *parts;
+    *millis = (unsigned)((filetime / 10000) % 1000);
+    return true;
+}
+
+// Print one log file; 0 on success, 1 if it cannot be read completely
+static int LogDecode_File(const char* path, LogLevel max_level, bool utc) {
+    ToolFile map;
+    if (!ToolCommon_MapFile(&map, path)) {
+        fprintf(stderr, "logdecode: cannot map %s\n", path);
+        return 1;
+    }
+
+    static BinaryLogReader reader;
+    static BinaryLogEntry entry;
+    if (!BinaryLog_Open(&reader, map.data, map.length)) {
+        fprintf(stderr, "logdecode: %s is not a binary log\n", path);
+        ToolCommon_UnmapFile(&map);
+        return 1;
+    }
+
+    uint64_t messages = 0;
+    while (BinaryLog_Next(&reader, &entry)) {
+        struct tm parts;
+        unsigned millis = 0;
+        bool has_time = LogDecode_Time(entry.time, utc, &parts, &millis);
+
+        if (entry.type == BINARY_LOG_ENTRY_SESSION) {
+            if (has_time) {
+                printf("\n=== Mouse Stabilizer Log: %04d-%02d-%02d %02d:%02d:%02d ===\n",
+                       parts.tm_year + 1900, parts.tm_mon + 1, parts.tm_mday, parts.tm_hour,
+                       parts.tm_min, parts.tm_sec);
+            } else {
+                printf("\n=== Mouse Stabilizer Log ===\n");
+            }
+            continue;
+        }
+
+        if (entry.level > max_level) continue;
+        const char* level = entry.level <= LOG_TRACE ? g_level_names[entry.level] : "UNKN ";
+        if (has_time) {
+            printf("[%02d:%02d:%02d.%03u %s] %s\n",
+                   parts.tm_hour, parts.tm_min, parts.tm_sec, millis, level, entry.text);
+        } else {
+            printf("[--:--:--.--- %s] %s\n", level, entry.text);
+        }
+        messages++;
+    }
+
+    bool corrupt = reader.corrupt;
+    size_t offset = reader.offset;
+    ToolCommon_UnmapFile(&map);
+
+    fflush(stdout);
+    fprintf(stderr, "logdecode: %s: %llu messages in %llu sessions\n",
+            path, (unsigned long long)messages, (unsigned long long)reader.sessions);
+    if (corrupt) {
+        fprintf(stderr, "logdecode: %s: stopped at byte %zu: truncated or malformed record\n",
+                path, offset);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    LogLevel max_level = LOG_TRACE;
+    bool utc = false;
+    int files = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            LogDecode_Usage();
+            return 0;
+        } else if (strcmp(arg, "--utc") == 0) {
+            utc = true;
+        } else if (strcmp(arg, "--level") == 0) {
+            if (i + 1 >= argc || !LogDecode_ParseLevel(argv[i + 1], &max_level)) {
+                fprintf(stderr, "logdecode: bad or missing value for --level\n");
+                return 2;
+            }
+            i++;
+        } else if (arg[0] != '-') {
+            argv[++files] = argv[i];
+        } else {
+            fprintf(stderr, "logdecode: unknown option %s\n", arg);
+            LogDecode_Usage();
+            return 2;
+        }
+    }
+
+    if (files == 0) {
+        LogDecode_Usage();
+        return 2;
+    }
+
+    int status = 0;
+    for (int i = 1; i <= files; i++) {
+        if (LogDecode_File(argv[i], max_level, utc) != 0) status = 1;
+    }
+    return status;
+}
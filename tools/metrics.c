@@ -0,0 +1,210 @@
+/**
+ * Metrics - Trajectory Quality Report for a Recorded Trace
+ *
+ * Replays a .mstrace through the engine with the given settings, keeps
+ * the per-tick target and output, and prints a compact report of lag,
+ * high-passed jitter, overshoot on reversals and corner rounding. The
+ * jitter power spectrum can be written as CSV.
+ *
+ * Usage: metrics [options] trace.mstrace
+ * Build: make tools
+ */
+
+#include "include/core/trace_replay.h"
+#include "include/core/trajectory_report.h"
+#include "tools/tool_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define METRICS_BATCH_RECORDS 65536
+
+typedef struct {
+    TrajectorySample* samples;
+    size_t count, capacity;
+    bool failed;
+} MetricsPath;
+
+static void Metrics_RecordTick(void* context, uint64_t time_us,
+                               const SmoothStabilizer* stabilizer) {
+    MetricsPath* path = (MetricsPath*)context;
+    if (path->failed) return;
+
+    if (path->count == path->capacity) {
+        size_t capacity = path->capacity ? path->capacity * 2 : 65536;
+        TrajectorySample* grown = realloc(path->samples, capacity * sizeof(TrajectorySample));
+        if (!grown) {
+            path->failed = true;
+            return;
+        }
+        path->samples = grown;
+        path->capacity = capacity;
+    }
+
+    TrajectorySample* sample = &path->samples[path->count++];
+    sample->time_us = time_us;
+    sample->target_x = stabilizer->target_pos.x;
+    sample->target_y = stabilizer->target_pos.y;
+    sample->output_x = stabilizer->current_pos.x;
+    sample->output_y = stabilizer->current_pos.y;
+    sample->engaged = StabilizerCore_IsEngaged(stabilizer);
+}
+
+static void Metrics_PrintReport(FILE* out, const char* name, const SmoothStabilizer* settings,
+                                const TrajectoryReportOptions* options,
+                                const TrajectoryReport* report) {
+    fprintf(out, "%s: %llu engaged ticks at %.1f Hz (follow %.2f, min %.1f px, ease %s, "
+            "dual %d, delay %u ms",
+            name, (unsigned long long)report->samples, report->sample_rate_hz,
+            settings->follow_strength,
+            settings->min_distance, ToolCommon_EaseName(settings->ease_type),
+            settings->dual_mode ? 1 : 0,
+            (unsigned)settings->delay_start_ms);
+    if (settings->drag_only) {
+        fprintf(out, ", drag-only %s", ToolCommon_DragButtonName(settings->drag_button));
+    }
+    fprintf(out, ")\n");
+    fprintf(out, "lag        mean %.2f px  p95 %.2f px  max %.2f px | "
+            "mean %.1f ms  p95 %.1f ms  max %.1f ms\n",
+            report->mean_lag_px, report->p95_lag_px, report->max_lag_px,
+            report->mean_lag_ms, report->p95_lag_ms, report->max_lag_ms);
+    if (report->spectrum_segments > 0) {
+        fprintf(out, "jitter     rms %.3f px above %.0f Hz, peak %.1f Hz, 8-12 Hz band %.4f px^2\n",
+                report->rms_jitter_px, options->highpass_hz, report->spectrum_peak_hz,
+                TrajectoryReport_BandPower(report, 8.0, 12.0));
+    } else {
+        fprintf(out, "jitter     rms %.3f px above %.0f Hz (runs too short for a spectrum)\n",
+                report->rms_jitter_px, options->highpass_hz);
+    }
+    fprintf(out, "overshoot  %llu reversals, mean %.2f px, max %.2f px\n",
+            (unsigned long long)report->reversals, report->mean_overshoot_px,
+            report->max_overshoot_px);
+    fprintf(out, "corners    %llu corners, mean error %.2f px, max %.2f px\n",
+            (unsigned long long)report->corners, report->mean_corner_error_px,
+            report->max_corner_error_px);
+}
+
+static bool Metrics_WriteSpectrum(const char* path, const TrajectoryReport* report) {
+    FILE* out = fopen(path, "w");
+    if (!out) return false;
+
+    fprintf(out, "hz,psd_px2_per_hz\n");
+    for (int k = 0; k < TRAJECTORY_SPECTRUM_BINS; k++) {
+        fprintf(out, "%.3f,%.6g\n", k * report->spectrum_bin_hz, report->spectrum[k]);
+    }
+    fclose(out);
+    return true;
+}
+
+static void Metrics_Usage(void) {
+    fprintf(stderr,
+            "Usage: metrics [options] trace.mstrace\n"
+            "Report:\n"
+            "  --highpass-hz F      Jitter high-pass cutoff (default 10)\n"
+            "  --max-lag-ms F       Search window for lag, overshoot and corners (default 1000)\n"
+            "  --reversal-px F      Swing back needed to count a reversal (default 5)\n"
+            "  --corner-deg F       Minimum turn for a corner (default 60)\n"
+            "  --corner-chord-px F  Path length each side of a corner (default 10)\n"
+            "  --spectrum FILE      Write the jitter power spectrum as CSV\n"
+            "Engine and replay:\n");
+    ToolCommon_PrintReplayUsage(stderr);
+}
+
+int main(int argc, char** argv) {
+    SmoothStabilizer settings;
+    TraceReplayOptions options;
+    TrajectoryReportOptions report_options;
+    const char* trace_path = NULL;
+    const char* spectrum_path = NULL;
+
+    StabilizerCore_Initialize(&settings, NULL, NULL, NULL);
+    TraceReplay_DefaultOptions(&options);
+    TrajectoryReport_DefaultOptions(&report_options);
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int consumed = ToolCommon_ParseReplayOption(arg, value, &settings, &options);
+
+        if (consumed < 0) {
+            fprintf(stderr, "metrics: bad or missing value for %s\n", arg);
+            return 2;
+        } else if (consumed > 0) {
+            i += consumed - 1;
+            continue;
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            Metrics_Usage();
+            return 0;
+        } else if (arg[0] != '-') {
+            trace_path = arg;
+            continue;
+        } else if (!value) {
+            fprintf(stderr, "metrics: %s needs a value\n", arg);
+            return 2;
+        } else if (strcmp(arg, "--highpass-hz") == 0) {
+            report_options.highpass_hz = strtof(value, NULL);
+        } else if (strcmp(arg, "--max-lag-ms") == 0) {
+            report_options.max_lag_ms = strtof(value, NULL);
+        } else if (strcmp(arg, "--reversal-px") == 0) {
+            report_options.reversal_px = strtof(value, NULL);
+        } else if (strcmp(arg, "--corner-deg") == 0) {
+            report_options.corner_angle_deg = strtof(value, NULL);
+        } else if (strcmp(arg, "--corner-chord-px") == 0) {
+            report_options.corner_chord_px = strtof(value, NULL);
+        } else if (strcmp(arg, "--spectrum") == 0) {
+            spectrum_path = value;
+        } else {
+            fprintf(stderr, "metrics: unknown option %s\n", arg);
+            Metrics_Usage();
+            return 2;
+        }
+        i++;
+    }
+
+    if (!trace_path) {
+        Metrics_Usage();
+        return 2;
+    }
+
+    ToolFile map;
+    if (!ToolCommon_MapFile(&map, trace_path)) {
+        fprintf(stderr, "metrics: cannot map %s\n", trace_path);
+        return 1;
+    }
+
+    static TraceReplay replay;
+    MetricsPath path = {NULL, 0, 0, false};
+    if (!TraceReplay_Open(&replay, map.data, map.length, &settings, &options, NULL, NULL)) {
+        fprintf(stderr, "metrics: %s is not an input trace\n", trace_path);
+        ToolCommon_UnmapFile(&map);
+        return 1;
+    }
+    replay.on_tick = Metrics_RecordTick;
+    replay.tick_context = &path;
+    while (TraceReplay_Step(&replay, METRICS_BATCH_RECORDS)) {}
+    ToolCommon_UnmapFile(&map);
+
+    if (path.failed) {
+        fprintf(stderr, "metrics: out of memory after %zu ticks\n", path.count);
+        free(path.samples);
+        return 1;
+    }
+
+    TrajectoryReport* report = malloc(sizeof(TrajectoryReport));
+    if (!report || !TrajectoryReport_Compute(path.samples, path.count, &report_options, report)) {
+        fprintf(stderr, "metrics: %s has no engaged movement to analyse\n", trace_path);
+        free(report);
+        free(path.samples);
+        return 1;
+    }
+
+    Metrics_PrintReport(stdout, trace_path, &settings, &report_options, report);
+    if (spectrum_path && !Metrics_WriteSpectrum(spectrum_path, report)) {
+        fprintf(stderr, "metrics: cannot write %s\n", spectrum_path);
+    }
+
+    free(report);
+    free(path.samples);
+    return 0;
+}
@@ -0,0 +1,269 @@
+/**
+ * Replay - Headless Trace Replay Tool
+ *
+ * Memory-maps a .mstrace input trace, runs it through the stabilizer core
+ * on a virtual clock and writes the resulting cursor trajectory. Needs no
+ * display and streams traces of any size: pages already replayed are
+ * released as the replay moves on. A .msidx seek index built once lets
+ * later runs start anywhere in the trace.
+ *
+ * Usage: replay [options] trace.mstrace
+ * Build: make tools
+ */
+
+#include "include/core/trace_replay.h"
+#include "include/core/trace_index.h"
+#include "tools/tool_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_BATCH_RECORDS 65536
+#define REPLAY_RELEASE_BYTES (64u * 1024 * 1024)  // Drop replayed pages every 64 MB
+
+typedef struct {
+    FILE* out;
+    uint64_t end_us;            // Stop writing here (UINT64_MAX = never)
+} ReplayCsv;
+
+static void Replay_WriteCsv(void* context, uint64_t time_us, float x, float y) {
+    ReplayCsv* csv = (ReplayCsv*)context;
+    if (time_us > csv->end_us) return;
+    fprintf(csv->out, "%llu,%.3f,%.3f\n", (unsigned long long)time_us, x, y);
+}
+
+static bool Replay_WriteIndex(void* context, const uint8_t* data, size_t length) {
+    return fwrite(data, 1, length, (FILE*)context) == length;
+}
+
+static void Replay_Usage(void) {
+    fprintf(stderr, "Usage: replay [options] trace.mstrace\n"
+            "  -o FILE              Write the trajectory as CSV (time_us,x,y); - for stdout\n"
+            "Seeking:\n"
+            "  --build-index FILE   Replay once and write a seek index (.msidx), then exit\n"
+            "  --index-interval S   Seconds of trace between index checkpoints (default 10)\n"
+            "  --index FILE         Seek with an index; replays with the settings it was "
+            "built with\n"
+            "  --from S             Start at S seconds into the trace (needs --index)\n"
+            "  --to S               Stop at S seconds into the trace\n"
+            "  --strokes            List the strokes in the index, then exit\n");
+    ToolCommon_PrintReplayUsage(stderr);
+}
+
+static int Replay_BuildIndex(const ToolFile* map, const char* index_path,
+                             const SmoothStabilizer* settings, const TraceReplayOptions* options,
+                             double interval_s) {
+    FILE* out = fopen(index_path, "wb");
+    if (!out) {
+        fprintf(stderr, "replay: cannot create %s\n", index_path);
+        return 1;
+    }
+
+    TraceIndexSummary summary;
+    double started = ToolCommon_Seconds();
+    bool built = TraceIndex_Build(map->data, map->length, settings, options,
+                                  (uint32_t)(interval_s * 1000.0),
+                                  Replay_WriteIndex, out, &summary);
+    if (fclose(out) != 0) built = false;
+    if (!built) {
+        fprintf(stderr, "replay: cannot index (unreadable trace or write error)\n");
+        return 1;
+    }
+    fprintf(stderr, "%s: %llu checkpoints, %llu strokes, %.1f kB in %.3f s\n", index_path,
+            (unsigned long long)summary.checkpoints, (unsigned long long)summary.strokes,
+            (double)summary.bytes / 1024.0, ToolCommon_Seconds() - started);
+    return 0;
+}
+
+static void Replay_ListStrokes(TraceIndexReader* index, uint64_t start_us) {
+    TraceIndexEntry entry;
+    int count = 0;
+    printf("stroke,start_s,duration_s\n");
+    while (TraceIndex_Next(index, &entry)) {
+        if (entry.type != TRACE_INDEX_STROKE) continue;
+        printf("%d,%.3f,%.3f\n", ++count, (double)(entry.time_us - start_us) / 1e6,
+               (double)(entry.end_us - entry.time_us) / 1e6);
+    }
+}
+
+int main(int argc, char** argv) {
+    SmoothStabilizer settings;
+    TraceReplayOptions options;
+    const char* trace_path = NULL;
+    const char* output_path = NULL;
+    const char* build_index_path = NULL;
+    const char* index_path = NULL;
+    double index_interval_s = TRACE_INDEX_DEFAULT_INTERVAL_MS / 1000.0;
+    double from_s = -1.0, to_s = -1.0;
+    bool list_strokes = false;
+
+    StabilizerCore_Initialize(&settings, NULL, NULL, NULL);
+    TraceReplay_DefaultOptions(&options);
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int consumed = ToolCommon_ParseReplayOption(arg, value, &settings, &options);
+
+        if (consumed < 0) {
+            fprintf(stderr, "replay: bad or missing value for %s\n", arg);
+            return 2;
+        } else if (consumed > 0) {
+            i += consumed - 1;
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            Replay_Usage();
+            return 0;
+        } else if (arg[0] != '-' || strcmp(arg, "-") == 0) {
+            trace_path = arg;
+        } else if (strcmp(arg, "-o") == 0 && value) {
+            output_path = value;
+            i++;
+        } else if (strcmp(arg, "--build-index") == 0 && value) {
+            build_index_path = value;
+            i++;
+        } else if (strcmp(arg, "--index-interval") == 0 && value) {
+            index_interval_s = strtod(value, NULL);
+            i++;
+        } else if (strcmp(arg, "--index") == 0 && value) {
+            index_path = value;
+            i++;
+        } else if (strcmp(arg, "--from") == 0 && value) {
+            from_s = strtod(value, NULL);
+            i++;
+        } else if (strcmp(arg, "--to") == 0 && value) {
+            to_s = strtod(value, NULL);
+            i++;
+        } else if (strcmp(arg, "--strokes") == 0) {
+            list_strokes = true;
+        } else {
+            fprintf(stderr, "replay: unknown option %s\n", arg);
+            Replay_Usage();
+            return 2;
+        }
+    }
+
+    if (!trace_path || ((from_s >= 0.0 || list_strokes) && !index_path)) {
+        Replay_Usage();
+        return 2;
+    }
+
+    ToolFile map;
+    if (!ToolCommon_MapFile(&map, trace_path)) {
+        fprintf(stderr, "replay: cannot map %s\n", trace_path);
+        return 1;
+    }
+
+    if (build_index_path) {
+        int result = Replay_BuildIndex(&map, build_index_path, &settings, &options,
+                                       index_interval_s);
+        ToolCommon_UnmapFile(&map);
+        return result;
+    }
+
+    InputTraceReader header;
+    if (!InputTrace_OpenReader(&header, map.data, map.length)) {
+        fprintf(stderr, "replay: %s is not an input trace\n", trace_path);
+        ToolCommon_UnmapFile(&map);
+        return 1;
+    }
+
+    ToolFile index_map;
+    TraceIndexReader index;
+    if (index_path) {
+        if (!ToolCommon_MapFile(&index_map, index_path)) {
+            fprintf(stderr, "replay: cannot map %s\n", index_path);
+            ToolCommon_UnmapFile(&map);
+            return 1;
+        }
+        if (!TraceIndex_Open(&index, index_map.data, index_map.length) ||
+            !TraceIndex_Matches(&index, map.data, map.length)) {
+            fprintf(stderr, "replay: %s is not an index of %s (rebuild with --build-index)\n",
+                    index_path, trace_path);
+            ToolCommon_UnmapFile(&index_map);
+            ToolCommon_UnmapFile(&map);
+            return 1;
+        }
+        if (list_strokes) {
+            Replay_ListStrokes(&index, header.start_us);
+            ToolCommon_UnmapFile(&index_map);
+            ToolCommon_UnmapFile(&map);
+            return 0;
+        }
+    }
+
+    ReplayCsv csv = {NULL, UINT64_MAX};
+    uint64_t end_us = to_s >= 0.0 ? header.start_us + (uint64_t)(to_s * 1e6) : UINT64_MAX;
+    csv.end_us = end_us;
+    if (output_path) {
+        csv.out = strcmp(output_path, "-") == 0 ? stdout : fopen(output_path, "w");
+        if (!csv.out) {
+            fprintf(stderr, "replay: cannot create %s\n", output_path);
+            if (index_path) ToolCommon_UnmapFile(&index_map);
+            ToolCommon_UnmapFile(&map);
+            return 1;
+        }
+        fputs("time_us,x,y\n", csv.out);
+    }
+
+    static TraceReplay replay;
+    double started = ToolCommon_Seconds();
+    bool opened;
+    if (index_path) {
+        uint64_t from_us = header.start_us + (uint64_t)((from_s > 0.0 ? from_s : 0.0) * 1e6);
+        opened = TraceIndex_Seek(&index, &replay, map.data, map.length, from_us,
+                                 csv.out ? Replay_WriteCsv : NULL, &csv);
+        if (opened) {
+            fprintf(stderr, "seeked to %.3f s in %.3f s\n",
+                    (double)(replay.now_us - header.start_us) / 1e6,
+                    ToolCommon_Seconds() - started);
+        }
+    } else {
+        opened = TraceReplay_Open(&replay, map.data, map.length, &settings, &options,
+                                  csv.out ? Replay_WriteCsv : NULL, &csv);
+    }
+    if (!opened) {
+        fprintf(stderr, "replay: cannot replay %s\n", trace_path);
+        if (csv.out && csv.out != stdout) fclose(csv.out);
+        if (index_path) ToolCommon_UnmapFile(&index_map);
+        ToolCommon_UnmapFile(&map);
+        return 1;
+    }
+
+    uint64_t first_us = replay.now_us;
+    uint64_t first_packets = replay.stats.packets;
+    size_t released = 0;
+    while (replay.now_us < end_us && TraceReplay_Step(&replay, REPLAY_BATCH_RECORDS)) {
+        size_t offset = TraceReplay_Offset(&replay);
+        if (offset - released >= REPLAY_RELEASE_BYTES) {
+            ToolCommon_ReleaseFile(&map, offset);
+            released = offset;
+        }
+    }
+    double elapsed = ToolCommon_Seconds() - started;
+
+    const TraceReplayStats* stats = &replay.stats;
+    double span = (double)(stats->last_us - stats->first_us) / 1e6;
+    double replayed = (double)(replay.now_us - first_us) / 1e6;
+    uint64_t packets = stats->packets - first_packets;
+    if (elapsed <= 0.0) elapsed = 1e-9;
+    fprintf(stderr, "%s: %llu packets, %llu ticks (%u us period), %llu outputs "
+            "over %.2f s of input\n",
+            trace_path, (unsigned long long)stats->packets, (unsigned long long)stats->ticks,
+            replay.tick_period_us, (unsigned long long)stats->outputs, span);
+    fprintf(stderr, "replayed %.2f s in %.3f s: %.0f packets/s, %.0fx real time\n",
+            replayed, elapsed, (double)packets / elapsed, replayed / elapsed);
+    if (stats->dropped > 0) {
+        fprintf(stderr, "warning: recorder dropped %llu packets\n",
+                (unsigned long long)stats->dropped);
+    }
+    if (replay.reader.corrupt) {
+        fprintf(stderr, "warning: trace is truncated or corrupt at byte %llu\n",
+                (unsigned long long)replay.reader.offset);
+    }
+
+    if (csv.out && csv.out != stdout) fclose(csv.out);
+    if (index_path) ToolCommon_UnmapFile(&index_map);
+    ToolCommon_UnmapFile(&map);
+    return replay.reader.corrupt ? 1 : 0;
+}
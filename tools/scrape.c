@@ -0,0 +1,285 @@
+/**
+ * Scrape - Local Test Scraper for the Metrics Endpoint
+ *
+ * Fetches /metrics from the app's loopback endpoint the way a monitoring
+ * agent would and checks the answer: HTTP status, content type and every
+ * line of the exposition format. With --serve it plays the endpoint
+ * instead, answering with a page of synthetic figures, so scrapers and
+ * dashboards can be tried without the app (or on a machine without
+ * Windows).
+ *
+ * Usage: scrape --port N [--path /metrics] [--quiet]
+ *        scrape --serve N [--count N]
+ * Build: make tools
+ */
+
+#include "include/core/metrics_text.h"
+#include "tools/tool_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+typedef SOCKET ScrapeSocket;
+#define SCRAPE_INVALID_SOCKET INVALID_SOCKET
+#define Scrape_Close closesocket
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int ScrapeSocket;
+#define SCRAPE_INVALID_SOCKET (-1)
+#define Scrape_Close close
+#endif
+
+#define SCRAPE_RESPONSE_SIZE (64 * 1024)
+#define SCRAPE_REQUEST_SIZE 2048
+
+static char g_response[SCRAPE_RESPONSE_SIZE];
+static char g_page[SCRAPE_RESPONSE_SIZE];
+
+static void Scrape_Usage(void) {
+    fprintf(stderr, "Usage: scrape --port N [--path /metrics] [--quiet]\n"
+            "       scrape --serve N [--count N]\n"
+            "\n"
+            "  --port N    Fetch and check http://127.0.0.1:N/metrics "
+            "(MetricsPort in mouse_stabilizer.ini)\n"
+            "  --path P    Request another path\n"
+            "  --quiet     Print only the check result, not the page\n"
+            "  --serve N   Answer scrapes on 127.0.0.1:N with synthetic figures\n"
+            "  --count N   Stop serving after N requests (default: run until interrupted)\n");
+}
+
+static bool Scrape_Startup(void) {
+#ifdef _WIN32
+    WSADATA wsa;
+    return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+#else
+    return true;
+#endif
+}
+
+static struct sockaddr_in Scrape_Loopback(int port) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((unsigned short)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+static bool Scrape_SendAll(ScrapeSocket socket_handle, const char* data, size_t length) {
+    while (length > 0) {
+        int sent = (int)send(socket_handle, data, (int)length, 0);
+        if (sent <= 0) return false;
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return true;
+}
+
+static int Scrape_Fetch(int port, const char* path, bool quiet) {
+    ScrapeSocket client = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    struct sockaddr_in address = Scrape_Loopback(port);
+    if (client == SCRAPE_INVALID_SOCKET ||
+        connect(client, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        fprintf(stderr, "scrape: cannot connect to 127.0.0.1:%d; is MetricsPort set?\n", port);
+        if (client != SCRAPE_INVALID_SOCKET) Scrape_Close(client);
+        return 1;
+    }
+
+    char request[256];
+    int length = snprintf(request, sizeof(request),
+                          "GET %s HTTP/1.1\r\nHost: 127.0.0.1:%d\r\n"
+                          "Accept: text/plain\r\nConnection: close\r\n\r\n", path, port);
+    if (length <= 0 || (size_t)length >= sizeof(request) ||
+        !Scrape_SendAll(client, request, (size_t)length)) {
+        fprintf(stderr, "scrape: request failed\n");
+        Scrape_Close(client);
+        return 1;
+    }
+
+    size_t received = 0;
+    int chunk;
+    double start = ToolCommon_Seconds();
+    while (received + 1 < sizeof(g_response) &&
+           (chunk = (int)recv(client, g_response + received,
+                              (int)(sizeof(g_response) - 1 - received), 0)) > 0) {
+        received += (size_t)chunk;
+    }
+    double elapsed_ms = (ToolCommon_Seconds() - start) * 1000.0;
+    Scrape_Close(client);
+    g_response[received] = '\0';
+
+    char* body = strstr(g_response, "\r\n\r\n");
+    if (!body) {
+        fprintf(stderr, "scrape: incomplete response (%u bytes)\n", (unsigned int)received);
+        return 1;
+    }
+    *body = '\0';
+    body += 4;
+    size_t body_length = received - (size_t)(body - g_response);
+
+    int status = 0;
+    if (sscanf(g_response, "HTTP/1.%*d %d", &status) != 1 || status != 200) {
+        fprintf(stderr, "scrape: HTTP status %d\n%s\n", status, body);
+        return 1;
+    }
+    if (!strstr(g_response, "Content-Type: text/plain")) {
+        fprintf(stderr, "scrape: unexpected content type\n%s\n", g_response);
+        return 1;
+    }
+
+    char error[128];
+    int samples = MetricsText_Validate(body, body_length, error, sizeof(error));
+    if (!quiet) fwrite(body, 1, body_length, stdout);
+    if (samples < 0) {
+        fprintf(stderr, "scrape: malformed page, %s\n", error);
+        return 1;
+    }
+    fprintf(stderr, "scrape: %d samples, %u bytes in %.1f ms\n",
+            samples, (unsigned int)body_length, elapsed_ms);
+    return 0;
+}
+
+static void Scrape_Synthetic(MetricsSnapshot* snapshot, uint64_t scrape) {
+    static const char* const stages[] = {"Input", "Timer", "Filter", "Write", "Total"};
+    static const uint64_t p50_us[] = {12, 3900, 2, 35, 4000};
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->enabled = true;
+    snapshot->packets_per_s = 1000.0;
+    snapshot->steps_per_s = 125.0;
+    snapshot->packets_total = 15000 * (scrape + 1);
+    snapshot->ticks_total = 1875 * (scrape + 1);
+    snapshot->tick_mean_ms = 8.0;
+    snapshot->tick_max_ms = 15.6;
+    snapshot->tick_jitter_ms = 0.9;
+    snapshot->cursor_issued_per_s = 118.0;
+    snapshot->cursor_skipped_per_s = 7.0;
+    snapshot->hook_mean_us = 1.8;
+    snapshot->hook_max_us = 41.0;
+    snapshot->cpu_percent = 0.7;
+    snapshot->latency_count = 5;
+    for (int s = 0; s < 5; s++) {
+        LatencySummary* summary = &snapshot->latency[s].summary;
+        snapshot->latency[s].stage = stages[s];
+        summary->count = snapshot->packets_total;
+        summary->mean = (double)p50_us[s] * 1.1;
+        summary->p50 = p50_us[s];
+        summary->p99 = p50_us[s] * 2;
+        summary->p999 = p50_us[s] * 3;
+        summary->max = p50_us[s] * 5;
+    }
+}
+
+static int Scrape_Serve(int port, long count) {
+    ScrapeSocket server = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    struct sockaddr_in address = Scrape_Loopback(port);
+    int reuse = 1;
+    if (server != SCRAPE_INVALID_SOCKET) {
+        setsockopt(server, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+    }
+    if (server == SCRAPE_INVALID_SOCKET ||
+        bind(server, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(server, 4) != 0) {
+        fprintf(stderr, "scrape: cannot listen on 127.0.0.1:%d\n", port);
+        if (server != SCRAPE_INVALID_SOCKET) Scrape_Close(server);
+        return 1;
+    }
+    printf("Serving synthetic metrics on http://127.0.0.1:%d%s\n", port, METRICS_TEXT_PATH);
+    fflush(stdout);
+
+    char request[SCRAPE_REQUEST_SIZE];
+    for (long served = 0; count <= 0 || served < count; served++) {
+        ScrapeSocket client = accept(server, NULL, NULL);
+        if (client == SCRAPE_INVALID_SOCKET) continue;
+
+        size_t length = 0;
+        int chunk;
+        MetricsRequest kind = METRICS_REQUEST_INCOMPLETE;
+        while (kind == METRICS_REQUEST_INCOMPLETE && length < sizeof(request) &&
+               (chunk = (int)recv(client, request + length,
+                                  (int)(sizeof(request) - length), 0)) > 0) {
+            length += (size_t)chunk;
+            kind = MetricsText_ParseRequest(request, length);
+        }
+
+        const char* status = "400 Bad Request";
+        const char* body = "Bad request\n";
+        size_t body_length = strlen(body);
+        if (kind == METRICS_REQUEST_METRICS) {
+            MetricsSnapshot snapshot;
+            Scrape_Synthetic(&snapshot, (uint64_t)served);
+            MetricsText text;
+            MetricsText_Initialize(&text, g_page, sizeof(g_page));
+            MetricsText_FormatPage(&text, &snapshot);
+            status = "200 OK";
+            body = text.data;
+            body_length = text.length;
+        } else if (kind == METRICS_REQUEST_NOT_FOUND) {
+            status = "404 Not Found";
+            body = "Not found\n";
+            body_length = strlen(body);
+        }
+
+        char header[256];
+        int header_length = snprintf(header, sizeof(header),
+                                     "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n"
+                                     "Connection: close\r\n\r\n",
+                                     status, METRICS_TEXT_CONTENT_TYPE, (unsigned int)body_length);
+        if (Scrape_SendAll(client, header, (size_t)header_length)) {
+            Scrape_SendAll(client, body, body_length);
+        }
+        Scrape_Close(client);
+    }
+
+    Scrape_Close(server);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int port = 0;
+    int serve_port = 0;
+    long count = 0;
+    const char* path = METRICS_TEXT_PATH;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            Scrape_Usage();
+            return 0;
+        } else if (strcmp(arg, "--quiet") == 0) {
+            quiet = true;
+        } else if (strcmp(arg, "--port") == 0 || strcmp(arg, "--serve") == 0 ||
+                   strcmp(arg, "--count") == 0 || strcmp(arg, "--path") == 0) {
+            if (!value) {
+                fprintf(stderr, "scrape: missing value for %s\n", arg);
+                return 2;
+            }
+            if (strcmp(arg, "--port") == 0) port = atoi(value);
+            else if (strcmp(arg, "--serve") == 0) serve_port = atoi(value);
+            else if (strcmp(arg, "--count") == 0) count = atol(value);
+            else path = value;
+            i++;
+        } else {
+            fprintf(stderr, "scrape: unknown option %s\n", arg);
+            Scrape_Usage();
+            return 2;
+        }
+    }
+
+    if ((port <= 0) == (serve_port <= 0) || port > 65535 || serve_port > 65535) {
+        Scrape_Usage();
+        return 2;
+    }
+    if (!Scrape_Startup()) {
+        fprintf(stderr, "scrape: sockets unavailable\n");
+        return 1;
+    }
+    return serve_port > 0 ? Scrape_Serve(serve_port, count) : Scrape_Fetch(port, path, quiet);
+}
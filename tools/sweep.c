@@ -0,0 +1,757 @@
+/**
+ * Sweep - Parameter Search over Recorded Traces
+ *
+ * Replays every trace under every combination of a parameter grid on all
+ * cores, one StabilizerBatch lane per combination, scores each combination
+ * by lag, jitter and overshoot, prints the Pareto front and writes the best
+ * weighted setting as an ini file the app loads. A Nelder-Mead pass can
+ * refine the continuous parameters around the best grid point.
+ *
+ * Usage: sweep [options] TRACE_DIR_OR_FILE...
+ * Build: make tools
+ */
+
+#ifndef _WIN32
+#define _DEFAULT_SOURCE
+#endif
+
+#include "include/core/trace_replay.h"
+#include "include/core/trajectory_metrics.h"
+#include "tools/tool_common.h"
+
+#include <dirent.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SWEEP_MAX_VALUES 256
+#define SWEEP_MAX_TRACES 4096
+#define SWEEP_MAX_THREADS 256
+#define SWEEP_CACHE_LINE 64
+
+// One parameter axis: explicit values or an expanded A:B:STEP range
+typedef struct {
+    double values[SWEEP_MAX_VALUES];
+    int count;
+} SweepAxis;
+
+typedef struct {
+    float follow_strength;
+    float min_distance;
+    uint32_t delay_start_ms;
+    EaseType ease_type;
+    bool dual_mode;
+} SweepParams;
+
+typedef struct {
+    SweepParams params;
+    TrajectoryScore score;
+    double objective;
+    bool pareto;
+} SweepResult;
+
+typedef struct {
+    ToolFile files[SWEEP_MAX_TRACES];
+    const char* paths[SWEEP_MAX_TRACES];
+    int count;
+} SweepCorpus;
+
+// Job queue owned by one worker; idle workers steal the back half. Each
+// queue starts a cache line of its own, so a worker taking jobs from its
+// queue does not contend with its neighbours' locks
+typedef struct {
+    pthread_mutex_t lock;
+    size_t begin, end;
+} __attribute__((aligned(SWEEP_CACHE_LINE))) SweepQueue;
+
+typedef void (*SweepJobFn)(void* context, size_t job);
+
+typedef struct {
+    SweepQueue queues[SWEEP_MAX_THREADS];
+    int thread_count;
+    SweepJobFn run;
+    void* context;
+} SweepPool;
+
+typedef struct {
+    SweepPool* pool;
+    int index;
+} SweepWorker;
+
+// Shared by every job of one evaluation round; a job is one block of
+// combinations replayed over one trace
+typedef struct {
+    const SweepCorpus* corpus;
+    const SweepParams* params;      // One entry per combination
+    size_t count;                   // Combinations
+    int block_lanes;                // Combinations per job
+    TrajectoryMetrics* metrics;     // combinations x traces
+    TraceReplayOptions options;
+} SweepRound;
+
+// Per-job view of the metrics of one block on one trace
+typedef struct {
+    TrajectoryMetrics* first;       // First lane's accumulator
+    size_t stride;                  // Distance between lanes (the trace count)
+} SweepBlock;
+
+static SweepPool g_pool;
+static bool g_force_isa = false;
+static StabilizerBatchIsa g_isa;
+static double g_weights[3] = {1.0, 20.0, 5.0};  // Lag, jitter, overshoot
+
+// ---------------------------------------------------------------------------
+// Work-stealing pool
+
+static bool SweepPool_Take(SweepPool* pool, int self, size_t* job) {
+    SweepQueue* own = &pool->queues[self];
+
+    pthread_mutex_lock(&own->lock);
+    if (own->begin < own->end) {
+        *job = own->begin++;
+        pthread_mutex_unlock(&own->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    for (int step = 1; step < pool->thread_count; step++) {
+        SweepQueue* victim = &pool->queues[(self + step) % pool->thread_count];
+        size_t begin = 0, end = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        size_t remaining = victim->end - victim->begin;
+        if (remaining > 0) {
+            size_t take = (remaining + 1) / 2;
+            end = victim->end;
+            begin = end - take;
+            victim->end = begin;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (end > begin) {
+            *job = begin;
+            pthread_mutex_lock(&own->lock);
+            own->begin = begin + 1;
+            own->end = end;
+            pthread_mutex_unlock(&own->lock);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void* SweepPool_Worker(void* argument) {
+    SweepWorker* worker = (SweepWorker*)argument;
+    size_t job;
+    while (SweepPool_Take(worker->pool, worker->index, &job)) {
+        worker->pool->run(worker->pool->context, job);
+    }
+    return NULL;
+}
+
+static void SweepPool_Run(SweepPool* pool, size_t jobs, SweepJobFn run, void* context) {
+    pthread_t threads[SWEEP_MAX_THREADS];
+    SweepWorker workers[SWEEP_MAX_THREADS];
+    int count = pool->thread_count;
+
+    pool->run = run;
+    pool->context = context;
+    for (int i = 0; i < count; i++) {
+        pool->queues[i].begin = jobs * (size_t)i / (size_t)count;
+        pool->queues[i].end = jobs * (size_t)(i + 1) / (size_t)count;
+    }
+
+    for (int i = 1; i < count; i++) {
+        workers[i].pool = pool;
+        workers[i].index = i;
+        pthread_create(&threads[i], NULL, SweepPool_Worker, &workers[i]);
+    }
+    workers[0].pool = pool;
+    workers[0].index = 0;
+    SweepPool_Worker(&workers[0]);
+    for (int i = 1; i < count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Scoring
+
+static void Sweep_ScoreTick(void* context, uint64_t time_us, const StabilizerBatch* batch) {
+    (void)time_us;
+    SweepBlock* block = (SweepBlock*)context;
+
+    for (int lane = 0; lane < batch->count; lane++) {
+        TrajectoryMetrics* metrics = block->first + (size_t)lane * block->stride;
+        // Only strokes the engine drives count; pass-through is the OS's business
+        if (!batch->engaged) {
+            TrajectoryMetrics_Break(metrics);
+        } else {
+            TrajectoryMetrics_AddSample(metrics, batch->target_x, batch->target_y,
+                                        batch->current_x[lane], batch->current_y[lane]);
+        }
+    }
+}
+
+// Snap to what the ini file can store and Settings_Load accepts, so the written preset
+// scores the same
+static void Sweep_Snap(SweepParams* params) {
+    SmoothStabilizer settings;
+    StabilizerCore_Initialize(&settings, NULL, NULL, NULL);
+    settings.follow_strength = params->follow_strength;
+    settings.min_distance = params->min_distance;
+    settings.delay_start_ms = params->delay_start_ms;
+    settings.ease_type = params->ease_type;
+    StabilizerCore_SnapSettings(&settings);
+    params->follow_strength = settings.follow_strength;
+    params->min_distance = settings.min_distance;
+    params->delay_start_ms = settings.delay_start_ms;
+    params->ease_type = settings.ease_type;
+}
+
+static void Sweep_RunJob(void* context, size_t job) {
+    SweepRound* round = (SweepRound*)context;
+    size_t traces = (size_t)round->corpus->count;
+    size_t trace = job % traces;
+    size_t first = job / traces * (size_t)round->block_lanes;
+    size_t lanes = round->count - first;
+    if (lanes > (size_t)round->block_lanes) lanes = (size_t)round->block_lanes;
+    const ToolFile* file = &round->corpus->files[trace];
+
+    StabilizerBatch batch;
+    StabilizerBatch_Initialize(&batch, (int)lanes, 0.0f, 0.0f);
+    if (g_force_isa) {
+        StabilizerBatch_SetIsa(&batch, g_isa);
+    }
+
+    SweepBlock block = {&round->metrics[first * traces + trace], traces};
+    for (size_t lane = 0; lane < lanes; lane++) {
+        const SweepParams* params = &round->params[first + lane];
+        SmoothStabilizer settings;
+        StabilizerCore_Initialize(&settings, NULL, NULL, NULL);
+        settings.follow_strength = params->follow_strength;
+        settings.min_distance = params->min_distance;
+        settings.delay_start_ms = params->delay_start_ms;
+        settings.ease_type = params->ease_type;
+        settings.dual_mode = params->dual_mode;
+        StabilizerBatch_SetLane(&batch, (int)lane, &settings);
+        TrajectoryMetrics_Reset(block.first + lane * traces);
+    }
+
+    TraceReplay_RunBatch(file->data, file->length, &batch, &round->options, Sweep_ScoreTick,
+                         &block, NULL);
+}
+
+static double Sweep_Objective(const TrajectoryScore* score) {
+    return g_weights[0] * score->mean_lag_px + g_weights[1] * score->rms_jitter_px +
+           g_weights[2] * score->max_overshoot_px;
+}
+
+/**
+ * Score a batch of parameter sets across the whole corpus
+ */
+static void Sweep_Evaluate(const SweepCorpus* corpus, const TraceReplayOptions* options,
+                           SweepResult* results, size_t count) {
+    SweepParams* params = malloc(sizeof(SweepParams) * count);
+    TrajectoryMetrics* metrics = malloc(sizeof(TrajectoryMetrics) * count * (size_t)corpus->count);
+    if (!params || !metrics) {
+        fprintf(stderr, "sweep: out of memory\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        params[i] = results[i].params;
+    }
+
+    // Enough blocks to keep every worker busy, each a whole number of AVX-512 vectors
+    size_t wanted = (size_t)g_pool.thread_count * 4;
+    size_t block_lanes = (count + wanted - 1) / wanted;
+    block_lanes = (block_lanes + 15) / 16 * 16;
+    if (block_lanes > STABILIZER_BATCH_MAX_LANES) block_lanes = STABILIZER_BATCH_MAX_LANES;
+    size_t blocks = (count + block_lanes - 1) / block_lanes;
+
+    SweepRound round = {corpus, params, count, (int)block_lanes, metrics, *options};
+    SweepPool_Run(&g_pool, blocks * (size_t)corpus->count, Sweep_RunJob, &round);
+
+    for (size_t i = 0; i < count; i++) {
+        TrajectoryMetrics total;
+        TrajectoryMetrics_Reset(&total);
+        for (int t = 0; t < corpus->count; t++) {
+            TrajectoryMetrics_Merge(&total, &metrics[i * (size_t)corpus->count + (size_t)t]);
+        }
+        TrajectoryMetrics_GetScore(&total, &results[i].score);
+        results[i].objective = Sweep_Objective(&results[i].score);
+    }
+
+    free(params);
+    free(metrics);
+}
+
+// ---------------------------------------------------------------------------
+// Nelder-Mead refinement of follow strength, min distance and delay
+
+#define SWEEP_DIMENSIONS 3
+
+// The ranges Settings_Load accepts, so the search never leaves what the app can load
+static const double g_lower[SWEEP_DIMENSIONS] = {
+    STABILIZER_FOLLOW_STRENGTH_MIN, STABILIZER_MIN_DISTANCE_MIN, 0.0
+};
+static const double g_upper[SWEEP_DIMENSIONS] = {
+    STABILIZER_FOLLOW_STRENGTH_MAX, STABILIZER_MIN_DISTANCE_MAX, STABILIZER_DELAY_START_MAX_MS
+};
+
+static SweepParams Sweep_FromVector(const double* v, const SweepParams* base) {
+    SweepParams params = *base;
+    double clamped[SWEEP_DIMENSIONS];
+    for (int d = 0; d < SWEEP_DIMENSIONS; d++) {
+        clamped[d] = fmin(fmax(v[d], 0.0), 1.0) * (g_upper[d] - g_lower[d]) + g_lower[d];
+    }
+    params.follow_strength = (float)clamped[0];
+    params.min_distance = (float)clamped[1];
+    params.delay_start_ms = (uint32_t)floor(clamped[2] + 0.5);
+    Sweep_Snap(&params);
+    return params;
+}
+
+static void Sweep_ToVector(const SweepParams* params, double* v) {
+    double raw[SWEEP_DIMENSIONS] = {
+        params->follow_strength, params->min_distance, (double)params->delay_start_ms
+    };
+    for (int d = 0; d < SWEEP_DIMENSIONS; d++) {
+        v[d] = (raw[d] - g_lower[d]) / (g_upper[d] - g_lower[d]);
+    }
+}
+
+static double Sweep_EvaluatePoint(const SweepCorpus* corpus, const TraceReplayOptions* options,
+                                  const double* v, const SweepParams* base, SweepResult* out) {
+    out->params = Sweep_FromVector(v, base);
+    Sweep_Evaluate(corpus, options, out, 1);
+    return out->objective;
+}
+
+static SweepResult Sweep_Refine(const SweepCorpus* corpus, const TraceReplayOptions* options,
+                                const SweepResult* start, int iterations) {
+    double simplex[SWEEP_DIMENSIONS + 1][SWEEP_DIMENSIONS];
+    SweepResult vertex[SWEEP_DIMENSIONS + 1];
+
+    // Initial simplex: the start point plus a 10% step along each axis, scored in parallel
+    Sweep_ToVector(&start->params, simplex[0]);
+    for (int i = 1; i <= SWEEP_DIMENSIONS; i++) {
+        memcpy(simplex[i], simplex[0], sizeof(simplex[0]));
+        simplex[i][i - 1] += simplex[i][i - 1] < 0.9 ? 0.1 : -0.1;
+    }
+    for (int i = 0; i <= SWEEP_DIMENSIONS; i++) {
+        vertex[i].params = Sweep_FromVector(simplex[i], &start->params);
+    }
+    Sweep_Evaluate(corpus, options, vertex, SWEEP_DIMENSIONS + 1);
+
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        // Order vertices best to worst
+        for (int i = 1; i <= SWEEP_DIMENSIONS; i++) {
+            for (int j = i; j > 0 && vertex[j].objective < vertex[j - 1].objective; j--) {
+                SweepResult r = vertex[j]; vertex[j] = vertex[j - 1]; vertex[j - 1] = r;
+                double v[SWEEP_DIMENSIONS];
+                memcpy(v, simplex[j], sizeof(v));
+                memcpy(simplex[j], simplex[j - 1], sizeof(v));
+                memcpy(simplex[j - 1], v, sizeof(v));
+            }
+        }
+
+        double centroid[SWEEP_DIMENSIONS] = {0};
+        for (int i = 0; i < SWEEP_DIMENSIONS; i++) {
+            for (int d = 0; d < SWEEP_DIMENSIONS; d++) {
+                centroid[d] += simplex[i][d] / SWEEP_DIMENSIONS;
+            }
+        }
+
+        const int worst = SWEEP_DIMENSIONS;
+        double reflected[SWEEP_DIMENSIONS], candidate[SWEEP_DIMENSIONS];
+        SweepResult reflected_result, candidate_result;
+        for (int d = 0; d < SWEEP_DIMENSIONS; d++) {
+            reflected[d] = centroid[d] + (centroid[d] - simplex[worst][d]);
+        }
+        double fr = Sweep_EvaluatePoint(corpus, options, reflected, &start->params,
+                                        &reflected_result);
+
+        if (fr < vertex[0].objective) {
+            for (int d = 0; d < SWEEP_DIMENSIONS; d++) {
+                candidate[d] = centroid[d] + 2.0 * (centroid[d] - simplex[worst][d]);
+            }
+            double fe = Sweep_EvaluatePoint(corpus, options, candidate, &start->params,
+                                            &candidate_result);
+            if (fe < fr) {
+                memcpy(simplex[worst], candidate, sizeof(candidate));
+                vertex[worst] = candidate_result;
+            } else {
+                memcpy(simplex[worst], reflected, sizeof(reflected));
+                vertex[worst] = reflected_result;
+            }
+        } else if (fr < vertex[worst - 1].objective) {
+            memcpy(simplex[worst], reflected, sizeof(reflected));
+            vertex[worst] = reflected_result;
+        } else {
+            for (int d = 0; d < SWEEP_DIMENSIONS; d++) {
+                candidate[d] = centroid[d] + 0.5 * (simplex[worst][d] - centroid[d]);
+            }
+            double fc = Sweep_EvaluatePoint(corpus, options, candidate, &start->params,
+                                            &candidate_result);
+            if (fc < vertex[worst].objective) {
+                memcpy(simplex[worst], candidate, sizeof(candidate));
+                vertex[worst] = candidate_result;
+            } else {
+                // Shrink towards the best vertex
+                for (int i = 1; i <= SWEEP_DIMENSIONS; i++) {
+                    for (int d = 0; d < SWEEP_DIMENSIONS; d++) {
+                        simplex[i][d] = simplex[0][d] + 0.5 * (simplex[i][d] - simplex[0][d]);
+                    }
+                    vertex[i].params = Sweep_FromVector(simplex[i], &start->params);
+                }
+                Sweep_Evaluate(corpus, options, &vertex[1], SWEEP_DIMENSIONS);
+            }
+        }
+    }
+
+    SweepResult best = vertex[0];
+    for (int i = 1; i <= SWEEP_DIMENSIONS; i++) {
+        if (vertex[i].objective < best.objective) best = vertex[i];
+    }
+    return best;
+}
+
+// ---------------------------------------------------------------------------
+// Output
+
+static int Sweep_CompareLag(const void* a, const void* b) {
+    const SweepResult* ra = (const SweepResult*)a;
+    const SweepResult* rb = (const SweepResult*)b;
+    if (ra->score.mean_lag_px != rb->score.mean_lag_px) {
+        return ra->score.mean_lag_px < rb->score.mean_lag_px ? -1 : 1;
+    }
+    return (ra->score.rms_jitter_px > rb->score.rms_jitter_px) -
+           (ra->score.rms_jitter_px < rb->score.rms_jitter_px);
+}
+
+// Non-dominated on (mean lag, RMS jitter, max overshoot); results must be sorted by lag
+static void Sweep_MarkPareto(SweepResult* results, size_t count) {
+    size_t* front = malloc(sizeof(size_t) * (count ? count : 1));
+    size_t front_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool dominated = false;
+        for (size_t f = 0; f < front_count && !dominated; f++) {
+            const TrajectoryScore* a = &results[front[f]].score;
+            const TrajectoryScore* b = &results[i].score;
+            dominated = a->rms_jitter_px <= b->rms_jitter_px &&
+                        a->max_overshoot_px <= b->max_overshoot_px;
+        }
+        results[i].pareto = !dominated;
+        if (!dominated) front[front_count++] = i;
+    }
+    free(front);
+}
+
+static void Sweep_PrintResult(FILE* out, const SweepResult* result) {
+    fprintf(out, "%6.2f %6.1f %6u %-7s %4d | %8.2f %8.2f %8.3f %8.3f | %9.3f\n",
+            result->params.follow_strength, result->params.min_distance,
+            (unsigned)result->params.delay_start_ms, ToolCommon_EaseName(result->params.ease_type),
+            result->params.dual_mode ? 1 : 0, result->score.mean_lag_px, result->score.max_lag_px,
+            result->score.rms_jitter_px, result->score.max_overshoot_px, result->objective);
+}
+
+// Same keys and fixed-point units as Settings_Save
+static bool Sweep_WriteIni(const char* path, const SweepResult* best) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    fprintf(file, "; Generated by sweep: mean lag %.2f px, RMS jitter %.3f px, "
+            "max overshoot %.3f px\n",
+            best->score.mean_lag_px, best->score.rms_jitter_px, best->score.max_overshoot_px);
+    fprintf(file, "[Settings]\n");
+    fprintf(file, "FollowStrength=%d\n",
+            (int)floorf(best->params.follow_strength * STABILIZER_INI_FOLLOW_SCALE + 0.5f));
+    fprintf(file, "MinDistance=%d\n",
+            (int)floorf(best->params.min_distance * STABILIZER_INI_DISTANCE_SCALE + 0.5f));
+    fprintf(file, "EaseType=%d\n", (int)best->params.ease_type);
+    fprintf(file, "DualMode=%d\n", best->params.dual_mode ? 1 : 0);
+    fprintf(file, "DelayStartMs=%u\n", (unsigned)best->params.delay_start_ms);
+    fclose(file);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Command line
+
+static bool Sweep_ParseAxis(const char* text, SweepAxis* axis) {
+    double a, b, step;
+    axis->count = 0;
+
+    if (sscanf(text, "%lf:%lf:%lf", &a, &b, &step) == 3) {
+        if (step <= 0.0 || b < a) return false;
+        for (int i = 0; a + step * i <= b + step * 1e-6 && axis->count < SWEEP_MAX_VALUES; i++) {
+            axis->values[axis->count++] = a + step * i;
+        }
+        return axis->count > 0;
+    }
+
+    const char* cursor = text;
+    while (*cursor && axis->count < SWEEP_MAX_VALUES) {
+        char* end;
+        axis->values[axis->count++] = strtod(cursor, &end);
+        if (end == cursor) return false;
+        cursor = (*end == ',') ? end + 1 : end;
+    }
+    return axis->count > 0;
+}
+
+static bool Sweep_ParseEaseList(const char* text, SweepAxis* axis) {
+    char buffer[128];
+    axis->count = 0;
+    strncpy(buffer, text, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    for (char* name = strtok(buffer, ",");
+         name && axis->count < SWEEP_MAX_VALUES;
+         name = strtok(NULL, ",")) {
+        EaseType ease;
+        if (!ToolCommon_ParseEase(name, &ease)) return false;
+        axis->values[axis->count++] = (double)ease;
+    }
+    return axis->count > 0;
+}
+
+static bool Sweep_HasSuffix(const char* name, const char* suffix) {
+    size_t length = strlen(name), suffix_length = strlen(suffix);
+    return length >= suffix_length && strcmp(name + length - suffix_length, suffix) == 0;
+}
+
+static void Sweep_AddTrace(SweepCorpus* corpus, const char* path) {
+    if (corpus->count >= SWEEP_MAX_TRACES) return;
+
+    ToolFile* file = &corpus->files[corpus->count];
+    InputTraceReader reader;
+    if (!ToolCommon_MapFile(file, path)) {
+        fprintf(stderr, "sweep: cannot map %s\n", path);
+        return;
+    }
+    if (!InputTrace_OpenReader(&reader, file->data, file->length)) {
+        fprintf(stderr, "sweep: %s is not an input trace\n", path);
+        ToolCommon_UnmapFile(file);
+        return;
+    }
+    corpus->paths[corpus->count++] = strdup(path);
+}
+
+static void Sweep_AddPath(SweepCorpus* corpus, const char* path) {
+    DIR* dir = opendir(path);
+    if (!dir) {
+        Sweep_AddTrace(corpus, path);
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!Sweep_HasSuffix(entry->d_name, ".mstrace")) continue;
+        char full[4096];
+        snprintf(full, sizeof(full), "%s/%s", path, entry->d_name);
+        Sweep_AddTrace(corpus, full);
+    }
+    closedir(dir);
+}
+
+static void Sweep_Usage(void) {
+    fprintf(stderr,
+            "Usage: sweep [options] TRACE_DIR_OR_FILE...\n"
+            "Axes take A:B:STEP or a comma list:\n"
+            "  --follow AXIS        Follow strength (default 0.05:0.5:0.05)\n"
+            "  --min-distance AXIS  Minimum distance in px (default 0.5,1,2)\n"
+            "  --delay-ms AXIS      Delay before following (default 0,50,150)\n"
+            "  --ease LIST          Ease types (default linear,in,out,inout)\n"
+            "  --dual AXIS          Dual mode 0/1 (default 0,1)\n"
+            "Values are rounded to the ini file's units and clamped to the ranges the app loads.\n"
+            "Search and output:\n"
+            "  --weights L,J,O      Objective weights for lag, jitter, overshoot (default 1,20,5)\n"
+            "  --refine N           Nelder-Mead iterations from the best grid point (default 0)\n"
+            "  --threads N          Worker threads (default: all cores)\n"
+            "  --isa NAME           Batch kernel: scalar, sse2, avx2 or avx512 (default: best)\n"
+            "  --windows-timer      Replay with the default 15.625 ms Windows timer\n"
+            "  --ini PATH           Write the best setting (default sweep.ini)\n"
+            "  --csv PATH           Write every scored combination\n");
+}
+
+int main(int argc, char** argv) {
+    static SweepCorpus corpus;
+    SweepAxis follow, min_distance, delay, ease, dual;
+    TraceReplayOptions options;
+    const char* ini_path = "sweep.ini";
+    const char* csv_path = NULL;
+    int refine = 0;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    Sweep_ParseAxis("0.05:0.5:0.05", &follow);
+    Sweep_ParseAxis("0.5,1,2", &min_distance);
+    Sweep_ParseAxis("0,50,150", &delay);
+    Sweep_ParseEaseList("linear,in,out,inout", &ease);
+    Sweep_ParseAxis("0,1", &dual);
+    TraceReplay_DefaultOptions(&options);
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = true;
+
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            Sweep_Usage();
+            return 0;
+        } else if (strcmp(arg, "--windows-timer") == 0) {
+            options.timer_resolution_us = TRACE_REPLAY_WINDOWS_TIMER_US;
+            continue;
+        } else if (arg[0] != '-') {
+            Sweep_AddPath(&corpus, arg);
+            continue;
+        } else if (!value) {
+            fprintf(stderr, "sweep: %s needs a value\n", arg);
+            return 2;
+        } else if (strcmp(arg, "--follow") == 0) {
+            ok = Sweep_ParseAxis(value, &follow);
+        } else if (strcmp(arg, "--min-distance") == 0) {
+            ok = Sweep_ParseAxis(value, &min_distance);
+        } else if (strcmp(arg, "--delay-ms") == 0) {
+            ok = Sweep_ParseAxis(value, &delay);
+        } else if (strcmp(arg, "--ease") == 0) {
+            ok = Sweep_ParseEaseList(value, &ease);
+        } else if (strcmp(arg, "--dual") == 0) {
+            ok = Sweep_ParseAxis(value, &dual);
+        } else if (strcmp(arg, "--weights") == 0) {
+            ok = sscanf(value, "%lf,%lf,%lf", &g_weights[0], &g_weights[1], &g_weights[2]) == 3;
+        } else if (strcmp(arg, "--refine") == 0) {
+            refine = atoi(value);
+        } else if (strcmp(arg, "--threads") == 0) {
+            threads = atol(value);
+        } else if (strcmp(arg, "--isa") == 0) {
+            ok = false;
+            for (int isa = STABILIZER_BATCH_SCALAR; isa <= STABILIZER_BATCH_AVX512 && !ok; isa++) {
+                if (strcmp(value, StabilizerBatch_IsaName((StabilizerBatchIsa)isa)) == 0) {
+                    g_isa = (StabilizerBatchIsa)isa;
+                    ok = g_force_isa = true;
+                }
+            }
+        } else if (strcmp(arg, "--ini") == 0) {
+            ini_path = value;
+        } else if (strcmp(arg, "--csv") == 0) {
+            csv_path = value;
+        } else {
+            fprintf(stderr, "sweep: unknown option %s\n", arg);
+            Sweep_Usage();
+            return 2;
+        }
+        if (!ok) {
+            fprintf(stderr, "sweep: bad value for %s: %s\n", arg, value);
+            return 2;
+        }
+        i++;
+    }
+
+    if (corpus.count == 0) {
+        fprintf(stderr, "sweep: no traces\n");
+        Sweep_Usage();
+        return 2;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > SWEEP_MAX_THREADS) threads = SWEEP_MAX_THREADS;
+    g_pool.thread_count = (int)threads;
+    for (int i = 0; i < g_pool.thread_count; i++) {
+        pthread_mutex_init(&g_pool.queues[i].lock, NULL);
+    }
+
+    size_t count = (size_t)follow.count * (size_t)min_distance.count * (size_t)delay.count *
+                   (size_t)ease.count * (size_t)dual.count;
+    SweepResult* results = calloc(count, sizeof(SweepResult));
+    if (!results) {
+        fprintf(stderr, "sweep: out of memory for %zu combinations\n", count);
+        return 1;
+    }
+
+    size_t n = 0;
+    for (int a = 0; a < follow.count; a++)
+    for (int b = 0; b < min_distance.count; b++)
+    for (int c = 0; c < delay.count; c++)
+    for (int d = 0; d < ease.count; d++)
+    for (int e = 0; e < dual.count; e++) {
+        SweepParams* params = &results[n++].params;
+        params->follow_strength = (float)follow.values[a];
+        params->min_distance = (float)min_distance.values[b];
+        params->delay_start_ms = (uint32_t)delay.values[c];
+        params->ease_type = (EaseType)(int)ease.values[d];
+        params->dual_mode = dual.values[e] != 0.0;
+        Sweep_Snap(params);
+    }
+
+    StabilizerBatchIsa isa = g_force_isa ? g_isa : StabilizerBatch_DetectIsa();
+    if (!StabilizerBatch_IsaSupported(isa)) {
+        fprintf(stderr, "sweep: %s is not supported here\n", StabilizerBatch_IsaName(isa));
+        return 2;
+    }
+    fprintf(stderr, "sweep: %zu combinations x %d traces on %d threads (%s)\n",
+            count, corpus.count, g_pool.thread_count, StabilizerBatch_IsaName(isa));
+    double started = ToolCommon_Seconds();
+    Sweep_Evaluate(&corpus, &options, results, count);
+    double elapsed = ToolCommon_Seconds() - started;
+    fprintf(stderr, "sweep: %zu replays in %.2f s (%.1f replays/s)\n",
+            count * (size_t)corpus.count, elapsed,
+            (double)(count * (size_t)corpus.count) / elapsed);
+
+    SweepResult best = results[0];
+    for (size_t i = 1; i < count; i++) {
+        if (results[i].objective < best.objective) best = results[i];
+    }
+    if (refine > 0) {
+        SweepResult refined = Sweep_Refine(&corpus, &options, &best, refine);
+        if (refined.objective < best.objective) best = refined;
+    }
+
+    qsort(results, count, sizeof(SweepResult), Sweep_CompareLag);
+    Sweep_MarkPareto(results, count);
+
+    printf("follow mindst  delay ease    dual |  lag avg  lag max   jitter overshoot "
+           "| objective\n");
+    for (size_t i = 0; i < count; i++) {
+        if (results[i].pareto) Sweep_PrintResult(stdout, &results[i]);
+    }
+    printf("best (weights %g,%g,%g):\n", g_weights[0], g_weights[1], g_weights[2]);
+    Sweep_PrintResult(stdout, &best);
+
+    if (csv_path) {
+        FILE* csv = fopen(csv_path, "w");
+        if (!csv) {
+            fprintf(stderr, "sweep: cannot create %s\n", csv_path);
+        } else {
+            fprintf(csv, "follow,min_distance,delay_ms,ease,dual,mean_lag_px,max_lag_px,"
+                         "rms_jitter_px,max_overshoot_px,objective,pareto\n");
+            for (size_t i = 0; i < count; i++) {
+                const SweepResult* r = &results[i];
+                fprintf(csv, "%.2f,%.1f,%u,%s,%d,%.4f,%.4f,%.5f,%.5f,%.5f,%d\n",
+                        r->params.follow_strength, r->params.min_distance,
+                        (unsigned)r->params.delay_start_ms,
+                        ToolCommon_EaseName(r->params.ease_type), r->params.dual_mode ? 1 : 0,
+                        r->score.mean_lag_px, r->score.max_lag_px, r->score.rms_jitter_px,
+                        r->score.max_overshoot_px, r->objective, r->pareto ? 1 : 0);
+            }
+            fclose(csv);
+        }
+    }
+
+    if (!Sweep_WriteIni(ini_path, &best)) {
+        fprintf(stderr, "sweep: cannot write %s\n", ini_path);
+        return 1;
+    }
+    fprintf(stderr, "sweep: wrote %s\n", ini_path);
+
+    free(results);
+    for (int i = 0; i < corpus.count; i++) {
+        ToolCommon_UnmapFile(&corpus.files[i]);
+        free((void*)corpus.paths[i]);
+    }
+    return 0;
+}
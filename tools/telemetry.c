@@ -0,0 +1,379 @@
+/**
+ * Telemetry - Shared Telemetry Test Reader and Writer
+ *
+ * Exercises the shared telemetry block (telemetry_block.h) from outside
+ * the app: watch follows the state and the sample ring as a painting tool
+ * would, set posts a settings command and waits for its status, and
+ * simulate publishes a synthetic stabilizer so readers can be developed
+ * without the app running (or on a machine without Windows).
+ *
+ * Usage: telemetry [--name NAME] watch [--csv] [--seconds N]
+ *        telemetry [--name NAME] set enabled|follow|min-distance|ease|delay-ms|dual VALUE
+ *        telemetry [--name NAME] simulate [--rate HZ] [--seconds N]
+ * Build: make tools
+ */
+
+#include "include/core/telemetry_block.h"
+#include "tools/tool_common.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define TELEMETRY_DEFAULT_NAME TELEMETRY_SECTION_NAME
+#else
+#define TELEMETRY_DEFAULT_NAME TELEMETRY_SHM_NAME
+#endif
+
+#define TELEMETRY_POLL_MS 100
+#define TELEMETRY_READ_BATCH 1024
+#define TELEMETRY_COMMAND_TIMEOUT_S 2.0
+#define TELEMETRY_SIM_TICK_US 1000
+#define TELEMETRY_SIM_RADIUS 200.0
+
+typedef struct {
+    const char* name;
+    TelemetryCommandType command;
+} TelemetryCommandName;
+
+static const TelemetryCommandName g_command_names[] = {
+    {"enabled", TELEMETRY_COMMAND_SET_ENABLED},
+    {"follow", TELEMETRY_COMMAND_SET_FOLLOW},
+    {"min-distance", TELEMETRY_COMMAND_SET_MIN_DISTANCE},
+    {"ease", TELEMETRY_COMMAND_SET_EASE},
+    {"delay-ms", TELEMETRY_COMMAND_SET_DELAY_MS},
+    {"dual", TELEMETRY_COMMAND_SET_DUAL}
+};
+#define TELEMETRY_COMMAND_NAME_COUNT ((int)(sizeof(g_command_names) / sizeof(g_command_names[0])))
+
+static void Telemetry_Usage(void) {
+    fprintf(stderr, "Usage: telemetry [--name NAME] watch [--csv] [--seconds N]\n"
+            "       telemetry [--name NAME] set "
+            "enabled|follow|min-distance|ease|delay-ms|dual VALUE\n"
+            "       telemetry [--name NAME] simulate [--rate HZ] [--seconds N]\n"
+            "\n"
+            "  watch      Print the published state once a second (or every sample as CSV)\n"
+            "  set        Send a settings command and wait for the writer's answer\n"
+            "  simulate   Publish a synthetic stabilizer that follows a circling target\n"
+            "  --name     Shared memory name (default %s)\n"
+            "  --seconds  Stop after N seconds (default: run until interrupted)\n"
+            "  --rate     Simulated input packets per second (default 1000)\n",
+            TELEMETRY_DEFAULT_NAME);
+}
+
+static const char* Telemetry_StatusName(TelemetryCommandStatus status) {
+    switch (status) {
+        case TELEMETRY_STATUS_OK: return "ok";
+        case TELEMETRY_STATUS_UNKNOWN_COMMAND: return "unknown command";
+        case TELEMETRY_STATUS_OUT_OF_RANGE: return "value out of range";
+    }
+    return "?";
+}
+
+static bool Telemetry_Open(ToolShared* shared, const char* name, TelemetryBlock** block) {
+    if (!ToolCommon_MapShared(shared, name, sizeof(TelemetryBlock), false)) {
+        fprintf(stderr, "telemetry: %s not found; is the writer running with SharedTelemetry=1?\n",
+                name);
+        return false;
+    }
+    *block = TelemetryBlock_Open(shared->data, shared->length);
+    if (!*block) {
+        fprintf(stderr, "telemetry: %s has an unknown layout (expected version %d)\n",
+                name, TELEMETRY_VERSION);
+        ToolCommon_UnmapShared(shared);
+        return false;
+    }
+    return true;
+}
+
+static int Telemetry_Watch(const char* name, bool csv, double seconds) {
+    ToolShared shared;
+    TelemetryBlock* block;
+    if (!Telemetry_Open(&shared, name, &block)) return 1;
+
+    static TelemetrySample samples[TELEMETRY_READ_BATCH];
+    uint64_t cursor = __atomic_load_n(&block->ring_head, __ATOMIC_ACQUIRE);
+    uint64_t lost = 0, packets = 0, ticks = 0, busy = 0;
+    double start = ToolCommon_Seconds();
+    double report = start + 1.0;
+
+    if (csv) printf("time_us,kind,target_x,target_y,output_x,output_y,flags,buttons\n");
+    for (;;) {
+        size_t count;
+        while ((count = TelemetryBlock_ReadSamples(block, &cursor, samples, TELEMETRY_READ_BATCH,
+                                                   &lost)) > 0) {
+            for (size_t i = 0; i < count; i++) {
+                const TelemetrySample* sample = &samples[i];
+                if (sample->kind == TELEMETRY_SAMPLE_PACKET) packets++;
+                else ticks++;
+                if (csv) {
+                    printf("%llu,%s,%.2f,%.2f,%.2f,%.2f,%u,%u\n",
+                           (unsigned long long)sample->time_us,
+                           sample->kind == TELEMETRY_SAMPLE_PACKET ? "packet" : "tick",
+                           sample->target_x, sample->target_y, sample->output_x, sample->output_y,
+                           (unsigned int)sample->flags, (unsigned int)sample->buttons);
+                }
+            }
+        }
+
+        double now = ToolCommon_Seconds();
+        if (!csv && now >= report) {
+            TelemetryState state;
+            if (TelemetryBlock_ReadState(block, &state)) {
+                float lag = hypotf(state.target_x - state.output_x,
+                                   state.target_y - state.output_y);
+                printf("target %7.1f,%7.1f  output %7.1f,%7.1f  lag %5.1f px  speed %6.0f px/s  "
+                       "accel %7.0f px/s^2  %s%s  follow %.2f  min %.1f  "
+                       "ease %u  delay %u ms  | %llu packets/s  %llu ticks/s  %llu lost\n",
+                       state.target_x, state.target_y, state.output_x, state.output_y, lag,
+                       state.speed, state.acceleration,
+                       (state.flags & TELEMETRY_FLAG_ENABLED) ? "on" : "off",
+                       (state.flags & TELEMETRY_FLAG_ENGAGED) ? " engaged" : "",
+                       state.follow_strength, state.min_distance, state.ease_type,
+                       state.delay_start_ms,
+                       (unsigned long long)packets, (unsigned long long)ticks,
+                       (unsigned long long)lost);
+            } else {
+                busy++;
+            }
+            fflush(stdout);
+            packets = ticks = 0;
+            report += 1.0;
+        }
+        if (seconds > 0.0 && now - start >= seconds) break;
+        ToolCommon_SleepMs(TELEMETRY_POLL_MS);
+    }
+
+    if (busy > 0) {
+        fprintf(stderr, "telemetry: %llu state reads gave up\n", (unsigned long long)busy);
+    }
+    ToolCommon_UnmapShared(&shared);
+    return 0;
+}
+
+static int Telemetry_Set(const char* name, const char* command_name, const char* value_text) {
+    TelemetryCommandType command = TELEMETRY_COMMAND_NONE;
+    for (int i = 0; i < TELEMETRY_COMMAND_NAME_COUNT; i++) {
+        if (strcmp(command_name, g_command_names[i].name) == 0) {
+            command = g_command_names[i].command;
+        }
+    }
+    char* end;
+    float value = strtof(value_text, &end);
+    if (command == TELEMETRY_COMMAND_NONE || end == value_text || *end != '\0') {
+        Telemetry_Usage();
+        return 2;
+    }
+
+    ToolShared shared;
+    TelemetryBlock* block;
+    if (!Telemetry_Open(&shared, name, &block)) return 1;
+
+    // Another client's command may still be pending; wait for the mailbox
+    uint32_t ticket = 0;
+    double deadline = ToolCommon_Seconds() + TELEMETRY_COMMAND_TIMEOUT_S;
+    bool sent;
+    while (!(sent = TelemetryBlock_SendCommand(block, command, value, &ticket)) &&
+           ToolCommon_Seconds() < deadline) {
+        ToolCommon_SleepMs(1);
+    }
+
+    TelemetryCommandStatus status = TELEMETRY_STATUS_OK;
+    bool done = false;
+    while (sent && !(done = TelemetryBlock_PollCommand(block, ticket, &status)) &&
+           ToolCommon_Seconds() < deadline) {
+        ToolCommon_SleepMs(1);
+    }
+    ToolCommon_UnmapShared(&shared);
+
+    if (!done) {
+        fprintf(stderr, "telemetry: no answer from the writer within %.0f s\n",
+                TELEMETRY_COMMAND_TIMEOUT_S);
+        return 1;
+    }
+    printf("%s %g: %s\n", command_name, value, Telemetry_StatusName(status));
+    return status == TELEMETRY_STATUS_OK ? 0 : 1;
+}
+
+// The synthetic writer's settings, with the app's ranges
+static TelemetryCommandStatus Telemetry_Apply(TelemetryState* state, TelemetryCommandType command,
+                                              float value) {
+    switch (command) {
+        case TELEMETRY_COMMAND_SET_ENABLED:
+        case TELEMETRY_COMMAND_SET_DUAL: {
+            if (value != 0.0f && value != 1.0f) return TELEMETRY_STATUS_OUT_OF_RANGE;
+            uint32_t flag = TELEMETRY_FLAG_DUAL;
+            if (command == TELEMETRY_COMMAND_SET_ENABLED) flag = TELEMETRY_FLAG_ENABLED;
+            state->flags = value != 0.0f ? (state->flags | flag) : (state->flags & ~flag);
+            return TELEMETRY_STATUS_OK;
+        }
+        case TELEMETRY_COMMAND_SET_FOLLOW:
+            if (!(value >= 0.05f && value <= 1.0f)) return TELEMETRY_STATUS_OUT_OF_RANGE;
+            state->follow_strength = value;
+            return TELEMETRY_STATUS_OK;
+        case TELEMETRY_COMMAND_SET_MIN_DISTANCE:
+            if (!(value >= 0.1f && value <= 5.0f)) return TELEMETRY_STATUS_OUT_OF_RANGE;
+            state->min_distance = value;
+            return TELEMETRY_STATUS_OK;
+        case TELEMETRY_COMMAND_SET_EASE:
+            if (!(value >= EASE_LINEAR && value <= EASE_IN_OUT) || value != (float)(int)value) {
+                return TELEMETRY_STATUS_OUT_OF_RANGE;
+            }
+            state->ease_type = (uint32_t)value;
+            return TELEMETRY_STATUS_OK;
+        case TELEMETRY_COMMAND_SET_DELAY_MS:
+            if (!(value >= 0.0f && value <= 1000.0f)) return TELEMETRY_STATUS_OUT_OF_RANGE;
+            state->delay_start_ms = (uint32_t)(value + 0.5f);
+            return TELEMETRY_STATUS_OK;
+        default:
+            return TELEMETRY_STATUS_UNKNOWN_COMMAND;
+    }
+}
+
+static void Telemetry_Push(TelemetryBlock* block, const TelemetryState* state,
+                           TelemetrySampleKind kind) {
+    TelemetrySample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.time_us = state->time_us;
+    sample.target_x = state->target_x;
+    sample.target_y = state->target_y;
+    sample.output_x = state->output_x;
+    sample.output_y = state->output_y;
+    sample.kind = (uint8_t)kind;
+    sample.flags = (uint8_t)state->flags;
+    TelemetryBlock_PushSample(block, &sample);
+}
+
+static int Telemetry_Simulate(const char* name, double rate_hz, double seconds) {
+    ToolShared shared;
+    if (!ToolCommon_MapShared(&shared, name, sizeof(TelemetryBlock), true)) {
+        fprintf(stderr, "telemetry: cannot create %s (is a writer already running?)\n", name);
+        return 1;
+    }
+    TelemetryBlock* block = (TelemetryBlock*)shared.data;
+    uint64_t start_us = ToolCommon_Nanos() / 1000;
+    TelemetryBlock_Initialize(block, 0, start_us);
+
+    TelemetryState state;
+    memset(&state, 0, sizeof(state));
+    state.flags = TELEMETRY_FLAG_ENABLED | TELEMETRY_FLAG_DUAL;
+    state.follow_strength = 0.3f;
+    state.min_distance = 0.5f;
+    state.ease_type = EASE_OUT;
+    state.output_x = state.target_x = (float)(960.0 + TELEMETRY_SIM_RADIUS);
+    state.output_y = state.target_y = 540.0f;
+
+    printf("Publishing %s: %.0f packets/s, ticks every %d us\n",
+           name, rate_hz, TELEMETRY_SIM_TICK_US);
+    fflush(stdout);
+
+    uint64_t packet_us = (uint64_t)(1e6 / rate_hz);
+    uint64_t next_packet = start_us;
+    uint64_t next_tick = start_us;
+    for (;;) {
+        uint64_t now = ToolCommon_Nanos() / 1000;
+
+        // Target circles the screen centre once every two seconds
+        while (next_packet <= now) {
+            double angle = (double)(next_packet - start_us) * 1e-6 * 3.14159265358979;
+            state.time_us = next_packet;
+            state.target_x = (float)(960.0 + TELEMETRY_SIM_RADIUS * cos(angle));
+            state.target_y = (float)(540.0 + TELEMETRY_SIM_RADIUS * sin(angle));
+            state.speed = (float)(TELEMETRY_SIM_RADIUS * 3.14159265358979);
+            state.acceleration = (float)(TELEMETRY_SIM_RADIUS * 3.14159265358979 *
+                                         3.14159265358979);
+            state.packets++;
+            Telemetry_Push(block, &state, TELEMETRY_SAMPLE_PACKET);
+            next_packet += packet_us;
+        }
+
+        if (next_tick <= now) {
+            float dx = state.target_x - state.output_x;
+            float dy = state.target_y - state.output_y;
+            bool engaged = (state.flags & TELEMETRY_FLAG_ENABLED) &&
+                           hypotf(dx, dy) > state.min_distance;
+            if (!(state.flags & TELEMETRY_FLAG_ENABLED)) {
+                state.output_x = state.target_x;
+                state.output_y = state.target_y;
+            } else if (engaged) {
+                state.output_x += dx * state.follow_strength;
+                state.output_y += dy * state.follow_strength;
+            }
+            state.flags &= ~TELEMETRY_FLAG_ENGAGED;
+            if (engaged) state.flags |= TELEMETRY_FLAG_ENGAGED;
+            state.time_us = now;
+            state.ticks++;
+            Telemetry_Push(block, &state, TELEMETRY_SAMPLE_TICK);
+
+            TelemetryCommandType command;
+            float value;
+            uint32_t ticket;
+            if (TelemetryBlock_TakeCommand(block, &command, &value, &ticket)) {
+                TelemetryCommandStatus status = Telemetry_Apply(&state, command, value);
+                TelemetryBlock_CompleteCommand(block, ticket, status);
+                printf("Command %d (%g): %s\n", (int)command, value, Telemetry_StatusName(status));
+                fflush(stdout);
+            }
+            TelemetryBlock_PublishState(block, &state);
+            next_tick = now + TELEMETRY_SIM_TICK_US;
+        }
+
+        if (seconds > 0.0 && (double)(now - start_us) * 1e-6 >= seconds) break;
+        ToolCommon_SleepMs(1);
+    }
+
+    ToolCommon_UnmapShared(&shared);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* name = TELEMETRY_DEFAULT_NAME;
+    const char* mode = NULL;
+    const char* operands[2] = {NULL, NULL};
+    int operand_count = 0;
+    bool csv = false;
+    double seconds = 0.0;
+    double rate_hz = 1000.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            Telemetry_Usage();
+            return 0;
+        } else if (strcmp(arg, "--csv") == 0) {
+            csv = true;
+        } else if (strcmp(arg, "--name") == 0 || strcmp(arg, "--seconds") == 0 ||
+                   strcmp(arg, "--rate") == 0) {
+            if (!value) {
+                fprintf(stderr, "telemetry: missing value for %s\n", arg);
+                return 2;
+            }
+            if (strcmp(arg, "--name") == 0) name = value;
+            else if (strcmp(arg, "--seconds") == 0) seconds = strtod(value, NULL);
+            else rate_hz = strtod(value, NULL);
+            i++;
+        } else if (!mode) {
+            mode = arg;
+        } else if (operand_count < 2) {
+            operands[operand_count++] = arg;
+        } else {
+            Telemetry_Usage();
+            return 2;
+        }
+    }
+
+    if (mode && strcmp(mode, "watch") == 0 && operand_count == 0) {
+        return Telemetry_Watch(name, csv, seconds);
+    }
+    if (mode && strcmp(mode, "set") == 0 && operand_count == 2) {
+        return Telemetry_Set(name, operands[0], operands[1]);
+    }
+    if (mode && strcmp(mode, "simulate") == 0 && operand_count == 0 && rate_hz > 0.0) {
+        return Telemetry_Simulate(name, rate_hz, seconds);
+    }
+    Telemetry_Usage();
+    return 2;
+}
@@ -0,0 +1,319 @@
+/**
+ * Tool Common - Shared Helpers for the Offline Tools
+ *
+ * File mapping and timing for POSIX and Windows, so every tool streams
+ * traces the same way on a Linux tuning box and on a developer desktop.
+ */
+
+#ifndef _WIN32
+#define _GNU_SOURCE  // sched_setaffinity
+#endif
+
+#include "tools/tool_common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+bool ToolCommon_MapFile(ToolFile* file, const char* path) {
+    memset(file, 0, sizeof(*file));
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!data) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+    file->file = handle;
+    file->mapping = mapping;
+    file->data = data;
+    file->length = (size_t)size.QuadPart;
+#else
+    file->fd = open(path, O_RDONLY);
+    if (file->fd < 0) return false;
+
+    struct stat info;
+    if (fstat(file->fd, &info) != 0 || info.st_size == 0) {
+        close(file->fd);
+        return false;
+    }
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file->fd, 0);
+    if (data == MAP_FAILED) {
+        close(file->fd);
+        return false;
+    }
+    madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+    file->data = data;
+    file->length = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+void ToolCommon_ReleaseFile(ToolFile* file, size_t offset) {
+#ifdef _WIN32
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    size_t page = (size_t)system.dwPageSize;
+#else
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+    if (offset > file->length) offset = file->length;
+    size_t end = offset / page * page;
+    if (end <= file->released) return;
+
+    void* start = (char*)file->data + file->released;
+#ifdef _WIN32
+    // Discard/OfferVirtualMemory only take private read-write pages; for a
+    // read-only file view, unlocking pages that were never locked is the
+    // documented way to drop them from the working set
+    VirtualUnlock(start, end - file->released);
+#else
+    madvise(start, end - file->released, MADV_DONTNEED);
+#endif
+    file->released = end;
+}
+
+void ToolCommon_UnmapFile(ToolFile* file) {
+    if (!file->data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(file->data);
+    CloseHandle((HANDLE)file->mapping);
+    CloseHandle((HANDLE)file->file);
+#else
+    munmap((void*)file->data, file->length);
+    close(file->fd);
+#endif
+    file->data = NULL;
+}
+
+bool ToolCommon_MapShared(ToolShared* shared, const char* name, size_t length, bool create) {
+    memset(shared, 0, sizeof(*shared));
+    shared->fd = -1;
+#ifdef _WIN32
+    HANDLE mapping;
+    if (create) {
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0,
+                                     (DWORD)length, name);
+        if (mapping && GetLastError() == ERROR_ALREADY_EXISTS) {
+            CloseHandle(mapping);
+            return false;
+        }
+    } else {
+        mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+    }
+    void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, length) : NULL;
+    if (!data) {
+        if (mapping) CloseHandle(mapping);
+        return false;
+    }
+    shared->mapping = mapping;
+#else
+    int fd = create ? shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600) : shm_open(name, O_RDWR, 0);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if ((create && ftruncate(fd, (off_t)length) != 0) || fstat(fd, &info) != 0 ||
+        (size_t)info.st_size < length) {
+        close(fd);
+        if (create) shm_unlink(name);
+        return false;
+    }
+    void* data = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        if (create) shm_unlink(name);
+        return false;
+    }
+    shared->fd = fd;
+    if (create) snprintf(shared->name, sizeof(shared->name), "%s", name);
+#endif
+    shared->data = data;
+    shared->length = length;
+    return true;
+}
+
+void ToolCommon_UnmapShared(ToolShared* shared) {
+    if (!shared->data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(shared->data);
+    CloseHandle((HANDLE)shared->mapping);
+#else
+    munmap(shared->data, shared->length);
+    close(shared->fd);
+    if (shared->name[0]) shm_unlink(shared->name);
+#endif
+    shared->data = NULL;
+}
+
+void ToolCommon_SleepMs(unsigned int ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec delay = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+#endif
+}
+
+double ToolCommon_Seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+uint64_t ToolCommon_Nanos(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
+
+int ToolCommon_PinToCpu(int cpu) {
+#ifdef _WIN32
+    if (cpu < 0) cpu = (int)GetCurrentProcessorNumber();
+    if (cpu >= 64 || !SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu)) return -1;
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+    return cpu;
+#else
+    if (cpu < 0) cpu = sched_getcpu();
+    if (cpu < 0) return -1;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? cpu : -1;
+#endif
+}
+
+bool ToolCommon_ParseEase(const char* name, EaseType* ease) {
+    if (strcmp(name, "linear") == 0) *ease = EASE_LINEAR;
+    else if (strcmp(name, "in") == 0) *ease = EASE_IN;
+    else if (strcmp(name, "out") == 0) *ease = EASE_OUT;
+    else if (strcmp(name, "inout") == 0) *ease = EASE_IN_OUT;
+    else return false;
+    return true;
+}
+
+bool ToolCommon_ParseDragButton(const char* name, DragButton* button) {
+    if (strcmp(name, "left") == 0) *button = DRAG_BUTTON_LEFT;
+    else if (strcmp(name, "right") == 0) *button = DRAG_BUTTON_RIGHT;
+    else if (strcmp(name, "middle") == 0) *button = DRAG_BUTTON_MIDDLE;
+    else if (strcmp(name, "any") == 0) *button = DRAG_BUTTON_ANY;
+    else return false;
+    return true;
+}
+
+int ToolCommon_ParseReplayOption(const char* arg, const char* value, SmoothStabilizer* settings,
+                                 TraceReplayOptions* options) {
+    if (strcmp(arg, "--windows-timer") == 0) {
+        options->timer_resolution_us = TRACE_REPLAY_WINDOWS_TIMER_US;
+        return 1;
+    }
+
+    static const char* const valued[] = {
+        "--interval-ms", "--timer-res-us", "--tail-ms", "--start",
+        "--follow", "--min-distance", "--ease", "--delay-ms", "--dual",
+        "--drag-only", "--drag-button"
+    };
+    bool known = false;
+    for (size_t i = 0; i < sizeof(valued) / sizeof(valued[0]); i++) {
+        if (strcmp(arg, valued[i]) == 0) known = true;
+    }
+    if (!known) return 0;
+    if (!value) return -1;
+
+    if (strcmp(arg, "--interval-ms") == 0) {
+        options->tick_interval_us = (uint32_t)(strtod(value, NULL) * 1000.0);
+    } else if (strcmp(arg, "--timer-res-us") == 0) {
+        options->timer_resolution_us = (uint32_t)strtoul(value, NULL, 10);
+    } else if (strcmp(arg, "--tail-ms") == 0) {
+        options->tail_ms = (uint32_t)strtoul(value, NULL, 10);
+    } else if (strcmp(arg, "--start") == 0) {
+        if (sscanf(value, "%f,%f", &options->start_x, &options->start_y) != 2) return -1;
+        options->has_start = true;
+    } else if (strcmp(arg, "--follow") == 0) {
+        settings->follow_strength = strtof(value, NULL);
+    } else if (strcmp(arg, "--min-distance") == 0) {
+        settings->min_distance = strtof(value, NULL);
+    } else if (strcmp(arg, "--ease") == 0) {
+        if (!ToolCommon_ParseEase(value, &settings->ease_type)) return -1;
+    } else if (strcmp(arg, "--delay-ms") == 0) {
+        settings->delay_start_ms = (uint32_t)strtoul(value, NULL, 10);
+    } else if (strcmp(arg, "--dual") == 0) {
+        settings->dual_mode = atoi(value) != 0;
+    } else if (strcmp(arg, "--drag-only") == 0) {
+        settings->drag_only = atoi(value) != 0;
+    } else if (strcmp(arg, "--drag-button") == 0) {
+        if (!ToolCommon_ParseDragButton(value, &settings->drag_button)) return -1;
+    }
+    return 2;
+}
+
+void ToolCommon_PrintReplayUsage(FILE* out) {
+    fprintf(out,
+            "  --interval-ms N      Engine timer period (default %d)\n"
+            "  --timer-res-us N     Round the period up to this timer granularity\n"
+            "  --windows-timer      Same as --timer-res-us %d (default SetTimer resolution)\n"
+            "  --tail-ms N          Keep ticking after the last packet (default %d)\n"
+            "  --start X,Y          Start position (default: first recorded output)\n"
+            "  --follow F           Follow strength (0.05-1.0)\n"
+            "  --min-distance F     Minimum distance to move\n"
+            "  --ease NAME          linear, in, out or inout\n"
+            "  --delay-ms N         Delay before following\n"
+            "  --dual 0|1           Velocity-adaptive following\n"
+            "  --drag-only 0|1      Smooth only while the drag button is held (recorded buttons)\n"
+            "  --drag-button NAME   left, right, middle or any (default left)\n",
+            UPDATE_INTERVAL_MS, TRACE_REPLAY_WINDOWS_TIMER_US, TRACE_REPLAY_DEFAULT_TAIL_MS);
+}
+
+const char* ToolCommon_EaseName(EaseType ease) {
+    switch (ease) {
+        case EASE_LINEAR: return "linear";
+        case EASE_IN: return "in";
+        case EASE_OUT: return "out";
+        case EASE_IN_OUT: return "inout";
+    }
+    return "unknown";
+}
+
+const char* ToolCommon_DragButtonName(DragButton button) {
+    switch (button) {
+        case DRAG_BUTTON_LEFT: return "left";
+        case DRAG_BUTTON_RIGHT: return "right";
+        case DRAG_BUTTON_MIDDLE: return "middle";
+        case DRAG_BUTTON_ANY: return "any";
+    }
+    return "unknown";
+}
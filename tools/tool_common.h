@@ -0,0 +1,106 @@
+#ifndef TOOL_COMMON_H
+#define TOOL_COMMON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "include/core/stabilizer_core.h"
+#include "include/core/trace_replay.h"
+
+// Helpers shared by the offline tools: read-only file mappings, a
+// monotonic clock and command-line parsing of engine parameters.
+
+typedef struct {
+    const void* data;
+    size_t length;
+    void* file;                 // Win32 file and mapping handles
+    void* mapping;
+    int fd;                     // POSIX descriptor
+    size_t released;            // Page-aligned prefix already handed back by ToolCommon_ReleaseFile
+} ToolFile;
+
+/**
+ * Map a whole file read-only for sequential access
+ * @return false if the file is missing, empty or cannot be mapped
+ */
+bool ToolCommon_MapFile(ToolFile* file, const char* path);
+
+/**
+ * Let the OS drop mapped pages below offset; they are never read again
+ * Only the pages since the previous call are released, so calling it as
+ * the read position advances costs the same at any depth into the file.
+ */
+void ToolCommon_ReleaseFile(ToolFile* file, size_t offset);
+
+void ToolCommon_UnmapFile(ToolFile* file);
+
+typedef struct {
+    void* data;
+    size_t length;
+    void* mapping;              // Win32 section handle
+    int fd;                     // POSIX shared memory descriptor
+    char name[64];              // POSIX object to unlink, if this side created it
+} ToolShared;
+
+/**
+ * Map a named shared memory region read-write
+ * @param name Win32 section or POSIX shm object name
+ * @param create true to create a new region (fails if it exists), false to open one
+ * @return false if the region is missing, exists already or cannot be mapped
+ */
+bool ToolCommon_MapShared(ToolShared* shared, const char* name, size_t length, bool create);
+
+/**
+ * Unmap the region; the creator also removes the name
+ */
+void ToolCommon_UnmapShared(ToolShared* shared);
+
+void ToolCommon_SleepMs(unsigned int ms);
+
+/**
+ * Monotonic wall clock in seconds
+ */
+double ToolCommon_Seconds(void);
+
+/**
+ * Monotonic clock in nanoseconds, for timing short loops
+ */
+uint64_t ToolCommon_Nanos(void);
+
+/**
+ * Pin the calling thread to one CPU (and raise its priority on Windows)
+ * @param cpu CPU index, or -1 for the CPU the thread is running on now
+ * @return The CPU pinned to, or -1 on failure
+ */
+int ToolCommon_PinToCpu(int cpu);
+
+/**
+ * Parse linear, in, out or inout
+ */
+bool ToolCommon_ParseEase(const char* name, EaseType* ease);
+
+const char* ToolCommon_EaseName(EaseType ease);
+
+/**
+ * Parse left, right, middle or any
+ */
+bool ToolCommon_ParseDragButton(const char* name, DragButton* button);
+
+const char* ToolCommon_DragButtonName(DragButton button);
+
+/**
+ * Parse one engine or replay option (--follow, --ease, --windows-timer, ...)
+ * @param value The next argument, may be NULL
+ * @return Arguments consumed (1 or 2), 0 if arg is not such an option, -1 on a bad value
+ */
+int ToolCommon_ParseReplayOption(const char* arg, const char* value, SmoothStabilizer* settings,
+                                 TraceReplayOptions* options);
+
+/**
+ * Describe the options ToolCommon_ParseReplayOption accepts
+ */
+void ToolCommon_PrintReplayUsage(FILE* out);
+
+#endif // TOOL_COMMON_H
@@ -0,0 +1,391 @@
+/**
+ * Trace Index - Checkpoints and Stroke Table for Seeking in a Trace
+ *
+ * Builds the .msidx companion of an input trace in one replay: every
+ * interval of virtual time the whole replay (decoder position, virtual
+ * host and engine snapshot) is written as a checkpoint, and every engaged
+ * stretch as a stroke. Seeking resumes from the nearest checkpoint, so a
+ * point deep in a long session replays in the time of one interval.
+ */
+
+#include "include/core/trace_index.h"
+
+#include <string.h>
+
+#define TRACE_INDEX_FINGERPRINT_SPAN 65536  // Bytes hashed at each end of the trace
+#define TRACE_INDEX_RECORD_HEADER_SIZE 5
+
+// Collects strokes from the tick hook while the build replays
+typedef struct {
+    TraceIndexWriteFn write;
+    void* context;
+    bool engaged;
+    uint64_t stroke_start_us;
+    uint64_t last_tick_us;
+    TraceIndexSummary summary;
+    bool failed;
+} TraceIndexBuilder;
+
+typedef struct {
+    const uint8_t* data;
+    size_t length, offset;
+    bool underflow;
+} TraceIndexCursor;
+
+static size_t TraceIndex_Put(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+    return (size_t)bytes;
+}
+
+static size_t TraceIndex_PutFloat(uint8_t* out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return TraceIndex_Put(out, bits, 4);
+}
+
+static uint64_t TraceIndex_Get(TraceIndexCursor* cursor, int bytes) {
+    if (cursor->offset + (size_t)bytes > cursor->length) {
+        cursor->underflow = true;
+        return 0;
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)cursor->data[cursor->offset++] << (8 * i);
+    }
+    return value;
+}
+
+static float TraceIndex_GetFloat(TraceIndexCursor* cursor) {
+    uint32_t bits = (uint32_t)TraceIndex_Get(cursor, 4);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint64_t TraceIndex_Hash(uint64_t hash, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+uint64_t TraceIndex_Fingerprint(const void* trace, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)trace;
+    uint8_t length_bytes[8];
+    TraceIndex_Put(length_bytes, length, 8);
+
+    // FNV-1a over the length and both ends; hashing all of an 8-hour trace
+    // would cost more than the seek it guards
+    uint64_t hash = TraceIndex_Hash(0xCBF29CE484222325ull, length_bytes, sizeof(length_bytes));
+    if (!bytes) return hash;
+    if (length <= 2 * TRACE_INDEX_FINGERPRINT_SPAN) return TraceIndex_Hash(hash, bytes, length);
+    hash = TraceIndex_Hash(hash, bytes, TRACE_INDEX_FINGERPRINT_SPAN);
+    return TraceIndex_Hash(hash, bytes + length - TRACE_INDEX_FINGERPRINT_SPAN,
+                           TRACE_INDEX_FINGERPRINT_SPAN);
+}
+
+static size_t TraceIndex_EncodeCheckpoint(uint8_t* out, const TraceReplayCheckpoint* checkpoint) {
+    const InputTraceState* state = &checkpoint->trace_state;
+    const TraceReplayStats* stats = &checkpoint->stats;
+    uint8_t* payload = out + TRACE_INDEX_RECORD_HEADER_SIZE;
+    size_t length = 0;
+
+    length += TraceIndex_Put(payload + length, checkpoint->offset, 8);
+    length += TraceIndex_Put(payload + length, state->packet_time_us, 8);
+    length += TraceIndex_Put(payload + length, (uint64_t)state->packet_interval_us, 8);
+    length += TraceIndex_Put(payload + length, state->output_time_us, 8);
+    length += TraceIndex_Put(payload + length, state->device, 8);
+    length += TraceIndex_Put(payload + length, (uint32_t)state->output_x, 4);
+    length += TraceIndex_Put(payload + length, (uint32_t)state->output_y, 4);
+    length += TraceIndex_Put(payload + length, checkpoint->now_us, 8);
+    length += TraceIndex_Put(payload + length, checkpoint->next_tick_us, 8);
+    length += TraceIndex_Put(payload + length, (uint32_t)checkpoint->cursor_x, 4);
+    length += TraceIndex_Put(payload + length, (uint32_t)checkpoint->cursor_y, 4);
+    length += TraceIndex_PutFloat(payload + length, checkpoint->last_x);
+    length += TraceIndex_PutFloat(payload + length, checkpoint->last_y);
+    length += TraceIndex_Put(payload + length, stats->packets, 8);
+    length += TraceIndex_Put(payload + length, stats->ticks, 8);
+    length += TraceIndex_Put(payload + length, stats->outputs, 8);
+    length += TraceIndex_Put(payload + length, stats->recorded_outputs, 8);
+    length += TraceIndex_Put(payload + length, stats->dropped, 8);
+    length += TraceIndex_Put(payload + length, stats->first_us, 8);
+    length += TraceIndex_Put(payload + length, stats->last_us, 8);
+    memcpy(payload + length, checkpoint->engine, checkpoint->engine_length);
+    length += checkpoint->engine_length;
+
+    out[0] = TRACE_INDEX_CHECKPOINT;
+    TraceIndex_Put(out + 1, length, 4);
+    return TRACE_INDEX_RECORD_HEADER_SIZE + length;
+}
+
+bool TraceIndex_LoadCheckpoint(const TraceIndexEntry* entry, TraceReplayCheckpoint* checkpoint) {
+    if (!entry || !checkpoint || entry->type != TRACE_INDEX_CHECKPOINT) return false;
+
+    TraceIndexCursor cursor = {entry->payload, entry->payload_length, 0, false};
+    InputTraceState* state = &checkpoint->trace_state;
+    TraceReplayStats* stats = &checkpoint->stats;
+
+    checkpoint->offset = TraceIndex_Get(&cursor, 8);
+    state->packet_time_us = TraceIndex_Get(&cursor, 8);
+    state->packet_interval_us = (int64_t)TraceIndex_Get(&cursor, 8);
+    state->output_time_us = TraceIndex_Get(&cursor, 8);
+    state->device = TraceIndex_Get(&cursor, 8);
+    state->output_x = (int32_t)TraceIndex_Get(&cursor, 4);
+    state->output_y = (int32_t)TraceIndex_Get(&cursor, 4);
+    checkpoint->now_us = TraceIndex_Get(&cursor, 8);
+    checkpoint->next_tick_us = TraceIndex_Get(&cursor, 8);
+    checkpoint->cursor_x = (int32_t)TraceIndex_Get(&cursor, 4);
+    checkpoint->cursor_y = (int32_t)TraceIndex_Get(&cursor, 4);
+    checkpoint->last_x = TraceIndex_GetFloat(&cursor);
+    checkpoint->last_y = TraceIndex_GetFloat(&cursor);
+    stats->packets = TraceIndex_Get(&cursor, 8);
+    stats->ticks = TraceIndex_Get(&cursor, 8);
+    stats->outputs = TraceIndex_Get(&cursor, 8);
+    stats->recorded_outputs = TraceIndex_Get(&cursor, 8);
+    stats->dropped = TraceIndex_Get(&cursor, 8);
+    stats->first_us = TraceIndex_Get(&cursor, 8);
+    stats->last_us = TraceIndex_Get(&cursor, 8);
+    if (cursor.underflow) return false;
+
+    size_t engine_length = cursor.length - cursor.offset;
+    if (engine_length > sizeof(checkpoint->engine)) return false;
+    memcpy(checkpoint->engine, cursor.data + cursor.offset, engine_length);
+    checkpoint->engine_length = (uint32_t)engine_length;
+    return true;
+}
+
+static void TraceIndexBuilder_Write(TraceIndexBuilder* builder, const uint8_t* data,
+                                    size_t length) {
+    if (builder->failed) return;
+    if (!builder->write(builder->context, data, length)) {
+        builder->failed = true;
+        return;
+    }
+    builder->summary.bytes += length;
+}
+
+static void TraceIndexBuilder_WriteStroke(TraceIndexBuilder* builder, uint64_t end_us) {
+    uint8_t record[TRACE_INDEX_RECORD_HEADER_SIZE + 16];
+    record[0] = TRACE_INDEX_STROKE;
+    TraceIndex_Put(record + 1, 16, 4);
+    TraceIndex_Put(record + 5, builder->stroke_start_us, 8);
+    TraceIndex_Put(record + 13, end_us, 8);
+    TraceIndexBuilder_Write(builder, record, sizeof(record));
+    builder->summary.strokes++;
+}
+
+static void TraceIndexBuilder_OnTick(void* context, uint64_t time_us,
+                                     const SmoothStabilizer* stabilizer) {
+    TraceIndexBuilder* builder = (TraceIndexBuilder*)context;
+    bool engaged = StabilizerCore_IsEngaged(stabilizer);
+
+    if (engaged && !builder->engaged) {
+        builder->stroke_start_us = time_us;
+    } else if (!engaged && builder->engaged) {
+        TraceIndexBuilder_WriteStroke(builder, time_us);
+    }
+    builder->engaged = engaged;
+    builder->last_tick_us = time_us;
+}
+
+static size_t TraceIndex_EncodeHeader(uint8_t* out, size_t trace_length, uint64_t fingerprint,
+                                      uint32_t interval_ms, const TraceReplayOptions* options,
+                                      uint32_t settings_length) {
+    size_t length = 0;
+    memcpy(out, TRACE_INDEX_MAGIC, 4);
+    length += 4;
+    length += TraceIndex_Put(out + length, TRACE_INDEX_VERSION, 2);
+    length += TraceIndex_Put(out + length, TRACE_INDEX_HEADER_SIZE, 2);
+    length += TraceIndex_Put(out + length, trace_length, 8);
+    length += TraceIndex_Put(out + length, fingerprint, 8);
+    length += TraceIndex_Put(out + length, interval_ms, 4);
+    length += TraceIndex_Put(out + length, options->tick_interval_us, 4);
+    length += TraceIndex_Put(out + length, options->timer_resolution_us, 4);
+    length += TraceIndex_Put(out + length, options->tail_ms, 4);
+    length += TraceIndex_Put(out + length, options->has_start, 1);
+    length += TraceIndex_PutFloat(out + length, options->start_x);
+    length += TraceIndex_PutFloat(out + length, options->start_y);
+    length += TraceIndex_Put(out + length, settings_length, 4);
+    return length;
+}
+
+bool TraceIndex_Build(const void* trace, size_t length, const SmoothStabilizer* settings,
+                      const TraceReplayOptions* options, uint32_t interval_ms,
+                      TraceIndexWriteFn write, void* context, TraceIndexSummary* summary) {
+    if (!write) return false;
+
+    TraceReplayOptions defaults;
+    if (!options) {
+        TraceReplay_DefaultOptions(&defaults);
+        options = &defaults;
+    }
+    if (interval_ms == 0) interval_ms = TRACE_INDEX_DEFAULT_INTERVAL_MS;
+
+    TraceReplay replay;
+    if (!TraceReplay_Open(&replay, trace, length, settings, options, NULL, NULL)) return false;
+
+    TraceIndexBuilder builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.write = write;
+    builder.context = context;
+    replay.on_tick = TraceIndexBuilder_OnTick;
+    replay.tick_context = &builder;
+
+    // Header, then the engine as opened: a seek before the first checkpoint starts from it
+    uint8_t record[TRACE_INDEX_MAX_RECORD_SIZE];
+    uint8_t engine[STABILIZER_STATE_MAX_SIZE];
+    size_t engine_length = StabilizerCore_SaveState(&replay.stabilizer, engine, sizeof(engine));
+    size_t header_length = TraceIndex_EncodeHeader(record, length,
+                                                   TraceIndex_Fingerprint(trace, length),
+                                                   interval_ms, options, (uint32_t)engine_length);
+    TraceIndexBuilder_Write(&builder, record, header_length);
+    TraceIndexBuilder_Write(&builder, engine, engine_length);
+
+    // One record per step, so checkpoints land exactly on record boundaries
+    TraceReplayCheckpoint checkpoint;
+    uint64_t interval_us = (uint64_t)interval_ms * 1000;
+    uint64_t next_checkpoint_us = replay.now_us + interval_us;
+    while (!builder.failed && TraceReplay_Step(&replay, 1)) {
+        if (replay.now_us < next_checkpoint_us) continue;
+        if (!TraceReplay_SaveCheckpoint(&replay, &checkpoint)) {
+            builder.failed = true;
+            break;
+        }
+        TraceIndexBuilder_Write(&builder, record, TraceIndex_EncodeCheckpoint(record, &checkpoint));
+        builder.summary.checkpoints++;
+        while (next_checkpoint_us <= replay.now_us) {
+            next_checkpoint_us += interval_us;
+        }
+    }
+    if (builder.engaged) {
+        TraceIndexBuilder_WriteStroke(&builder, builder.last_tick_us);
+    }
+
+    if (summary) *summary = builder.summary;
+    return !builder.failed;
+}
+
+bool TraceIndex_Open(TraceIndexReader* index, const void* data, size_t length) {
+    if (!index) return false;
+
+    memset(index, 0, sizeof(*index));
+    if (!data || length < TRACE_INDEX_HEADER_SIZE || memcmp(data, TRACE_INDEX_MAGIC, 4) != 0) {
+        return false;
+    }
+
+    TraceIndexCursor cursor = {(const uint8_t*)data, length, 4, false};
+    index->version = (uint16_t)TraceIndex_Get(&cursor, 2);
+    uint16_t header_size = (uint16_t)TraceIndex_Get(&cursor, 2);
+    if (index->version != TRACE_INDEX_VERSION || header_size < TRACE_INDEX_HEADER_SIZE ||
+        header_size > length) {
+        return false;
+    }
+
+    TraceReplay_DefaultOptions(&index->options);
+    index->trace_length = TraceIndex_Get(&cursor, 8);
+    index->trace_fingerprint = TraceIndex_Get(&cursor, 8);
+    index->interval_ms = (uint32_t)TraceIndex_Get(&cursor, 4);
+    index->options.tick_interval_us = (uint32_t)TraceIndex_Get(&cursor, 4);
+    index->options.timer_resolution_us = (uint32_t)TraceIndex_Get(&cursor, 4);
+    index->options.tail_ms = (uint32_t)TraceIndex_Get(&cursor, 4);
+    index->options.has_start = TraceIndex_Get(&cursor, 1) != 0;
+    index->options.start_x = TraceIndex_GetFloat(&cursor);
+    index->options.start_y = TraceIndex_GetFloat(&cursor);
+    index->settings_length = (uint32_t)TraceIndex_Get(&cursor, 4);
+    if (cursor.underflow || index->settings_length > length - header_size) return false;
+
+    index->data = (const uint8_t*)data;
+    index->length = length;
+    index->settings = index->data + header_size;
+    index->first_record = header_size + index->settings_length;
+    index->offset = index->first_record;
+    return true;
+}
+
+bool TraceIndex_Matches(const TraceIndexReader* index, const void* trace, size_t length) {
+    return index && index->data && index->trace_length == length &&
+           index->trace_fingerprint == TraceIndex_Fingerprint(trace, length);
+}
+
+bool TraceIndex_Next(TraceIndexReader* index, TraceIndexEntry* entry) {
+    if (!index || !entry || !index->data || index->offset >= index->length) return false;
+
+    TraceIndexCursor cursor = {index->data, index->length, index->offset, false};
+    uint8_t type = (uint8_t)TraceIndex_Get(&cursor, 1);
+    uint32_t payload_length = (uint32_t)TraceIndex_Get(&cursor, 4);
+    if (cursor.underflow || payload_length > index->length - cursor.offset) {
+        index->corrupt = true;
+        return false;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    entry->type = (TraceIndexEntryType)type;
+    entry->payload = index->data + cursor.offset;
+    entry->payload_length = payload_length;
+
+    // Both record kinds start with their time; STROKE adds its end
+    TraceIndexCursor payload = {entry->payload, payload_length, 0, false};
+    if (type == TRACE_INDEX_CHECKPOINT) {
+        payload.offset = 8 + 40;
+        entry->time_us = TraceIndex_Get(&payload, 8);
+    } else if (type == TRACE_INDEX_STROKE) {
+        entry->time_us = TraceIndex_Get(&payload, 8);
+        entry->end_us = TraceIndex_Get(&payload, 8);
+    }
+    if (payload.underflow) {
+        index->corrupt = true;
+        return false;
+    }
+
+    // Unknown record kinds from newer writers are returned for the caller to skip
+    index->offset = cursor.offset + payload_length;
+    return true;
+}
+
+bool TraceIndex_Seek(const TraceIndexReader* index, TraceReplay* replay, const void* trace,
+                     size_t length, uint64_t time_us, TraceReplayOutputFn output, void* context) {
+    if (!replay || !TraceIndex_Matches(index, trace, length)) return false;
+
+    // Latest checkpoint at or before the target; records are in time order
+    TraceIndexReader scan = *index;
+    scan.offset = scan.first_record;
+    TraceIndexEntry entry, best;
+    bool found = false;
+    while (TraceIndex_Next(&scan, &entry)) {
+        if (entry.type != TRACE_INDEX_CHECKPOINT) continue;
+        if (entry.time_us > time_us) break;
+        best = entry;
+        found = true;
+    }
+
+    if (found) {
+        TraceReplayCheckpoint checkpoint;
+        if (!TraceIndex_LoadCheckpoint(&best, &checkpoint) ||
+            !TraceReplay_Resume(replay, trace, length, &index->options, &checkpoint, NULL, NULL)) {
+            return false;
+        }
+    } else if (!TraceReplay_Open(replay, trace, length, NULL, &index->options, NULL, NULL) ||
+               !StabilizerCore_RestoreState(&replay->stabilizer, index->settings,
+                                            index->settings_length)) {
+        return false;
+    }
+
+    // Replay silently up to the first timed record at or after the target
+    for (;;) {
+        InputTraceReader peek = replay->reader;
+        InputTraceRecord record;
+        if (!InputTrace_Read(&peek, &record)) break;
+        if ((record.type == INPUT_TRACE_PACKET || record.type == INPUT_TRACE_OUTPUT) &&
+            record.time_us >= time_us) {
+            break;
+        }
+        TraceReplay_Step(replay, 1);
+    }
+
+    replay->output = output;
+    replay->output_context = context;
+    return true;
+}
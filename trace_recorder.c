@@ -0,0 +1,417 @@
+/**
+ * Trace Recorder - Raw Input Capture to Disk
+ *
+ * Encodes every raw input packet and the engine output on the message
+ * thread and hands full buffers to a low-priority writer thread. The input
+ * path never touches the disk and never allocates: it only encodes into
+ * the active half of a static double buffer.
+ *
+ * Independently of recording, every packet, output and tick also goes into
+ * an always-on flight recorder ring that can be dumped after the fact. A
+ * dump copies the ring on the message thread and leaves the file writing
+ * to a short-lived low-priority thread.
+ */
+
+#include "mouse_stabilizer.h"
+
+static uint8_t g_trace_buffers[2][TRACE_RECORDER_BUFFER_SIZE];
+static size_t g_trace_fill[2];
+static volatile LONG g_trace_pending[2];     // 1 while the writer thread owns a half
+static int g_trace_active = 0;                // Half being filled by the input thread
+
+static HANDLE g_trace_file = INVALID_HANDLE_VALUE;
+static HANDLE g_trace_thread = NULL;
+static HANDLE g_trace_wake = NULL;            // Auto-reset: a half is pending or stop requested
+static volatile LONG g_trace_stop = 0;
+static volatile LONG g_trace_write_errors = 0;
+
+static bool g_trace_recording = false;
+static InputTraceState g_trace_state;
+static uint32_t g_trace_unreported_drops = 0;  // Dropped since the last GAP record
+static TraceRecorderStats g_trace_stats;
+static char g_trace_path[MAX_PATH] = "";
+
+static FlightRecorder g_flight_recorder;
+static char g_flight_path[MAX_PATH] = "";
+
+// Owned by the dump thread while g_flight_busy is 1
+static FlightRecorder g_flight_snapshot;
+static uint64_t g_flight_now_us;
+static char g_flight_trace_path[MAX_PATH];
+static char g_flight_ticks_path[MAX_PATH];
+static char g_flight_replay[224];               // Replay options for the settings at dump time
+static HANDLE g_flight_thread = NULL;
+static volatile LONG g_flight_busy = 0;
+
+static bool TraceRecorder_WriteBuffer(const uint8_t* data, size_t length) {
+    DWORD written = 0;
+    if (length == 0) return true;
+    if (!WriteFile(g_trace_file, data, (DWORD)length, &written, NULL) || written != (DWORD)length) {
+        InterlockedIncrement(&g_trace_write_errors);
+        return false;
+    }
+    return true;
+}
+
+static DWORD WINAPI TraceRecorder_WriterThread(LPVOID parameter) {
+    (void)parameter;
+
+    for (;;) {
+        WaitForSingleObject(g_trace_wake, INFINITE);
+
+        // At most one half is pending at a time, so file order matches encode order
+        for (int i = 0; i < 2; i++) {
+            if (InterlockedCompareExchange(&g_trace_pending[i], 1, 1) == 1) {
+                TraceRecorder_WriteBuffer(g_trace_buffers[i], g_trace_fill[i]);
+                InterlockedExchange(&g_trace_pending[i], 0);
+            }
+        }
+
+        if (InterlockedCompareExchange(&g_trace_stop, 1, 1) == 1) break;
+    }
+    return 0;
+}
+
+/**
+ * Room for one more record in the active half
+ * Swaps halves when the active one is full; returns NULL (drop) if the
+ * writer still owns the other half.
+ */
+static uint8_t* TraceRecorder_Reserve(void) {
+    int active = g_trace_active;
+    if (g_trace_fill[active] + INPUT_TRACE_MAX_RECORD_SIZE * 2 > TRACE_RECORDER_BUFFER_SIZE) {
+        int next = 1 - active;
+        if (InterlockedCompareExchange(&g_trace_pending[next], 0, 0) != 0) {
+            return NULL;
+        }
+        InterlockedExchange(&g_trace_pending[active], 1);
+        SetEvent(g_trace_wake);
+        g_trace_active = active = next;
+        g_trace_fill[active] = 0;
+    }
+
+    // A GAP always fits next to the record thanks to the doubled margin above
+    if (g_trace_unreported_drops > 0) {
+        size_t length = InputTrace_EncodeGap(g_trace_buffers[active] + g_trace_fill[active],
+                                             g_trace_unreported_drops);
+        g_trace_fill[active] += length;
+        g_trace_stats.bytes += length;
+        g_trace_unreported_drops = 0;
+    }
+    return g_trace_buffers[active] + g_trace_fill[active];
+}
+
+static void TraceRecorder_Commit(size_t length) {
+    g_trace_fill[g_trace_active] += length;
+    g_trace_stats.bytes += length;
+}
+
+// <exe dir>\<prefix><local time><suffix>
+static void TraceRecorder_BuildPath(char* path, const char* prefix, const char* suffix) {
+    SYSTEMTIME now;
+    char name[96];
+
+    GetLocalTime(&now);
+    sprintf_s(name, sizeof(name), "%s%04u%02u%02u_%02u%02u%02u%s", prefix,
+              now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond, suffix);
+
+    GetModuleFileName(NULL, path, MAX_PATH);
+    char* last_slash = strrchr(path, '\\');
+    if (last_slash) {
+        strcpy_s(last_slash + 1, MAX_PATH - (last_slash + 1 - path), name);
+    } else {
+        strcpy_s(path, MAX_PATH, name);
+    }
+}
+
+bool TraceRecorder_Start(void) {
+    if (g_trace_recording) return false;
+
+    TraceRecorder_BuildPath(g_trace_path, "mouse_stabilizer_", ".mstrace");
+    g_trace_file = CreateFile(g_trace_path, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (g_trace_file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Failed to create trace file %s: error code %lu", g_trace_path, GetLastError());
+        return false;
+    }
+
+    g_trace_wake = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (!g_trace_wake) {
+        LOG_ERROR("Failed to create trace writer event: error code %lu", GetLastError());
+        CloseHandle(g_trace_file);
+        g_trace_file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    uint64_t start_us = Platform_NowMicros(PlatformWin32_Get());
+    memset(&g_trace_stats, 0, sizeof(g_trace_stats));
+    InputTrace_ResetState(&g_trace_state, start_us);
+    g_trace_pending[0] = 0;
+    g_trace_pending[1] = 0;
+    g_trace_active = 0;
+    g_trace_fill[0] = InputTrace_WriteHeader(g_trace_buffers[0], start_us);
+    g_trace_fill[1] = 0;
+    g_trace_stats.bytes = g_trace_fill[0];
+    g_trace_unreported_drops = 0;
+    g_trace_stop = 0;
+    g_trace_write_errors = 0;
+
+    g_trace_thread = CreateThread(NULL, 0, TraceRecorder_WriterThread, NULL, 0, NULL);
+    if (!g_trace_thread) {
+        LOG_ERROR("Failed to start trace writer thread: error code %lu", GetLastError());
+        CloseHandle(g_trace_wake);
+        CloseHandle(g_trace_file);
+        g_trace_wake = NULL;
+        g_trace_file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    SetThreadPriority(g_trace_thread, THREAD_PRIORITY_BELOW_NORMAL);
+
+    g_trace_recording = true;
+    LOG_INFO("Input recording started: %s", g_trace_path);
+    return true;
+}
+
+void TraceRecorder_Stop(void) {
+    if (!g_trace_recording) return;
+    g_trace_recording = false;
+
+    InterlockedExchange(&g_trace_stop, 1);
+    SetEvent(g_trace_wake);
+    WaitForSingleObject(g_trace_thread, INFINITE);
+    CloseHandle(g_trace_thread);
+    CloseHandle(g_trace_wake);
+    g_trace_thread = NULL;
+    g_trace_wake = NULL;
+
+    // The writer is gone; a half handed over just before the stop request may
+    // still be pending, then the active half and a trailing GAP go out here
+    int previous = 1 - g_trace_active;
+    if (g_trace_pending[previous]) {
+        TraceRecorder_WriteBuffer(g_trace_buffers[previous], g_trace_fill[previous]);
+        g_trace_pending[previous] = 0;
+    }
+    TraceRecorder_WriteBuffer(g_trace_buffers[g_trace_active], g_trace_fill[g_trace_active]);
+    g_trace_fill[g_trace_active] = 0;
+    if (g_trace_unreported_drops > 0) {
+        uint8_t gap[INPUT_TRACE_MAX_RECORD_SIZE];
+        size_t length = InputTrace_EncodeGap(gap, g_trace_unreported_drops);
+        TraceRecorder_WriteBuffer(gap, length);
+        g_trace_stats.bytes += length;
+        g_trace_unreported_drops = 0;
+    }
+
+    CloseHandle(g_trace_file);
+    g_trace_file = INVALID_HANDLE_VALUE;
+    g_trace_stats.write_errors = (uint64_t)g_trace_write_errors;
+
+    double bytes_per_packet = 0.0;
+    if (g_trace_stats.packets) {
+        bytes_per_packet = (double)g_trace_stats.bytes / (double)g_trace_stats.packets;
+    }
+    LOG_INFO("Input recording stopped: %llu packets, %llu outputs, %llu bytes "
+             "(%.2f bytes/packet), %llu dropped, %llu write errors",
+             (unsigned long long)g_trace_stats.packets, (unsigned long long)g_trace_stats.outputs,
+             (unsigned long long)g_trace_stats.bytes, bytes_per_packet,
+             (unsigned long long)g_trace_stats.dropped,
+             (unsigned long long)g_trace_stats.write_errors);
+}
+
+void TraceRecorder_Toggle(void) {
+    if (g_trace_recording) {
+        TraceRecorder_Stop();
+    } else {
+        TraceRecorder_Start();
+    }
+}
+
+bool TraceRecorder_IsRecording(void) {
+    return g_trace_recording;
+}
+
+void TraceRecorder_RecordPacket(uint64_t time_us, HANDLE device, LONG dx, LONG dy,
+                                unsigned int pressed, unsigned int released) {
+    FlightRecorder_RecordPacket(&g_flight_recorder, time_us, (uint64_t)(uintptr_t)device,
+                                (int32_t)dx, (int32_t)dy, pressed, released);
+    if (!g_trace_recording) return;
+
+    uint8_t* out = TraceRecorder_Reserve();
+    if (!out) {
+        g_trace_stats.dropped++;
+        g_trace_unreported_drops++;
+        return;
+    }
+
+    TraceRecorder_Commit(InputTrace_EncodePacket(&g_trace_state, out, time_us,
+                                                 (uint64_t)(uintptr_t)device,
+                                                 (int32_t)dx, (int32_t)dy, pressed, released));
+    g_trace_stats.packets++;
+}
+
+void TraceRecorder_RecordOutput(const SmoothStabilizer* stabilizer) {
+    if (!stabilizer) return;
+
+    FlightRecorder_RecordOutput(&g_flight_recorder, StabilizerCore_GetTimeMicros(stabilizer),
+                                stabilizer->current_pos.x, stabilizer->current_pos.y);
+    if (!g_trace_recording) return;
+
+    uint8_t* out = TraceRecorder_Reserve();
+    if (!out) return;  // Output is re-derived on replay; only packet loss is marked
+
+    size_t length = InputTrace_EncodeOutput(&g_trace_state, out,
+                                            StabilizerCore_GetTimeMicros(stabilizer),
+                                            stabilizer->current_pos.x, stabilizer->current_pos.y);
+    if (length > 0) {
+        TraceRecorder_Commit(length);
+        g_trace_stats.outputs++;
+    }
+}
+
+void TraceRecorder_RecordTick(const SmoothStabilizer* stabilizer, uint64_t start_us) {
+    if (!stabilizer) return;
+
+    uint64_t end_us = Platform_NowMicros(PlatformWin32_Get());
+    uint64_t duration = end_us > start_us ? end_us - start_us : 0;
+    FlightRecorder_RecordTick(&g_flight_recorder, start_us,
+                              duration > UINT32_MAX ? UINT32_MAX : (uint32_t)duration,
+                              StabilizerCore_IsEngaged(stabilizer),
+                              StabilizerCore_CalculateDistance(stabilizer->current_pos,
+                                                               stabilizer->target_pos));
+}
+
+static bool TraceRecorder_WriteFlight(void* context, const uint8_t* data, size_t length) {
+    DWORD written = 0;
+    return WriteFile((HANDLE)context, data, (DWORD)length, &written, NULL) &&
+           written == (DWORD)length;
+}
+
+static const char* TraceRecorder_EaseOption(EaseType ease) {
+    switch (ease) {
+        case EASE_LINEAR: return "linear";
+        case EASE_IN: return "in";
+        case EASE_OUT: return "out";
+        case EASE_IN_OUT: return "inout";
+    }
+    return "linear";
+}
+
+static const char* TraceRecorder_DragButtonOption(DragButton button) {
+    switch (button) {
+        case DRAG_BUTTON_LEFT: return "left";
+        case DRAG_BUTTON_RIGHT: return "right";
+        case DRAG_BUTTON_MIDDLE: return "middle";
+        case DRAG_BUTTON_ANY: return "any";
+    }
+    return "left";
+}
+
+static DWORD WINAPI TraceRecorder_FlightThread(LPVOID parameter) {
+    (void)parameter;
+
+    uint64_t window_us = (uint64_t)FLIGHT_RECORDER_DEFAULT_WINDOW_MS * 1000;
+    FlightRecorderSummary summary;
+
+    HANDLE file = CreateFile(g_flight_trace_path, GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                             CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Failed to create flight recording %s: error code %lu",
+                  g_flight_trace_path, GetLastError());
+        InterlockedExchange(&g_flight_busy, 0);
+        return 1;
+    }
+    bool ok = FlightRecorder_WriteTrace(&g_flight_snapshot, g_flight_now_us, window_us,
+                                        TraceRecorder_WriteFlight, file, &summary);
+    CloseHandle(file);
+    if (!ok) {
+        LOG_ERROR("Failed to write flight recording %s: error code %lu",
+                  g_flight_trace_path, GetLastError());
+        InterlockedExchange(&g_flight_busy, 0);
+        return 1;
+    }
+
+    file = CreateFile(g_flight_ticks_path, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+                      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_WARN("Failed to create tick timing %s: error code %lu",
+                 g_flight_ticks_path, GetLastError());
+    } else {
+        if (!FlightRecorder_WriteTicks(&g_flight_snapshot, g_flight_now_us, window_us,
+                                       TraceRecorder_WriteFlight, file)) {
+            LOG_WARN("Failed to write tick timing %s: error code %lu",
+                     g_flight_ticks_path, GetLastError());
+        }
+        CloseHandle(file);
+    }
+
+    LOG_INFO("Flight recording written: %s (%.1f s, %llu packets, %llu outputs, "
+             "%llu ticks, %llu bytes)",
+             g_flight_trace_path, (double)(summary.last_us - summary.first_us) / 1e6,
+             (unsigned long long)summary.packets, (unsigned long long)summary.outputs,
+             (unsigned long long)summary.ticks, (unsigned long long)summary.bytes);
+    LOG_INFO("Replay with: replay %s -o trajectory.csv \"%s\"", g_flight_replay,
+             g_flight_trace_path);
+    InterlockedExchange(&g_flight_busy, 0);
+    return 0;
+}
+
+bool TraceRecorder_DumpFlight(void) {
+    if (InterlockedCompareExchange(&g_flight_busy, 1, 0) != 0) {
+        LOG_WARN("Flight recording %s is still being written; dump skipped", g_flight_trace_path);
+        return false;
+    }
+    if (g_flight_thread) {
+        // The previous dump has finished; only its handle is left
+        WaitForSingleObject(g_flight_thread, INFINITE);
+        CloseHandle(g_flight_thread);
+        g_flight_thread = NULL;
+    }
+
+    // Everything the writer needs is copied now, so input keeps flowing into the live ring
+    g_flight_now_us = Platform_NowMicros(PlatformWin32_Get());
+    g_flight_snapshot = g_flight_recorder;
+    TraceRecorder_BuildPath(g_flight_trace_path, "mouse_stabilizer_flight_", ".mstrace");
+    TraceRecorder_BuildPath(g_flight_ticks_path, "mouse_stabilizer_flight_", "_ticks.csv");
+    // The instance driving the cursor, with any per-device settings applied
+    const SmoothStabilizer* settings = MouseInput_GetActiveStabilizer();
+    sprintf_s(g_flight_replay, sizeof(g_flight_replay),
+              "--follow %.2f --min-distance %.1f --ease %s --delay-ms %d --dual %d "
+              "--drag-only %d --drag-button %s",
+              settings->follow_strength, settings->min_distance,
+              TraceRecorder_EaseOption(settings->ease_type), settings->delay_start_ms,
+              settings->dual_mode ? 1 : 0, settings->drag_only ? 1 : 0,
+              TraceRecorder_DragButtonOption(settings->drag_button));
+    strcpy_s(g_flight_path, sizeof(g_flight_path), g_flight_trace_path);
+
+    g_flight_thread = CreateThread(NULL, 0, TraceRecorder_FlightThread, NULL, 0, NULL);
+    if (!g_flight_thread) {
+        LOG_ERROR("Failed to start flight recording thread: error code %lu", GetLastError());
+        InterlockedExchange(&g_flight_busy, 0);
+        return false;
+    }
+    SetThreadPriority(g_flight_thread, THREAD_PRIORITY_BELOW_NORMAL);
+    return true;
+}
+
+void TraceRecorder_WaitForFlight(void) {
+    if (!g_flight_thread) return;
+
+    WaitForSingleObject(g_flight_thread, INFINITE);
+    CloseHandle(g_flight_thread);
+    g_flight_thread = NULL;
+}
+
+const char* TraceRecorder_GetFlightPath(void) {
+    return g_flight_path;
+}
+
+const char* TraceRecorder_GetPath(void) {
+    return g_trace_path;
+}
+
+void TraceRecorder_GetStats(TraceRecorderStats* stats) {
+    if (!stats) return;
+
+    *stats = g_trace_stats;
+    stats->write_errors = (uint64_t)g_trace_write_errors;
+}
@@ -0,0 +1,343 @@
+/**
+ * Trace Replay - Offline Engine Runs over Recorded Input
+ *
+ * Feeds a decoded input trace into a stabilizer bound to a virtual host:
+ * the clock is set to each packet's timestamp and to every simulated timer
+ * tick in between, cursor reads return the last position the engine wrote
+ * and nothing is logged. Same trace and settings give the same trajectory.
+ */
+
+#include "include/core/trace_replay.h"
+
+#include <string.h>
+
+// Upper bound on records scanned for the first recorded output position
+#define TRACE_REPLAY_START_SCAN 100000
+
+static uint64_t TraceReplay_NowMicros(void* context) {
+    return ((TraceReplay*)context)->now_us;
+}
+
+static bool TraceReplay_GetCursor(void* context, int* x, int* y) {
+    TraceReplay* replay = (TraceReplay*)context;
+    *x = replay->cursor_x;
+    *y = replay->cursor_y;
+    return true;
+}
+
+static bool TraceReplay_Write(void* context, int x, int y) {
+    TraceReplay* replay = (TraceReplay*)context;
+    replay->cursor_x = x;
+    replay->cursor_y = y;
+    return true;
+}
+
+// Where the recorded engine was first seen, so the replay starts on the same pixel
+static bool TraceReplay_FindStart(const InputTraceReader* reader, float* x, float* y) {
+    InputTraceReader scan = *reader;
+    InputTraceRecord record;
+    for (int i = 0; i < TRACE_REPLAY_START_SCAN && InputTrace_Read(&scan, &record); i++) {
+        if (record.type == INPUT_TRACE_OUTPUT) {
+            *x = record.x;
+            *y = record.y;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void TraceReplay_RunTicks(TraceReplay* replay, uint64_t until_us) {
+    SmoothStabilizer* stabilizer = &replay->stabilizer;
+    while (replay->next_tick_us <= until_us) {
+        replay->now_us = replay->next_tick_us;
+        StabilizerCore_UpdatePosition(stabilizer);
+        replay->stats.ticks++;
+        if (replay->on_tick) {
+            replay->on_tick(replay->tick_context, replay->now_us, stabilizer);
+        }
+
+        if (stabilizer->current_pos.x != replay->last_x ||
+            stabilizer->current_pos.y != replay->last_y) {
+            replay->last_x = stabilizer->current_pos.x;
+            replay->last_y = stabilizer->current_pos.y;
+            replay->stats.outputs++;
+            if (replay->output) {
+                replay->output(replay->output_context, replay->now_us, replay->last_x,
+                               replay->last_y);
+            }
+        }
+        replay->next_tick_us += replay->tick_period_us;
+    }
+}
+
+void TraceReplay_DefaultOptions(TraceReplayOptions* options) {
+    if (!options) return;
+
+    memset(options, 0, sizeof(*options));
+    options->tick_interval_us = UPDATE_INTERVAL_MS * 1000;
+    options->tail_ms = TRACE_REPLAY_DEFAULT_TAIL_MS;
+}
+
+uint32_t TraceReplay_TickPeriod(uint32_t interval_us, uint32_t resolution_us) {
+    if (interval_us == 0) interval_us = UPDATE_INTERVAL_MS * 1000;
+    if (resolution_us == 0) return interval_us;
+
+    // SetTimer fires on the next scheduler tick at or after the due time
+    return ((interval_us + resolution_us - 1) / resolution_us) * resolution_us;
+}
+
+bool TraceReplay_Open(TraceReplay* replay, const void* data, size_t length,
+                      const SmoothStabilizer* settings, const TraceReplayOptions* options,
+                      TraceReplayOutputFn output, void* context) {
+    if (!replay) return false;
+
+    memset(replay, 0, sizeof(*replay));
+    if (!InputTrace_OpenReader(&replay->reader, data, length)) return false;
+
+    TraceReplayOptions defaults;
+    if (!options) {
+        TraceReplay_DefaultOptions(&defaults);
+        options = &defaults;
+    }
+
+    float start_x = options->start_x;
+    float start_y = options->start_y;
+    if (!options->has_start && !TraceReplay_FindStart(&replay->reader, &start_x, &start_y)) {
+        start_x = 0.0f;
+        start_y = 0.0f;
+    }
+
+    replay->now_us = replay->reader.start_us;
+    replay->cursor_x = (int)start_x;
+    replay->cursor_y = (int)start_y;
+    replay->tick_period_us = TraceReplay_TickPeriod(options->tick_interval_us,
+                                                    options->timer_resolution_us);
+    replay->next_tick_us = replay->now_us + replay->tick_period_us;
+    replay->tail_us = (uint64_t)options->tail_ms * 1000;
+    replay->output = output;
+    replay->output_context = context;
+
+    replay->platform.context = replay;
+    replay->platform.now_us = TraceReplay_NowMicros;
+    replay->platform.get_cursor = TraceReplay_GetCursor;
+    OutputSink_Initialize(&replay->sink, TraceReplay_Write, replay);
+
+    StabilizerCore_Initialize(&replay->stabilizer, &replay->platform, NULL, &replay->sink);
+    if (settings) {
+        StabilizerCore_CopySettings(&replay->stabilizer, settings);
+    }
+    replay->stabilizer.enabled = true;
+    replay->stabilizer.current_pos.x = start_x;
+    replay->stabilizer.current_pos.y = start_y;
+    replay->stabilizer.target_pos = replay->stabilizer.current_pos;
+    replay->last_x = start_x;
+    replay->last_y = start_y;
+
+    replay->stats.first_us = replay->now_us;
+    replay->stats.last_us = replay->now_us;
+    return true;
+}
+
+bool TraceReplay_Step(TraceReplay* replay, size_t max_records) {
+    if (!replay || replay->finished) return false;
+
+    SmoothStabilizer* stabilizer = &replay->stabilizer;
+    InputTraceRecord record;
+    for (size_t i = 0; i < max_records; i++) {
+        if (!InputTrace_Read(&replay->reader, &record)) {
+            // End of trace (or a torn tail): let the cursor settle, then stop
+            TraceReplay_RunTicks(replay, replay->now_us + replay->tail_us);
+            replay->stats.last_us = replay->now_us;
+            replay->finished = true;
+            return false;
+        }
+
+        switch (record.type) {
+            case INPUT_TRACE_PACKET:
+                TraceReplay_RunTicks(replay, record.time_us);
+                if (record.time_us > replay->now_us) {
+                    replay->now_us = record.time_us;
+                }
+                if (record.dx != 0 || record.dy != 0) {
+                    // Pass-through packets move the OS cursor directly (pointer
+                    // acceleration is not modelled); engaging picks that position up
+                    if (!StabilizerCore_IsEngaged(stabilizer)) {
+                        replay->cursor_x += record.dx;
+                        replay->cursor_y += record.dy;
+                    }
+                    StabilizerCore_AddMouseDelta(stabilizer, (float)record.dx, (float)record.dy,
+                                                 replay->now_us);
+                }
+                if (record.pressed || record.released) {
+                    StabilizerCore_UpdateButtons(stabilizer, record.pressed, record.released);
+                }
+                replay->stats.packets++;
+                break;
+            case INPUT_TRACE_OUTPUT:
+                replay->stats.recorded_outputs++;
+                break;
+            case INPUT_TRACE_GAP:
+                replay->stats.dropped += record.dropped;
+                break;
+            case INPUT_TRACE_DEVICE:
+                break;
+        }
+    }
+
+    replay->stats.last_us = replay->now_us;
+    return true;
+}
+
+size_t TraceReplay_Offset(const TraceReplay* replay) {
+    return replay ? replay->reader.offset : 0;
+}
+
+bool TraceReplay_SaveCheckpoint(const TraceReplay* replay, TraceReplayCheckpoint* checkpoint) {
+    if (!replay || !checkpoint) return false;
+
+    checkpoint->offset = replay->reader.offset;
+    checkpoint->trace_state = replay->reader.state;
+    checkpoint->now_us = replay->now_us;
+    checkpoint->next_tick_us = replay->next_tick_us;
+    checkpoint->cursor_x = replay->cursor_x;
+    checkpoint->cursor_y = replay->cursor_y;
+    checkpoint->last_x = replay->last_x;
+    checkpoint->last_y = replay->last_y;
+    checkpoint->stats = replay->stats;
+    checkpoint->engine_length = (uint32_t)StabilizerCore_SaveState(&replay->stabilizer,
+                                                                   checkpoint->engine,
+                                                                   sizeof(checkpoint->engine));
+    return checkpoint->engine_length > 0;
+}
+
+bool TraceReplay_Resume(TraceReplay* replay, const void* data, size_t length,
+                        const TraceReplayOptions* options, const TraceReplayCheckpoint* checkpoint,
+                        TraceReplayOutputFn output, void* context) {
+    if (!replay || !checkpoint) return false;
+
+    // The start position is in the checkpoint; skip the scan for it
+    TraceReplayOptions resume_options;
+    if (options) {
+        resume_options = *options;
+    } else {
+        TraceReplay_DefaultOptions(&resume_options);
+    }
+    resume_options.has_start = true;
+    if (!TraceReplay_Open(replay, data, length, NULL, &resume_options, output, context)) {
+        return false;
+    }
+
+    if (checkpoint->offset < replay->reader.offset || checkpoint->offset > length ||
+        checkpoint->engine_length > sizeof(checkpoint->engine) ||
+        !StabilizerCore_RestoreState(&replay->stabilizer, checkpoint->engine,
+                                     checkpoint->engine_length)) {
+        return false;
+    }
+
+    replay->reader.offset = (size_t)checkpoint->offset;
+    replay->reader.state = checkpoint->trace_state;
+    replay->now_us = checkpoint->now_us;
+    replay->next_tick_us = checkpoint->next_tick_us;
+    replay->cursor_x = checkpoint->cursor_x;
+    replay->cursor_y = checkpoint->cursor_y;
+    replay->last_x = checkpoint->last_x;
+    replay->last_y = checkpoint->last_y;
+    replay->stats = checkpoint->stats;
+    return true;
+}
+
+// Virtual clock shared by the batch driver's tick loop
+typedef struct {
+    StabilizerBatch* batch;
+    uint64_t now_us;
+    uint64_t next_tick_us;
+    uint32_t tick_period_us;
+    TraceReplayBatchTickFn on_tick;
+    void* context;
+    TraceReplayStats stats;
+} TraceReplayBatchClock;
+
+static void TraceReplay_RunBatchTicks(TraceReplayBatchClock* clock, uint64_t until_us) {
+    while (clock->next_tick_us <= until_us) {
+        clock->now_us = clock->next_tick_us;
+        StabilizerBatch_UpdatePosition(clock->batch, clock->now_us);
+        clock->stats.ticks++;
+        if (clock->on_tick) {
+            clock->on_tick(clock->context, clock->now_us, clock->batch);
+        }
+        clock->next_tick_us += clock->tick_period_us;
+    }
+}
+
+bool TraceReplay_RunBatch(const void* data, size_t length, StabilizerBatch* batch,
+                          const TraceReplayOptions* options, TraceReplayBatchTickFn on_tick,
+                          void* context, TraceReplayStats* stats) {
+    InputTraceReader reader;
+    if (!batch || !InputTrace_OpenReader(&reader, data, length)) return false;
+
+    TraceReplayOptions defaults;
+    if (!options) {
+        TraceReplay_DefaultOptions(&defaults);
+        options = &defaults;
+    }
+
+    float start_x = options->start_x;
+    float start_y = options->start_y;
+    if (!options->has_start && !TraceReplay_FindStart(&reader, &start_x, &start_y)) {
+        start_x = 0.0f;
+        start_y = 0.0f;
+    }
+    int cursor_x = (int)start_x;
+    int cursor_y = (int)start_y;
+
+    TraceReplayBatchClock clock;
+    memset(&clock, 0, sizeof(clock));
+    clock.batch = batch;
+    clock.now_us = reader.start_us;
+    clock.tick_period_us = TraceReplay_TickPeriod(options->tick_interval_us,
+                                                  options->timer_resolution_us);
+    clock.next_tick_us = clock.now_us + clock.tick_period_us;
+    clock.on_tick = on_tick;
+    clock.context = context;
+    clock.stats.first_us = clock.now_us;
+
+    InputTraceRecord record;
+    while (InputTrace_Read(&reader, &record)) {
+        switch (record.type) {
+            case INPUT_TRACE_PACKET:
+                TraceReplay_RunBatchTicks(&clock, record.time_us);
+                if (record.time_us > clock.now_us) {
+                    clock.now_us = record.time_us;
+                }
+                if (record.dx != 0 || record.dy != 0) {
+                    // As StabilizerCore_AddMouseDelta: the engaging packet only moves the OS cursor
+                    if (!batch->engaged) {
+                        cursor_x += record.dx;
+                        cursor_y += record.dy;
+                        StabilizerBatch_Engage(batch, (float)cursor_x, (float)cursor_y);
+                    } else {
+                        StabilizerBatch_AddMouseDelta(batch, (float)record.dx, (float)record.dy,
+                                                      clock.now_us);
+                    }
+                }
+                if ((record.pressed || record.released) && !batch->engaged) {
+                    StabilizerBatch_Engage(batch, (float)cursor_x, (float)cursor_y);
+                }
+                clock.stats.packets++;
+                break;
+            case INPUT_TRACE_OUTPUT:
+                clock.stats.recorded_outputs++;
+                break;
+            case INPUT_TRACE_GAP:
+                clock.stats.dropped += record.dropped;
+                break;
+            case INPUT_TRACE_DEVICE:
+                break;
+        }
+    }
+
+    TraceReplay_RunBatchTicks(&clock, clock.now_us + (uint64_t)options->tail_ms * 1000);
+    clock.stats.last_us = clock.now_us;
+    if (stats) *stats = clock.stats;
+    return true;
+}
@@ -0,0 +1,100 @@
+/**
+ * Trajectory Metrics - Lag, Jitter and Overshoot Scores
+ *
+ * Running sums over (target, output) pairs taken once per engine tick.
+ * Used by the offline tools to compare parameter sets on recorded input.
+ */
+
+#include "include/core/trajectory_metrics.h"
+
+#include <math.h>
+#include <string.h>
+
+void TrajectoryMetrics_Reset(TrajectoryMetrics* metrics) {
+    if (!metrics) return;
+
+    memset(metrics, 0, sizeof(*metrics));
+}
+
+void TrajectoryMetrics_Break(TrajectoryMetrics* metrics) {
+    if (!metrics) return;
+
+    metrics->history = 0;
+}
+
+void TrajectoryMetrics_AddSample(TrajectoryMetrics* metrics, float target_x, float target_y,
+                                 float output_x, float output_y) {
+    if (!metrics) return;
+
+    double error_x = (double)target_x - (double)output_x;
+    double error_y = (double)target_y - (double)output_y;
+    double lag = sqrt(error_x * error_x + error_y * error_y);
+
+    metrics->samples++;
+    metrics->lag_sum += lag;
+    if (lag > metrics->lag_max) metrics->lag_max = lag;
+
+    if (metrics->history >= 1) {
+        // The output stepped past the target: the remaining error points back
+        // against the direction it just moved
+        double step_x = (double)output_x - metrics->prev_x;
+        double step_y = (double)output_y - metrics->prev_y;
+        double step_length = sqrt(step_x * step_x + step_y * step_y);
+        double along = error_x * step_x + error_y * step_y;
+        if (step_length > 1e-6 && along < 0.0) {
+            double overshoot = -along / step_length;
+            metrics->overshoot_sum += overshoot;
+            metrics->overshoot_events++;
+            if (overshoot > metrics->overshoot_max) metrics->overshoot_max = overshoot;
+        }
+    }
+
+    if (metrics->history >= 2) {
+        double ax = (double)output_x - 2.0 * metrics->prev_x + metrics->prev2_x;
+        double ay = (double)output_y - 2.0 * metrics->prev_y + metrics->prev2_y;
+        metrics->jitter_sq_sum += ax * ax + ay * ay;
+        metrics->jitter_samples++;
+    }
+
+    metrics->prev2_x = metrics->prev_x;
+    metrics->prev2_y = metrics->prev_y;
+    metrics->prev_x = output_x;
+    metrics->prev_y = output_y;
+    if (metrics->history < 2) metrics->history++;
+}
+
+void TrajectoryMetrics_Merge(TrajectoryMetrics* metrics, const TrajectoryMetrics* other) {
+    if (!metrics || !other) return;
+
+    metrics->samples += other->samples;
+    metrics->lag_sum += other->lag_sum;
+    if (other->lag_max > metrics->lag_max) metrics->lag_max = other->lag_max;
+    metrics->jitter_sq_sum += other->jitter_sq_sum;
+    metrics->jitter_samples += other->jitter_samples;
+    metrics->overshoot_sum += other->overshoot_sum;
+    metrics->overshoot_events += other->overshoot_events;
+    if (other->overshoot_max > metrics->overshoot_max) {
+        metrics->overshoot_max = other->overshoot_max;
+    }
+}
+
+void TrajectoryMetrics_GetScore(const TrajectoryMetrics* metrics, TrajectoryScore* score) {
+    if (!score) return;
+
+    memset(score, 0, sizeof(*score));
+    if (!metrics) return;
+
+    score->samples = metrics->samples;
+    score->max_lag_px = metrics->lag_max;
+    score->max_overshoot_px = metrics->overshoot_max;
+    score->overshoot_events = metrics->overshoot_events;
+    if (metrics->samples > 0) {
+        score->mean_lag_px = metrics->lag_sum / (double)metrics->samples;
+    }
+    if (metrics->jitter_samples > 0) {
+        score->rms_jitter_px = sqrt(metrics->jitter_sq_sum / (double)metrics->jitter_samples);
+    }
+    if (metrics->overshoot_events > 0) {
+        score->mean_overshoot_px = metrics->overshoot_sum / (double)metrics->overshoot_events;
+    }
+}
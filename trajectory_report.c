@@ -0,0 +1,464 @@
+/**
+ * Trajectory Report - Offline Lag, Jitter, Overshoot and Corner Analysis
+ *
+ * Works run by run over a recorded trajectory. Lag in time is found by
+ * searching back along the target path for the point closest to the
+ * current output; jitter comes from a Butterworth high-pass and a Welch
+ * power spectrum; reversals and corners are detected on the target path
+ * and matched against what the output did afterwards.
+ */
+
+#include "include/core/trajectory_report.h"
+
+#include <math.h>
+#include <string.h>
+
+#define REPORT_PI 3.14159265358979323846
+
+// Percentile histograms: 0.05 px and 0.25 ms bins, last bin is overflow
+#define REPORT_HISTOGRAM_BINS 4096
+#define REPORT_LAG_PX_BIN 0.05
+#define REPORT_LAG_MS_BIN 0.25
+
+typedef struct {
+    uint32_t counts[REPORT_HISTOGRAM_BINS];
+    double bin_width;
+    uint64_t total;
+    double max;
+} ReportHistogram;
+
+// Second-order Butterworth high-pass (RBJ cookbook, Q = 1/sqrt(2))
+typedef struct {
+    double b0, b1, b2, a1, a2;
+    double x1, x2, y1, y2;
+} ReportBiquad;
+
+static void ReportHistogram_Add(ReportHistogram* histogram, double value) {
+    int bin = (int)(value / histogram->bin_width);
+    if (bin < 0) bin = 0;
+    if (bin >= REPORT_HISTOGRAM_BINS) bin = REPORT_HISTOGRAM_BINS - 1;
+    histogram->counts[bin]++;
+    histogram->total++;
+    if (value > histogram->max) histogram->max = value;
+}
+
+// Upper edge of the bin holding the percentile, never beyond the true maximum
+static double ReportHistogram_Percentile(const ReportHistogram* histogram, double p) {
+    if (histogram->total == 0) return 0.0;
+
+    uint64_t rank = (uint64_t)ceil(p * (double)histogram->total);
+    uint64_t seen = 0;
+    for (int bin = 0; bin < REPORT_HISTOGRAM_BINS; bin++) {
+        seen += histogram->counts[bin];
+        if (seen >= rank) {
+            if (bin == REPORT_HISTOGRAM_BINS - 1) return histogram->max;
+            double edge = (bin + 1) * histogram->bin_width;
+            return edge < histogram->max ? edge : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+static void ReportBiquad_Initialize(ReportBiquad* filter, double cutoff_hz, double sample_rate_hz,
+                                    double first, double slope) {
+    double w0 = 2.0 * REPORT_PI * cutoff_hz / sample_rate_hz;
+    double alpha = sin(w0) / (2.0 * 0.70710678118654752);
+    double c = cos(w0);
+    double a0 = 1.0 + alpha;
+
+    filter->b0 = (1.0 + c) / 2.0 / a0;
+    filter->b1 = -(1.0 + c) / a0;
+    filter->b2 = (1.0 + c) / 2.0 / a0;
+    filter->a1 = -2.0 * c / a0;
+    filter->a2 = (1.0 - alpha) / a0;
+    // Start settled on the run's initial offset and drift: the double zero at
+    // DC passes neither, so a run that starts mid-stroke shows no false step
+    filter->x1 = first - slope;
+    filter->x2 = first - 2.0 * slope;
+    filter->y1 = filter->y2 = 0.0;
+}
+
+static double ReportBiquad_Apply(ReportBiquad* filter, double x) {
+    double y = filter->b0 * x + filter->b1 * filter->x1 + filter->b2 * filter->x2 -
+               filter->a1 * filter->y1 - filter->a2 * filter->y2;
+    filter->x2 = filter->x1;
+    filter->x1 = x;
+    filter->y2 = filter->y1;
+    filter->y1 = y;
+    return y;
+}
+
+// In-place iterative radix-2 FFT, n a power of two
+static void Report_Fft(double* re, double* im, int n) {
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j |= bit;
+        if (i < j) {
+            double t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (int length = 2; length <= n; length <<= 1) {
+        double angle = -2.0 * REPORT_PI / length;
+        for (int k = 0; k < length / 2; k++) {
+            double wr = cos(angle * k), wi = sin(angle * k);
+            for (int start = 0; start < n; start += length) {
+                int a = start + k, b = start + k + length / 2;
+                double tr = re[b] * wr - im[b] * wi;
+                double ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+/**
+ * Add the periodogram of one Hann-windowed segment of the high-passed output
+ * x and y go through one complex FFT as re and im; their power separates
+ * again from the conjugate-symmetric pair of bins.
+ */
+static void Report_AddSegment(TrajectoryReport* report, const double* hx, const double* hy) {
+    double re[TRAJECTORY_FFT_SIZE], im[TRAJECTORY_FFT_SIZE];
+    double window_power = 0.0;
+
+    for (int n = 0; n < TRAJECTORY_FFT_SIZE; n++) {
+        double w = 0.5 * (1.0 - cos(2.0 * REPORT_PI * n / TRAJECTORY_FFT_SIZE));
+        re[n] = hx[n] * w;
+        im[n] = hy[n] * w;
+        window_power += w * w;
+    }
+    Report_Fft(re, im, TRAJECTORY_FFT_SIZE);
+
+    double scale = 1.0 / (report->sample_rate_hz * window_power);
+    for (int k = 0; k < TRAJECTORY_SPECTRUM_BINS; k++) {
+        int mirror = (TRAJECTORY_FFT_SIZE - k) % TRAJECTORY_FFT_SIZE;
+        double power = (re[k] * re[k] + im[k] * im[k] +
+                        re[mirror] * re[mirror] + im[mirror] * im[mirror]) / 2.0;
+        bool one_sided = (k != 0 && k != TRAJECTORY_FFT_SIZE / 2);
+        report->spectrum[k] += power * scale * (one_sided ? 2.0 : 1.0);
+    }
+    report->spectrum_segments++;
+}
+
+// Time at which the target path came closest to the output, searching back from i
+static double Report_LagMs(const TrajectorySample* s, size_t begin, size_t i, size_t window) {
+    double ox = s[i].output_x, oy = s[i].output_y;
+    double best_distance = INFINITY;
+    double best_time = (double)s[i].time_us;
+    size_t stop = (i - begin > window) ? i - window : begin;
+
+    for (size_t j = i; j > stop; j--) {
+        double px = s[j - 1].target_x, py = s[j - 1].target_y;
+        double qx = s[j].target_x, qy = s[j].target_y;
+        double sx = qx - px, sy = qy - py;
+        double length_sq = sx * sx + sy * sy;
+        double t = 1.0;
+        if (length_sq > 1e-12) {
+            t = ((ox - px) * sx + (oy - py) * sy) / length_sq;
+            t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+        }
+        double dx = px + t * sx - ox, dy = py + t * sy - oy;
+        double distance = dx * dx + dy * dy;
+        // Strictly closer only: a stationary target resolves to its newest sample
+        if (distance < best_distance - 1e-9) {
+            best_distance = distance;
+            best_time = (double)s[j - 1].time_us + t * (double)(s[j].time_us - s[j - 1].time_us);
+        }
+    }
+    return ((double)s[i].time_us - best_time) / 1000.0;
+}
+
+static double Report_Axis(const TrajectorySample* s, size_t i, int axis, bool output) {
+    if (output) return axis ? s[i].output_y : s[i].output_x;
+    return axis ? s[i].target_y : s[i].target_x;
+}
+
+/**
+ * Overshoot at target reversals along one axis
+ * A reversal is a turning point the target then swings back from by at
+ * least reversal_px. The output's furthest excursion past it, until the
+ * target passes the turning point again or the window ends, is the overshoot.
+ */
+static void Report_Reversals(const TrajectorySample* s, size_t begin, size_t end, int axis,
+                             size_t window, double reversal_px, double* sum,
+                             TrajectoryReport* report) {
+    int direction = 0;
+    double extreme = Report_Axis(s, begin, axis, false);
+    size_t extreme_index = begin;
+
+    for (size_t i = begin + 1; i < end; i++) {
+        double v = Report_Axis(s, i, axis, false);
+        if (direction == 0) {
+            if (fabs(v - extreme) >= reversal_px) {
+                direction = v > extreme ? 1 : -1;
+                extreme = v;
+                extreme_index = i;
+            }
+            continue;
+        }
+        if (direction * (v - extreme) > 0.0) {
+            extreme = v;
+            extreme_index = i;
+            continue;
+        }
+        if (direction * (extreme - v) < reversal_px) continue;
+
+        double furthest = direction * extreme;
+        for (size_t k = extreme_index; k < end && k - extreme_index <= window; k++) {
+            if (k > extreme_index &&
+                direction * (Report_Axis(s, k, axis, false) - extreme) > 0.0) break;
+            double o = direction * Report_Axis(s, k, axis, true);
+            if (o > furthest) furthest = o;
+        }
+        double overshoot = furthest - direction * extreme;
+        report->reversals++;
+        *sum += overshoot;
+        if (overshoot > report->max_overshoot_px) report->max_overshoot_px = overshoot;
+
+        direction = -direction;
+        extreme = v;
+        extreme_index = i;
+    }
+}
+
+static double Report_SegmentDistance(double px, double py, double ax, double ay, double bx,
+                                     double by) {
+    double sx = bx - ax, sy = by - ay;
+    double length_sq = sx * sx + sy * sy;
+    double t = 0.0;
+    if (length_sq > 1e-12) {
+        t = ((px - ax) * sx + (py - ay) * sy) / length_sq;
+        t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+    }
+    double dx = ax + t * sx - px, dy = ay + t * sy - py;
+    return sqrt(dx * dx + dy * dy);
+}
+
+static double Report_Step(const TrajectorySample* s, size_t i) {
+    double dx = (double)s[i].target_x - s[i - 1].target_x;
+    double dy = (double)s[i].target_y - s[i - 1].target_y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+// Closest approach of the output path to a target corner
+static void Report_ScoreCorner(const TrajectorySample* s, size_t corner, size_t begin, size_t end,
+                               size_t window, double* sum, TrajectoryReport* report) {
+    double cx = s[corner].target_x, cy = s[corner].target_y;
+    double closest = INFINITY;
+    for (size_t k = (corner > begin ? corner : begin + 1); k < end && k - corner <= window; k++) {
+        double d = Report_SegmentDistance(cx, cy, s[k - 1].output_x, s[k - 1].output_y,
+                                          s[k].output_x, s[k].output_y);
+        if (d < closest) closest = d;
+    }
+    if (closest < INFINITY) {
+        report->corners++;
+        *sum += closest;
+        if (closest > report->max_corner_error_px) report->max_corner_error_px = closest;
+    }
+}
+
+/**
+ * Corner rounding along the target path
+ * The turn at each sample is the angle between the chords reaching
+ * corner_chord_px of path back and ahead; the sharpest sample of each
+ * stretch above corner_angle_deg is a corner, scored by how close the
+ * output path later comes to it.
+ */
+static void Report_Corners(const TrajectorySample* s, size_t begin, size_t end, size_t window,
+                           const TrajectoryReportOptions* options, double* sum,
+                           TrajectoryReport* report) {
+    double chord = options->corner_chord_px;
+    double min_turn = options->corner_angle_deg * REPORT_PI / 180.0;
+    size_t back = begin, ahead = begin;
+    double back_length = 0.0, ahead_length = 0.0;  // Path length back..i and i..ahead
+    bool in_corner = false;
+    double best_turn = 0.0;
+    size_t best_index = begin;
+
+    for (size_t i = begin; i < end; i++) {
+        if (i > begin) {
+            double step = Report_Step(s, i);
+            back_length += step;
+            ahead_length -= step;
+        }
+        while (back + 1 < i && back_length - Report_Step(s, back + 1) >= chord) {
+            back_length -= Report_Step(s, back + 1);
+            back++;
+        }
+        while (ahead + 1 < end && ahead_length < chord) {
+            ahead++;
+            ahead_length += Report_Step(s, ahead);
+        }
+
+        double turn = 0.0;
+        if (back_length >= chord && ahead_length >= chord) {
+            double ux = (double)s[i].target_x - s[back].target_x,
+                    uy = (double)s[i].target_y - s[back].target_y;
+            double vx = (double)s[ahead].target_x - s[i].target_x,
+                    vy = (double)s[ahead].target_y - s[i].target_y;
+            double norms = sqrt((ux * ux + uy * uy) * (vx * vx + vy * vy));
+            if (norms > 1e-9) {
+                double c = (ux * vx + uy * vy) / norms;
+                turn = acos(c < -1.0 ? -1.0 : (c > 1.0 ? 1.0 : c));
+            }
+        }
+
+        if (turn >= min_turn) {
+            if (!in_corner || turn > best_turn) {
+                best_turn = turn;
+                best_index = i;
+            }
+            in_corner = true;
+            continue;
+        }
+        if (in_corner) {
+            Report_ScoreCorner(s, best_index, begin, end, window, sum, report);
+            in_corner = false;
+        }
+    }
+    if (in_corner) {
+        Report_ScoreCorner(s, best_index, begin, end, window, sum, report);
+    }
+}
+
+void TrajectoryReport_DefaultOptions(TrajectoryReportOptions* options) {
+    if (!options) return;
+
+    options->highpass_hz = 10.0f;
+    options->max_lag_ms = 1000.0f;
+    options->reversal_px = 5.0f;
+    options->corner_angle_deg = 60.0f;
+    options->corner_chord_px = 10.0f;
+}
+
+bool TrajectoryReport_Compute(const TrajectorySample* samples, size_t count,
+                              const TrajectoryReportOptions* options, TrajectoryReport* report) {
+    if (!report) return false;
+
+    memset(report, 0, sizeof(*report));
+    if (!samples) return false;
+
+    TrajectoryReportOptions defaults;
+    if (!options) {
+        TrajectoryReport_DefaultOptions(&defaults);
+        options = &defaults;
+    }
+
+    // Sample rate from the spacing inside engaged runs
+    uint64_t span_us = 0, intervals = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (samples[i].engaged && samples[i - 1].engaged &&
+            samples[i].time_us > samples[i - 1].time_us) {
+            span_us += samples[i].time_us - samples[i - 1].time_us;
+            intervals++;
+        }
+    }
+    if (intervals == 0) return false;
+    report->sample_rate_hz = 1e6 * (double)intervals / (double)span_us;
+    report->spectrum_bin_hz = report->sample_rate_hz / TRAJECTORY_FFT_SIZE;
+
+    size_t window = (size_t)(options->max_lag_ms * report->sample_rate_hz / 1000.0);
+    if (window < 1) window = 1;
+    double cutoff = options->highpass_hz;
+    if (cutoff > 0.45 * report->sample_rate_hz) cutoff = 0.45 * report->sample_rate_hz;
+
+    ReportHistogram lag_px, lag_ms;
+    memset(&lag_px, 0, sizeof(lag_px));
+    memset(&lag_ms, 0, sizeof(lag_ms));
+    lag_px.bin_width = REPORT_LAG_PX_BIN;
+    lag_ms.bin_width = REPORT_LAG_MS_BIN;
+
+    double lag_px_sum = 0.0, lag_ms_sum = 0.0, jitter_sq_sum = 0.0;
+    double overshoot_sum = 0.0, corner_sum = 0.0;
+    double hx[TRAJECTORY_FFT_SIZE], hy[TRAJECTORY_FFT_SIZE];
+
+    size_t begin = 0;
+    while (begin < count) {
+        if (!samples[begin].engaged) {
+            begin++;
+            continue;
+        }
+        size_t end = begin;
+        while (end < count && samples[end].engaged) end++;
+
+        ReportBiquad filter_x, filter_y;
+        const TrajectorySample* first = &samples[begin];
+        const TrajectorySample* second = &samples[end - begin > 1 ? begin + 1 : begin];
+        ReportBiquad_Initialize(&filter_x, cutoff, report->sample_rate_hz, first->output_x,
+                                (double)second->output_x - first->output_x);
+        ReportBiquad_Initialize(&filter_y, cutoff, report->sample_rate_hz, first->output_y,
+                                (double)second->output_y - first->output_y);
+        int filled = 0;
+
+        for (size_t i = begin; i < end; i++) {
+            const TrajectorySample* s = &samples[i];
+            double ex = (double)s->target_x - s->output_x;
+            double ey = (double)s->target_y - s->output_y;
+            double lag = sqrt(ex * ex + ey * ey);
+            double lag_time = Report_LagMs(samples, begin, i, window);
+            lag_px_sum += lag;
+            lag_ms_sum += lag_time;
+            ReportHistogram_Add(&lag_px, lag);
+            ReportHistogram_Add(&lag_ms, lag_time);
+
+            double x = ReportBiquad_Apply(&filter_x, s->output_x);
+            double y = ReportBiquad_Apply(&filter_y, s->output_y);
+            jitter_sq_sum += x * x + y * y;
+
+            // Welch segments with 50% overlap
+            hx[filled] = x;
+            hy[filled] = y;
+            if (++filled == TRAJECTORY_FFT_SIZE) {
+                Report_AddSegment(report, hx, hy);
+                memmove(hx, hx + TRAJECTORY_FFT_SIZE / 2, sizeof(double) * TRAJECTORY_FFT_SIZE / 2);
+                memmove(hy, hy + TRAJECTORY_FFT_SIZE / 2, sizeof(double) * TRAJECTORY_FFT_SIZE / 2);
+                filled = TRAJECTORY_FFT_SIZE / 2;
+            }
+            report->samples++;
+        }
+
+        Report_Reversals(samples, begin, end, 0, window, options->reversal_px, &overshoot_sum,
+                         report);
+        Report_Reversals(samples, begin, end, 1, window, options->reversal_px, &overshoot_sum,
+                         report);
+        Report_Corners(samples, begin, end, window, options, &corner_sum, report);
+        begin = end;
+    }
+
+    report->mean_lag_px = lag_px_sum / (double)report->samples;
+    report->p95_lag_px = ReportHistogram_Percentile(&lag_px, 0.95);
+    report->max_lag_px = lag_px.max;
+    report->mean_lag_ms = lag_ms_sum / (double)report->samples;
+    report->p95_lag_ms = ReportHistogram_Percentile(&lag_ms, 0.95);
+    report->max_lag_ms = lag_ms.max;
+    report->rms_jitter_px = sqrt(jitter_sq_sum / (double)report->samples);
+    if (report->reversals > 0) {
+        report->mean_overshoot_px = overshoot_sum / (double)report->reversals;
+    }
+    if (report->corners > 0) report->mean_corner_error_px = corner_sum / (double)report->corners;
+
+    if (report->spectrum_segments > 0) {
+        int peak = 1;
+        for (int k = 0; k < TRAJECTORY_SPECTRUM_BINS; k++) {
+            report->spectrum[k] /= report->spectrum_segments;
+            if (k >= 1 && report->spectrum[k] > report->spectrum[peak]) peak = k;
+        }
+        report->spectrum_peak_hz = peak * report->spectrum_bin_hz;
+    }
+    return true;
+}
+
+double TrajectoryReport_BandPower(const TrajectoryReport* report, double low_hz, double high_hz) {
+    if (!report || report->spectrum_segments == 0) return 0.0;
+
+    double power = 0.0;
+    for (int k = 0; k < TRAJECTORY_SPECTRUM_BINS; k++) {
+        double hz = k * report->spectrum_bin_hz;
+        if (hz >= low_hz && hz <= high_hz) power += report->spectrum[k] * report->spectrum_bin_hz;
+    }
+    return power;
+}
@@ -1,6 +1,8 @@
 #include "mouse_stabilizer.h"
 #include <shellapi.h>
 
+NOTIFYICONDATA g_nid = {0};          // System tray icon data
+
 bool TrayUI_CreateIcon(HWND hwnd) {
     g_nid.cbSize = sizeof(NOTIFYICONDATA);
     g_nid.hWnd = hwnd;
@@ -75,6 +77,11 @@ void TrayUI_ShowContextMenu(HWND hwnd) {
     sprintf_s(debug_text, sizeof(debug_text), "Debug Mode: %s", 
               Settings_GetLogLevelName(Settings_GetLogLevel()));
     AppendMenu(hMenu, MF_STRING, 1003, debug_text);
+    AppendMenu(hMenu, MF_STRING, 1005,
+               TraceRecorder_IsRecording() ? "Stop Input Recording" : "Start Input Recording");
+    AppendMenu(hMenu, MF_STRING, 1006,
+               EventTracer_IsActive() ? "Stop Event Tracing" : "Start Event Tracing");
+    AppendMenu(hMenu, MF_STRING, 1007, "Save Flight Recording\tCtrl+Alt+D");
     
     AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
     AppendMenu(hMenu, MF_STRING, 1004, "Exit");
@@ -0,0 +1,185 @@
+/**
+ * Velocity Estimator - Sliding-Window Regression
+ *
+ * Least-squares quadratic fit of the target trajectory over a short time
+ * window. Samples enter and leave the running moment sums in O(1); the
+ * sums are rebuilt around the newest sample every few windows so the
+ * normal equations stay well conditioned as absolute time grows.
+ */
+
+#include "include/core/velocity_estimator.h"
+
+#include <math.h>
+#include <string.h>
+
+#define VELOCITY_RING_MASK (VELOCITY_RING_CAPACITY - 1)
+
+// Rebuild the sums once the time origin lags the newest sample by this many windows
+#define VELOCITY_REBASE_WINDOWS 4
+
+static double VelocityEstimator_Det3(double a, double b, double c,
+                                     double d, double e, double f,
+                                     double g, double h, double i) {
+    return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+}
+
+// Sample `offset` places after the oldest one
+static VelocitySample* VelocityEstimator_At(VelocityEstimator* estimator, int offset) {
+    return &estimator->samples[(estimator->head + offset) & VELOCITY_RING_MASK];
+}
+
+static void VelocityEstimator_Accumulate(VelocityEstimator* estimator, const VelocitySample* sample,
+                                         double sign) {
+    double t = (double)(int64_t)(sample->time_us - estimator->base_time_us) / 1000000.0;
+    double x = sample->x - estimator->base_x;
+    double y = sample->y - estimator->base_y;
+    double t2 = t * t;
+
+    estimator->sum_t[0] += sign;
+    estimator->sum_t[1] += sign * t;
+    estimator->sum_t[2] += sign * t2;
+    estimator->sum_t[3] += sign * t2 * t;
+    estimator->sum_t[4] += sign * t2 * t2;
+    estimator->sum_x[0] += sign * x;
+    estimator->sum_x[1] += sign * t * x;
+    estimator->sum_x[2] += sign * t2 * x;
+    estimator->sum_y[0] += sign * y;
+    estimator->sum_y[1] += sign * t * y;
+    estimator->sum_y[2] += sign * t2 * y;
+}
+
+static void VelocityEstimator_Rebase(VelocityEstimator* estimator) {
+    memset(estimator->sum_t, 0, sizeof(estimator->sum_t));
+    memset(estimator->sum_x, 0, sizeof(estimator->sum_x));
+    memset(estimator->sum_y, 0, sizeof(estimator->sum_y));
+    if (estimator->count == 0) return;
+
+    const VelocitySample* newest = VelocityEstimator_At(estimator, estimator->count - 1);
+    estimator->base_time_us = newest->time_us;
+    estimator->base_x = newest->x;
+    estimator->base_y = newest->y;
+
+    for (int i = 0; i < estimator->count; i++) {
+        VelocityEstimator_Accumulate(estimator, VelocityEstimator_At(estimator, i), 1.0);
+    }
+}
+
+static void VelocityEstimator_EvictOldest(VelocityEstimator* estimator) {
+    VelocityEstimator_Accumulate(estimator, &estimator->samples[estimator->head], -1.0);
+    estimator->head = (estimator->head + 1) & VELOCITY_RING_MASK;
+    estimator->count--;
+}
+
+/**
+ * Solve the normal equations and evaluate the fit at the newest sample
+ * Quadratic with three or more samples, linear when the quadratic system is
+ * degenerate (e.g. packets sharing one timestamp), zero below two samples.
+ */
+static void VelocityEstimator_Solve(VelocityEstimator* estimator) {
+    estimator->velocity_x = 0.0f;
+    estimator->velocity_y = 0.0f;
+    estimator->acceleration_x = 0.0f;
+    estimator->acceleration_y = 0.0f;
+    estimator->speed = 0.0f;
+
+    if (estimator->count < 2) return;
+
+    const VelocitySample* newest = VelocityEstimator_At(estimator, estimator->count - 1);
+    double t_newest = (double)(int64_t)(newest->time_us - estimator->base_time_us) / 1000000.0;
+    double n = (double)estimator->count;
+    const double* s = estimator->sum_t;
+    const double* sx = estimator->sum_x;
+    const double* sy = estimator->sum_y;
+
+    if (estimator->count >= 3) {
+        double det = VelocityEstimator_Det3(n, s[1], s[2], s[1], s[2], s[3], s[2], s[3], s[4]);
+        if (fabs(det) > 1e-12 * n * s[2] * s[4] && det != 0.0) {
+            double bx = VelocityEstimator_Det3(n, sx[0], s[2],
+                                               s[1], sx[1], s[3],
+                                               s[2], sx[2], s[4]) / det;
+            double cx = VelocityEstimator_Det3(n, s[1], sx[0],
+                                               s[1], s[2], sx[1],
+                                               s[2], s[3], sx[2]) / det;
+            double by = VelocityEstimator_Det3(n, sy[0], s[2],
+                                               s[1], sy[1], s[3],
+                                               s[2], sy[2], s[4]) / det;
+            double cy = VelocityEstimator_Det3(n, s[1], sy[0],
+                                               s[1], s[2], sy[1],
+                                               s[2], s[3], sy[2]) / det;
+
+            estimator->velocity_x = (float)(bx + 2.0 * cx * t_newest);
+            estimator->velocity_y = (float)(by + 2.0 * cy * t_newest);
+            estimator->acceleration_x = (float)(2.0 * cx);
+            estimator->acceleration_y = (float)(2.0 * cy);
+            estimator->speed = sqrtf(estimator->velocity_x * estimator->velocity_x +
+                                     estimator->velocity_y * estimator->velocity_y);
+            return;
+        }
+    }
+
+    double denominator = n * s[2] - s[1] * s[1];
+    if (denominator <= 1e-12 * n * s[2] || denominator <= 0.0) return;
+
+    estimator->velocity_x = (float)((n * sx[1] - s[1] * sx[0]) / denominator);
+    estimator->velocity_y = (float)((n * sy[1] - s[1] * sy[0]) / denominator);
+    estimator->speed = sqrtf(estimator->velocity_x * estimator->velocity_x +
+                             estimator->velocity_y * estimator->velocity_y);
+}
+
+void VelocityEstimator_Reset(VelocityEstimator* estimator, uint64_t window_us) {
+    if (!estimator) return;
+
+    memset(estimator, 0, sizeof(*estimator));
+    estimator->window_us = window_us > 0 ? window_us : (uint64_t)DEFAULT_VELOCITY_WINDOW_MS * 1000;
+}
+
+void VelocityEstimator_AddSample(VelocityEstimator* estimator, uint64_t time_us, float x, float y) {
+    if (!estimator) return;
+
+    if (estimator->count > 0) {
+        const VelocitySample* newest = VelocityEstimator_At(estimator, estimator->count - 1);
+        if (time_us < newest->time_us) time_us = newest->time_us;
+
+        while (estimator->count > 0 &&
+               time_us - estimator->samples[estimator->head].time_us > estimator->window_us) {
+            VelocityEstimator_EvictOldest(estimator);
+        }
+        if (estimator->count == VELOCITY_RING_CAPACITY) {
+            VelocityEstimator_EvictOldest(estimator);
+        }
+    }
+
+    VelocitySample* sample = VelocityEstimator_At(estimator, estimator->count);
+    sample->time_us = time_us;
+    sample->x = x;
+    sample->y = y;
+    estimator->count++;
+
+    if (estimator->count == 1 ||
+        time_us - estimator->base_time_us > VELOCITY_REBASE_WINDOWS * estimator->window_us) {
+        VelocityEstimator_Rebase(estimator);
+    } else {
+        VelocityEstimator_Accumulate(estimator, sample, 1.0);
+    }
+
+    VelocityEstimator_Solve(estimator);
+}
+
+void VelocityEstimator_Expire(VelocityEstimator* estimator, uint64_t now_us) {
+    if (!estimator || estimator->count == 0) return;
+
+    bool evicted = false;
+    while (estimator->count > 0 &&
+           now_us > estimator->samples[estimator->head].time_us &&
+           now_us - estimator->samples[estimator->head].time_us > estimator->window_us) {
+        VelocityEstimator_EvictOldest(estimator);
+        evicted = true;
+    }
+
+    if (evicted) {
+        if (estimator->count == 0) {
+            VelocityEstimator_Rebase(estimator);
+        }
+        VelocityEstimator_Solve(estimator);
+    }
+}